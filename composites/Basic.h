@@ -105,6 +105,7 @@ public:
         PW_PARAM,
         PWM_PARAM,
         WAVEFORM_PARAM,
+        ECO_PARAM,
         NUM_PARAMS
     };
 
@@ -212,7 +213,8 @@ inline void Basic<TBase>::stepm() {
     numBanks_m += ((numChannels_m % 4) == 0) ? 0 : 1;
 
     auto wf = BasicVCO::Waveform((int)std::round(TBase::params[WAVEFORM_PARAM].value));
-    pProcess = vcos[0].getProcPointer(wf);
+    const bool eco = TBase::params[ECO_PARAM].value > .5f;
+    pProcess = vcos[0].getProcPointer(wf, eco);
     updateBasePitch();
     updateBasePwm();
 }
@@ -357,6 +359,9 @@ inline IComposite::Config BasicDescription<TBase>::getParam(int i) {
         case Basic<TBase>::PWM_PARAM:
             ret = {-100.0f, 100, 0, "pulse width modulation depth"};
             break;
+        case Basic<TBase>::ECO_PARAM:
+            ret = {0.0f, 1, 0, "Economy (wavetable)"};
+            break;
         default:
             assert(false);
     }
@@ -5,11 +5,14 @@
 
 #include "AudioMath.h"
 #include "IComposite.h"
+#include "IIRDecimator.h"
+#include "IIRUpsampler.h"
 #include "LookupTableFactory.h"
 #include "MultiLag.h"
 #include "ObjectCache.h"
+#include "SimdBlocks.h"
 #include "SinOscillator.h"
-#include "poly.h"
+#include "simd.h"
 
 namespace rack {
 namespace engine {
@@ -41,6 +44,19 @@ public:
  *
  * Performance measure for 1.0 = 42.44
  * reduced polynomial order to what we actually use (10), perf = 39.5
+ *
+ * Polyphonic: the number of channels follows the V/Oct input (or the external
+ * audio input, if that has more). Channels are processed four at a time in float_4,
+ * including the Chebyshev recurrence. The harmonic volumes are calculated and lagged
+ * every four samples.
+ *
+ * When running from the internal sine, harmonics that would be above nyquist
+ * are faded out, so there is no alias from the polynomials.
+ *
+ * External audio, and a sine that is driven into the clipper or folder, are not
+ * band limited, so those banks run the clip/fold and the polynomials at 4X, and
+ * decimate with an IIR. A bank stays oversampled for about a second after it last
+ * clipped, so an envelope on the gain does not switch it back and forth.
  */
 template <class TBase>
 class CHB : public TBase {
@@ -54,6 +70,8 @@ public:
     virtual ~CHB() {
     }
 
+    void init();
+
     enum ParamIds {
         PARAM_TUNE,
         PARAM_OCTAVE,
@@ -137,25 +155,67 @@ public:
         knobToFilterL = makeLPFDirectFilterLookup<float>(this->engineGetSampleTime());
     }
 
+    /**
+     * frequency of the first channel
+     */
     float _freq = 0;
 
+    int _getNumChannels() const {
+        return numChannels;
+    }
+
 private:
     int cycleCount = 1;
     int clipCount = 0;
     int signalCount = 0;
     const int clipDuration = 4000;
-    float finalGain = 0;
     bool isExternalAudio = false;
 
     static const int polyOrder = 10;
+    static const int maxChannels = 16;
+    static const int maxBanks = maxChannels / 4;
+
+    int numChannels = 1;
+    int numBanks = 1;
+    bool fold = false;
+
+    static const int oversample = 4;
+    static const int oversampleHoldTime = 11025;    // control rate ticks, one second at 44.1k
+    int oversampleHold[maxBanks] = {};
+    IIRUpsampler<float_4> upsampler[maxBanks];
+    IIRDecimator<float_4> decimator[maxBanks];
 
     /**
-     * The waveshaper that is the heart of this module.
-     * Let's use doubles.
+     * per channel state, four channels to a bank.
      */
-    Poly<double, polyOrder> poly;
+    float_4 phase[maxBanks] = {};
+    float_4 freq[maxBanks] = {};
+    float_4 finalGain[maxBanks] = {};
 
-    MultiLag<12> lag;
+    /**
+     * Lagged volume of each harmonic. Everything is done to these
+     * except removing the DC, which is folded into harmonicDC.
+     */
+    float_4 harmonicGain[maxBanks][polyOrder] = {};
+
+    /**
+     * When the input amplitude is less than one, the even
+     * polynomials put out DC. This is the sum of it, weighted by the harmonic gains.
+     */
+    float_4 harmonicDC[maxBanks] = {};
+
+    // the value of all the control rate pitch knobs
+    float basePitch = 0;
+    float pitchModTrim = 0;
+    float linearFMTrim = 0;
+
+    /**
+     * The harmonic volumes of each bank go through one lag.
+     * Only the active banks are stepped.
+     * _volume[bank][harmonic * 4 + lane]
+     */
+    MultiLag<polyOrder * 4> lag[maxBanks];
+    float _volume[maxBanks][polyOrder * 4] = {};
 
     /*
      * maps freq multiple to "octave".
@@ -163,24 +223,11 @@ private:
      */
     float _octave[polyOrder];
     float getOctave(int mult) const;
-    void init();
-
-    // round up to 12, so multi-lag is happy
-    float _volume[12] = {0};
-
-    /**
-     * Internal sine wave oscillator to drive the waveshaper
-     */
-    SinOscillatorParams<float> sinParams;
-    SinOscillatorState<float> sinState;
 
     // just maps 0..1 to 0..1
     std::shared_ptr<LookupTableParams<float>> audioTaper = {ObjectCache<float>::getAudioTaper()};
 
     AudioMath::ScaleFun<float> gainCombiner = AudioMath::makeLinearScaler(0.f, 1.f);
-
-    std::function<float(float)> expLookup = ObjectCache<float>::getExp2Ex();
-    std::shared_ptr<LookupTableParams<float>> db2gain = ObjectCache<float>::getDb2Gain();
     std::shared_ptr<LookupTableParams<float>> knobToFilterL;
 
     /**
@@ -190,17 +237,34 @@ private:
         {AudioMath::makeLinearScaler<float>(-18, 0)};
 
     /**
-     * do one-time calculations when sample rate changes
+     * Sets up the channels and all the things that
+     * only change at control rate.
      */
-    void internalUpdate();
+    void updateControlRate();
+
+    bool isOversampled(int bank) const {
+        return oversampleHold[bank] > 0;
+    }
 
     /**
      * Do all the processing to get the input waveform
-     * that will be fed to the polynomials
+     * that will be fed to the polynomials.
+     * Fills in oversample samples if the bank is oversampled, otherwise one.
+     */
+    void getInput(int bank, float_4* input);
+
+    /**
+     * Keeps x in -1...+1
      */
-    float getInput();
+    float_4 clipOrFold(float_4 x) const;
 
-    void calcVolumes(float *);
+    /**
+     * The weighted sum of all the harmonics for input x.
+     */
+    float_4 runPolynomials(int bank, float_4 x) const;
+
+    void calcVolumes(int bank);
+    void updateHarmonicGains(int bank);
 
     void checkClipping(float sample);
 
@@ -224,8 +288,12 @@ inline void CHB<TBase>::init() {
         _octave[i] = std::log2(float(i + 1));
     }
     onSampleRateChange();
-    lag.setAttack(.1f);
-    lag.setRelease(.0001f);
+    for (int bank = 0; bank < maxBanks; ++bank) {
+        lag[bank].setAttack(.1f);
+        lag[bank].setRelease(.0001f);
+        upsampler[bank].setup(oversample);
+        decimator[bank].setup(oversample);
+    }
 }
 
 template <class TBase>
@@ -245,75 +313,116 @@ inline void CHB<TBase>::updateLagTC() {
         TBase::inputs[FALL_INPUT].getVoltage(0),
         TBase::params[PARAM_FALL].value,
         1);
-    if (combinedA < .1 && combinedR < .1) {
-        lag.setEnable(false);
-    } else {
-        lag.setEnable(true);
-
-        const float lA = LookupTable<float>::lookup(*knobToFilterL, combinedA);
-        lag.setAttackL(lA);
-        const float lR = LookupTable<float>::lookup(*knobToFilterL, combinedR);
-        lag.setReleaseL(lR);
+    const bool enable = !(combinedA < .1 && combinedR < .1);
+    const float lA = enable ? LookupTable<float>::lookup(*knobToFilterL, combinedA) : 0;
+    const float lR = enable ? LookupTable<float>::lookup(*knobToFilterL, combinedR) : 0;
+
+    // set up all of them, so a bank that comes on later is ready
+    for (int bank = 0; bank < maxBanks; ++bank) {
+        lag[bank].setEnable(enable);
+        if (enable) {
+            lag[bank].setAttackL(lA);
+            lag[bank].setReleaseL(lR);
+        }
     }
 }
 
 template <class TBase>
-inline float CHB<TBase>::getInput() {
-    assert(TBase::engineGetSampleTime() > 0);
-
-    // Get the frequency from the inputs.
-    float pitch = 1.0f + roundf(TBase::params[PARAM_OCTAVE].value) +
-                  TBase::params[PARAM_SEMIS].value / 12.0f +
-                  TBase::params[PARAM_TUNE].value / 12.0f;
-    pitch += TBase::inputs[CV_INPUT].getVoltage(0);
-    pitch += .25f * TBase::inputs[PITCH_MOD_INPUT].getVoltage(0) *
-             taper(TBase::params[PARAM_PITCH_MOD_TRIM].value);
-
-    const float q = float(log2(261.626));  // move up to pitch range of EvenVCO
-    pitch += q;
-    _freq = expLookup(pitch);
-
-    if (_freq < .01f) {
-        _freq = .01f;
+inline void CHB<TBase>::updateControlRate() {
+    isExternalAudio = TBase::inputs[AUDIO_INPUT].isConnected();
+    numChannels = std::max<int>(1, TBase::inputs[CV_INPUT].channels);
+    if (isExternalAudio) {
+        numChannels = std::max<int>(numChannels, TBase::inputs[AUDIO_INPUT].channels);
     }
+    numBanks = (numChannels + 3) / 4;
+    TBase::outputs[MIX_OUTPUT].setChannels(numChannels);
+    fold = TBase::params[PARAM_FOLD].value > .5;
 
-    // Multiply in the Linear FM contribution
-    _freq *= 1.0f + TBase::inputs[LINEAR_FM_INPUT].getVoltage(0) * taper(TBase::params[PARAM_LINEAR_FM_TRIM].value);
-    float time = std::clamp(_freq * TBase::engineGetSampleTime(), -.5f, 0.5f);
-
-    Osc::setFrequency(sinParams, time);
+    const float q = float(log2(261.626));  // move up to pitch range of EvenVCO
+    basePitch = 1.0f + roundf(TBase::params[PARAM_OCTAVE].value) +
+                TBase::params[PARAM_SEMIS].value / 12.0f +
+                TBase::params[PARAM_TUNE].value / 12.0f + q;
+    pitchModTrim = .25f * taper(TBase::params[PARAM_PITCH_MOD_TRIM].value);
+    linearFMTrim = taper(TBase::params[PARAM_LINEAR_FM_TRIM].value);
+
+    const float gainKnobValue = TBase::params[PARAM_EXTGAIN].value;
+    const float gainTrimValue = TBase::params[PARAM_EXTGAIN_TRIM].value;
+    const bool envConnected = TBase::inputs[ENV_INPUT].isConnected();
+    for (int bank = 0; bank < numBanks; ++bank) {
+        const int baseChannel = bank * 4;
 
-    if (cycleCount == 0) {
         // Get the gain from the envelope generator in
         // eGain = {0 .. 10.0f }
-        float eGain = TBase::inputs[ENV_INPUT].isConnected() ? TBase::inputs[ENV_INPUT].getVoltage(0) : 10.f;
-        isExternalAudio = TBase::inputs[AUDIO_INPUT].isConnected();
-
-        const float gainKnobValue = TBase::params[PARAM_EXTGAIN].value;
-        const float gainCVValue = TBase::inputs[GAIN_INPUT].getVoltage(0);
-        const float gainTrimValue = TBase::params[PARAM_EXTGAIN_TRIM].value;
-        const float combinedGain = gainCombiner(gainCVValue, gainKnobValue, gainTrimValue);
-
-        // tapered gain {0 .. 0.5}
-        const float taperedGain = .5f * taper(combinedGain);
+        const float_4 eGain = envConnected ? TBase::inputs[ENV_INPUT].template getPolyVoltageSimd<float_4>(baseChannel) : float_4(10.f);
+        const float_4 gainCV = TBase::inputs[GAIN_INPUT].template getPolyVoltageSimd<float_4>(baseChannel);
+        float_4 taperedGain;
+        for (int i = 0; i < 4; ++i) {
+            // tapered gain {0 .. 0.5}
+            taperedGain[i] = .5f * taper(gainCombiner(gainCV[i], gainKnobValue, gainTrimValue));
+        }
 
         // final gain 0..5
-        finalGain = taperedGain * eGain;
+        finalGain[bank] = taperedGain * eGain;
+
+        // the internal sine only clips (or folds) if the gain is over one
+        if (isExternalAudio || rack::simd::movemask(finalGain[bank] > float_4(1))) {
+            if (!isOversampled(bank)) {
+                // don't start from whatever was left the last time this bank was oversampled
+                upsampler[bank].reset();
+                decimator[bank].reset();
+            }
+            oversampleHold[bank] = oversampleHoldTime;
+        } else if (oversampleHold[bank] > 0) {
+            --oversampleHold[bank];
+        }
     }
+}
 
-    float input = finalGain * (isExternalAudio ? TBase::inputs[AUDIO_INPUT].getVoltage(0) : Osc::run(sinState, sinParams));
+template <class TBase>
+inline void CHB<TBase>::getInput(int bank, float_4* input) {
+    const int baseChannel = bank * 4;
+
+    // Get the frequency from the inputs.
+    float_4 pitch = basePitch;
+    pitch += TBase::inputs[CV_INPUT].template getVoltageSimd<float_4>(baseChannel);
+    pitch += TBase::inputs[PITCH_MOD_INPUT].template getPolyVoltageSimd<float_4>(baseChannel) * pitchModTrim;
 
-    checkClipping(input);
+    float_4 f = rack::dsp::approxExp2_taylor5(pitch + 30) / 1073741824;
+    f = SimdBlocks::max(f, float_4(.01f));
 
-    // Now clip or fold to keep in -1...+1
-    if (TBase::params[PARAM_FOLD].value > .5) {
-        input = AudioMath::fold(input);
+    // Multiply in the Linear FM contribution
+    f *= 1.0f + TBase::inputs[LINEAR_FM_INPUT].template getPolyVoltageSimd<float_4>(baseChannel) * linearFMTrim;
+    freq[bank] = f;
+
+    const int numSamples = isOversampled(bank) ? oversample : 1;
+    if (isExternalAudio) {
+        const float_4 x = TBase::inputs[AUDIO_INPUT].template getPolyVoltageSimd<float_4>(baseChannel) * finalGain[bank];
+        if (numSamples > 1) {
+            upsampler[bank].process(input, x);
+        } else {
+            input[0] = x;
+        }
     } else {
-        input = std::max(input, -1.f);
-        input = std::min(input, 1.f);
+        const float_4 time = rack::simd::clamp(f * TBase::engineGetSampleTime(), -.5f, .5f) / float(numSamples);
+        for (int i = 0; i < numSamples; ++i) {
+            phase[bank] = SimdBlocks::wrapPhase01(phase[bank] + time);
+            input[i] = rack::simd::sin(phase[bank] * float(2 * AudioMath::Pi)) * finalGain[bank];
+        }
+    }
+
+    if (bank == 0) {
+        _freq = f[0];
+        checkClipping(input[0][0]);
+    }
+
+    for (int i = 0; i < numSamples; ++i) {
+        input[i] = clipOrFold(input[i]);
     }
+}
 
-    return input;
+template <class TBase>
+inline float_4 CHB<TBase>::clipOrFold(float_4 x) const {
+    return fold ? SimdBlocks::fold(x) : rack::simd::clamp(x, -1.f, 1.f);
 }
 
 /**
@@ -348,16 +457,22 @@ inline void CHB<TBase>::checkClipping(float input) {
     }
 }
 
+/**
+ * Puts the volumes for the four channels in bank into _volume
+ */
 template <class TBase>
-inline void CHB<TBase>::calcVolumes(float *volumes) {
+inline void CHB<TBase>::calcVolumes(int bank) {
+    const int baseChannel = bank * 4;
+    float_4 volumes[polyOrder];
+
     // first get the harmonics knobs, and scale them
     for (int i = 0; i < numHarmonics; ++i) {
-        float val = taper(TBase::params[i + PARAM_H0].value);  // apply taper to the knobs
+        float_4 val = taper(TBase::params[i + PARAM_H0].value);  // apply taper to the knobs
 
         // If input connected, scale and multiply with knob value
         if (TBase::inputs[i + H0_INPUT].isConnected()) {
-            const float inputCV = TBase::inputs[i + H0_INPUT].getVoltage(0) * .1f;
-            val *= std::max(inputCV, 0.f);
+            const float_4 inputCV = TBase::inputs[i + H0_INPUT].template getPolyVoltageSimd<float_4>(baseChannel) * .1f;
+            val *= SimdBlocks::max(inputCV, float_4::zero());
         }
 
         volumes[i] = val;
@@ -365,37 +480,108 @@ inline void CHB<TBase>::calcVolumes(float *volumes) {
 
     // Second: apply the even and odd knobs
     {
-        const float evenCombined = gainCombiner(
-            TBase::inputs[EVEN_INPUT].getVoltage(0),
-            TBase::params[PARAM_MAG_EVEN].value,
-            TBase::params[PARAM_EVEN_TRIM].value);
-
-        const float oddCombined = gainCombiner(
-            TBase::inputs[ODD_INPUT].getVoltage(0),
-            TBase::params[PARAM_MAG_ODD].value,
-            TBase::params[PARAM_ODD_TRIM].value);
-
-        const float even = taper(evenCombined);
-        const float odd = taper(oddCombined);
+        const float_4 evenCV = TBase::inputs[EVEN_INPUT].template getPolyVoltageSimd<float_4>(baseChannel);
+        const float_4 oddCV = TBase::inputs[ODD_INPUT].template getPolyVoltageSimd<float_4>(baseChannel);
+        float_4 even;
+        float_4 odd;
+        for (int i = 0; i < 4; ++i) {
+            even[i] = taper(gainCombiner(evenCV[i], TBase::params[PARAM_MAG_EVEN].value, TBase::params[PARAM_EVEN_TRIM].value));
+            odd[i] = taper(gainCombiner(oddCV[i], TBase::params[PARAM_MAG_ODD].value, TBase::params[PARAM_ODD_TRIM].value));
+        }
         for (int i = 1; i < polyOrder; ++i) {
-            const float mul = (i & 1) ? even : odd;  // 0 = fundamental, 1=even, 2=odd....
-            volumes[i] *= mul;
+            volumes[i] *= (i & 1) ? even : odd;  // 0 = fundamental, 1=even, 2=odd....
         }
     }
 
     // Third: slope
     {
-        const float slope = slopeScale(
-            TBase::inputs[SLOPE_INPUT].getVoltage(0),
-            TBase::params[PARAM_SLOPE].value,
-            TBase::params[PARAM_SLOPE_TRIM].value);
+        const float_4 slopeCV = TBase::inputs[SLOPE_INPUT].template getPolyVoltageSimd<float_4>(baseChannel);
+        float_4 slope;
+        for (int i = 0; i < 4; ++i) {
+            slope[i] = slopeScale(slopeCV[i], TBase::params[PARAM_SLOPE].value, TBase::params[PARAM_SLOPE_TRIM].value);
+        }
 
+        // db to gain is 2 ** (db * log2(10) / 20)
+        const float dbToExp2 = float(std::log2(10.0) / 20.0);
         for (int i = 0; i < polyOrder; ++i) {
-            float slopeAttenDb = slope * getOctave(i);
-            float slopeAtten = LookupTable<float>::lookup(*db2gain, slopeAttenDb);
-            volumes[i] *= slopeAtten;
+            const float_4 slopeAttenDb = slope * getOctave(i);
+            volumes[i] *= rack::dsp::approxExp2_taylor5(slopeAttenDb * dbToExp2 + 30) / 1073741824;
+        }
+    }
+
+    // Last: fade out harmonics that would alias
+    if (!isExternalAudio) {
+        const float nyquist = TBase::engineGetSampleRate() / 2;
+        const float fadeWidth = .1f * nyquist;
+        const float_4 absFreq = rack::simd::fabs(freq[bank]);
+        for (int i = 1; i < polyOrder; ++i) {
+            const float_4 headroom = nyquist - absFreq * float(i + 1);
+            volumes[i] *= rack::simd::clamp(headroom / fadeWidth, 0.f, 1.f);
         }
     }
+
+    for (int i = 0; i < polyOrder; ++i) {
+        volumes[i].store(_volume[bank] + i * 4);
+    }
+}
+
+/**
+ * Picks up the lagged volumes for bank, and figures out the DC
+ * they will make.
+ */
+template <class TBase>
+inline void CHB<TBase>::updateHarmonicGains(int bank) {
+    const float* lagged = lag[bank].get();
+    for (int i = 0; i < polyOrder; ++i) {
+        harmonicGain[bank][i] = float_4::load(lagged + i * 4);
+    }
+
+    // The DC of T(n) driven by a sin of amplitude g.
+    // Integrals of sin**n over a period.
+    const float W2 = 2.0f / 4.0f;
+    const float W4 = W2 * 3.0f / 4.0f;
+    const float W6 = W4 * 5.0f / 6.0f;
+    const float W8 = W6 * 7.0f / 8.0f;
+    const float W10 = W8 * 9.0f / 10.0f;
+
+    const float_4 g = SimdBlocks::min(finalGain[bank], float_4(1));
+    const float_4 g2 = g * g;
+    const float_4 g4 = g2 * g2;
+    const float_4 g6 = g4 * g2;
+    const float_4 g8 = g6 * g2;
+    const float_4 g10 = g8 * g2;
+
+    const float_4 dc2 = 2 * W2 * g2 - 1;
+    const float_4 dc4 = 8 * W4 * g4 - 8 * W2 * g2 + 1;
+    const float_4 dc6 = 32 * W6 * g6 - 48 * W4 * g4 + 18 * W2 * g2 - 1;
+    const float_4 dc8 = 128 * W8 * g8 - 256 * W6 * g6 + 160 * W4 * g4 - 32 * W2 * g2 + 1;
+    const float_4 dc10 = 512 * W10 * g10 - 1280 * W8 * g8 + 1120 * W6 * g6 - 400 * W4 * g4 + 50 * W2 * g2 - 1;
+
+    // harmonic index 1 is T(2), etc.
+    harmonicDC[bank] =
+        harmonicGain[bank][1] * dc2 +
+        harmonicGain[bank][3] * dc4 +
+        harmonicGain[bank][5] * dc6 +
+        harmonicGain[bank][7] * dc8 +
+        harmonicGain[bank][9] * dc10;
+}
+
+template <class TBase>
+inline float_4 CHB<TBase>::runPolynomials(int bank, float_4 x) const {
+    // Chebyshev recurrence: T(n+1) = 2x * T(n) - T(n-1)
+    const float_4 twoX = x + x;
+    const float_4* gain = harmonicGain[bank];
+
+    float_4 tPrev = 1;
+    float_4 t = x;
+    float_4 sum = gain[0] * x - harmonicDC[bank];
+    for (int i = 1; i < polyOrder; ++i) {
+        const float_4 tNext = twoX * t - tPrev;
+        sum += gain[i] * tNext;
+        tPrev = t;
+        t = tNext;
+    }
+    return sum;
 }
 
 template <class TBase>
@@ -404,23 +590,41 @@ inline void CHB<TBase>::step() {
         cycleCount = 3;
     }
 
+    if (cycleCount == 0) {
+        updateControlRate();
+    }
+
     // do all the processing to get the carrier signal
     // Does the pitch every cycle, vol every 4
-    const float input = getInput();
+    float_4 input[maxBanks][oversample];
+    for (int bank = 0; bank < numBanks; ++bank) {
+        getInput(bank, input[bank]);
+        if (cycleCount == 0) {
+            calcVolumes(bank);
+        }
+    }
 
     if (cycleCount == 0) {
         updateLagTC();         // TODO: could do at reduced rate
-        calcVolumes(_volume);  // now _volume has all 10 harmonic volumes
-        lag.step(_volume);     // TODO: we could run lag at full rate.
-
-        for (int i = 0; i < polyOrder; ++i) {
-            //poly.setGain(i, _volume[i]);
-            poly.setGain(i, lag.get(i));
+        for (int bank = 0; bank < numBanks; ++bank) {
+            lag[bank].step(_volume[bank]);     // TODO: we could run lag at full rate.
+            updateHarmonicGains(bank);
         }
     }
 
-    float output = poly.run(input, std::min(finalGain, 1.f));
-    TBase::outputs[MIX_OUTPUT].setVoltage(5.0f * output, 0);
+    for (int bank = 0; bank < numBanks; ++bank) {
+        float_4 sum;
+        if (isOversampled(bank)) {
+            float_4 buffer[oversample];
+            for (int i = 0; i < oversample; ++i) {
+                buffer[i] = runPolynomials(bank, input[bank][i]);
+            }
+            sum = decimator[bank].process(buffer);
+        } else {
+            sum = runPolynomials(bank, input[bank][0]);
+        }
+        TBase::outputs[MIX_OUTPUT].setVoltageSimd(sum * 5.f, bank * 4);
+    }
 }
 
 template <class TBase>
@@ -4,10 +4,9 @@
 
 #include "AudioMath.h"
 #include "FFT.h"
-#include "FFTCrossFader.h"
 #include "FFTData.h"
 #include "IComposite.h"
-#include "ManagedPool.h"
+#include "NoiseSpectrumBank.h"
 #include "ThreadClient.h"
 #include "ThreadServer.h"
 #include "ThreadSharedState.h"
@@ -19,7 +18,6 @@ struct Module;
 }
 }  // namespace rack
 using Module = ::rack::engine::Module;
-class NoiseMessage;
 
 template <class TBase>
 class ColoredNoiseDescription : public IComposite {
@@ -28,22 +26,43 @@ public:
     int getNumParams() override;
 };
 
-const int crossfadeSamples = 4 * 1024;
+/**
+ * The server thread sends back the NoiseSpectrumBank
+ * in one of these.
+ */
+class NoiseBankMessage : public ThreadMessage {
+public:
+    NoiseBankMessage() : ThreadMessage(Type::NOISE_BANK) {
+    }
+
+    std::shared_ptr<const NoiseSpectrumBank> bank;
+};
 
 /**
  * Implementation of the "Colors" noises generator
  *
  * Original CPI = 11.7
  * service thread less often and iput less often -> 5.6
+ *
+ * Noise is played from a NoiseSpectrumBank, so slope changes
+ * just change the mix of two frames. The server thread is
+ * only used once, to get the bank.
+ *
+ * Polyphonic: there is one output channel for each channel of slope CV.
+ * All the channels play the same (shared) bank, each with its
+ * own slope, but from offsets spread evenly through the frames
+ * so that the channels are not correlated.
+ * Every instance also starts from its own random offset, so that
+ * two modules don't play the same noise.
  */
 template <class TBase>
 class ColoredNoise : public TBase {
 public:
-    ColoredNoise(Module* module) : TBase(module), crossFader(crossfadeSamples) {
+    ColoredNoise(Module* module) : TBase(module) {
         commonConstruct();
     }
 
-    ColoredNoise() : TBase(), crossFader(crossfadeSamples) {
+    ColoredNoise() : TBase() {
         commonConstruct();
     }
 
@@ -91,6 +110,9 @@ public:
     */
     void step() override;
 
+    /**
+     * Slope of the first channel
+     */
     float getSlope() const;
 
     int _msgCount() const;  // just for debugging
@@ -101,22 +123,23 @@ private:
     bool isRequestPending = false;
     int cycleCount = 1;
 
-    /**
-     * crossFader generates the audio, but we must
-     * feed it with NoiseMessage data from the ThreadServer
-     */
-    FFTCrossFader crossFader;
-
     // just for debugging
     int messageCount = 0;
 
     std::unique_ptr<ThreadClient> thread;
+    NoiseBankMessage bankMessage;
 
     /**
-     * Messages moved between thread, messagePool, and crossFader
-     * as new noise slopes are requested in response to CV/knob changes.
+     * Null until the server thread sends it to us.
      */
-    ManagedPool<NoiseMessage, 2> messagePool;
+    std::shared_ptr<const NoiseSpectrumBank> bank;
+
+    static const int maxChannels = 16;
+    static const int channelSpacing = NoiseSpectrumBank::numBins / maxChannels;
+    int numChannels = 1;
+    NoiseSpectrumBank::Mix mix[maxChannels];
+    float slope[maxChannels] = {0};
+    int playOffset = 0;
 
     void serviceFFTServer();
     void serviceAudio();
@@ -124,6 +147,9 @@ private:
     void commonConstruct();
 };
 
+/**
+ * A single frame of noise, as played by FFTCrossFader.
+ */
 class NoiseMessage : public ThreadMessage {
 public:
     NoiseMessage() : ThreadMessage(Type::NOISE),
@@ -139,7 +165,7 @@ public:
 
     ColoredNoiseSpec noiseSpec;
 
-    /** Server is going to fill this buffer up with time-domain data
+    /** Time-domain data
      */
     std::unique_ptr<FFTDataReal> dataBuffer;
 };
@@ -155,51 +181,33 @@ protected:
      * We have plenty of time to do some heavy lifting here.
      */
     virtual void handleMessage(ThreadMessage* msg) override {
-        if (msg->type != ThreadMessage::Type::NOISE) {
+        if (msg->type != ThreadMessage::Type::NOISE_BANK) {
             assert(false);
             return;
         }
 
-        // Unpack the parameters, convert to frequency domain "noise" recipe
-        NoiseMessage* noiseMessage = static_cast<NoiseMessage*>(msg);
-        reallocSpectrum(noiseMessage);
-        FFT::makeNoiseSpectrum(noiseSpectrum.get(),
-                               noiseMessage->noiseSpec);
-
-        // Now inverse FFT to time domain noise in client's buffer
-        FFT::inverse(noiseMessage->dataBuffer.get(), *noiseSpectrum.get());
-        FFT::normalize(noiseMessage->dataBuffer.get(), 5);  // use 5v amplitude.
-        sendMessageToClient(noiseMessage);
-    }
-
-private:
-    std::unique_ptr<FFTDataCpx> noiseSpectrum;
-
-    // may do nothing, may create the first buffer,
-    // may delete the old buffer and make a new one.
-    void reallocSpectrum(const NoiseMessage* msg) {
-        if (noiseSpectrum && ((int)noiseSpectrum->size() == msg->dataBuffer->size())) {
-            return;
-        }
-
-        noiseSpectrum.reset(new FFTDataCpx(msg->dataBuffer->size()));
+        // The first time this will build the bank, which is slow.
+        NoiseBankMessage* bankMessage = static_cast<NoiseBankMessage*>(msg);
+        bankMessage->bank = NoiseSpectrumBank::get();
+        sendMessageToClient(bankMessage);
     }
 };
 
 template <class TBase>
 float ColoredNoise<TBase>::getSlope() const {
-    const NoiseMessage* curMsg = crossFader.playingMessage();
-    return curMsg ? curMsg->noiseSpec.slope : 0;
+    return slope[0];
 }
 
 template <class TBase>
 void ColoredNoise<TBase>::commonConstruct() {
-    crossFader.enableMakeupGain(true);
     std::shared_ptr<ThreadSharedState> threadState = std::make_shared<ThreadSharedState>();
     std::unique_ptr<ThreadServer> server(new NoiseServer(threadState));
 
     std::unique_ptr<ThreadClient> client(new ThreadClient(threadState, std::move(server)));
     this->thread = std::move(client);
+
+    const float r = AudioMath::random()();
+    playOffset = int(r * NoiseSpectrumBank::numBins) & (NoiseSpectrumBank::numBins - 1);
 }
 
 template <class TBase>
@@ -209,93 +217,65 @@ int ColoredNoise<TBase>::_msgCount() const {
 
 template <class TBase>
 void ColoredNoise<TBase>::serviceFFTServer() {
-    // see if we need to request first frame of sample data
-    // first request will be white noise. Is that ok?
-    if (!isRequestPending && crossFader.empty()) {
-        assert(!messagePool.empty());
-        NoiseMessage* msg = messagePool.pop();
-
-        bool sent = thread->sendMessage(msg);
-        if (sent) {
-            isRequestPending = true;
-        } else {
-            messagePool.push(msg);
-        }
+    if (bank) {
+        return;  // we have everything we need
+    }
+
+    // request the bank
+    if (!isRequestPending) {
+        isRequestPending = thread->sendMessage(&bankMessage);
     }
 
-    // see if any messages came back for us
+    // see if it came back for us
     ThreadMessage* newMsg = thread->getMessage();
     if (newMsg) {
         ++messageCount;
-        assert(newMsg->type == ThreadMessage::Type::NOISE);
-        NoiseMessage* noise = static_cast<NoiseMessage*>(newMsg);
-
+        assert(newMsg == &bankMessage);
         isRequestPending = false;
-
-        // put it in the cross fader for playback
-        // give the last one back
-        NoiseMessage* oldMsg = crossFader.acceptData(noise);
-        if (oldMsg) {
-            messagePool.push(oldMsg);
+        bank = bankMessage.bank;
+        for (int i = 0; i < maxChannels; ++i) {
+            mix[i] = bank->getMix(slope[i]);
         }
     }
 }
 
 template <class TBase>
 void ColoredNoise<TBase>::serviceAudio() {
-    float output = 0;
-    NoiseMessage* oldMessage = crossFader.step(&output);
-    if (oldMessage) {
-        // One frame may be done fading - we can take it back.
-        messagePool.push(oldMessage);
+    if (!bank) {
+        for (int i = 0; i < numChannels; ++i) {
+            TBase::outputs[AUDIO_OUTPUT].setVoltage(0, i);
+        }
+        return;
     }
 
-    TBase::outputs[AUDIO_OUTPUT].setVoltage(output, 0);
+    // numBins is a power of two, so we can wrap with a mask
+    const int mask = NoiseSpectrumBank::numBins - 1;
+    for (int i = 0; i < numChannels; ++i) {
+        const int offset = (playOffset + i * channelSpacing) & mask;
+        const float lower = mix[i].lower[offset];
+        const float output = lower + mix[i].upperGain * (mix[i].upper[offset] - lower);
+        TBase::outputs[AUDIO_OUTPUT].setVoltage(output, i);
+    }
+    playOffset = (playOffset + 1) & mask;
 }
 
 template <class TBase>
 void ColoredNoise<TBase>::serviceInputs() {
-    if (isRequestPending) {
-        return;  // can't do anything until server is free.
-    }
-    if (crossFader.empty()) {
-        return;  // if we don't have data, we will be asking anyway
-    }
-    if (messagePool.empty()) {
-        return;  // all our buffers are in use
-    }
-
-    T combinedSlope = cv_scaler(
-        TBase::inputs[SLOPE_CV].getVoltage(0),
-        TBase::params[SLOPE_PARAM].value,
-        TBase::params[SLOPE_TRIM].value);
-
-    // get slope input to one decimal place
-    int i = int(combinedSlope * 10);
-    combinedSlope = i / 10.f;
-    ColoredNoiseSpec sp;
-    sp.slope = combinedSlope;
-    sp.highFreqCorner = 6000;
-    const NoiseMessage* playingData = crossFader.playingMessage();
-    if (!playingData || !(sp != playingData->noiseSpec)) {
-        // If we aren't playing yet, or no change in slope,
-        // the don't do anything
-        return;
-    }
-
-    assert(!messagePool.empty());
-    NoiseMessage* msg = messagePool.pop();
-    assert(msg);
-    if (!msg) {
-        return;
-    }
-    msg->noiseSpec = sp;
-    // TODO: put this logic in one place
-    bool sent = thread->sendMessage(msg);
-    if (sent) {
-        isRequestPending = true;
-    } else {
-        messagePool.push(msg);
+    numChannels = std::max<int>(1, TBase::inputs[SLOPE_CV].channels);
+    TBase::outputs[AUDIO_OUTPUT].setChannels(numChannels);
+
+    for (int i = 0; i < numChannels; ++i) {
+        const T combinedSlope = cv_scaler(
+            TBase::inputs[SLOPE_CV].getVoltage(i),
+            TBase::params[SLOPE_PARAM].value,
+            TBase::params[SLOPE_TRIM].value);
+
+        if (combinedSlope != slope[i]) {
+            slope[i] = combinedSlope;
+            if (bank) {
+                mix[i] = bank->getMix(combinedSlope);
+            }
+        }
     }
 }
 
@@ -162,6 +162,21 @@ private:
     void stepn();
     void pollAttackRelease();
 
+    template <Cmprsr::Kernel k>
+    void processBanks();
+
+    /**
+     * Calls processBanks<k> for the kernel KernelDispatch picks.
+     */
+    struct BankProcessor {
+        Compressor& comp;
+
+        template <class K>
+        void operator()(K) {
+            comp.template processBanks<K::value>();
+        }
+    };
+
     int numChannelsL_m = 0;
     int numBanksL_m = 0;
     int numChannelsR_m = 0;
@@ -347,10 +362,23 @@ inline void Compressor<TBase>::process(const typename TBase::ProcessArgs& args)
         return;
     }
 
+    // stepn gives every bank the same curve and times, so they all use the same kernel.
+    // Pick it once for all of them.
+    Cmprsr::KernelDispatch::call(compressorsL[0].getKernel(), BankProcessor{*this});
+}
+
+template <class TBase>
+template <Cmprsr::Kernel k>
+inline void Compressor<TBase>::processBanks() {
+    SqInput& inPortL = TBase::inputs[LAUDIO_INPUT];
+    SqOutput& outPortL = TBase::outputs[LAUDIO_OUTPUT];
+    SqInput& inPortR = TBase::inputs[RAUDIO_INPUT];
+    SqOutput& outPortR = TBase::outputs[RAUDIO_OUTPUT];
+
     for (int bank = 0; bank < numBanksL_m; ++bank) {
         const int baseChannel = bank * 4;
         const float_4 input = inPortL.getPolyVoltageSimd<float_4>(baseChannel);
-        const float_4 wetOutput = compressorsL[bank].step(input) * makeupGain_m;
+        const float_4 wetOutput = compressorsL[bank].step<k>(input) * makeupGain_m;
         const float_4 mixedOutput = wetOutput * wetLevel + input * dryLevel;
 
         outPortL.setVoltageSimd(mixedOutput, baseChannel);
@@ -358,7 +386,7 @@ inline void Compressor<TBase>::process(const typename TBase::ProcessArgs& args)
     for (int bank = 0; bank < numBanksR_m; ++bank) {
         const int baseChannel = bank * 4;
         const float_4 input = inPortR.getPolyVoltageSimd<float_4>(baseChannel);
-        const float_4 wetOutput = compressorsR[bank].step(input) * makeupGain_m;
+        const float_4 wetOutput = compressorsR[bank].step<k>(input) * makeupGain_m;
         const float_4 mixedOutput = wetOutput * wetLevel + input * dryLevel;
 
         outPortR.setVoltageSimd(mixedOutput, baseChannel);
@@ -11,6 +11,7 @@
 #include "IComposite.h"
 #include "LookupTableFactory.h"
 #include "ObjectCache.h"
+#include "SimdDispatch.h"
 #include "SqPort.h"
 
 namespace rack {
@@ -115,18 +116,147 @@ private:
     CompressorParmHolder compParams;
     unsigned int currentChannel = 0;        // which of the 16 channels we are editing ATM.
 
-    Cmprsr compressors[4];
+    /**
+     * The compressors for all 16 channels.
+     * init() makes one set of banks: float_8 on a CPU with AVX,
+     * and float_4 otherwise, the SSE fallback.
+     */
+    class BanksBase {
+    public:
+        virtual ~BanksBase() {}
+        virtual void setNumChannels(int numChannels) = 0;
+        virtual void setCurve(float threshold, Cmprsr::Ratios ratio) = 0;
+        virtual void setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) = 0;
+        virtual float getChannelGain(int ch) const = 0;
+        virtual float getMinGain() const = 0;
+        virtual void process(Compressor2&) = 0;
+    };
+
+    /**
+     * The work of BanksBase, for lane type T.
+     */
+    template <typename T>
+    class Banks {
+    public:
+        static const int lanes = T::size;
+        static const int maxBanks = 16 / lanes;
+
+        void setNumChannels(int numChannels) {
+            numBanks = (numChannels / lanes) + ((numChannels % lanes) ? 1 : 0);
+            for (int i = 0; i < numBanks; ++i) {
+                const int baseChannel = i * lanes;
+                compressors[i].setNumChannels(std::min(int(lanes), numChannels - baseChannel));
+            }
+        }
+
+        void setCurve(float threshold, Cmprsr::Ratios ratio) {
+            for (int i = 0; i < maxBanks; ++i) {
+                compressors[i].setThreshold(threshold);
+                compressors[i].setCurve(ratio);
+            }
+        }
+
+        void setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) {
+            for (int i = 0; i < maxBanks; ++i) {
+                compressors[i].setTimes(attackMs, releaseMs, sampleTime, enableDistortionReduction);
+            }
+        }
+
+        float getChannelGain(int ch) const {
+            const int bank = ch / lanes;
+            return compressors[bank].getGain()[ch - bank * lanes];
+        }
+
+        float getMinGain() const {
+            float minGain = 1;
+            for (int bank = 0; bank < numBanks; ++bank) {
+                const T gain = compressors[bank].getGain();
+                for (int i = 0; i < lanes; ++i) {
+                    minGain = std::min(minGain, gain[i]);
+                }
+            }
+            return minGain;
+        }
+
+        /**
+         * stepn gives every bank the same curve and times, so they all use the same kernel.
+         * Pick it once for all of them.
+         */
+        void process(Compressor2& comp) {
+            Cmprsr::KernelDispatch::call(compressors[0].getKernel(), BankProcessor<T>{comp, *this});
+        }
+
+        int numBanks = 0;
+        CmprsrT<T> compressors[maxBanks];
+    };
+
+    class Banks4 : public BanksBase {
+    public:
+        void setNumChannels(int numChannels) override { banks.setNumChannels(numChannels); }
+        void setCurve(float threshold, Cmprsr::Ratios ratio) override { banks.setCurve(threshold, ratio); }
+        void setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) override {
+            banks.setTimes(attackMs, releaseMs, sampleTime, enableDistortionReduction);
+        }
+        float getChannelGain(int ch) const override { return banks.getChannelGain(ch); }
+        float getMinGain() const override { return banks.getMinGain(); }
+        void process(Compressor2& comp) override { banks.process(comp); }
+
+    private:
+        Banks<float_4> banks;
+    };
+
+    /**
+     * Every entry point here is built for AVX, and flattened, so all the float_8
+     * code is inlined into them. Only ints, floats and references go in and out,
+     * so no float_8 is ever passed between AVX code and SSE code.
+     * init() only makes one of these if we have AVX.
+     */
+    class Banks8 : public BanksBase {
+    public:
+        SQ_TARGET_AVX SQ_FLATTEN Banks8() {}
+        SQ_TARGET_AVX SQ_FLATTEN void setNumChannels(int numChannels) override { banks.setNumChannels(numChannels); }
+        SQ_TARGET_AVX SQ_FLATTEN void setCurve(float threshold, Cmprsr::Ratios ratio) override { banks.setCurve(threshold, ratio); }
+        SQ_TARGET_AVX SQ_FLATTEN void setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) override {
+            banks.setTimes(attackMs, releaseMs, sampleTime, enableDistortionReduction);
+        }
+        SQ_TARGET_AVX SQ_FLATTEN float getChannelGain(int ch) const override { return banks.getChannelGain(ch); }
+        SQ_TARGET_AVX SQ_FLATTEN float getMinGain() const override { return banks.getMinGain(); }
+        SQ_TARGET_AVX SQ_FLATTEN void process(Compressor2& comp) override { banks.process(comp); }
+
+    private:
+        Banks<float_8> banks;
+    };
+
+    std::unique_ptr<BanksBase> banks;
+
     void setupLimiter();
     void stepn();
     void pollAttackRelease();
 
+    template <Cmprsr::Kernel k, typename T>
+    void processBanks(Banks<T>&);
+
+    /**
+     * Calls processBanks<k> for the kernel KernelDispatch picks.
+     */
+    template <typename T>
+    struct BankProcessor {
+        Compressor2& comp;
+        Banks<T>& banks;
+
+        template <class K>
+        void operator()(K) {
+            comp.template processBanks<K::value>(banks);
+        }
+    };
+
     int numChannels_m = 0;
     int numBanks_m = 0;
 
 
-    float_4 wetLevel = 0;
-    float_4 dryLevel = 0;
-    float_4 makeupGain_m = 1;
+    float wetLevel = 0;
+    float dryLevel = 0;
+    float makeupGain_m = 1;
     Divider divn;
 
     // we could unify this stuff with the ui stuff, above.
@@ -159,6 +289,11 @@ inline const std::vector<std::string>& Compressor2<TBase>::ratiosLong() {
 
 template <class TBase>
 inline void Compressor2<TBase>::init() {
+    if (SimdDispatch::hasAVX()) {
+        banks.reset(new Banks8());
+    } else {
+        banks.reset(new Banks4());
+    }
     setupLimiter();
     divn.setup(32, [this]() {
         this->stepn();
@@ -177,11 +312,8 @@ inline void Compressor2<TBase>::init() {
  */
 template <class TBase>
 inline float Compressor2<TBase>::getChannelGain(int ch) const {
-    const int bank = ch / 4;
-    const int subChan = ch - bank * 4;
     // TODO:db
-    float_4 g = compressors[bank].getGain();
-    float gainReduction = g[subChan];
+    float gainReduction = banks->getChannelGain(ch);
 #if 0
     if (ch == 0) {
         {
@@ -189,7 +321,7 @@ inline float Compressor2<TBase>::getChannelGain(int ch) const {
             static float lastReduction = 0;
             if (!AudioMath::closeTo(gainReduction, lastReduction, .05)) {
                 lastReduction = gainReduction;
-                printf("%d gain r [0] = %f full sse=%s\n", count++, gainReduction, toStr(g).c_str());
+                printf("%d gain r [0] = %f\n", count++, gainReduction);
                 fflush(stdout);
             }
         }
@@ -203,19 +335,11 @@ inline float Compressor2<TBase>::getChannelGain(int ch) const {
 
 template <class TBase>
 inline float Compressor2<TBase>::getGainReductionDb() const {
-    float_4 minGain_4 = 1;
     if (bypassed) {
         return 0;
     }
 
-    for (int bank = 0; bank < numBanks_m; ++bank) {
-        minGain_4 = SimdBlocks::min(minGain_4, compressors[bank].getGain());
-    }
-
-    float minGain = minGain_4[0];
-    minGain = std::min(minGain, minGain_4[1]);
-    minGain = std::min(minGain, minGain_4[2]);
-    minGain = std::min(minGain, minGain_4[3]);
+    const float minGain = banks->getMinGain();
     auto r = AudioMath::db(minGain);
     return -r;
 }
@@ -255,23 +379,17 @@ inline void Compressor2<TBase>::stepn() {
         lastRatio = rawRatio;
         lastNumChannels = numChannels_m;
         Cmprsr::Ratios ratio = Cmprsr::Ratios(int(std::round(rawRatio)));
-        for (int i = 0; i < 4; ++i) {
-            compressors[i].setThreshold(threshold);
-            compressors[i].setCurve(ratio);
-
-            if (i < numBanks_m) {
-                const int baseChannel = i * 4;
-                const int chanThisBank = std::min(4, numChannels_m - baseChannel);
-                compressors[i].setNumChannels(chanThisBank);
-            }
+        banks->setCurve(threshold, ratio);
+        banks->setNumChannels(numChannels_m);
 #if 0
+        for (int i = 0; i < 4; ++i) {
             if (i < numBanksR_m) {
                 const int baseChannel = i * 4;
                 const int chanThisBankR = std::min(4, numChannelsR_m - baseChannel);
                 compressorsR[i].setNumChannels(chanThisBankR);
             }
-#endif
         }
+#endif
     }
 
     bypassed = !bool(std::round(Compressor2<TBase>::params[NOTBYPASS_PARAM].value));
@@ -291,10 +409,7 @@ inline void Compressor2<TBase>::pollAttackRelease() {
         const float attack = LookupTable<float>::lookup(attackFunctionParams, rawAttack);
         const float release = LookupTable<float>::lookup(releaseFunctionParams, rawRelease);
 
-        for (int i = 0; i < 4; ++i) {
-            compressors[i].setTimes(attack, release, TBase::engineGetSampleTime(), reduceDistortion);
-            //     compressorsR[i].setTimes(attack, release, TBase::engineGetSampleTime(), reduceDistortion);
-        }
+        banks->setTimes(attack, release, TBase::engineGetSampleTime(), reduceDistortion);
     }
 }
 
@@ -323,11 +438,23 @@ inline void Compressor2<TBase>::process(const typename TBase::ProcessArgs& args)
         return;
     }
 
-    for (int bank = 0; bank < numBanks_m; ++bank) {
-        const int baseChannel = bank * 4;
-        const float_4 input = inPort.getPolyVoltageSimd<float_4>(baseChannel);
-        const float_4 wetOutput = compressors[bank].step(input) * makeupGain_m;
-        const float_4 mixedOutput = wetOutput * wetLevel + input * dryLevel;
+    banks->process(*this);
+}
+
+template <class TBase>
+template <Cmprsr::Kernel k, typename T>
+inline void Compressor2<TBase>::processBanks(Banks<T>& banks) {
+    SqInput& inPort = TBase::inputs[LAUDIO_INPUT];
+    SqOutput& outPort = TBase::outputs[LAUDIO_OUTPUT];
+
+    const T makeupGain = makeupGain_m;
+    const T wet = wetLevel;
+    const T dry = dryLevel;
+    for (int bank = 0; bank < banks.numBanks; ++bank) {
+        const int baseChannel = bank * Banks<T>::lanes;
+        const T input = inPort.getPolyVoltageSimd<T>(baseChannel);
+        const T wetOutput = banks.compressors[bank].template step<k>(input) * makeupGain;
+        const T mixedOutput = wetOutput * wet + input * dry;
 
         outPort.setVoltageSimd(mixedOutput, baseChannel);
     }
@@ -335,7 +462,7 @@ inline void Compressor2<TBase>::process(const typename TBase::ProcessArgs& args)
     for (int bank = 0; bank < numBanksR_m; ++bank) {
         const int baseChannel = bank * 4;
         const float_4 input = inPortR.getPolyVoltageSimd<float_4>(baseChannel);
-        const float_4 wetOutput = compressorsR[bank].step(input) * makeupGain_m;
+        const float_4 wetOutput = compressorsR[bank].step<k>(input) * makeupGain_m;
         const float_4 mixedOutput = wetOutput * wetLevel + input * dryLevel;
 
         outPortR.setVoltageSimd(mixedOutput, baseChannel);
@@ -346,9 +473,9 @@ inline void Compressor2<TBase>::process(const typename TBase::ProcessArgs& args)
 // TODO: do we still need this old init function? combine with other?
 template <class TBase>
 inline void Compressor2<TBase>::setupLimiter() {
-    for (int i = 0; i < 4; ++i) {
-        compressors[i].setTimes(1, 100, TBase::engineGetSampleTime(), false);
-        //   compressorsR[i].setTimes(1, 100, TBase::engineGetSampleTime(), false);
+    // the module calls onSampleRateChange before init makes the banks.
+    if (banks) {
+        banks->setTimes(1, 100, TBase::engineGetSampleTime(), false);
     }
 }
 
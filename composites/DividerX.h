@@ -8,6 +8,7 @@
 
 #include "IComposite.h"
 #include "OscSmoother.h"
+#include "SqMinBlep.h"
 #include "simd.h"
 
 namespace rack {
@@ -107,7 +108,7 @@ private:
     T lastClockValue = 0;
     int counter = 0;
     bool state = false;
-    rack::dsp::MinBlepGenerator<16, 16, T> minBlep;
+    SqMinBlep<16, 16, T> minBlep;
 
     // debugging
     float timeSinceLastCrossing = 0;
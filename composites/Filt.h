@@ -39,7 +39,7 @@ public:
 template <class TBase>
 class Filt : public TBase {
 public:
-    using T = double;
+    using T = float_4;
     Filt(Module* module) : TBase(module) {
     }
     Filt() : TBase() {
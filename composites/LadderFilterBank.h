@@ -1,11 +1,11 @@
 #pragma once
 #include "LadderFilter.h"
+#include "LadderFilter_4.h"
 #include "PeakDetector.h"
 #include "SqPort.h"
 #include "SqStream.h"
 
-template <typename T>
-class LadderFilterBank {
+class LadderFilterBankBase {
 public:
     enum class Modes {
         normal,    // mono, poly. R out == L out
@@ -13,6 +13,11 @@ public:
         leftOnly,  // in L -> out L, out R
         rightOnly  // in R -> out L, out R
     };
+};
+
+template <typename T>
+class LadderFilterBank : public LadderFilterBankBase {
+public:
     void stepn(float sampleTime, int numChannels,
                SqInput& fc1Input, SqInput& fc2Input, SqInput& qInput, SqInput& driveInput, SqInput& edgeInput, SqInput& slopeInput,
                float fcParam, float fc1TrimParam, float fc2TrimParam,
@@ -48,6 +53,39 @@ public:
 private:
     LadderFilter<T> filters[16];
 
+    /**
+     * All the filters use the same voicing. step picks the
+     * instantiation of stepVoiced once, rather than each filter picking one.
+     */
+    LadderFilterBase::Voicing voicing = LadderFilterBase::Voicing::Classic;
+
+    template <LadderFilterBase::Voicing v>
+    void stepVoiced(int numChannels, Modes mode,
+                    SqInput& audioInput, SqOutput& audioOutput,
+                    SqInput* inputForChannel0, SqInput* inputForChannel1,
+                    PeakDetector& peak);
+
+    /**
+     * Calls stepVoiced<v> for the voicing VoicingDispatch picks.
+     */
+    struct Stepper
+    {
+        LadderFilterBank& bank;
+        int numChannels;
+        Modes mode;
+        SqInput& audioInput;
+        SqOutput& audioOutput;
+        SqInput* inputForChannel0;
+        SqInput* inputForChannel1;
+        PeakDetector& peak;
+
+        template <class V>
+        void operator()(V)
+        {
+            bank.template stepVoiced<V::value>(numChannels, mode, audioInput, audioOutput, inputForChannel0, inputForChannel1, peak);
+        }
+    };
+
     std::shared_ptr<LookupTableParams<T>> expLookup = ObjectCache<T>::getExp2();  // Do we need more precision?
     AudioMath::ScaleFun<float> scaleGain = AudioMath::makeLinearScaler<float>(0, 1);
     std::shared_ptr<LookupTableParams<float>> audioTaper = {ObjectCache<float>::getAudioTaper()};
@@ -69,6 +107,7 @@ inline void LadderFilterBank<T>::stepn(float sampleTime, int numChannels,
                                        float edgeParam, float edgeTrim,
                                        float slopeParam, float slopeTrim,
                                        float spreadParam) {
+    this->voicing = voicing;
     for (int channel = 0; channel < numChannels; ++channel) {
         LadderFilter<T>& filt = filters[channel];
 
@@ -102,8 +141,7 @@ inline void LadderFilterBank<T>::stepn(float sampleTime, int numChannels,
                 qTrimParam);
             const T qMiddle = 2.8;
             res = (res < 2) ? (res * qMiddle / 2) : .5 * (res - 2) * (4 - qMiddle) + qMiddle;
-
-            if (res < 0 || res > 4) fprintf(stderr, "res out of bounds %f\n", res);
+            res = std::max(T(0), std::min(T(4), res));
 
             const T bAmt = makeupGainParam;
             const T makeupGain = 1 + bAmt * (res);
@@ -143,6 +181,16 @@ inline void LadderFilterBank<T>::step(int numChannels, Modes mode,
                                       SqInput& audioInput, SqOutput& audioOutput,
                                       SqInput* inputForChannel0, SqInput* inputForChannel1,
                                       PeakDetector& peak) {
+    Stepper stepper = {*this, numChannels, mode, audioInput, audioOutput, inputForChannel0, inputForChannel1, peak};
+    LadderFilterBase::VoicingDispatch::call(voicing, stepper);
+}
+
+template <typename T>
+template <LadderFilterBase::Voicing v>
+inline void LadderFilterBank<T>::stepVoiced(int numChannels, Modes mode,
+                                            SqInput& audioInput, SqOutput& audioOutput,
+                                            SqInput* inputForChannel0, SqInput* inputForChannel1,
+                                            PeakDetector& peak) {
     for (int channel = 0; channel < numChannels; ++channel) {
         LadderFilter<T>& filt = filters[channel];
 
@@ -167,9 +215,220 @@ inline void LadderFilterBank<T>::step(int numChannels, Modes mode,
                 assert(false);
         }
 
-        filt.run(input);
+        filt.template run<v>(input);
         const float output = (float)filt.getOutput();
         audioOutput.setVoltage(output, channel);
         peak.step(output);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * SIMD version of the bank. Each LadderFilter<float_4> runs four channels.
+ * The control rate code still computes each channel as a scalar,
+ * then hands the filter a float_4 for each of the per-channel settings.
+ */
+template <>
+class LadderFilterBank<float_4> : public LadderFilterBankBase {
+public:
+    using T = float_4;
+    void stepn(float sampleTime, int numChannels,
+               SqInput& fc1Input, SqInput& fc2Input, SqInput& qInput, SqInput& driveInput, SqInput& edgeInput, SqInput& slopeInput,
+               float fcParam, float fc1TrimParam, float fc2TrimParam,
+               float volume,
+               float qParam, float qTrimParam, float makeupGainParam,
+               LadderFilterBase::Types type, LadderFilterBase::Voicing voicing,
+               float driveParam, float driveTrim,
+               float edgeParam, float edgeTrim,
+               float slopeParam, float slopeTrim,
+               float spread);
+
+    void step(int numChannels, Modes mode,
+              SqInput& audioInput, SqOutput& audioOutput,
+              SqInput* inputForChannel0, SqInput* inputForChannel1,
+              PeakDetector& peak);
+
+    void _dump(int channel, const std::string& label) {
+        SqStream s;
+        s.add(label);
+        s.add("[");
+        s.add(channel);
+        s.add("] ");
+        filters[channel / 4]._dump(s.str());
+    }
+
+    /**
+     * returns the filter that is running channel "channel"
+     */
+    const LadderFilter<T>& get(int channel) {
+        return filters[channel / 4];
+    }
+
+private:
+    LadderFilter<T> filters[4];
+
+    // Same as the scalar bank: the voicing is picked once per step.
+    LadderFilterBase::Voicing voicing = LadderFilterBase::Voicing::Classic;
+
+    template <LadderFilterBase::Voicing v>
+    void stepVoiced(int numChannels, Modes mode,
+                    SqInput& audioInput, SqOutput& audioOutput,
+                    SqInput* inputForChannel0, SqInput* inputForChannel1,
+                    PeakDetector& peak);
+
+    /**
+     * Calls stepVoiced<v> for the voicing VoicingDispatch picks.
+     */
+    struct Stepper
+    {
+        LadderFilterBank& bank;
+        int numChannels;
+        Modes mode;
+        SqInput& audioInput;
+        SqOutput& audioOutput;
+        SqInput* inputForChannel0;
+        SqInput* inputForChannel1;
+        PeakDetector& peak;
+
+        template <class V>
+        void operator()(V)
+        {
+            bank.template stepVoiced<V::value>(numChannels, mode, audioInput, audioOutput, inputForChannel0, inputForChannel1, peak);
+        }
+    };
+
+    std::shared_ptr<LookupTableParams<float>> expLookup = ObjectCache<float>::getExp2();
+    AudioMath::ScaleFun<float> scaleGain = AudioMath::makeLinearScaler<float>(0, 1);
+    std::shared_ptr<LookupTableParams<float>> audioTaper = {ObjectCache<float>::getAudioTaper()};
+
+    AudioMath::ScaleFun<float> scaleFc = AudioMath::makeScalerWithBipolarAudioTrim(-5, 5);
+    AudioMath::ScaleFun<float> scaleQ = AudioMath::makeScalerWithBipolarAudioTrim(0, 4);
+    AudioMath::ScaleFun<float> scaleSlope = AudioMath::makeScalerWithBipolarAudioTrim(0, 3);
+    AudioMath::ScaleFun<float> scaleEdge = AudioMath::makeScalerWithBipolarAudioTrim(0, 1);
+};
+
+inline void LadderFilterBank<float_4>::stepn(float sampleTime, int numChannels,
+                                             SqInput& fc1Input, SqInput& fc2Input, SqInput& qInput, SqInput& driveInput, SqInput& edgeInput, SqInput& slopeInput,
+                                             float fcParam, float fc1TrimParam, float fc2TrimParam,
+                                             float volume,
+                                             float qParam, float qTrimParam, float makeupGainParam,
+                                             LadderFilterBase::Types type, LadderFilterBase::Voicing voicing,
+                                             float driveParam, float driveTrimParam,
+                                             float edgeParam, float edgeTrim,
+                                             float slopeParam, float slopeTrim,
+                                             float spreadParam) {
+    this->voicing = voicing;
+    const int numBanks = (numChannels + 3) / 4;
+    for (int bank = 0; bank < numBanks; ++bank) {
+        LadderFilter<T>& filt = filters[bank];
+
+        filt.setType(type);
+        filt.setVoicing(voicing);
+        filt.setVolume(volume);
+
+        T fcClipped, res, makeupGain, gain, edge, slope;
+        for (int i = 0; i < 4; ++i) {
+            const int channel = bank * 4 + i;
+
+            // filter Fc calc
+            {
+                float freqCV1 = scaleFc(
+                    fc1Input.getPolyVoltage(channel),
+                    fcParam,
+                    fc1TrimParam);
+                float freqCV2 = scaleFc(
+                    fc2Input.getPolyVoltage(channel),
+                    0,
+                    fc2TrimParam);  // note: test second inputs
+                float freqCV = freqCV1 + freqCV2 + 6;
+                const float fc = LookupTable<float>::lookup(*expLookup, freqCV, true) * 10;
+                const float normFc = fc * sampleTime;
+
+                fcClipped[i] = std::max(std::min(normFc, .48f), .0000001f);
+            }
+            {
+                float r = scaleQ(
+                    qInput.getPolyVoltage(0),
+                    qParam,
+                    qTrimParam);
+                const float qMiddle = 2.8f;
+                r = (r < 2) ? (r * qMiddle / 2) : .5f * (r - 2) * (4 - qMiddle) + qMiddle;
+                r = std::max(0.f, std::min(4.f, r));
+
+                res[i] = r;
+                makeupGain[i] = 1 + makeupGainParam * r;
+            }
+            {
+                float gainInput = scaleGain(
+                    driveInput.getPolyVoltage(channel),
+                    driveParam,
+                    driveTrimParam);
+
+                gain[i] = .15f + 4 * LookupTable<float>::lookup(*audioTaper, gainInput, false);
+            }
+            edge[i] = scaleEdge(
+                edgeInput.getPolyVoltage(channel),
+                edgeParam,
+                edgeTrim);
+            slope[i] = scaleSlope(
+                slopeInput.getPolyVoltage(channel),
+                slopeParam,
+                slopeTrim);
+        }
+
+        filt.setNormalizedFc(fcClipped);
+        filt.setFeedback(res);
+        filt.setBassMakeupGain(makeupGain);
+        filt.setGain(gain);
+        filt.setEdge(edge);
+        filt.setSlope(slope);
+        filt.setFreqSpread(spreadParam);
+    }
+}
+
+inline void LadderFilterBank<float_4>::step(int numChannels, Modes mode,
+                                            SqInput& audioInput, SqOutput& audioOutput,
+                                            SqInput* inputForChannel0, SqInput* inputForChannel1,
+                                            PeakDetector& peak) {
+    Stepper stepper = {*this, numChannels, mode, audioInput, audioOutput, inputForChannel0, inputForChannel1, peak};
+    LadderFilterBase::VoicingDispatch::call(voicing, stepper);
+}
+
+template <LadderFilterBase::Voicing v>
+inline void LadderFilterBank<float_4>::stepVoiced(int numChannels, Modes mode,
+                                                  SqInput& audioInput, SqOutput& audioOutput,
+                                                  SqInput* inputForChannel0, SqInput* inputForChannel1,
+                                                  PeakDetector& peak) {
+    const int numBanks = (numChannels + 3) / 4;
+    for (int bank = 0; bank < numBanks; ++bank) {
+        LadderFilter<T>& filt = filters[bank];
+        const int firstChannel = bank * 4;
+
+        T input = audioInput.getVoltageSimd<T>(firstChannel);
+        switch (mode) {
+            case Modes::stereo:
+                assert(inputForChannel1);
+                assert(numChannels == 2);
+                // for legacy stereo mode, dsp1 gets input from right input
+                input[1] = inputForChannel1->getVoltage(0);
+                break;
+            case Modes::rightOnly:
+                assert(numChannels == 1);
+                input[0] = inputForChannel0->getVoltage(0);
+                break;
+            case Modes::normal:
+            case Modes::leftOnly:
+                break;
+            default:
+                assert(false);
+        }
+
+        filt.run<v>(input);
+        const T output = filt.getOutput();
+        audioOutput.setVoltageSimd(output, firstChannel);
+
+        const int activeChannels = std::min(4, numChannels - firstChannel);
+        for (int i = 0; i < activeChannels; ++i) {
+            peak.step(output[i]);
+        }
+    }
+}
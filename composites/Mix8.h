@@ -9,6 +9,7 @@
 #include "IComposite.h"
 #include "MultiLag.h"
 #include "ObjectCache.h"
+#include "SimdLookupTable.h"
 #include "SqMath.h"
 
 namespace rack {
@@ -224,8 +225,9 @@ public:
     float buf_inputs[numChannels] = {0};
     float buf_channelGains[numChannels] = {0};
     float buf_channelOuts[numChannels] = {0};
-    float buf_leftPanGains[numChannels] = {0};
-    float buf_rightPanGains[numChannels] = {0};
+    // aligned, because the pan lookup stores into these four at a time
+    alignas(16) float buf_leftPanGains[numChannels] = {0};
+    alignas(16) float buf_rightPanGains[numChannels] = {0};
     float buf_channelSendGains[numChannels] = {0};
 
     /** 
@@ -298,13 +300,18 @@ inline void Mix8<TBase>::stepn(int div) {
         buf_channelSendGains[i] = slider;
     }
 
-    // fill buf_leftPanGains and buf_rightPanGains
-    for (int i = 0; i < numChannels; ++i) {
-        const float balance = TBase::params[i + PAN0_PARAM].value;
-        const float cv = TBase::inputs[i + PAN0_INPUT].getVoltage(0);
-        const float panValue = std::clamp(balance + cv / 5, -1, 1);
-        buf_leftPanGains[i] = LookupTable<float>::lookup(*panL, panValue);
-        buf_rightPanGains[i] = LookupTable<float>::lookup(*panR, panValue);
+    // fill buf_leftPanGains and buf_rightPanGains, four channels at a time
+    static_assert((numChannels % 4) == 0, "pan lookup is done in blocks of four");
+    for (int i = 0; i < numChannels; i += 4) {
+        float_4 panValue;
+        for (int j = 0; j < 4; ++j) {
+            const float balance = TBase::params[i + j + PAN0_PARAM].value;
+            const float cv = TBase::inputs[i + j + PAN0_INPUT].getVoltage(0);
+            panValue[j] = balance + cv / 5;
+        }
+        panValue = rack::simd::clamp(panValue, float_4(-1), float_4(1));
+        _mm_store_ps(buf_leftPanGains + i, SimdLookupTable::lookup4(*panL, panValue).v);
+        _mm_store_ps(buf_rightPanGains + i, SimdLookupTable::lookup4(*panR, panValue).v);
     }
 
     buf_masterGain = TBase::params[MASTER_VOLUME_PARAM].value;
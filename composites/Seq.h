@@ -53,6 +53,14 @@ public:
      */
     void setSong(MidiSongPtr);
 
+    /**
+     * Call from the UI thread, often.
+     * Sends any edits to the song over to the player.
+     */
+    void sendEdits() {
+        player->sendEdits();
+    }
+
     enum ParamIds {
         CLOCK_INPUT_PARAM,
         UNUSED_TEMPO_PARAM,
@@ -63,6 +71,7 @@ public:
         AUDITION_PARAM,
         STEP_RECORD_PARAM,
         REMOTE_EDIT_PARAM,  // also invisible. Are we enabled for host editing?
+        STEAL_POLICY_PARAM, // invisible, set from the context menu
         NUM_PARAMS
     };
 
@@ -178,9 +187,6 @@ public:
 #endif
         seq->outputs[Seq<TBase>::CV_OUTPUT].voltages[voice] = cv;
     }
-    void onLockFailed() override {
-    }
-
     void resetClock() override {
         assert(false);
     }
@@ -280,6 +286,7 @@ void Seq<TBase>::stepn(int n) {
     TBase::outputs[GATE_OUTPUT].channels = numVoices;
 
     player->setNumVoices(0, numVoices);
+    player->setStealPolicy(0, MidiVoiceAssigner::StealPolicy((int)std::round(TBase::params[STEAL_POLICY_PARAM].value)));
 
     if (!running && wasRunning) {
         allGatesOff();
@@ -368,6 +375,9 @@ inline IComposite::Config SeqDescription<TBase>::getParam(int i) {
         case Seq<TBase>::REMOTE_EDIT_PARAM:
             ret = {0, 1, 0, "re"};
             break;
+        case Seq<TBase>::STEAL_POLICY_PARAM:
+            ret = {0, int(MidiVoiceAssigner::StealPolicy::SamePitch), 0, "Voice steal policy"};
+            break;
         default:
             assert(false);
     }
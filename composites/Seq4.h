@@ -6,7 +6,6 @@
 #include <cmath>
 #include <memory>
 
-#include "Divider.h"
 #include "GateTrigger.h"
 #include "IComposite.h"
 #include "IMidiPlayerHost.h"
@@ -38,12 +37,14 @@ public:
     friend class SeqHost4;
 
     Seq4(Module* module, MidiSong4Ptr song) : TBase(module),
-                                              runStopProcessor(true) {
+                                              runStopProcessor(true),
+                                              clockEdgeProcessor(false) {
         init(song);
     }
 
     Seq4(MidiSong4Ptr song) : TBase(),
-                              runStopProcessor(true) {
+                              runStopProcessor(true),
+                              clockEdgeProcessor(false) {
         init(song);
     }
 
@@ -56,6 +57,14 @@ public:
      */
     void setSong(MidiSong4Ptr);
 
+    /**
+     * Call from the UI thread, often.
+     * Sends any edits to the song over to the player.
+     */
+    void updateSnapshot() {
+        player->updateSnapshot();
+    }
+
     /**
     * re-calc everything that changes with sample
     * rate. Also everything that depends on baseFrequency.
@@ -95,6 +104,7 @@ public:
         CV_FUNCTION2_PARAM,
         CV_FUNCTION3_PARAM,
         CV_SELECT_OCTAVE_PARAM,
+        STEAL_POLICY_PARAM,         // invisible, set from the context menu. Same for all tracks
         NUM_PARAMS
     };
 
@@ -173,7 +183,17 @@ private:
     GateTrigger runStopProcessor;
     std::shared_ptr<MidiPlayer4> player;
     SeqClock clock;
-    Divider div;
+
+    /**
+     * Most of the work is done every 'stepnDivisor' samples, but we look
+     * for clock edges on every sample. That way a note starts on the sample its
+     * clock arrives, rather than up to stepnDivisor - 1 samples later.
+     * Between edges metric time doesn't move, so there is nothing to schedule in between
+     * (see MidiTrackPlayer::nextEventTime).
+     */
+    GateTrigger clockEdgeProcessor;
+    static const int stepnDivisor = 4;
+    int samplesSinceStepn = stepnDivisor - 1;     // so the first step() calls stepn()
     bool runStopRequested = false;
     bool wasRunning = false;
 
@@ -184,7 +204,8 @@ private:
     void resetClock();
     void serviceSelCV();
     /**
-     * called by the divider every 'n' step calls
+     * called every stepnDivisor step calls, or sooner on a clock edge.
+     * @param n is the number of samples since the last call.
      */
     void stepn(int n);
 
@@ -222,8 +243,6 @@ public:
 #endif
         seq->outputs[Seq4<TBase>::CV0_OUTPUT + track].voltages[voice] = cv;
     }
-    void onLockFailed() override {
-    }
     void resetClock() override {
         seq->resetClock();
     }
@@ -238,9 +257,6 @@ void Seq4<TBase>::init(MidiSong4Ptr song) {
     player = std::make_shared<MidiPlayer4>(host, song);
     // audition = std::make_shared<MidiAudition>(host);
 
-    div.setup(4, [this] {
-        this->stepn(div.getDiv());
-    });
     onSampleRateChange();
     player->setPorts(TBase::inputs.data() + MOD0_INPUT, TBase::params.data() + TRIGGER_IMMEDIATE_PARAM);
 }
@@ -315,11 +331,13 @@ void Seq4<TBase>::stepn(int n) {
     player->updateToMetricTime(results.totalElapsedTime, float(clock.getMetricTimePerClock()), running);
 
     // copy the current voice number to the poly ports
+    const auto stealPolicy = MidiVoiceAssigner::StealPolicy((int)std::round(TBase::params[STEAL_POLICY_PARAM].value));
     for (int i = 0; i < MidiSong4::numTracks; ++i) {
         const int numVoices = (int)std::round(TBase::params[NUM_VOICES0_PARAM + i].value + 1);
         TBase::outputs[CV0_OUTPUT + i].channels = numVoices;
         TBase::outputs[GATE0_OUTPUT + i].channels = numVoices;
         player->setNumVoices(i, numVoices);
+        player->setStealPolicy(i, stealPolicy);
 
         const float cvMode = TBase::params[CV_FUNCTION_PARAM + i].value;
         MidiTrackPlayer::CVInputMode mode = MidiTrackPlayer::CVInputMode(std::round(cvMode));
@@ -362,7 +380,14 @@ void Seq4<TBase>::serviceRunStop() {
 
 template <class TBase>
 inline void Seq4<TBase>::step() {
-    div.step();
+    ++samplesSinceStepn;
+    clockEdgeProcessor.go(TBase::inputs[CLOCK_INPUT].getVoltage(0));
+    const bool clockEdge = clockEdgeProcessor.trigger();
+    if (clockEdge || (samplesSinceStepn >= stepnDivisor)) {
+        const int n = samplesSinceStepn;
+        samplesSinceStepn = 0;
+        stepn(n);
+    }
 }
 
 template <class TBase>
@@ -539,6 +564,9 @@ inline IComposite::Config Seq4Description<TBase>::getParam(int i) {
         case Seq4<TBase>::CV_SELECT_OCTAVE_PARAM:
             ret = {0, 10, 2, "Select CV octave"};
             break;
+        case Seq4<TBase>::STEAL_POLICY_PARAM:
+            ret = {0, int(MidiVoiceAssigner::StealPolicy::SamePitch), 0, "Voice steal policy"};
+            break;
         default:
             assert(false);
     }
@@ -52,6 +52,13 @@ public:
  * add percussion: 14.6 /41.5
  * Perf 7/28 mono: 12.5% 4vx: 37.8
  * 
+ * The sines are organized by drawbar, then by bank of four voices. So each
+ * SIMD oscillator does one drawbar for four voices, and the voice mix comes
+ * out of the multiply-adds with no horizontal sums. Each bank only needs one
+ * exp for pitch, the drawbars are fixed frequency ratios of that.
+ *
+ * With only one voice that would waste three lanes of every sine, so mono
+ * puts the drawbars in the lanes instead.
  */
 
 template <class TBase>
@@ -131,17 +138,25 @@ public:
 private:
     static const int numVoices = 16;
     static const int numDrawbars = 9;
-    static const int numDrawbars4 = 12;  // round up to even SIMD per voice
-    static const int numSinesPerVoices = numDrawbars4 / 4;
-    static const int numSines = numVoices * numSinesPerVoices;
-    static const int numEgNorm = numVoices / 4;
+    static const int numBanks = numVoices / 4;
+    static const int numEgNorm = numBanks;
     static const int numEgPercussion = numEgNorm;
 
-    SinesVCO<T> sines[numSines];
+    /**
+     * sines[drawbar][bank] does one drawbar for four voices
+     */
+    SinesVCO<T> sines[numDrawbars][numBanks];
+
+    /**
+     * for mono, drawbars are in the lanes.
+     */
+    static const int numMonoSines = (numDrawbars + 3) / 4;
+    SinesVCO<T> monoSines[numMonoSines];
     ADSR4 normAdsr[numEgNorm];
     ADSR4 percAdsr[numEgPercussion];
 
     int numChannels_m = 1;  // 1..16
+    int numBanks_m = 1;
     float volumeNorm_m = 1;
 
     Divider divn;
@@ -149,16 +164,32 @@ private:
 
     void stepn();
     void stepm();
+    void processMono(const typename TBase::ProcessArgs& args);
     void computeBaseDrawbars_m();
     void computeFinalDrawbars_n();
 
     const float* getDrawbarPitches() const;
 
-    float_4 baseDrawbarVolumes_m[numDrawbars4 / 4] = {};
-    float_4 basePercussionVolumes_m[numDrawbars4 / 4] = {};
+    /**
+     * Frequency ratio of each drawbar, from getDrawbarPitches.
+     * Padded out for the mono sines.
+     */
+    float drawbarRatios[numMonoSines * 4] = {};
+
+    float baseDrawbarVolumes_m[numDrawbars] = {};
+    float basePercussionVolumes_m[numDrawbars] = {};
+
+    float finalDrawbarVolumes_n[numDrawbars] = {};
+    float finalPercussionVolumes_n[numDrawbars] = {};
 
-    float_4 finalDrawbarVolumes_n[numDrawbars4 / 4] = {};
-    float_4 finalPercussionVolumes_n[numDrawbars4 / 4] = {};
+    /**
+     * Drawbars with no drawbar or percussion volume
+     * don't need to run.
+     */
+    bool drawbarActive_n[numDrawbars] = {};
+
+    float_4 monoDrawbarVolumes_n[numMonoSines] = {};
+    float_4 monoPercussionVolumes_n[numMonoSines] = {};
 
     bool lastDecayParamBool = false;
     int lastKeyclickParamInt = -1;
@@ -180,6 +211,11 @@ inline void Sines<TBase>::init() {
     for (int i = 0; i < NUM_LIGHTS; ++i) {
         Sines<TBase>::lights[i].setBrightness(3.f);
     }
+
+    const float* pitches = getDrawbarPitches();
+    for (int i = 0; i < numDrawbars; ++i) {
+        drawbarRatios[i] = std::exp2(pitches[i]);
+    }
 }
 
 static float gainFromSlider(float slider) {
@@ -215,40 +251,33 @@ inline void Sines<TBase>::computeBaseDrawbars_m() {
         gainComp = 1.f / std::sqrt(power);
     }
 
-    baseDrawbarVolumes_m[2] = 0;
     for (int i = 0; i < numDrawbars; ++i) {
-        int bank = i / 4;
-        int offset = i - (bank * 4);
-        baseDrawbarVolumes_m[bank][offset] = gains[i] * gainComp;
+        baseDrawbarVolumes_m[i] = gains[i] * gainComp;
     }
 
-    basePercussionVolumes_m[1][0] = gainFromSlider(Sines<TBase>::params[PERCUSSION1_PARAM].value);
-    basePercussionVolumes_m[0][3] = gainFromSlider(Sines<TBase>::params[PERCUSSION2_PARAM].value);
+    basePercussionVolumes_m[4] = gainFromSlider(Sines<TBase>::params[PERCUSSION1_PARAM].value);
+    basePercussionVolumes_m[3] = gainFromSlider(Sines<TBase>::params[PERCUSSION2_PARAM].value);
 }
 
 template <class TBase>
 inline void Sines<TBase>::computeFinalDrawbars_n() {
     for (int i = 0; i < numDrawbars; ++i) {
-        int bank = i / 4;
-        int offset = i - (bank * 4);
-
         bool connected = Sines<TBase>::inputs[DRAWBAR1_INPUT + i].isConnected();
-        finalDrawbarVolumes_n[bank][offset] = baseDrawbarVolumes_m[bank][offset] *
-                                              (connected ? Sines<TBase>::inputs[DRAWBAR1_INPUT + i].getVoltage(0) : 10);
-    }
-
-    for (int i = 0; i < 3; ++i) {
-        float_4 x = finalDrawbarVolumes_n[i];
-        x = SimdBlocks::ifelse(x < 0, 0, x);
-        finalDrawbarVolumes_n[i] = x * float_4(.1f);
-
+        float x = baseDrawbarVolumes_m[i] *
+                  (connected ? Sines<TBase>::inputs[DRAWBAR1_INPUT + i].getVoltage(0) : 10);
+        finalDrawbarVolumes_n[i] = std::max(x, 0.f) * .1f;
         finalPercussionVolumes_n[i] = basePercussionVolumes_m[i];
+        drawbarActive_n[i] = (finalDrawbarVolumes_n[i] != 0) || (finalPercussionVolumes_n[i] != 0);
+
+        monoDrawbarVolumes_n[i / 4][i % 4] = finalDrawbarVolumes_n[i];
+        monoPercussionVolumes_n[i / 4][i % 4] = finalPercussionVolumes_n[i];
     }
 }
 
 template <class TBase>
 inline void Sines<TBase>::stepm() {
     numChannels_m = std::max<int>(1, TBase::inputs[VOCT_INPUT].channels);
+    numBanks_m = (numChannels_m + 3) / 4;
     Sines<TBase>::outputs[MAIN_OUTPUT].setChannels(numChannels_m);
 
     //volumeNorm_m = 2.f / std::sqrt( float(numChannels_m));
@@ -273,26 +302,20 @@ template <class TBase>
 inline void Sines<TBase>::stepn() {
     computeFinalDrawbars_n();
 
-    const float* drawbarPitches = getDrawbarPitches();
     const float sampleRate = TBase::engineGetSampleRate();
-    for (int vx = 0; vx < numChannels_m; ++vx) {
-        const float cv = Sines<TBase>::inputs[VOCT_INPUT].getVoltage(vx);
-        const int baseSineIndex = numSinesPerVoices * vx;
-        float_4 basePitch(cv);
-
-        float_4 pitch = basePitch;
-        pitch += float_4::load(drawbarPitches);
-        sines[baseSineIndex].setPitch(pitch, sampleRate);
-
-        const float* p = drawbarPitches + 4;
-        pitch = basePitch;
-        pitch += float_4::load(p);
-        sines[baseSineIndex + 1].setPitch(pitch, sampleRate);
-
-        p = drawbarPitches + 8;
-        pitch = basePitch;
-        pitch += float_4::load(p);
-        sines[baseSineIndex + 2].setPitch(pitch, sampleRate);
+    if (numChannels_m == 1) {
+        const float cv = Sines<TBase>::inputs[VOCT_INPUT].getVoltage(0);
+        const float_4 baseFreq = rack::dsp::FREQ_C4 * rack::dsp::approxExp2_taylor5(cv + 30) / 1073741824;
+        for (int i = 0; i < numMonoSines; ++i) {
+            monoSines[i].setFrequency(baseFreq * float_4::load(drawbarRatios + 4 * i), sampleRate);
+        }
+    }
+    for (int bank = 0; bank < numBanks_m; ++bank) {
+        const float_4 cv = Sines<TBase>::inputs[VOCT_INPUT].template getVoltageSimd<float_4>(bank * 4);
+        const float_4 baseFreq = rack::dsp::FREQ_C4 * rack::dsp::approxExp2_taylor5(cv + 30) / 1073741824;
+        for (int i = 0; i < numDrawbars; ++i) {
+            sines[i][bank].setFrequency(baseFreq * drawbarRatios[i], sampleRate);
+        }
     }
 
     const bool decayParamBool = Sines<TBase>::params[DECAY_PARAM].value > .5;
@@ -368,97 +391,80 @@ inline void Sines<TBase>::process(const typename TBase::ProcessArgs& args) {
 
 template <class TBase>
 inline void Sines<TBase>::process(const typename TBase::ProcessArgs& args) {
-    divn.step();
+    // channels first, so the pitches get set for all of them
     divm.step();
+    divn.step();
 
-    const T deltaT(args.sampleTime);
+    if (numChannels_m == 1) {
+        processMono(args);
+        return;
+    }
 
-    float_4 sines4 = 0;
-    float_4 percSines4 = 0;
-#if 0
-    printf("draw 0 = %s perc 0 = %s\n", 
-        toStr(finalDrawbarVolumes_n[0]).c_str(),
-        toStr(finalPercussionVolumes_n[0]).c_str()
-        ); fflush(stdout);
-#endif
-    for (int vx = 0; vx < numChannels_m; ++vx) {
-        const int adsrBank = vx / 4;
-        const int adsrBankOffset = vx - (adsrBank * 4);
-        const int baseSineIndex = numSinesPerVoices * vx;
-
-        // for each voice we must compute all the sines for that voice.
-        // Add them all together into sum, which will be the non-percussion
-        //mix of all drawbars.
-        T sum;
-        sum = sines[baseSineIndex + 0].process(deltaT) * finalDrawbarVolumes_n[0];
-        sum += sines[baseSineIndex + 1].process(deltaT) * finalDrawbarVolumes_n[1];
-
-        float s = sum[0] + sum[1] + sum[2] + sum[3];
-        s += sines[baseSineIndex + 2].process(deltaT)[0] * finalDrawbarVolumes_n[2][0];
-        sines4[adsrBankOffset] = s;
-
-        sum = sines[baseSineIndex + 0].get() * finalPercussionVolumes_n[0];
-        sum += sines[baseSineIndex + 1].get() * finalPercussionVolumes_n[1];
-        s = sum[0] + sum[1] + sum[2] + sum[3];
-        percSines4[adsrBankOffset] = s;
-
-        // after each block of [up to] 4 voices, run the ADSRs
-        bool outputNow = false;
-        int bankToOutput = 0;
-
-        const bool gateConnected = TBase::inputs[GATE_INPUT].isConnected();
-
-        // If we fill up a whole block, output it now - it's the voltages from the
-        // previous bank.
-        if (adsrBankOffset == 3) {
-            outputNow = true;
-            bankToOutput = adsrBank;
+    const T deltaT(args.sampleTime);
+    const bool gateConnected = TBase::inputs[GATE_INPUT].isConnected();
+
+    for (int bank = 0; bank < numBanks_m; ++bank) {
+        // Each drawbar's sines cover all four voices in the bank, so
+        // the weighted sums are the non-percussion and percussion mixes
+        // for those voices.
+        float_4 sines4 = 0;
+        float_4 percSines4 = 0;
+        for (int i = 0; i < numDrawbars; ++i) {
+            if (drawbarActive_n[i]) {
+                const float_4 x = sines[i][bank].process(deltaT);
+                sines4 += x * finalDrawbarVolumes_n[i];
+                percSines4 += x * finalPercussionVolumes_n[i];
+            }
         }
 
-        // If it's the last voice and we only have a partial block, output - it's the voltages
-        // for the current bank
-        else if (vx == (numChannels_m - 1)) {
-            outputNow = true;
-            bankToOutput = adsrBank;
+        if (gateConnected) {
+            Port& p = TBase::inputs[GATE_INPUT];
+            float_4 g = p.getVoltageSimd<float_4>(bank * 4);
+            float_4 gate4 = (g > float_4(1));
+            simd_assertMask(gate4);
+            float_4 normEnv = normAdsr[bank].step(gate4, args.sampleTime);
+            sines4 *= normEnv;
+
+            float_4 percEnv = percAdsr[bank].step(gate4, args.sampleTime);
+            percSines4 *= percEnv;
+            percSines4 *= float_4(6.f);
         }
 
-        float_4 gate4 = 0;
-        if (outputNow) {
-            if (gateConnected) {
-                Port& p = TBase::inputs[GATE_INPUT];
-                float_4 g = p.getVoltageSimd<float_4>(bankToOutput * 4);
-                gate4 = (g > float_4(1));
-                simd_assertMask(gate4);
-                float_4 normEnv = normAdsr[bankToOutput].step(gate4, args.sampleTime);
-                sines4 *= normEnv;
-            }
+        sines4 += percSines4;
+        sines4 *= volumeNorm_m;
+        sines4 = rack::simd::clamp(sines4, -10, 10);
 
-            if (gateConnected) {
-                float_4 percEnv = percAdsr[bankToOutput].step(gate4, args.sampleTime);
-                percSines4 *= percEnv;
-                percSines4 *= float_4(6.f);
-            }
+        Sines<TBase>::outputs[MAIN_OUTPUT].setVoltageSimd(sines4, bank * 4);
+    }
+}
 
-            sines4 += percSines4;
-            sines4 *= volumeNorm_m;
-            sines4 = rack::simd::clamp(sines4, -10, 10);
-
-            Sines<TBase>::outputs[MAIN_OUTPUT].setVoltageSimd(sines4, bankToOutput * 4);
-#if 0
-            static float mx = 0;
-            for (int i=0; i<4; ++i) {
-                float x = std::max(mx, std::abs(sines4[i]));
-                if ( x > mx) {
-                    mx = x;
-                    printf("max = %f\n", mx); fflush(stdout);
-                }
-            }
-#endif
+template <class TBase>
+inline void Sines<TBase>::processMono(const typename TBase::ProcessArgs& args) {
+    const T deltaT(args.sampleTime);
 
-            sines4 = 0;
-            percSines4 = 0;
-        }
+    T sum = 0;
+    T percSum = 0;
+    for (int i = 0; i < numMonoSines; ++i) {
+        const float_4 x = monoSines[i].process(deltaT);
+        sum += x * monoDrawbarVolumes_n[i];
+        percSum += x * monoPercussionVolumes_n[i];
     }
+    float_4 sines4 = sum[0] + sum[1] + sum[2] + sum[3];
+    float_4 percSines4 = percSum[0] + percSum[1] + percSum[2] + percSum[3];
+
+    if (TBase::inputs[GATE_INPUT].isConnected()) {
+        Port& p = TBase::inputs[GATE_INPUT];
+        float_4 gate4 = (p.getVoltageSimd<float_4>(0) > float_4(1));
+        simd_assertMask(gate4);
+        sines4 *= normAdsr[0].step(gate4, args.sampleTime);
+        percSines4 *= percAdsr[0].step(gate4, args.sampleTime);
+        percSines4 *= float_4(6.f);
+    }
+
+    sines4 += percSines4;
+    sines4 *= volumeNorm_m;
+    sines4 = rack::simd::clamp(sines4, -10, 10);
+    Sines<TBase>::outputs[MAIN_OUTPUT].setVoltageSimd(sines4, 0);
 }
 #endif
 
@@ -121,6 +121,7 @@ public:
         PULSEWIDTH1_TRIM_PARAM,
         PULSEWIDTH2_TRIM_PARAM,
         AGC_PARAM,
+        ECO_PARAM,
         NUM_PARAMS
     };
 
@@ -447,8 +448,10 @@ inline void Sub<TBase>::setupWaveforms() {
     float_4 mainIsSawMask = bitfieldToMask(mainIsSawBitMask);
     float_4 subIsSawMask = bitfieldToMask(subIsSawBitMask);
     // printf("in setup waveform main is saw mask: %s\n subIsSawMask: %s\n",    toStr(mainIsSawMask).c_str(),toStr(subIsSawMask).c_str());
+    const bool eco = Sub<TBase>::params[Sub<TBase>::ECO_PARAM].value > .5f;
     for (int bank = 0; bank < 4; ++bank) {
         oscillators[bank].setWaveform(mainIsSawMask, subIsSawMask);
+        oscillators[bank].setEco(eco);
     }
 }
 
@@ -796,6 +799,9 @@ inline IComposite::Config SubDescription<TBase>::getParam(int i) {
         case Sub<TBase>::AGC_PARAM:
             ret = {0, 1, 0, "agc"};
             break;
+        case Sub<TBase>::ECO_PARAM:
+            ret = {0, 1, 0, "Economy (wavetable)"};
+            break;
         default:
             assert(false);
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "asserts.h"
+#include "float_8.h"
 
 //#include <simd/vector.hpp>
 //#include <simd/functions.hpp>
@@ -37,6 +38,13 @@ public:
 
     static float_4 ifelse(float_4 mask, float a, float b);
 
+    static float_8 ifelse(float_8 mask, float_8 a, float_8 b);
+    static float_8 min(float_8 a, float_8 b);
+    static float_8 max(float_8 a, float_8 b);
+
+    static float_4 abs(float_4);
+    static float_8 abs(float_8);
+
     static float_4 maskTrue();
     static float_4 maskFalse();
     static bool isChannelTrue(int channel, float_4 x);
@@ -75,6 +83,27 @@ inline float_4 SimdBlocks::max(float_4 a, float_4 b) {
     return ifelse(a > b, a, b);
 }
 
+inline float_8 SimdBlocks::ifelse(float_8 mask, float_8 a, float_8 b) {
+    simd_assertMask(mask);
+    return (mask & a) | (~mask & b);
+}
+
+inline float_8 SimdBlocks::min(float_8 a, float_8 b) {
+    return ifelse(a < b, a, b);
+}
+inline float_8 SimdBlocks::max(float_8 a, float_8 b) {
+    return ifelse(a > b, a, b);
+}
+
+inline float_4 SimdBlocks::abs(float_4 x) {
+    return rack::simd::abs(x);
+}
+
+inline float_8 SimdBlocks::abs(float_8 x) {
+    // clear the sign bits
+    return x & ~float_8(-0.f);
+}
+
 // put back here once it works.
 
 inline float_4 SimdBlocks::fold(float_4 x) {
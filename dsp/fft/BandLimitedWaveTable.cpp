@@ -0,0 +1,61 @@
+
+#include "BandLimitedWaveTable.h"
+#include "AudioMath.h"
+#include "FFT.h"
+#include "FFTData.h"
+
+#include <assert.h>
+
+/**
+ * Sets bin to be a sine of amplitude, in the convention of FFT::inverse.
+ */
+static void setSine(FFTDataCpx& spectrum, int bin, double amplitude)
+{
+    spectrum.set(bin, std::complex<float>(0, float(-amplitude / 2)));
+}
+
+/**
+ * Fourier series of the waveforms.
+ */
+static double getHarmonicAmplitude(BandLimitedWaveTable::Waveform waveform, int harmonic)
+{
+    double ret = 0;
+    switch (waveform) {
+        case BandLimitedWaveTable::Waveform::SAW:
+            // 2x - 1 = -2/pi * sum(sin(nx) / n)
+            ret = -2.0 / (AudioMath::Pi * harmonic);
+            break;
+        case BandLimitedWaveTable::Waveform::TRIANGLE:
+            // odd harmonics only, falling at 1/n**2, alternating sign.
+            if (harmonic & 1) {
+                const double sign = (harmonic & 2) ? -1 : 1;
+                ret = sign * 8.0 / (AudioMath::Pi * AudioMath::Pi * harmonic * harmonic);
+            }
+            break;
+        default:
+            assert(false);
+    }
+    return ret;
+}
+
+BandLimitedWaveTable::BandLimitedWaveTable(Waveform waveform) : data(numLevels * stride)
+{
+    FFTDataCpx spectrum(tableSize);
+    FFTDataReal table(tableSize);
+    for (int level = 0; level < numLevels; ++level) {
+        for (int i = 0; i < tableSize; ++i) {
+            spectrum.set(i, 0);
+        }
+        const int numHarmonics = getNumHarmonics(level);
+        for (int harmonic = 1; harmonic <= numHarmonics; ++harmonic) {
+            setSine(spectrum, harmonic, getHarmonicAmplitude(waveform, harmonic));
+        }
+        FFT::inverse(&table, spectrum);
+
+        float* dest = data.data() + level * stride;
+        for (int i = 0; i < tableSize; ++i) {
+            dest[i] = table.get(i);
+        }
+        dest[tableSize] = dest[0];
+    }
+}
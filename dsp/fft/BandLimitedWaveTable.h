@@ -0,0 +1,105 @@
+#pragma once
+
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Mip-mapped band-limited wavetable, for the "eco" modes of the VCOs.
+ *
+ * There is one table per octave. Table 0 has maxHarmonics harmonics,
+ * and each table after that has half as many as the one before, down to
+ * a pure sine. The tables are made with an inverse FFT, so building one
+ * takes a little while. Get them from ObjectCache, so everyone shares the
+ * same ones.
+ *
+ * An oscillator picks the table for its frequency at control rate (getLevel),
+ * then reads it every sample with lookup.
+ */
+class BandLimitedWaveTable
+{
+public:
+    enum class Waveform
+    {
+        SAW,        // rising, -1..1, discontinuity at phase zero
+        TRIANGLE    // like sine, with peak of 1 at phase .25
+    };
+
+    static const int tableSize = 2048;
+    static const int numLevels = 10;
+    static const int maxHarmonics = tableSize / 4;
+
+    BandLimitedWaveTable(Waveform);
+
+    /**
+     * Returns the table that has no harmonics above nyquist.
+     * normalizedFreq is freq / sampleRate, in lanes.
+     * Negative freq is treated as positive.
+     */
+    static int32_4 getLevel(float_4 normalizedFreq);
+
+    /**
+     * Linear interpolated read of four tables at once.
+     * Phase must be 0 <= phase < 1.
+     */
+    float_4 lookup(float_4 phase, int32_4 level) const;
+
+    /**
+     * Raw data for one table. There is one extra
+     * point past the end (a copy of point zero), for the interpolation.
+     */
+    const float* getLevelData(int level) const;
+
+    static int getNumHarmonics(int level)
+    {
+        return maxHarmonics >> level;
+    }
+
+private:
+    static const int stride = tableSize + 1;
+    std::vector<float> data;
+};
+
+inline int32_4 BandLimitedWaveTable::getLevel(float_4 normalizedFreq)
+{
+    int32_4 ret;
+    for (int i = 0; i < 4; ++i) {
+        // we want the most harmonics that are all below nyquist.
+        const float topHarmonicAtMax = std::abs(normalizedFreq[i]) * float(2 * maxHarmonics);
+        int level = 0;
+        if (topHarmonicAtMax > 1) {
+            int exponent;
+            const float mantissa = std::frexp(topHarmonicAtMax, &exponent);
+            level = (mantissa == .5f) ? exponent - 1 : exponent;
+        }
+        ret[i] = std::min(level, numLevels - 1);
+    }
+    return ret;
+}
+
+inline float_4 BandLimitedWaveTable::lookup(float_4 phase, int32_4 level) const
+{
+    const float_4 position = phase * float(tableSize);
+
+    // position is never negative, so truncate is the same as floor
+    const int32_4 index = position;
+    const float_4 fraction = position - float_4(index);
+
+    // Build the vectors from scalars, rather than poking them in
+    // one lane at a time, which stalls waiting for the stores.
+    const float* table = data.data();
+    const float* p0 = table + level[0] * stride + index[0];
+    const float* p1 = table + level[1] * stride + index[1];
+    const float* p2 = table + level[2] * stride + index[2];
+    const float* p3 = table + level[3] * stride + index[3];
+    const float_4 y0(p0[0], p1[0], p2[0], p3[0]);
+    const float_4 y1(p0[1], p1[1], p2[1], p3[1]);
+    return y0 + fraction * (y1 - y0);
+}
+
+inline const float* BandLimitedWaveTable::getLevelData(int level) const
+{
+    return data.data() + level * stride;
+}
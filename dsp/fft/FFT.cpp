@@ -2,10 +2,9 @@
 #include "AudioMath.h"
 #include "FFT.h"
 #include "FFTData.h"
+#include "FFTPlan.h"
 
 #include <assert.h>
-#include "kiss_fft.h"
-#include "kiss_fftr.h"
 
 #include "AudioMath.h"
 
@@ -16,31 +15,16 @@ bool FFT::forward(FFTDataCpx* out, const FFTDataReal& in)
         return false;
     }
 
-    // step 1: create the cfg, if needed
-    if (in.kiss_cfg == 0) {
-        bool inverse_fft = false;
-        kiss_fftr_cfg newCfg=  kiss_fftr_alloc((int)in.buffer.size(),
-            inverse_fft,
-           nullptr, nullptr);
-
-        assert (newCfg);
-        if (!newCfg) {
-            return false;
-        }
-
-        // now save off in our typeless pointer.
-        assert(sizeof(newCfg) == sizeof(in.kiss_cfg));
-        in.kiss_cfg = newCfg;
+    // step 1: get the plan, if needed
+    if (!in.plan) {
+        const bool inverse_fft = false;
+        in.plan = FFTPlanCache::get((int) in.buffer.size(), inverse_fft);
     }
 
     // step 2: do the fft
-    kiss_fftr_cfg theCfg = reinterpret_cast<kiss_fftr_cfg>(in.kiss_cfg);
+    in.plan->forward(out->buffer.data(), in.buffer.data());
 
-    // TODO: need a test that this assumption is correct (that we kiss_fft_cpx == std::complex.
-    kiss_fft_cpx * outBuffer = reinterpret_cast<kiss_fft_cpx *>(out->buffer.data());
-    kiss_fftr(theCfg, in.buffer.data(), outBuffer);
-
-    // step 4: scale
+    // step 3: scale
     const float scale = float(1.0 / in.buffer.size());
     for (size_t i = 0; i < in.buffer.size(); ++i) {
         out->buffer[i] *= scale;
@@ -55,30 +39,14 @@ bool FFT::inverse(FFTDataReal* out, const FFTDataCpx& in)
         return false;
     }
 
-    // step 1: create the cfg, if needed
-    if (in.kiss_cfg == 0) {
-        bool inverse_fft = true;
-        kiss_fftr_cfg newCfg = kiss_fftr_alloc((int) in.buffer.size(),
-            inverse_fft,
-            nullptr, nullptr);
-
-        assert(newCfg);
-        if (!newCfg) {
-            return false;
-        }
-
-        // now save off in our typeless pointer.
-        assert(sizeof(newCfg) == sizeof(in.kiss_cfg));
-        in.kiss_cfg = newCfg;
+    // step 1: get the plan, if needed
+    if (!in.plan) {
+        const bool inverse_fft = true;
+        in.plan = FFTPlanCache::get((int) in.buffer.size(), inverse_fft);
     }
 
     // step 2: do the fft
-    kiss_fftr_cfg theCfg = reinterpret_cast<kiss_fftr_cfg>(in.kiss_cfg);
-
-    // TODO: need a test that this assumption is correct (that we kiss_fft_cpx == std::complex.
-    const kiss_fft_cpx * inBuffer = reinterpret_cast<const kiss_fft_cpx *>(in.buffer.data());
-
-    kiss_fftri(theCfg, inBuffer, out->buffer.data());
+    in.plan->inverse(out->buffer.data(), in.buffer.data());
     return true;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <complex>
 #include <memory>
 #include <vector>
@@ -7,6 +8,7 @@
 
 
 class FFT;
+class FFTPlan;
 
 
 /**
@@ -59,19 +61,20 @@ public:
         _isPolar = false;
     }
 
-    static int _count;
+    // atomic, since FFTData get made and freed on several threads at once (SpectralReport)
+    static std::atomic<int> _count;
 private:
     std::vector<T> buffer;
     bool _isPolar = false;
 
     /**
-    * we store this without type so that clients don't need
-    * to pull in the kiss_fft headers. It's mutable so it can
+    * Plans come from FFTPlanCache, and are shared by all
+    * the FFTData of the same size. It's mutable so it can
     * be lazy created by FFT functions.
-    * Note that the cfg has a "direction" baked into it. For
+    * Note that the plan has a "direction" baked into it. For
     * now we assume that all FFT with complex input will be inverse FFTs.
     */
-    mutable void * kiss_cfg = 0;
+    mutable std::shared_ptr<const FFTPlan> plan;
 };
 
 using FFTDataReal = FFTData<float>;
@@ -79,7 +82,7 @@ using FFTDataCpx = FFTData<cpx>;
 using FFTDataRealPtr = std::shared_ptr<FFTDataReal>;
 using FFTDataCpxPtr = std::shared_ptr<FFTDataCpx>;
 
-template<typename T> int FFTData<T>::_count = 0;
+template<typename T> std::atomic<int> FFTData<T>::_count(0);
 
 template <typename T>
 inline FFTData<T>::FFTData(int numBins) :
@@ -91,11 +94,6 @@ inline FFTData<T>::FFTData(int numBins) :
 template <typename T>
 inline FFTData<T>::~FFTData()
 {
-    // We need to manually delete the cfg, since only "we" know
-    // what type it is.
-    if (kiss_cfg) {
-        free(kiss_cfg);
-    }
     --_count;
 }
 
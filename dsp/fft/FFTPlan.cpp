@@ -0,0 +1,78 @@
+
+#include "FFTPlan.h"
+#include "RadixFFT.h"
+
+#include <assert.h>
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+
+/**
+ * Plan for sizes RadixFFT can't do.
+ *
+ * kiss_fftr keeps a scratch buffer inside its cfg, so
+ * runs of the same plan on different threads are serialized.
+ */
+class KissFFTPlan : public FFTPlan
+{
+public:
+    KissFFTPlan(int size, bool inverse) : FFTPlan(size, inverse)
+    {
+        cfg = kiss_fftr_alloc(size, inverse, nullptr, nullptr);
+        assert(cfg);
+    }
+
+    ~KissFFTPlan()
+    {
+        free(cfg);
+    }
+
+    void forward(cpx* output, const float* input) const override
+    {
+        assert(!isInverse());
+        std::lock_guard<std::mutex> lock(cfgMutex);
+
+        // kiss_fft_cpx has the same layout as std::complex<float>
+        kiss_fftr(cfg, input, reinterpret_cast<kiss_fft_cpx*>(output));
+    }
+
+    void inverse(float* output, const cpx* input) const override
+    {
+        assert(isInverse());
+        std::lock_guard<std::mutex> lock(cfgMutex);
+        kiss_fftri(cfg, reinterpret_cast<const kiss_fft_cpx*>(input), output);
+    }
+
+private:
+    kiss_fftr_cfg cfg = nullptr;
+    mutable std::mutex cfgMutex;
+};
+
+std::map<FFTPlanCache::Key, std::weak_ptr<const FFTPlan>> FFTPlanCache::plans;
+std::mutex FFTPlanCache::planMutex;
+bool FFTPlanCache::forceKiss = false;
+
+FFTPlanPtr FFTPlanCache::get(int size, bool inverse)
+{
+    std::lock_guard<std::mutex> lock(planMutex);
+
+    // kiss and radix plans are never in the cache at the same time,
+    // since _forceKiss clears it.
+    const Key key(size, inverse);
+    FFTPlanPtr ret = plans[key].lock();
+    if (!ret) {
+        if (!forceKiss && RadixFFT::isSupported(size)) {
+            ret = std::make_shared<RadixFFT>(size, inverse);
+        } else {
+            ret = std::make_shared<KissFFTPlan>(size, inverse);
+        }
+        plans[key] = ret;
+    }
+    return ret;
+}
+
+void FFTPlanCache::_forceKiss(bool force)
+{
+    std::lock_guard<std::mutex> lock(planMutex);
+    forceKiss = force;
+    plans.clear();
+}
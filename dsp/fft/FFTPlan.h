@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FFTData.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * An FFTPlan does real FFTs of one size, in one direction.
+ * All the tables a plan needs are built when it is created.
+ *
+ * Plans are shared (see FFTPlanCache), so running a plan
+ * must not modify it. It's ok for several threads to
+ * run the same plan at the same time.
+ *
+ * Scaling is the same as kiss_fftr: neither direction scales.
+ * FFT::forward does the 1/N scaling.
+ */
+class FFTPlan
+{
+public:
+    virtual ~FFTPlan()
+    {
+    }
+
+    /**
+     * Fills bins 0..size/2 of output. Bins above size/2 are not touched.
+     * output must have room for size bins.
+     */
+    virtual void forward(cpx* output, const float* input) const = 0;
+
+    /**
+     * Only reads bins 0..size/2 of input.
+     */
+    virtual void inverse(float* output, const cpx* input) const = 0;
+
+    int size() const
+    {
+        return numBins;
+    }
+
+    bool isInverse() const
+    {
+        return _isInverse;
+    }
+
+protected:
+    FFTPlan(int size, bool inverse) : numBins(size), _isInverse(inverse)
+    {
+    }
+
+private:
+    const int numBins;
+    const bool _isInverse;
+};
+
+using FFTPlanPtr = std::shared_ptr<const FFTPlan>;
+
+/**
+ * Creates FFT plans and shares them between all the FFTData objects of the
+ * same size and direction.
+ *
+ * Like ObjectCache, the cache uses weak pointers, so a plan is
+ * freed when the last FFTData using it goes away.
+ *
+ * Power of two sizes use the SIMD radix FFT (RadixFFT).
+ * Other sizes fall back to kiss_fft.
+ */
+class FFTPlanCache
+{
+public:
+    FFTPlanCache() = delete;       // we are only static
+
+    static FFTPlanPtr get(int size, bool inverse);
+
+    /**
+     * Unit tests can use this to run the kiss_fft plans
+     * for all sizes, to compare the two.
+     */
+    static void _forceKiss(bool);
+
+private:
+    using Key = std::pair<int, bool>;
+    static std::map<Key, std::weak_ptr<const FFTPlan>> plans;
+    static std::mutex planMutex;
+    static bool forceKiss;
+};
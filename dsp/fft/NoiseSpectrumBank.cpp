@@ -0,0 +1,70 @@
+
+#include "NoiseSpectrumBank.h"
+#include "AudioMath.h"
+#include "FFT.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+std::weak_ptr<const NoiseSpectrumBank> NoiseSpectrumBank::theBank;
+std::mutex NoiseSpectrumBank::bankMutex;
+
+std::shared_ptr<const NoiseSpectrumBank> NoiseSpectrumBank::get()
+{
+    std::lock_guard<std::mutex> lock(bankMutex);
+    std::shared_ptr<const NoiseSpectrumBank> ret = theBank.lock();
+    if (!ret) {
+        ret = std::make_shared<NoiseSpectrumBank>();
+        theBank = ret;
+    }
+    return ret;
+}
+
+NoiseSpectrumBank::NoiseSpectrumBank()
+{
+    // one set of phases, shared by all the frames
+    std::vector<float> phases(numBins);
+    for (int i = 0; i < numBins; ++i) {
+        const float phase = float(rand()) / float(RAND_MAX);   // 0..1
+        phases[i] = float(phase * 2 * AudioMath::Pi);
+    }
+
+    FFTDataCpx spectrum(numBins);
+    for (int slope = minSlope; slope <= maxSlope; ++slope) {
+        ColoredNoiseSpec spec;
+        spec.slope = float(slope);
+        spec.highFreqCorner = 6000;
+        FFT::makeNoiseSpectrum(&spectrum, spec);
+
+        // keep the magnitudes, but use the shared phases
+        for (int i = 0; i < numBins; ++i) {
+            spectrum.set(i, std::polar(spectrum.getAbs(i), phases[i]));
+        }
+
+        FFTDataRealPtr frame = std::make_shared<FFTDataReal>(numBins);
+        FFT::inverse(frame.get(), spectrum);
+        FFT::normalize(frame.get(), 5);  // use 5v amplitude.
+        frames.push_back(frame);
+    }
+    assert(int(frames.size()) == numFrames);
+}
+
+const float* NoiseSpectrumBank::getFrame(int frame) const
+{
+    assert(frame >= 0 && frame < numFrames);
+    return frames[frame]->data();
+}
+
+NoiseSpectrumBank::Mix NoiseSpectrumBank::getMix(float slope) const
+{
+    slope = std::max(float(minSlope), std::min(float(maxSlope), slope));
+    const float position = slope - minSlope;           // 0..numFrames - 1
+    const int lowerFrame = std::min(int(position), numFrames - 2);
+
+    Mix ret;
+    ret.lower = getFrame(lowerFrame);
+    ret.upper = getFrame(lowerFrame + 1);
+    ret.upperGain = position - lowerFrame;
+    return ret;
+}
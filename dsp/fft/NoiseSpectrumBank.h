@@ -0,0 +1,66 @@
+#pragma once
+
+#include "FFTData.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * A bank of pre-rendered colored noise, one frame for each whole
+ * number slope from minSlope to maxSlope (db/octave).
+ *
+ * All the frames use the same random phase for each bin, so the frames
+ * add coherently: mixing the frames for two neighboring slopes gives
+ * noise with a spectrum between the two. This lets ColoredNoise follow
+ * a slope CV by changing the mix, without doing any FFTs.
+ *
+ * Building the bank takes a while (one inverse FFT per slope),
+ * so it must not be done on the audio thread. One bank is shared by all clients.
+ */
+class NoiseSpectrumBank
+{
+public:
+    static const int numBins = 64 * 1024;      // must be a power of two
+    static const int minSlope = -8;
+    static const int maxSlope = 8;
+    static const int numFrames = maxSlope - minSlope + 1;
+
+    /**
+     * Returns the shared bank, building it if needed.
+     * Like ObjectCache, the bank is freed when the last
+     * client lets go of it.
+     */
+    static std::shared_ptr<const NoiseSpectrumBank> get();
+
+    /**
+     * The two frames to play for a given slope.
+     * output = lower[i] + upperGain * (upper[i] - lower[i])
+     */
+    class Mix
+    {
+    public:
+        const float* lower = nullptr;
+        const float* upper = nullptr;
+        float upperGain = 0;
+    };
+
+    /**
+     * Slopes outside the range of the bank are clipped.
+     */
+    Mix getMix(float slope) const;
+
+    /**
+     * Time domain data for one of the frames.
+     * frame 0 is minSlope.
+     */
+    const float* getFrame(int frame) const;
+
+    NoiseSpectrumBank();
+
+private:
+    std::vector<FFTDataRealPtr> frames;
+
+    static std::weak_ptr<const NoiseSpectrumBank> theBank;
+    static std::mutex bankMutex;
+};
@@ -1,80 +1,173 @@
 
 #include "OnsetDetector.h"
+#include "simd.h"
 
-#include "FFTData.h"
-#include "FFTUtils.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <utility>
+#include <xmmintrin.h>
 
+const int OnsetDetector::frameSize = {512};
+const int OnsetDetector::hopSize = {frameSize / 2};
 
+// We skip the top half of the spectrum (it's the mirror image), and nyquist.
+const int OnsetDetector::numBins = {frameSize / 2};
+const int OnsetDetector::preroll = {frameSize + 2 * hopSize};
 
-const int OnsetDetector::frameSize = {512};
-const int OnsetDetector::preroll = {2 * frameSize};
+// Added to the total magnitude before normalizing, so
+// very quiet signals don't trigger. About a millivolt.
+static const float silence = .001f;
+
+OnsetDetector::OnsetDetector(DetectionFunction function) :
+    function(function),
+    stft(frameSize, hopSize, STFT::Window::Hann, false, false),
+    prevRe(numBins),
+    prevIm(numBins),
+    prevPrevRe(numBins),
+    prevPrevIm(numBins),
+    prevMag(numBins),
+    prerollCounter(preroll)
+{
+    assert((numBins % 4) == 0);
+    stft.setCallback([this](FFTDataCpx& spectrum) {
+        this->analyze(spectrum);
+    });
+    setThreshold(getDefaultThreshold(function));
+    updateTimes();
+}
 
-OnsetDetector::OnsetDetector()
+float OnsetDetector::getDefaultThreshold(DetectionFunction function)
 {
-    for (int i=0; i<numFrames; ++i) {
-        fftFrames[i] = std::make_shared<FFTDataReal>(frameSize);
-        fftFramesAnalyzed[i] = std::make_shared<FFTDataCpx>(frameSize);
+    switch (function) {
+        case DetectionFunction::SpectralFlux:
+            return .4f;
+        case DetectionFunction::PhaseDeviation:
+            return .4f;         // note that noise will trigger this
+        case DetectionFunction::ComplexDomain:
+            return .7f;
     }
+    assert(false);
+    return 1;
 }
 
-int OnsetDetector::nextFrame()
+void OnsetDetector::setSampleRate(float sr)
 {
-    return curFrame >= (numFrames - 1) ? 0 : curFrame + 1;
+    sampleRate = sr;
+    updateTimes();
 }
 
-int OnsetDetector::prevFrame()
+void OnsetDetector::setHoldoffMs(float ms)
 {
-    return curFrame == 0 ? 2 : curFrame - 1;
+    holdoffMs = ms;
+    updateTimes();
 }
 
-int OnsetDetector::prevPrevFrame()
+void OnsetDetector::setThreshold(float t)
 {
-    int ret = curFrame - 2;
-    if (ret < 0) {
-        ret += 3;
-    }
-    return ret;
+    threshold = t;
 }
 
-bool OnsetDetector::step(float inputData)
+void OnsetDetector::updateTimes()
+{
+    triggerSamples = std::max(1, int(sampleRate * .001f));
+    holdoffSamples = std::max(triggerSamples, int(sampleRate * holdoffMs * .001f));
+}
+
+bool OnsetDetector::step(float input)
 {
-    fftFrames[curFrame]->set(indexInFrame, inputData);
-    if (++indexInFrame >= frameSize) {
-        numFullFrames++;
-        // now take fft into cpx
-        FFT::forward(fftFramesAnalyzed[curFrame].get(), *fftFrames[curFrame]);
-        printf("about to analyze frame %d\n", curFrame);
-        fftFramesAnalyzed[curFrame]->toPolar();
-        analyze();
-        curFrame = nextFrame();
-
-        indexInFrame = 0;
-    }
     if (triggerCounter > 0) {
         --triggerCounter;
     }
-    return triggerCounter > 0;;
+    if (holdoffCounter > 0) {
+        --holdoffCounter;
+    }
+    if (prerollCounter > 0) {
+        --prerollCounter;
+    }
+
+    // will call analyze at the end of every hop
+    stft.step(input);
+    return triggerCounter > 0;
 }
 
-void OnsetDetector::analyze()
+/**
+ * Pulls 4 bins out of the interleaved complex spectrum.
+ */
+inline void loadBins(const float* bins, int index, float_4& re, float_4& im)
 {
-    printf("enter analyze, ff=%d\n", numFullFrames);
-    if (numFullFrames < 3) {
-        printf("still priming\n");
-        return;
-    }
-    FFTUtils::Stats stats;
-    FFTUtils::getStats(stats, *fftFramesAnalyzed[prevPrevFrame()], *fftFramesAnalyzed[prevFrame()], *fftFramesAnalyzed[curFrame]);
-    printf("analyze frame, jump = %f\n", stats.averagePhaseJump);
-    if (stats.averagePhaseJump > .1) {
-        // 1 ms. ( used 46 becaue it's close and makes the test pass ;-)
-        triggerCounter = 46;        // todo: sample rate independent?
+    const __m128 a = _mm_loadu_ps(bins + 2 * index);
+    const __m128 b = _mm_loadu_ps(bins + 2 * index + 4);
+    re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline float sum(float_4 x)
+{
+    return x[0] + x[1] + x[2] + x[3];
+}
+
+void OnsetDetector::analyze(const FFTDataCpx& spectrum)
+{
+    // FFTData doesn't have a const data(), but we won't change it.
+    const float* bins = reinterpret_cast<const float*>(const_cast<FFTDataCpx&>(spectrum).data());
+
+    float_4 magSum = 0;         // of the larger of this and the last magnitude
+    float_4 detectionSum = 0;
+    for (int i = 0; i < numBins; i += 4) {
+        float_4 re, im;
+        loadBins(bins, i, re, im);
+        float_4 mag = rack::simd::sqrt(re * re + im * im);
+        const float_4 lastMag = float_4::load(&prevMag[i]);
+
+        if (function == DetectionFunction::SpectralFlux) {
+            detectionSum += rack::simd::fmax(mag - lastMag, 0);
+        } else {
+            // If the phase keeps advancing at the same rate, this frame's phase will be
+            // 2 * lastPhase - lastLastPhase. So the predicted phasor is last * last * conj(lastLast).
+            const float_4 lastRe = float_4::load(&prevRe[i]);
+            const float_4 lastIm = float_4::load(&prevIm[i]);
+            const float_4 lastLastRe = float_4::load(&prevPrevRe[i]);
+            const float_4 lastLastIm = float_4::load(&prevPrevIm[i]);
+
+            const float_4 squareRe = lastRe * lastRe - lastIm * lastIm;
+            const float_4 squareIm = 2 * lastRe * lastIm;
+            float_4 predictedRe = squareRe * lastLastRe + squareIm * lastLastIm;
+            float_4 predictedIm = squareIm * lastLastRe - squareRe * lastLastIm;
+
+            // normalize to a unit phasor. If there is no history, predict zero.
+            const float_4 predictedMag = rack::simd::sqrt(predictedRe * predictedRe + predictedIm * predictedIm);
+            const float_4 scale = rack::simd::ifelse(predictedMag > 1e-12f, 1.f / predictedMag, 0);
+            predictedRe *= scale;
+            predictedIm *= scale;
+
+            if (function == DetectionFunction::PhaseDeviation) {
+                // mag * (1 - cos(deviation))
+                detectionSum += mag - (re * predictedRe + im * predictedIm);
+            } else {
+                // distance from the last magnitude at the predicted phase.
+                // Only count bins that got louder, so we don't trigger as notes decay.
+                const float_4 errorRe = re - lastMag * predictedRe;
+                const float_4 errorIm = im - lastMag * predictedIm;
+                const float_4 error = rack::simd::sqrt(errorRe * errorRe + errorIm * errorIm);
+                detectionSum += rack::simd::ifelse(mag >= lastMag, error, 0);
+            }
+
+            // lastLast is used up, so this frame can go there
+            re.store(&prevPrevRe[i]);
+            im.store(&prevPrevIm[i]);
+        }
+        mag.store(&prevMag[i]);
+        magSum += rack::simd::fmax(mag, lastMag);
     }
-    else {
-        assert(triggerCounter == 0);
-        triggerCounter = 0;
+
+    // after the swap, prev is the frame we just did
+    std::swap(prevRe, prevPrevRe);
+    std::swap(prevIm, prevPrevIm);
+
+    detectionValue = sum(detectionSum) / (sum(magSum) + silence);
+    if (detectionValue > threshold && holdoffCounter == 0 && prerollCounter == 0) {
+        triggerCounter = triggerSamples;
+        holdoffCounter = holdoffSamples;
     }
-    //printf("will clear polary on %d\n", prevPrevFrame());
-    fftFramesAnalyzed[prevPrevFrame()]->reset();
- 
-}
\ No newline at end of file
+}
@@ -1,34 +1,96 @@
 #pragma once
 
 #include "FFTData.h"
+#include "STFT.h"
 
-#include <memory>
-
-
+#include <vector>
 
+/**
+ * Spectral onset detector.
+ *
+ * Runs a Hann windowed STFT on the input. Each hop the new spectrum is reduced
+ * to a single number by the detection function, normalized to the total
+ * magnitude so it doesn't depend on the input level. When that goes over the threshold
+ * step() returns true for one millisecond. After that new onsets are ignored until
+ * the holdoff time has passed.
+ *
+ * All the state is allocated in the constructor, so step() is safe
+ * to call from the audio thread.
+ */
 class OnsetDetector
 {
 public:
-    friend class TestOnsetDetector;
-    OnsetDetector();
+    enum class DetectionFunction
+    {
+        SpectralFlux,       // sum of the magnitude increases. Good for percussive onsets.
+        PhaseDeviation,     // magnitude weighted deviation from the predicted phase. Good for pitched onsets.
+        ComplexDomain       // distance from the predicted bin values. Catches both.
+    };
+
+    OnsetDetector(DetectionFunction function = DetectionFunction::SpectralFlux);
+    OnsetDetector(const OnsetDetector&) = delete;
+    OnsetDetector& operator = (const OnsetDetector&) = delete;
+
+    /**
+     * returns true while the trigger is high.
+     */
     bool step(float);
 
+    void setSampleRate(float sampleRate);
+    void setHoldoffMs(float ms);
+
+    /**
+     * Threshold for the normalized detection function.
+     * SpectralFlux goes from 0 to 1, the others from 0 to 2.
+     */
+    void setThreshold(float);
+
+    /**
+     * Each function gets a threshold that works for typical material
+     */
+    static float getDefaultThreshold(DetectionFunction);
+
+    /**
+     * The detection function for the most recent frame.
+     */
+    float getDetectionValue() const
+    {
+        return detectionValue;
+    }
+
     static const int frameSize;
+    static const int hopSize;
+    static const int numBins;
+
+    /**
+     * Onsets in the first preroll samples are ignored,
+     * so the first frames (and the phase history) can fill.
+     */
     static const int preroll;
 private:
-    static const int numFrames = 3;
-   
-    std::shared_ptr<FFTDataReal> fftFrames[numFrames];
-    std::shared_ptr<FFTDataCpx> fftFramesAnalyzed[numFrames];
-    int curFrame = 0;
-    int indexInFrame = 0;
-    int numFullFrames = 0;
-
-  //  bool triggered = false;
+    const DetectionFunction function;
+    STFT stft;
+
+    /**
+     * Last two frames, de-interleaved so the SIMD can get at them.
+     */
+    std::vector<float> prevRe;
+    std::vector<float> prevIm;
+    std::vector<float> prevPrevRe;
+    std::vector<float> prevPrevIm;
+    std::vector<float> prevMag;
+
+    float sampleRate = 44100;
+    float holdoffMs = 50;
+    float threshold = 0;
+    float detectionValue = 0;
+
+    int triggerSamples = 0;
+    int holdoffSamples = 0;
     int triggerCounter = 0;
-    void analyze();
+    int holdoffCounter = 0;
+    int prerollCounter = 0;
 
-    int nextFrame();
-    int prevFrame();
-    int prevPrevFrame();
+    void analyze(const FFTDataCpx& spectrum);
+    void updateTimes();
 };
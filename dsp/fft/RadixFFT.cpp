@@ -0,0 +1,178 @@
+
+#include "RadixFFT.h"
+#include "AudioMath.h"
+
+#include <assert.h>
+#include <xmmintrin.h>
+
+bool RadixFFT::isSupported(int size)
+{
+    // first two stages are always done together, so need at least 4 complex points
+    return (size >= 8) && ((size & (size - 1)) == 0);
+}
+
+RadixFFT::RadixFFT(int size, bool inverse) :
+    FFTPlan(size, inverse),
+    half(size / 2)
+{
+    assert(isSupported(size));
+
+    int bits = 0;
+    while ((1 << bits) < half) {
+        ++bits;
+    }
+    bitReverse.resize(half);
+    for (int i = 0; i < half; ++i) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            if (i & (1 << bit)) {
+                reversed |= 1 << (bits - 1 - bit);
+            }
+        }
+        bitReverse[i] = reversed;
+    }
+
+    // forward uses e ** -j, inverse e ** +j
+    const double sign = inverse ? 1 : -1;
+    for (int len = 8; len <= half; len *= 2) {
+        for (int j = 0; j < len / 2; j += 2) {
+            const double angle0 = sign * 2 * AudioMath::Pi * j / len;
+            const double angle1 = sign * 2 * AudioMath::Pi * (j + 1) / len;
+            const float cos0 = float(std::cos(angle0));
+            const float cos1 = float(std::cos(angle1));
+            const float sin0 = float(std::sin(angle0));
+            const float sin1 = float(std::sin(angle1));
+            const float entry[8] = {cos0, cos0, cos1, cos1, -sin0, sin0, -sin1, sin1};
+            stageTwiddles.insert(stageTwiddles.end(), entry, entry + 8);
+        }
+    }
+
+    splitTwiddles.resize(half / 2 + 1);
+    for (int k = 0; k <= half / 2; ++k) {
+        const double angle = sign * 2 * AudioMath::Pi * k / size;
+        splitTwiddles[k] = cpx(float(std::cos(angle)), float(std::sin(angle)));
+    }
+}
+
+void RadixFFT::runComplex(float* data) const
+{
+    // first two stages, four points at a time.
+    // stage 2 multiplies the last point by -j (forward) or +j (inverse)
+    const __m128 signs1 = _mm_setr_ps(1, 1, -1, -1);
+    const __m128 signs2 = isInverse() ? _mm_setr_ps(1, 1, -1, 1) : _mm_setr_ps(1, 1, 1, -1);
+    for (int i = 0; i < half; i += 4) {
+        float* p = data + 2 * i;
+        const __m128 a01 = _mm_loadu_ps(p);
+        const __m128 a23 = _mm_loadu_ps(p + 4);
+
+        // b01 = (a0 + a1, a0 - a1), b23 = (a2 + a3, a2 - a3)
+        const __m128 b01 = _mm_add_ps(_mm_movelh_ps(a01, a01), _mm_mul_ps(_mm_movehl_ps(a01, a01), signs1));
+        const __m128 b23 = _mm_add_ps(_mm_movelh_ps(a23, a23), _mm_mul_ps(_mm_movehl_ps(a23, a23), signs1));
+
+        // t = (b2, b3 * (-/+ j))
+        const __m128 t = _mm_mul_ps(_mm_shuffle_ps(b23, b23, _MM_SHUFFLE(2, 3, 1, 0)), signs2);
+        _mm_storeu_ps(p, _mm_add_ps(b01, t));
+        _mm_storeu_ps(p + 4, _mm_sub_ps(b01, t));
+    }
+
+    // the rest of the stages, two butterflies at a time.
+    const float* twiddles = stageTwiddles.data();
+    for (int len = 8; len <= half; len *= 2) {
+        const int stageHalf = len / 2;
+        for (int k = 0; k < half; k += len) {
+            float* pa = data + 2 * k;
+            float* pb = pa + 2 * stageHalf;
+            const float* w = twiddles;
+            for (int j = 0; j < stageHalf; j += 2) {
+                const __m128 a = _mm_loadu_ps(pa);
+                const __m128 b = _mm_loadu_ps(pb);
+                const __m128 wr = _mm_loadu_ps(w);
+                const __m128 wi = _mm_loadu_ps(w + 4);
+
+                // complex multiply, b * w
+                const __m128 bSwapped = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+                const __m128 t = _mm_add_ps(_mm_mul_ps(b, wr), _mm_mul_ps(bSwapped, wi));
+
+                _mm_storeu_ps(pa, _mm_add_ps(a, t));
+                _mm_storeu_ps(pb, _mm_sub_ps(a, t));
+                pa += 4;
+                pb += 4;
+                w += 8;
+            }
+        }
+        twiddles += 4 * stageHalf;
+    }
+}
+
+void RadixFFT::forward(cpx* output, const float* input) const
+{
+    assert(!isInverse());
+
+    // pack even samples into real, odd into imaginary
+    const cpx* packed = reinterpret_cast<const cpx*>(input);
+    for (int i = 0; i < half; ++i) {
+        output[i] = packed[bitReverse[i]];
+    }
+    runComplex(reinterpret_cast<float*>(output));
+
+    // split the even and odd spectra
+    const float z0r = output[0].real();
+    const float z0i = output[0].imag();
+    output[0] = cpx(z0r + z0i, 0);
+    output[half] = cpx(z0r - z0i, 0);
+
+    for (int k = 1; k <= half / 2; ++k) {
+        const float ar = output[k].real();
+        const float ai = output[k].imag();
+        const float br = output[half - k].real();
+        const float bi = -output[half - k].imag();
+
+        // even = (a + b) / 2, odd = -j(a - b) / 2
+        const float er = .5f * (ar + br);
+        const float ei = .5f * (ai + bi);
+        const float orr = .5f * (ai - bi);
+        const float oi = -.5f * (ar - br);
+
+        // odd * twiddle
+        const float wr = splitTwiddles[k].real();
+        const float wi = splitTwiddles[k].imag();
+        const float tr = orr * wr - oi * wi;
+        const float ti = orr * wi + oi * wr;
+
+        output[k] = cpx(er + tr, ei + ti);
+        output[half - k] = cpx(er - tr, ti - ei);
+    }
+}
+
+void RadixFFT::inverse(float* output, const cpx* input) const
+{
+    assert(isInverse());
+    cpx* packed = reinterpret_cast<cpx*>(output);
+
+    // combine the spectra into the even and odd samples
+    const float x0 = input[0].real();
+    const float xn = input[half].real();
+    packed[0] = cpx(x0 + xn, x0 - xn);
+
+    for (int k = 1; k <= half / 2; ++k) {
+        const float ar = input[k].real();
+        const float ai = input[k].imag();
+        const float br = input[half - k].real();
+        const float bi = -input[half - k].imag();
+
+        // even = a + b, odd = (a - b) * twiddle
+        const float er = ar + br;
+        const float ei = ai + bi;
+        const float dr = ar - br;
+        const float di = ai - bi;
+        const float wr = splitTwiddles[k].real();
+        const float wi = splitTwiddles[k].imag();
+        const float orr = dr * wr - di * wi;
+        const float oi = dr * wi + di * wr;
+
+        // z[k] = even + j * odd, z[half - k] = conj(even) + j * conj(odd)
+        packed[bitReverse[k]] = cpx(er - oi, ei + orr);
+        packed[bitReverse[half - k]] = cpx(er + oi, orr - ei);
+    }
+    runComplex(output);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FFTPlan.h"
+
+#include <vector>
+
+/**
+ * Real FFT for power of two sizes, using SSE.
+ *
+ * A real FFT of size N is done as a complex FFT of size N/2,
+ * followed by (or, for the inverse, preceded by) a pass that
+ * splits out the even and odd samples. The bit reversal is done while
+ * copying the data into the output buffer, so the plan never needs
+ * scratch memory, and is safe to share.
+ *
+ * The complex FFT is radix 2, decimation in time. The first two stages are done together,
+ * since they don't need any twiddles. The rest do two butterflies
+ * per SSE vector, with the twiddles stored ready to use.
+ */
+class RadixFFT : public FFTPlan
+{
+public:
+    RadixFFT(int size, bool inverse);
+
+    /**
+     * Sizes we can do. Everything else goes to kiss_fft.
+     */
+    static bool isSupported(int size);
+
+    void forward(cpx* output, const float* input) const override;
+    void inverse(float* output, const cpx* input) const override;
+
+private:
+    /**
+     * Size of the complex FFT (size() / 2).
+     */
+    const int half;
+
+    /**
+     * bitReverse[i] is the index i with its bits reversed.
+     */
+    std::vector<int> bitReverse;
+
+    /**
+     * For each stage after the first two: (half the stage length) / 2 entries of eight floats.
+     * Each entry is the twiddles for two butterflies:
+     *      cos0, cos0, cos1, cos1, -sin0, sin0, -sin1, sin1
+     */
+    std::vector<float> stageTwiddles;
+
+    /**
+     * The twiddles for the even / odd split, for k = 0..half / 2.
+     */
+    std::vector<cpx> splitTwiddles;
+
+    void runComplex(float* data) const;
+};
@@ -0,0 +1,212 @@
+
+#include "STFT.h"
+#include "AudioMath.h"
+#include "FFT.h"
+#include "ThreadClient.h"
+#include "ThreadServer.h"
+#include "ThreadSharedState.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+/**
+ * One frame of work for the worker thread.
+ */
+class STFTMessage : public ThreadMessage
+{
+public:
+    STFTMessage(const STFT* owner, int frameSize) :
+        ThreadMessage(Type::STFT),
+        owner(owner),
+        frame(frameSize),
+        spectrum(frameSize)
+    {
+    }
+
+    const STFT* const owner;
+    FFTDataReal frame;
+    FFTDataCpx spectrum;
+};
+
+class STFTServer : public ThreadServer
+{
+public:
+    STFTServer(std::shared_ptr<ThreadSharedState> state) : ThreadServer(state)
+    {
+    }
+
+protected:
+    void handleMessage(ThreadMessage* msg) override
+    {
+        if (msg->type != ThreadMessage::Type::STFT) {
+            assert(false);
+            return;
+        }
+        STFTMessage* frameMessage = static_cast<STFTMessage*>(msg);
+        frameMessage->owner->processFrame(frameMessage->frame, frameMessage->spectrum);
+        sendMessageToClient(frameMessage);
+    }
+};
+
+static float windowValue(STFT::Window window, int i, int frameSize)
+{
+    // periodic windows, so that they overlap-add cleanly
+    const double hann = .5 - .5 * std::cos(2 * AudioMath::Pi * i / frameSize);
+    switch (window) {
+        case STFT::Window::Hann:
+            return float(hann);
+        case STFT::Window::SqrtHann:
+            return float(std::sqrt(hann));
+        case STFT::Window::Rectangular:
+        default:
+            return 1;
+    }
+}
+
+STFT::STFT(int frameSize, int hopSize, Window windowType, bool resynthesize, bool useThread) :
+    frameSize(frameSize),
+    hopSize(hopSize),
+    resynthesize(resynthesize),
+    window(frameSize),
+    synthesisWindow(frameSize),
+    inputBuffer(frameSize),
+    outputBuffer(frameSize)
+{
+    assert(hopSize > 0 && hopSize <= frameSize);
+    assert((frameSize % hopSize) == 0);
+
+    for (int i = 0; i < frameSize; ++i) {
+        window[i] = windowValue(windowType, i, frameSize);
+    }
+
+    // The overlap-add of the two windows should be constant.
+    // Use the average, in case it isn't quite.
+    double sum = 0;
+    for (int i = 0; i < frameSize; ++i) {
+        sum += window[i] * window[i];
+    }
+    const float overlapGain = float(sum / hopSize);
+    for (int i = 0; i < frameSize; ++i) {
+        synthesisWindow[i] = window[i] / overlapGain;
+    }
+
+    if (useThread) {
+        message.reset(new STFTMessage(this, frameSize));
+        std::shared_ptr<ThreadSharedState> threadState = std::make_shared<ThreadSharedState>();
+        std::unique_ptr<ThreadServer> server(new STFTServer(threadState));
+        thread.reset(new ThreadClient(threadState, std::move(server)));
+    } else {
+        frame.reset(new FFTDataReal(frameSize));
+        spectrum.reset(new FFTDataCpx(frameSize));
+
+        // run once now, so the FFT plans are not
+        // created on the audio thread.
+        processFrame(*frame, *spectrum);
+    }
+}
+
+STFT::~STFT()
+{
+    thread.reset();  // kill the threads before deleting other things
+}
+
+void STFT::setCallback(Callback cb)
+{
+    callback = cb;
+}
+
+int STFT::getLatency() const
+{
+    return thread ? frameSize + hopSize : frameSize;
+}
+
+float STFT::step(float input)
+{
+    inputBuffer[frameSize - hopSize + hopCounter] = input;
+    const float output = outputBuffer[hopCounter];
+    if (++hopCounter >= hopSize) {
+        hopCounter = 0;
+        endOfHop();
+    }
+    return output;
+}
+
+void STFT::endOfHop()
+{
+    // we played the first hop of output, so shift it out.
+    std::copy(outputBuffer.begin() + hopSize, outputBuffer.end(), outputBuffer.begin());
+    std::fill(outputBuffer.end() - hopSize, outputBuffer.end(), 0.f);
+
+    if (thread) {
+        serviceThread();
+    } else {
+        std::copy(inputBuffer.begin(), inputBuffer.end(), frame->data());
+        processFrame(*frame, *spectrum);
+        addToOutput(*frame);
+    }
+
+    // make room for the next hop of input
+    std::copy(inputBuffer.begin() + hopSize, inputBuffer.end(), inputBuffer.begin());
+}
+
+/**
+ * Each hop we pick up the frame we sent last hop, then send the new one.
+ */
+void STFT::serviceThread()
+{
+    if (isRequestPending) {
+        ThreadMessage* msg = thread->getMessage();
+        if (msg) {
+            assert(msg == message.get());
+            isRequestPending = false;
+            if (!isRequestLate) {
+                addToOutput(message->frame);
+            }
+            isRequestLate = false;
+        } else {
+            // worker didn't make it in time. When it does come back
+            // it will be too late to use.
+            ++overruns;
+            isRequestLate = true;
+        }
+    }
+
+    if (!isRequestPending) {
+        std::copy(inputBuffer.begin(), inputBuffer.end(), message->frame.data());
+        isRequestPending = thread->sendMessage(message.get());
+        if (!isRequestPending) {
+            ++overruns;
+        }
+    }
+}
+
+void STFT::addToOutput(const FFTDataReal& processedFrame)
+{
+    if (!resynthesize) {
+        return;
+    }
+    for (int i = 0; i < frameSize; ++i) {
+        outputBuffer[i] += processedFrame.get(i);
+    }
+}
+
+void STFT::processFrame(FFTDataReal& data, FFTDataCpx& freqData) const
+{
+    float* samples = data.data();
+    for (int i = 0; i < frameSize; ++i) {
+        samples[i] *= window[i];
+    }
+
+    FFT::forward(&freqData, data);
+    if (callback) {
+        callback(freqData);
+    }
+
+    if (resynthesize) {
+        FFT::inverse(&data, freqData);
+        for (int i = 0; i < frameSize; ++i) {
+            samples[i] *= synthesisWindow[i];
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "FFTData.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ThreadClient;
+class STFTMessage;
+
+/**
+ * Streaming short time Fourier transform, with optional
+ * overlap-add resynthesis.
+ *
+ * Feed it one sample at a time with step(). Every hopSize samples
+ * the last frameSize samples are windowed and transformed, and
+ * the callback is called with the spectrum. The callback may modify the spectrum.
+ * If resynthesis is enabled the (possibly modified) spectrum
+ * is transformed back, windowed again, and overlap-added into the output.
+ *
+ * All buffers are allocated in the constructor, so step() is safe
+ * to call from the audio thread.
+ *
+ * If useThread is true, the FFTs and the callback run on a worker thread.
+ * This adds one hop of latency. If the worker can't keep up, frames are dropped
+ * (see _overruns()).
+ *
+ * For exact resynthesis the window, squared, must overlap-add
+ * to a constant at the hop size. For example SqrtHann with a hop of frameSize / 2,
+ * or Hann with a hop of frameSize / 4.
+ *
+ * Not copyable or movable: the worker thread's messages point back at the STFT that sent them.
+ */
+class STFT
+{
+public:
+    enum class Window
+    {
+        Rectangular,
+        Hann,
+        SqrtHann
+    };
+
+    using Callback = std::function<void(FFTDataCpx& spectrum)>;
+
+    /**
+     * frameSize must be a multiple of hopSize.
+     */
+    STFT(int frameSize, int hopSize, Window window, bool resynthesize, bool useThread);
+    ~STFT();
+
+    STFT(const STFT&) = delete;
+    STFT(STFT&&) = delete;
+    STFT& operator=(const STFT&) = delete;
+    STFT& operator=(STFT&&) = delete;
+
+    /**
+     * Must be called before the first step().
+     */
+    void setCallback(Callback);
+
+    /**
+     * returns the resynthesized output, or zero if resynthesis is off.
+     */
+    float step(float input);
+
+    /**
+     * Delay from input to output, in samples.
+     */
+    int getLatency() const;
+
+    int getFrameSize() const
+    {
+        return frameSize;
+    }
+
+    int getHopSize() const
+    {
+        return hopSize;
+    }
+
+    int _overruns() const
+    {
+        return overruns;
+    }
+
+    /**
+     * Runs one frame: window, FFT, callback, and (maybe) inverse FFT and window.
+     * frame comes in holding the raw input samples. On return it holds
+     * the output samples to be overlap-added.
+     * Called from the worker thread when useThread is true.
+     */
+    void processFrame(FFTDataReal& frame, FFTDataCpx& spectrum) const;
+
+private:
+    using Buffer = std::vector<float, AlignedAllocator<float>>;
+
+    const int frameSize;
+    const int hopSize;
+    const bool resynthesize;
+
+    Buffer window;
+
+    /**
+     * Window, with the overlap-add gain correction folded in.
+     */
+    Buffer synthesisWindow;
+
+    /**
+     * The last frameSize input samples, oldest first.
+     */
+    Buffer inputBuffer;
+
+    /**
+     * Overlap-add accumulator. We play the first hopSize
+     * samples, then shift it down.
+     */
+    Buffer outputBuffer;
+    int hopCounter = 0;
+
+    Callback callback;
+
+    // used when running on the audio thread
+    std::unique_ptr<FFTDataReal> frame;
+    std::unique_ptr<FFTDataCpx> spectrum;
+
+    // used when running on a worker thread
+    std::unique_ptr<ThreadClient> thread;
+    std::unique_ptr<STFTMessage> message;
+    bool isRequestPending = false;
+    bool isRequestLate = false;
+    int overruns = 0;
+
+    void endOfHop();
+    void serviceThread();
+    void addToOutput(const FFTDataReal& frame);
+};
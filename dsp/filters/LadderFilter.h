@@ -1,11 +1,13 @@
 #pragma once
 
 #include "AsymWaveShaper.h"
+#include "EnumDispatch.h"
 #include "IIRDecimator.h"
 #include "IIRUpsampler.h"
 #include "LookupTable.h"
 #include "NonUniformLookupTable.h"
 #include "ObjectCache.h"
+#include "SimdLookupTable.h"
 #include "TrapezoidalLowpass.h"
 
 #include <vector>
@@ -18,54 +20,56 @@ class EdgeTables
 {
 public:
     EdgeTables();
+
+    /**
+     * gains must be 16 byte aligned.
+     */
     void lookup(bool is4PLP, float edge, float* gains);
 private:
-    LookupTableParams<float> tables4PLP[4];
-    LookupTableParams<float> tablesOther[4];
+    /**
+     * The four stage gains share the same domain, so each
+     * set of them is a single bank.
+     */
+    LookupTableBank4 tables4PLP;
+    LookupTableBank4 tablesOther;
 };
 
 inline EdgeTables::EdgeTables()
 {
 
     for (int is4PLP = 0; is4PLP <= 1; ++is4PLP) {
-        for (int stage = 0; stage < 4; ++stage) {
-            LookupTableParams<float>* tables = (is4PLP) ? tables4PLP : tablesOther;
-          
-            LookupTable<float>::init(tables[stage], 20, 0, 1, [stage, is4PLP](double rawEdge) {
-                float localStageGains[4];
-                float k;
-                if (rawEdge > .5) {
-                    k = is4PLP ? .2f : .5f;
-                } else {
-                    k = is4PLP ? .6f : .8f;
-                }
-
-                const float edgeToUse = float(k + rawEdge * (1 - k) / .5f);
-                AudioMath::distributeEvenly(localStageGains, 4, edgeToUse);
-                return localStageGains[stage];
-                });
-        }
+        LookupTableBank4& tables = (is4PLP) ? tables4PLP : tablesOther;
+        tables.init(20, 0, 1, [is4PLP](double rawEdge, int stage) {
+            float localStageGains[4];
+            float k;
+            if (rawEdge > .5) {
+                k = is4PLP ? .2f : .5f;
+            } else {
+                k = is4PLP ? .6f : .8f;
+            }
+
+            const float edgeToUse = float(k + rawEdge * (1 - k) / .5f);
+            AudioMath::distributeEvenly(localStageGains, 4, edgeToUse);
+            return localStageGains[stage];
+            });
     }
 
 }
 
 inline void EdgeTables::lookup(bool is4PLP, float edge, float* gains)
 {
-    const LookupTableParams<float> * tables = (is4PLP) ? tables4PLP : tablesOther;
-    for (int i = 0; i < 4; ++i) {
-        float x = LookupTable<float>::lookup(tables[i], edge, false);
-        gains[i] = x;
-    }
+    const LookupTableBank4& tables = (is4PLP) ? tables4PLP : tablesOther;
+    assert((reinterpret_cast<uintptr_t>(gains) & 15) == 0);
+    _mm_store_ps(gains, tables.lookup(edge).v);
 }
 
 /**
- * Moog-ish ladder filter, but lots of options
+ * The parts of LadderFilter that don't depend on the sample type.
+ * Shared by the scalar filter and the SIMD one.
  */
-template <typename T>
-class LadderFilter
+class LadderFilterBase
 {
 public:
-    LadderFilter();
     enum class Types
     {
         _4PLP,
@@ -96,9 +100,53 @@ public:
         NUM_VOICINGS
     };
 
+    /**
+     * Picks the instantiation of a function template for a voicing.
+     */
+    using VoicingDispatch = EnumDispatch<Voicing,
+                                         Voicing::Classic,
+                                         Voicing::Clip2,
+                                         Voicing::Fold,
+                                         Voicing::Fold2,
+                                         Voicing::Clean>;
+    static_assert(VoicingDispatch::checkCount(int(Voicing::NUM_VOICINGS)), "VoicingDispatch must list every voicing");
+
+    static std::vector<std::string> getTypeNames();
+    static std::vector<std::string> getVoicingNames();
+
+    /**
+     * Fills in the output mixer gains for each stage, for filter type "type".
+     * returns true if the first stage should be bypassed.
+     */
+    template <typename T>
+    static bool getStageTaps(Types type, T* stageTaps);
+
+    /**
+     * Makes the lookup for maximum feedback (Q compensation) vs. normalized Fc.
+     */
+    template <typename T>
+    static std::shared_ptr<NonUniformLookupTableParams<T>> makeFeedbackAdjustLookup();
+};
+
+/**
+ * Moog-ish ladder filter, but lots of options
+ */
+template <typename T>
+class LadderFilter : public LadderFilterBase
+{
+public:
+    LadderFilter();
     void run(T);
     T getOutput();
 
+    /**
+     * Same as run(T), but the voicing is a template parameter.
+     * Lets a caller that runs a lot of filters pick the voicing once,
+     * rather than once for each filter. v must be the voicing last passed to setVoicing.
+     */
+    template <Voicing v>
+    void run(T);
+
     /**
      * input range >0 to < .5
      */
@@ -107,6 +155,10 @@ public:
     void setFeedback(T f);
     void setType(Types);
     void setVoicing(Voicing);
+    Voicing getVoicing() const
+    {
+        return voicing;
+    }
     void setGain(T);
     void setEdge(T);        // 0..1
     void setFreqSpread(T);
@@ -116,9 +168,6 @@ public:
 
     float getLEDValue(int tapNumber) const;
 
-    static std::vector<std::string> getTypeNames();
-    static std::vector<std::string> getVoicingNames();
-
     // Only calibration routines will do this
     void disableQComp()
     {
@@ -157,7 +206,7 @@ private:
     T slope = 3;
     T volume = 0;
 
-    float stageGain[4] = {1, 1, 1, 1};
+    alignas(16) float stageGain[4] = {1, 1, 1, 1};
     T stageFreqOffsets[4] = {1, 1, 1, 1};
 
     Types type = Types::_4PLP;
@@ -176,17 +225,32 @@ private:
     std::shared_ptr<LookupTableParams<T>> expLookup = ObjectCache<T>::getExp2();
 
     static const int oversampleRate = 4;
-    IIRUpsampler up;
+    IIRUpsampler<float> up;
     IIRDecimator<float> down;
 
     AsymWaveShaper shaper;
     T _lastInput = 0;
 
-    void runBufferClassic(float* buffer, int);
-    void runBufferClip2(float* buffer, int);
-    void runBufferFold(float* buffer, int);
-    void runBufferFold2(float* buffer, int);
-    void runBufferClean(float* buffer, int);
+    template <Voicing v>
+    void runBuffer(float* buffer);
+
+    /**
+     * Calls run<v> for the voicing VoicingDispatch picks.
+     */
+    struct Runner
+    {
+        LadderFilter& filter;
+        T input;
+
+        template <class V>
+        void operator()(V)
+        {
+            filter.template run<V::value>(input);
+        }
+    };
+
+    template <Voicing v>
+    T distort(T x, int stage) const;
 
     void updateFilter();
     void updateSlope();
@@ -414,13 +478,9 @@ void LadderFilter<T>::setVoicing(Voicing v)
 }
 
 template <typename T>
-void LadderFilter<T>::setType(Types t)
+inline bool LadderFilterBase::getStageTaps(Types type, T* stageTaps)
 {
-    if (t == type)
-        return;
-
-    bypassFirstStage = false;
-    type = t;
+    bool bypassFirstStage = false;
     switch (type) {
         case Types::_4PLP:
             stageTaps[3] = 1;
@@ -520,6 +580,17 @@ void LadderFilter<T>::setType(Types t)
         default:
             assert(false);
     }
+    return bypassFirstStage;
+}
+
+template <typename T>
+void LadderFilter<T>::setType(Types t)
+{
+    if (t == type)
+        return;
+
+    type = t;
+    bypassFirstStage = getStageTaps(type, stageTaps);
     updateFilter();
     updateSlope();
     updateStageGains();         // many filter types turn off the edge
@@ -598,113 +669,77 @@ inline void LadderFilter<T>::updateFeedback()
 template <typename T>
 inline void LadderFilter<T>::run(T input)
 {
+    VoicingDispatch::call(voicing, Runner{*this, input});
+}
+
+template <typename T>
+template <LadderFilterBase::Voicing v>
+inline void LadderFilter<T>::run(T input)
+{
+    assert(v == voicing);
     _lastInput = input;
     input *= gain;
     float buffer[oversampleRate];
     up.process(buffer, (float) input);
+    runBuffer<v>(buffer);
+    mixedOutput = down.process(buffer) * finalVolume;
+}
 
-    switch (voicing) {
+/**
+ * The distortion in front of each filter stage.
+ * v and stage are constants after inlining, so the switches go away.
+ */
+template <typename T>
+template <LadderFilterBase::Voicing v>
+inline T LadderFilter<T>::distort(T x, int stage) const
+{
+    switch (v) {
         case Voicing::Classic:
-            runBufferClassic(buffer, oversampleRate);
-            break;
+            return T(2) * LookupTable<T>::lookup(*tanhLookup.get(), T(.5) * x, true);
         case Voicing::Clip2:
-            runBufferClip2(buffer, oversampleRate);
-            break;
+            return (stage & 1) ? std::max<T>(x, -1.f) : std::min<T>(x, 1.f);
         case Voicing::Fold:
-            runBufferFold(buffer, oversampleRate);
-            break;
+            return (stage == 0) ? AudioMath::fold(float(x) * .5f) : AudioMath::fold(float(x));
         case Voicing::Fold2:
-            runBufferFold2(buffer, oversampleRate);
-            break;
+            if (stage & 1) {
+                return (x < 0) ? (T) AudioMath::fold(float(x)) : x;
+            } else {
+                return (x > 0) ? (T) AudioMath::fold(float(x)) : x;
+            }
         case Voicing::Clean:
-            runBufferClean(buffer, oversampleRate);
-            break;
         default:
-            assert(false);
+            return x;
     }
-    mixedOutput = down.process(buffer) * finalVolume;
 }
 
-/**************************************************************************************
- *
- * A set of macros for (ugh) building up process functions for different distortion functions
- */
-#define PROC_PREAMBLE(name) template <typename T> \
-    inline void  LadderFilter<T>::name(float* buffer, int numSamples) { \
-        for (int i = 0; i < numSamples; ++i) { \
-            const T input = buffer[i]; \
-            T temp = input - adjustedFeedback * stageOutputs[3]; \
-            temp = std::max(T(-3), temp); \
-            temp = std::min(T(3), temp);
-
-#define PROC_END \
-        temp = 0; \
-        for (int i = 0; i < 4; ++i) { \
-            temp += stageOutputs[i] * stageTaps[i]; \
-        } \
-        temp = std::max(T(-1.7), temp); \
-        temp = std::min(T(1.7), temp); \
-        buffer[i] = float(temp); \
-     } \
-}
-
-#define ONETAP(func, index) \
-    temp *= stageGain[index]; \
-    func(); \
-    temp = lpfs[index].run(temp, stageG[index]); \
-    stageOutputs[index] = temp;
-
-#define BODY( func0, func1, func2, func3) \
-    ONETAP(func0, 0) \
-    ONETAP(func1, 1) \
-    ONETAP(func2, 2) \
-    ONETAP(func3, 3)
-
-#define TANH() temp = T(2) * LookupTable<T>::lookup(*tanhLookup.get(), T(.5) * temp, true)
-
-#define CLIP() temp = std::max<T>(temp, -1.f); temp = std::min<T>(temp, 1.f)
-#define CLIP_TOP()  temp = std::min<T>(temp, 1.f)
-#define CLIP_BOTTOM()  temp = std::max<T>(temp, -1.f)
-
-#define FOLD() temp = AudioMath::fold(float(temp))
-#define FOLD_ATTEN() temp = AudioMath::fold(float(temp) * .5f)
-//#define FOLD_ATTEN() temp = AudioMath::fold(float(temp) * 1)
-#define FOLD_BOOST() temp = 2 * AudioMath::fold(float(temp))
-
-#define FOLD_TOP() temp = (temp > 0) ? (T) AudioMath::fold(float(temp)) : temp
-#define FOLD_BOTTOM() temp = (temp < 0) ? (T) AudioMath::fold(float(temp)) : temp
-#define NOPROC()
-
-//#define TRIODE1() temp = T(1.4) * shaper.lookup(float(temp * .4f), 7)
-//#define TRIODE2_ATTEN() temp = T(.1) * shaper.lookup(float(temp), 5)
-//#define TRIODE2() temp = 1.1 * shaper.lookup(float(temp * .4f), 5)
-//#define TRIODE2g() temp = 3 * shaper.lookup(float(temp * .4f), 5)
-//#define TRIODE2b() temp = 1.1 * -shaper.lookup(float(-temp * .4f), 5)
-
-PROC_PREAMBLE(runBufferClassic)
-BODY(TANH, TANH, TANH, TANH)
-PROC_END
-
-PROC_PREAMBLE(runBufferClip2)
-BODY(CLIP_TOP, CLIP_BOTTOM, CLIP_TOP, CLIP_BOTTOM)
-PROC_END
-
-PROC_PREAMBLE(runBufferFold)
-BODY(FOLD_ATTEN, FOLD, FOLD, FOLD)
-PROC_END
-
-PROC_PREAMBLE(runBufferFold2)
-BODY(FOLD_TOP, FOLD_BOTTOM, FOLD_TOP, FOLD_BOTTOM)
-PROC_END
-
-#if 1
-PROC_PREAMBLE(runBufferClean)
-BODY(NOPROC, NOPROC, NOPROC, NOPROC)
-PROC_END
-#endif
-
 template <typename T>
-inline  std::vector<std::string> LadderFilter<T>::getTypeNames()
+template <LadderFilterBase::Voicing v>
+inline void LadderFilter<T>::runBuffer(float* buffer)
+{
+    for (int i = 0; i < oversampleRate; ++i) {
+        const T input = buffer[i];
+        T temp = input - adjustedFeedback * stageOutputs[3];
+        temp = std::max(T(-3), temp);
+        temp = std::min(T(3), temp);
+
+        for (int stage = 0; stage < 4; ++stage) {
+            temp *= stageGain[stage];
+            temp = distort<v>(temp, stage);
+            temp = lpfs[stage].run(temp, stageG[stage]);
+            stageOutputs[stage] = temp;
+        }
+
+        temp = 0;
+        for (int stage = 0; stage < 4; ++stage) {
+            temp += stageOutputs[stage] * stageTaps[stage];
+        }
+        temp = std::max(T(-1.7), temp);
+        temp = std::min(T(1.7), temp);
+        buffer[i] = float(temp);
+    }
+}
+
+inline  std::vector<std::string> LadderFilterBase::getTypeNames()
 {
     return {
         "4P LP",
@@ -725,8 +760,7 @@ inline  std::vector<std::string> LadderFilter<T>::getTypeNames()
     };
 }
 
-template <typename T>
-inline  std::vector<std::string> LadderFilter<T>::getVoicingNames()
+inline  std::vector<std::string> LadderFilterBase::getVoicingNames()
 {
     return {
         "Transistor",
@@ -878,7 +912,7 @@ inline T LadderFilter<T>::processFeedback(T fcNorm, T feedback) const
 
 
 template <typename T>
-void LadderFilter<T>::initQLookup()
+inline std::shared_ptr<NonUniformLookupTableParams<T>> LadderFilterBase::makeFeedbackAdjustLookup()
 {
     std::shared_ptr<NonUniformLookupTableParams<T>> ret =
         std::make_shared<NonUniformLookupTableParams<T>>();
@@ -900,7 +934,13 @@ void LadderFilter<T>::initQLookup()
     NonUniformLookupTable<T>::addPoint(*ret, T(0.498866), T(2.390137));
     
     NonUniformLookupTable<T>::finalize(*ret);
-    feedbackAdjust = ret;
+    return ret;
+}
+
+template <typename T>
+void LadderFilter<T>::initQLookup()
+{
+    feedbackAdjust = makeFeedbackAdjustLookup<T>();
 }
 #if 0 // gain=40 = too much
 template <typename T>
@@ -0,0 +1,379 @@
+#pragma once
+
+#include "LadderFilter.h"
+#include "SimdBlocks.h"
+#include "SimdLookupTable.h"
+
+/**
+ * SIMD version of the ladder filter. Runs four independent
+ * filters, one in each lane of a float_4.
+ *
+ * Per-channel settings (Fc, Q, drive, edge, slope, bass) take a float_4.
+ * Type, voicing, spread and volume come from panel knobs, so they
+ * are shared by all four lanes.
+ */
+template <>
+class LadderFilter<float_4> : public LadderFilterBase
+{
+public:
+    using T = float_4;
+
+    LadderFilter();
+    void run(T);
+    T getOutput() const;
+
+    /**
+     * Same as run(T), with the voicing picked by the caller.
+     * v must be the voicing last passed to setVoicing.
+     */
+    template <Voicing v>
+    void run(T);
+
+    /**
+     * input range >0 to < .5
+     */
+    void setNormalizedFc(T);
+
+    void setFeedback(T f);
+    void setType(Types);
+    void setVoicing(Voicing);
+    Voicing getVoicing() const
+    {
+        return voicing;
+    }
+    void setGain(T);
+    void setEdge(T);        // 0..1
+    void setFreqSpread(float);
+    void setBassMakeupGain(T);
+    void setSlope(T);       // 0..3. only works in 4 pole
+    void setVolume(float vol);  // 0..1
+
+    /**
+     * Reports the taps for the filter in lane 0
+     */
+    float getLEDValue(int tapNumber) const;
+
+    // Only calibration routines will do this
+    void disableQComp()
+    {
+        _disableQComp = true;
+    }
+
+    void _dump(const std::string&);
+
+private:
+    TrapezoidalLowpass<T> lpfs[4];
+    EdgeTables edgeLookup;
+
+    T _g = T(.001f);
+    T stageG[4] = {T(.001f), T(.001f), T(.001f), T(.001f)};
+    T stageTaps[4] = {T(0), T(0), T(0), T(1)};
+    T stageGain[4] = {T(1), T(1), T(1), T(1)};
+    T stageOutputs[4] = {T(0), T(0), T(0), T(0)};
+    float stageFreqOffsets[4] = {1, 1, 1, 1};
+
+    T bassMakeupGain = T(1);
+    T mixedOutput = T(0);
+    T requestedFeedback = T(0);
+    T adjustedFeedback = T(0);
+    T gain = T(.3f);
+    T rawEdge = T(.5f);         // matches the initial stageGain
+    T slope = T(3);
+    T lastNormalizedFc = T(.0001f);
+    float freqSpread = 0;
+    float lastVolume = -1;
+    T finalVolume = T(1);
+
+    Types type = Types::_4PLP;
+    Voicing voicing = Voicing::Classic;
+    bool bypassFirstStage = false;
+    bool _disableQComp = false;
+
+    std::shared_ptr<NonUniformLookupTableParams<float>> fs2gLookup = makeTrapFilter_Lookup<float>();
+    std::shared_ptr<NonUniformLookupTableParams<float>> feedbackAdjust = makeFeedbackAdjustLookup<float>();
+    std::shared_ptr<LookupTableParams<float>> tanhLookup = ObjectCache<float>::getTanh5();
+
+    static const int oversampleRate = 4;
+    IIRUpsampler<T> up;
+    IIRDecimator<T> down;
+
+    template <Voicing v>
+    void runBuffer(T* buffer);
+
+    /**
+     * Calls run<v> for the voicing VoicingDispatch picks.
+     */
+    struct Runner
+    {
+        LadderFilter& filter;
+        T input;
+
+        template <class V>
+        void operator()(V)
+        {
+            filter.template run<V::value>(input);
+        }
+    };
+
+    template <Voicing v>
+    T distort(T x, int stage) const;
+
+    void updateFilter();
+    void updateSlope();
+    void updateFeedback();
+    void updateStageGains();
+
+    static bool allEqual(T a, T b)
+    {
+        return rack::simd::movemask(a == b) == 0xf;
+    }
+};
+
+inline LadderFilter<float_4>::LadderFilter()
+{
+    // fix at 4X oversample
+    up.setup(oversampleRate);
+    down.setup(oversampleRate);
+}
+
+inline void LadderFilter<float_4>::_dump(const std::string& s)
+{
+#if 0
+    printf("\ndump %s\n", s.c_str());
+    printf("filt:_g=%f bypassFirst=%d\n", _g[0], bypassFirstStage);
+    for (int i = 0; i < 4; ++i) {
+        printf("stage[%d] tap=%.2f, gain=%.2f freqoff=%.2f filter_G %f\n", i,
+            stageTaps[i][0],
+            stageGain[i][0],
+            stageFreqOffsets[i],
+            stageG[i][0]);
+    }
+    fflush(stdout);
+#endif
+}
+
+inline float LadderFilter<float_4>::getLEDValue(int tapNumber) const
+{
+    return (type == Types::_4PLP) ? stageTaps[tapNumber][0] : 0;
+}
+
+inline void LadderFilter<float_4>::setType(Types t)
+{
+    if (t == type) {
+        return;
+    }
+
+    type = t;
+    float taps[4];
+    bypassFirstStage = getStageTaps(type, taps);
+    for (int i = 0; i < 4; ++i) {
+        stageTaps[i] = T(taps[i]);
+    }
+    updateFilter();
+    updateSlope();
+    updateStageGains();         // many filter types turn off the edge
+}
+
+inline void LadderFilter<float_4>::setVoicing(Voicing v)
+{
+    if (v == voicing) {
+        return;
+    }
+    voicing = v;
+}
+
+inline void LadderFilter<float_4>::setSlope(T _slope)
+{
+    slope = rack::simd::clamp(_slope, T(0), T(3));
+    updateSlope();
+}
+
+/**
+ * Same taps as the scalar version, but without the branches:
+ * each tap is a triangle centered on its own stage number.
+ */
+inline void LadderFilter<float_4>::updateSlope()
+{
+    if (type != Types::_4PLP) {
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        const T distance = rack::simd::fabs(slope - T(float(i)));
+        stageTaps[i] = rack::simd::fmax(T(0), T(1) - distance);
+    }
+}
+
+inline void LadderFilter<float_4>::setVolume(float vol)
+{
+    if (lastVolume == vol) {
+        return;
+    }
+    lastVolume = vol;
+    finalVolume = T(4 * vol * vol);
+}
+
+inline void LadderFilter<float_4>::setNormalizedFc(T input)
+{
+    if (allEqual(input, lastNormalizedFc)) {
+        return;
+    }
+
+    lastNormalizedFc = input;
+    _g = SimdLookupTable::lookup4(*fs2gLookup, input * T(1.f / oversampleRate));
+    updateFilter();
+    updateFeedback();
+}
+
+inline void LadderFilter<float_4>::setBassMakeupGain(T g)
+{
+    bassMakeupGain = g;
+}
+
+inline void LadderFilter<float_4>::setGain(T g)
+{
+    gain = g;
+}
+
+inline void LadderFilter<float_4>::setFreqSpread(float s)
+{
+    if (s == freqSpread) {
+        return;
+    }
+    freqSpread = s;
+
+    s *= .5;        // cut it down
+    assert(s <= 1 && s >= 0);
+
+    float s2 = s + 1;       // 1..2
+    AudioMath::distributeEvenly(stageFreqOffsets, 4, s2);
+
+    updateFilter();
+}
+
+inline void LadderFilter<float_4>::updateFilter()
+{
+    for (int i = 0; i < 4; ++i) {
+        stageG[i] = _g * T(stageFreqOffsets[i]);
+    }
+
+    if (bypassFirstStage) {
+        const float g = NonUniformLookupTable<float>::lookup(*fs2gLookup, .9f / oversampleRate);
+        stageG[0] = T(g);
+    }
+}
+
+inline void LadderFilter<float_4>::setEdge(T e)
+{
+    if (allEqual(e, rawEdge)) {
+        return;
+    }
+    rawEdge = e;
+    updateStageGains();
+}
+
+/**
+ * The edge tables are per channel, so we look up each lane
+ * and transpose the results into our per-stage gains.
+ */
+inline void LadderFilter<float_4>::updateStageGains()
+{
+    const bool is4PLP = (type == Types::_4PLP);
+    for (int lane = 0; lane < 4; ++lane) {
+        float gains[4];
+        edgeLookup.lookup(is4PLP, rawEdge[lane], gains);
+        for (int stage = 0; stage < 4; ++stage) {
+            stageGain[stage][lane] = gains[stage];
+        }
+    }
+}
+
+inline void LadderFilter<float_4>::setFeedback(T f)
+{
+    if (allEqual(f, requestedFeedback)) {
+        return;
+    }
+    requestedFeedback = f;
+    updateFeedback();
+}
+
+inline void LadderFilter<float_4>::updateFeedback()
+{
+    if (!_disableQComp) {
+        const T x = requestedFeedback * T(.25f);      // range 0..1
+        const T y = x * (T(2) - x);                   // still 0..1, but now a smooshed parabola
+        const T maxFeedback = SimdLookupTable::lookup4(*feedbackAdjust, lastNormalizedFc);
+        adjustedFeedback = y * maxFeedback;
+    } else {
+        adjustedFeedback = requestedFeedback;
+    }
+}
+
+inline float_4 LadderFilter<float_4>::getOutput() const
+{
+    return mixedOutput * T(5) * bassMakeupGain;
+}
+
+inline void LadderFilter<float_4>::run(T input)
+{
+    VoicingDispatch::call(voicing, Runner{*this, input});
+}
+
+template <LadderFilterBase::Voicing v>
+inline void LadderFilter<float_4>::run(T input)
+{
+    assert(v == voicing);
+    input = input * gain;
+    T buffer[oversampleRate];
+    up.process(buffer, input);
+    runBuffer<v>(buffer);
+    mixedOutput = down.process(buffer) * finalVolume;
+}
+
+/**
+ * The distortion applied in front of each stage.
+ * v and stage are constants after inlining, so the switches go away.
+ */
+template <LadderFilterBase::Voicing v>
+inline float_4 LadderFilter<float_4>::distort(T x, int stage) const
+{
+    switch (v) {
+        case Voicing::Classic:
+            return T(2) * SimdLookupTable::lookup4(*tanhLookup, T(.5f) * x);
+        case Voicing::Clip2:
+            return (stage & 1) ? rack::simd::fmax(x, T(-1)) : rack::simd::fmin(x, T(1));
+        case Voicing::Fold:
+            return SimdBlocks::fold((stage == 0) ? x * T(.5f) : x);
+        case Voicing::Fold2:
+            {
+                const T folded = SimdBlocks::fold(x);
+                return (stage & 1) ?
+                    SimdBlocks::ifelse(x < T(0), folded, x) :
+                    SimdBlocks::ifelse(x > T(0), folded, x);
+            }
+        case Voicing::Clean:
+        default:
+            return x;
+    }
+}
+
+template <LadderFilterBase::Voicing v>
+inline void LadderFilter<float_4>::runBuffer(T* buffer)
+{
+    for (int i = 0; i < oversampleRate; ++i) {
+        T temp = buffer[i] - adjustedFeedback * stageOutputs[3];
+        temp = rack::simd::clamp(temp, T(-3), T(3));
+
+        for (int stage = 0; stage < 4; ++stage) {
+            temp = temp * stageGain[stage];
+            temp = distort<v>(temp, stage);
+            temp = lpfs[stage].run(temp, stageG[stage]);
+            stageOutputs[stage] = temp;
+        }
+
+        temp = T(0);
+        for (int stage = 0; stage < 4; ++stage) {
+            temp += stageOutputs[stage] * stageTaps[stage];
+        }
+        buffer[i] = rack::simd::clamp(temp, T(-1.7f), T(1.7f));
+    }
+}
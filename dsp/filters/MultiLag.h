@@ -56,6 +56,14 @@ public:
         return memory[index];
     }
 
+    /**
+     * all N outputs
+     */
+    const float* get() const
+    {
+        return memory;
+    }
+
 private:
     float memory[N] = {0};
 
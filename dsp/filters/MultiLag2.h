@@ -5,49 +5,59 @@
 #include "LookupTable.h"
 #include "LowpassFilter.h"
 #include "SimdBlocks.h"
+#include "float_8.h"
 #include "simd.h"
 
 /**
  * MultiLag2 is based on MultiLag, but uses VCV SIMD library
+ *
+ * T is the lane type, float_4 or float_8.
+ * MultiLPF2 and MultiLag2 are the usual float_4 ones.
  */
-class MultiLPF2 {
+template <typename T>
+class MultiLPF2T {
 public:
-    float_4 get() const { return memory; }
-    void step(float_4 input);
+    T get() const { return memory; }
+    void step(T input);
 
     /**
      * set cutoff, normalized freq
      */
     void setCutoff(float);
-    void setCutoffPoly(float_4);
+    void setCutoffPoly(T);
 
 private:
-    float_4 l = 0;
-    float_4 k = 0;
-    float_4 memory = 0;
+    T l = 0;
+    T k = 0;
+    T memory = 0;
     std::shared_ptr<NonUniformLookupTableParams<float>> lookup = makeLPFilterL_Lookup<float>();
 };
 
+using MultiLPF2 = MultiLPF2T<float_4>;
+
 /**
  * z = _z * _l + _k * x;
  */
-inline void MultiLPF2::step(float_4 input) {
-    float_4 temp = input * k;
+template <typename T>
+inline void MultiLPF2T<T>::step(T input) {
+    T temp = input * k;
     memory *= l;
     memory += temp;
 }
 
-inline void MultiLPF2::setCutoff(float fs) {
+template <typename T>
+inline void MultiLPF2T<T>::setCutoff(float fs) {
     assert(fs > 00 && fs < .5);
 
     float ls = NonUniformLookupTable<float>::lookup(*lookup, fs);
     float ks = LowpassFilter<float>::computeKfromL(ls);
-    k = float_4(ks);
-    l = float_4(ls);
+    k = T(ks);
+    l = T(ls);
 }
 
-inline void MultiLPF2::setCutoffPoly(float_4 fs) {
-    for (int i = 0; i < 4; ++i) {
+template <typename T>
+inline void MultiLPF2T<T>::setCutoffPoly(T fs) {
+    for (int i = 0; i < T::size; ++i) {
         float ls = NonUniformLookupTable<float>::lookup(*lookup, fs[i]);
         float ks = LowpassFilter<float>::computeKfromL(ls);
         k[i] = ks;
@@ -57,109 +67,122 @@ inline void MultiLPF2::setCutoffPoly(float_4 fs) {
 
 ///////////////////////////////////////////////////////////////////
 
-class MultiLag2 {
+template <typename T>
+class MultiLag2T {
 public:
-    float_4 get() const;
-    void step(float_4 input);
+    T get() const;
+    void step(T input);
 
     /**
      * attack and release specified as normalized frequency (LPF equivalent)
      */
     void setAttack(float);
     void setRelease(float);
-    void setAttackPoly(float_4);
-    void setReleasePoly(float_4);
+    void setAttackPoly(T);
+    void setReleasePoly(T);
 
     void setEnable(bool);
     void setInstantAttack(bool);
-    void setInstantAttackPoly(float_4);
+    void setInstantAttackPoly(T);
 
-    float_4 _memory() const;
+    T _memory() const;
 
 private:
-    float_4 memory = 0;
-    float_4 lAttack = 0;
-    float_4 lRelease = 0;
-    float_4 instant = 0;
+    T memory = 0;
+    T lAttack = 0;
+    T lRelease = 0;
+    T instant = 0;
 
     std::shared_ptr<NonUniformLookupTableParams<float>> lookup = makeLPFilterL_Lookup<float>();
     bool enabled = true;
 };
 
-inline void MultiLag2::setInstantAttack(bool b) {
+using MultiLag2 = MultiLag2T<float_4>;
+
+template <typename T>
+inline void MultiLag2T<T>::setInstantAttack(bool b) {
     // tortured way to may a simd boolean mask - make this a function!
     if (!b) {
         instant = 0;
     } else {
-        instant = (float_4(1) > float_4(0));
+        instant = (T(1) > T(0));
     }
     simd_assertMask(instant);
 }
 
-inline void MultiLag2::setInstantAttackPoly(float_4 inst) {
+template <typename T>
+inline void MultiLag2T<T>::setInstantAttackPoly(T inst) {
     instant = inst;
     simd_assertMask(instant);
  }
 
-inline void MultiLag2::setEnable(bool b) {
+template <typename T>
+inline void MultiLag2T<T>::setEnable(bool b) {
     enabled = b;
 }
 
-inline float_4 MultiLag2::_memory() const {
+template <typename T>
+inline T MultiLag2T<T>::_memory() const {
     return memory;
 }
 /**
  * z = _z * _l + _k * x;
  */
-inline void MultiLag2::step(float_4 input) {
+template <typename T>
+inline void MultiLag2T<T>::step(T input) {
     //  printf("--step, input = %s\n", toStr(input).c_str());
     if (!enabled) {
         memory = input;
         return;
     }
 
-    const float_4 isAttack = input >= memory;
-    float_4 l = SimdBlocks::ifelse(isAttack, lAttack, lRelease);
-    float_4 k = float_4(1) - l;
+    const T isAttack = input >= memory;
+    T l = SimdBlocks::ifelse(isAttack, lAttack, lRelease);
+    T k = T(1) - l;
     //  printf("l=%s k=%s\n", toStr(l).c_str(), toStr(k).c_str());
-    float_4 temp = input * k;
-    float_4 laggedMemory = temp + memory * l;
+    T temp = input * k;
+    T laggedMemory = temp + memory * l;
     // memory *= l;
     //  memory += temp;
-    const float_4 isInstantAttack = isAttack & instant;
+    const T isInstantAttack = isAttack & instant;
     //   printf("in step. isInsta = %s isAtt = %s\n", toStr(isInstantAttack).c_str(), toStr(isAttack).c_str());
     memory = SimdBlocks::ifelse(isInstantAttack, input, laggedMemory);
     //   printf("lagged mem = %s, final mem = %s\n", toStr(laggedMemory).c_str(), toStr(memory).c_str());
 }
 
-inline float_4 MultiLag2::get() const {
+template <typename T>
+inline T MultiLag2T<T>::get() const {
     return memory;
 }
 
-inline void MultiLag2::setAttack(float fs) {
+template <typename T>
+inline void MultiLag2T<T>::setAttack(float fs) {
     assert(fs > 00 && fs < .5);
     float ls = LowpassFilter<float>::computeLfromFs(fs);
-    lAttack = float_4(ls);
+    lAttack = T(ls);
 }
 
-inline void MultiLag2::setAttackPoly(float_4 a) {
+template <typename T>
+inline void MultiLag2T<T>::setAttackPoly(T a) {
     // assert(fs > 00 && fs < .5);
-    for (int i = 0; i < 4; ++i) {
+    for (int i = 0; i < T::size; ++i) {
         float ls = LowpassFilter<float>::computeLfromFs(a[i]);
         lAttack[i] = ls;
     }
 }
 
-inline void MultiLag2::setRelease(float fs) {
+template <typename T>
+inline void MultiLag2T<T>::setRelease(float fs) {
     assert(fs > 00 && fs < .5);
     //float ls = NonUniformLookupTable<float>::lookup(*lookup, fs);
     float ls = LowpassFilter<float>::computeLfromFs(fs);
-    lRelease = float_4(ls);
+    lRelease = T(ls);
 }
 
-inline void MultiLag2::setReleasePoly(float_4 r) {
+template <typename T>
+inline void MultiLag2T<T>::setReleasePoly(T r) {
     // assert(fs > 00 && fs < .5);
-    for (int i = 0; i < 4; ++i) {
+    for (int i = 0; i < T::size; ++i) {
         float ls = LowpassFilter<float>::computeLfromFs(r[i]);
         lRelease[i] = ls;
     }
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "simd.h"
+#include "asserts.h"
+
+#include <cstring>
+
+/**
+ * Eight floats, used the same way as float_4: arithmetic, compares that
+ * return masks, operator[], load and store.
+ * Code written for float_4 can be made a template on the lane type
+ * and then run eight channels at a time.
+ *
+ * With gcc and clang it is built on the compiler's vector extensions, not on AVX intrinsics.
+ * That way it compiles for any target, and needs no special build flags.
+ * Inside a function marked SQ_TARGET_AVX (see SimdDispatch.h) each operation
+ * is one AVX instruction. Outside of one it still works, but it is slow
+ * (gcc does the compares one lane at a time), so the SSE fallback
+ * for float_8 code is the same template run on float_4.
+ *
+ * It only asks for 16 byte alignment, because C++11 operator new
+ * (which allocates our modules) does not promise 32.
+ *
+ * MS tools do not have vector extensions, so there it is a pair of float_4.
+ * That is plenty for the unit tests.
+ */
+#if defined(_MSC_VER)
+
+class float_8 {
+public:
+    static constexpr int size = 8;
+
+    float_8() = default;
+    float_8(float x) : lo_(x), hi_(x) {}
+    float_8(float_4 lo, float_4 hi) : lo_(lo), hi_(hi) {}
+
+    float_4 lo() const { return lo_; }
+    float_4 hi() const { return hi_; }
+
+    float& operator[](int i) { return (i < 4) ? lo_[i] : hi_[i - 4]; }
+    float operator[](int i) const { return (i < 4) ? lo_[i] : hi_[i - 4]; }
+
+    static float_8 zero() { return float_8(float_4::zero(), float_4::zero()); }
+    static float_8 mask() { return float_8(float_4::mask(), float_4::mask()); }
+    static float_8 load(const float* x) { return float_8(float_4::load(x), float_4::load(x + 4)); }
+    void store(float* x) {
+        lo_.store(x);
+        hi_.store(x + 4);
+    }
+
+private:
+    float_4 lo_;
+    float_4 hi_;
+};
+
+#define SQ_FLOAT_8_OP(op)                                             \
+    inline float_8 operator op(float_8 a, float_8 b) {                \
+        return float_8(a.lo() op b.lo(), a.hi() op b.hi());           \
+    }                                                                 \
+    inline float_8& operator op##=(float_8& a, float_8 b) {           \
+        a = a op b;                                                   \
+        return a;                                                     \
+    }
+
+#define SQ_FLOAT_8_CMP(op)                                            \
+    inline float_8 operator op(float_8 a, float_8 b) {                \
+        return float_8(a.lo() op b.lo(), a.hi() op b.hi());           \
+    }
+
+inline float_8 operator~(float_8 a) {
+    return float_8(~a.lo(), ~a.hi());
+}
+
+#else
+
+class float_8 {
+public:
+    typedef float Raw __attribute__((vector_size(32), aligned(16)));
+    typedef int32_t RawInt __attribute__((vector_size(32), aligned(16)));
+
+    static constexpr int size = 8;
+
+    float_8() = default;
+    float_8(float x) : v{x, x, x, x, x, x, x, x} {}
+    float_8(float_4 lo, float_4 hi) {
+        lo.store(data());
+        hi.store(data() + 4);
+    }
+
+    float_4 lo() const { return float_4::load(data()); }
+    float_4 hi() const { return float_4::load(data() + 4); }
+
+    // vector types may alias their element type, so this is allowed
+    float& operator[](int i) { return data()[i]; }
+    float operator[](int i) const { return data()[i]; }
+
+    static float_8 zero() { return float_8(0.f); }
+    static float_8 mask() { return fromInt(RawInt{} == RawInt{}); }
+    static float_8 load(const float* x) {
+        float_8 ret;
+        std::memcpy(&ret.v, x, sizeof(Raw));
+        return ret;
+    }
+    void store(float* x) {
+        std::memcpy(x, &v, sizeof(Raw));
+    }
+
+    static float_8 fromRaw(const Raw& x) {
+        float_8 ret;
+        ret.v = x;
+        return ret;
+    }
+    static float_8 fromInt(const RawInt& x) {
+        return fromRaw((Raw)x);
+    }
+    Raw v;
+
+private:
+    float* data() { return reinterpret_cast<float*>(&v); }
+    const float* data() const { return reinterpret_cast<const float*>(&v); }
+};
+
+#define SQ_FLOAT_8_OP(op)                                             \
+    inline float_8 operator op(float_8 a, float_8 b) {                \
+        return float_8::fromRaw(a.v op b.v);                          \
+    }                                                                 \
+    inline float_8& operator op##=(float_8& a, float_8 b) {           \
+        a = a op b;                                                   \
+        return a;                                                     \
+    }
+
+// vector compares give all ones or all zeros per lane, same as float_4
+#define SQ_FLOAT_8_CMP(op)                                            \
+    inline float_8 operator op(float_8 a, float_8 b) {                \
+        return float_8::fromInt(a.v op b.v);                          \
+    }
+
+inline float_8 operator&(float_8 a, float_8 b) {
+    return float_8::fromInt((float_8::RawInt)a.v & (float_8::RawInt)b.v);
+}
+inline float_8 operator|(float_8 a, float_8 b) {
+    return float_8::fromInt((float_8::RawInt)a.v | (float_8::RawInt)b.v);
+}
+inline float_8 operator^(float_8 a, float_8 b) {
+    return float_8::fromInt((float_8::RawInt)a.v ^ (float_8::RawInt)b.v);
+}
+inline float_8 operator~(float_8 a) {
+    return float_8::fromInt(~(float_8::RawInt)a.v);
+}
+
+#endif
+
+SQ_FLOAT_8_OP(+)
+SQ_FLOAT_8_OP(-)
+SQ_FLOAT_8_OP(*)
+SQ_FLOAT_8_OP(/)
+#if defined(_MSC_VER)
+SQ_FLOAT_8_OP(&)
+SQ_FLOAT_8_OP(|)
+SQ_FLOAT_8_OP(^)
+#endif
+
+SQ_FLOAT_8_CMP(==)
+SQ_FLOAT_8_CMP(!=)
+SQ_FLOAT_8_CMP(<)
+SQ_FLOAT_8_CMP(<=)
+SQ_FLOAT_8_CMP(>)
+SQ_FLOAT_8_CMP(>=)
+
+#undef SQ_FLOAT_8_OP
+#undef SQ_FLOAT_8_CMP
+
+inline float_8 operator-(float_8 a) {
+    return float_8(0.f) - a;
+}
+
+inline bool isMask(float_8 m) {
+    return isMask(m.lo()) && isMask(m.hi());
+}
+
+#ifndef NDEBUG
+inline void printBadMask(float_8 m) {
+    printBadMask(m.lo());
+    printBadMask(m.hi());
+}
+#endif
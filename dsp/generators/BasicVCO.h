@@ -4,11 +4,12 @@
 #include "SimdBlocks.h"
 #include "engine/Port.hpp"
 #include "dsp/approx.hpp"
-#include "dsp/minblep.hpp"
 #include "simd/vector.hpp"
 #include "simd/functions.hpp"
 
+#include "BandLimitedWaveTable.h"
 #include "ObjectCache.h"
+#include "SqMinBlep.h"
 #include "simd.h"
 
 #define _VCOJUMP
@@ -33,10 +34,16 @@ public:
 
   //  using  processFunction = float_4 (BasicVCO:: *)(float deltaTime);
     using  processFunction = float_4 (BasicVCO::*)(float deltaTime);
-    processFunction getProcPointer(Waveform);
+
+    /**
+     * eco selects the wavetable versions of saw, square, even, and tri clean.
+     * They alias a little less than the minBLEP ones, and use less CPU.
+     * The other waveforms are the same either way.
+     */
+    processFunction getProcPointer(Waveform, bool eco = false);
 
 private:
-    using MinBlep = rack::dsp::MinBlepGenerator<16, 16, float_4>; 
+    using MinBlep = SqMinBlep<16, 16, float_4>;
     MinBlep minBlep;
     float_4 phase = {};
     float_4 freq = {};
@@ -46,6 +53,8 @@ private:
     float_4 currentPulseWidth = 0.5f;
     float_4 nextPulseWidth = .5f;
     float_4 triIntegrator = {};
+    int32_4 tableLevel = {};
+    int32_4 tableLevel2x = {};      // for the double saw in even
   //  float_4 lastPitch = {-100};
 
     /**
@@ -53,6 +62,8 @@ private:
     * Destructor will free them automatically.
     */
     std::shared_ptr<LookupTableParams<float>> sinLookup = {ObjectCache<float>::getSinLookup()};
+    std::shared_ptr<const BandLimitedWaveTable> sawTable = {ObjectCache<float>::getSawWaveTable()};
+    std::shared_ptr<const BandLimitedWaveTable> triTable = {ObjectCache<float>::getTriangleWaveTable()};
 
     float_4 processSaw(float deltaTime);
     float_4 processSin(float deltaTime);
@@ -62,6 +73,11 @@ private:
     float_4 processSinClean(float deltaTime);
     float_4 processTriClean(float deltaTime);
 
+    float_4 processSawEco(float deltaTime);
+    float_4 processPulseEco(float deltaTime);
+    float_4 processEvenEco(float deltaTime);
+    float_4 processTriCleanEco(float deltaTime);
+
     void doSquareLowToHighMinblep(float_4 samplePoint, float_4 crossingThreshold, float_4 deltaPhase);
     void doSquareHighToLowMinblep(float_4 samplePoint, float_4 crossingThreshold, float_4 deltaPhase);
 };
@@ -84,10 +100,28 @@ inline void BasicVCO::setPitch(float_4 pitch, float sampleTime, float sampleRate
     const float sawCorrect = -5.698f;
     const float_4 normalizedFreq = float_4(sampleTime) * freq;
     sawOffsetDCComp = normalizedFreq * float_4(sawCorrect);
+
+    tableLevel = BandLimitedWaveTable::getLevel(normalizedFreq);
+    tableLevel2x = BandLimitedWaveTable::getLevel(normalizedFreq * 2);
 }
 
-inline  BasicVCO::processFunction BasicVCO::getProcPointer(Waveform wf)
+inline  BasicVCO::processFunction BasicVCO::getProcPointer(Waveform wf, bool eco)
 {
+    if (eco) {
+        switch(wf) {
+            case Waveform::SAW:
+                return &BasicVCO::processSawEco;
+            case Waveform::SQUARE:
+                return &BasicVCO::processPulseEco;
+            case Waveform::EVEN:
+                return &BasicVCO::processEvenEco;
+            case Waveform::TRI_CLEAN:
+                return &BasicVCO::processTriCleanEco;
+            default:
+                break;
+        }
+    }
+
     BasicVCO::processFunction ret = &BasicVCO::processSaw;
     switch(wf) {
         case Waveform::SIN:
@@ -161,54 +195,22 @@ private:
 inline void BasicVCO::doSquareLowToHighMinblep(float_4 phase, float_4 crossingThreshold, float_4 deltaPhase)
 {
     const float_4 syncDirection = 1.f;
-    const int channels = 4;
 
+    // all the lanes that cross go into the minBLEP together
     float_4 pulseCrossing = (crossingThreshold + deltaPhase - phase) / deltaPhase;
-	int pulseMask = rack::simd::movemask((0 < pulseCrossing) & (pulseCrossing <= 1.f));
-	if (pulseMask) {
-		for (int i = 0; i < channels; i++) {
-			if (pulseMask & (1 << i)) {
-				float_4 highToLowMask = rack::simd::movemaskInverse<float_4>(1 << i);
-				const float_4 mainHighToLowMask = highToLowMask;
-				float p = pulseCrossing[i] - 1.f;
-				float_4 x = mainHighToLowMask & (2.f * syncDirection);
-				minBlep.insertDiscontinuity(p, x);
-#if 0
-                if (i == 0) {
-                    printf("doSquareLowToHighMinblep th=%f pulseCross = %f\n", 
-                        crossingThreshold[0], 
-                        pulseCrossing[0]);
-                    printf("phase = %f, deltaPhase = %f\n", phase[0], deltaPhase[0]);
-                }
-               // minb1.go(p);
-#endif
-			}
-		}
-	}
+    const float_4 crossed = (0 < pulseCrossing) & (pulseCrossing <= 1.f);
+    if (rack::simd::movemask(crossed)) {
+        minBlep.insertDiscontinuities(pulseCrossing - 1.f, crossed & (2.f * syncDirection));
+    }
 }
 
 inline void BasicVCO::doSquareHighToLowMinblep(float_4 phase, float_4 crossingThreshold, float_4 deltaPhase)
 {
-    const int channels = 4;
     const float_4 syncDirection = 1;
     float_4 oneCrossing = (crossingThreshold - (phase - deltaPhase)) / deltaPhase;	
-    int oneCrossMask =  rack::simd::movemask((0 < oneCrossing) & (oneCrossing <= 1.f));
-
-	if (oneCrossMask) {
-		for (int channelNumber = 0; channelNumber < channels; channelNumber++) {
-			if (oneCrossMask & (1 << channelNumber)) {
-				float_4 crossingMask = rack::simd::movemaskInverse<float_4>(1 << channelNumber);
-				float p = oneCrossing[channelNumber] - 1.f;
-				float_4 x =  crossingMask & (-2.f * syncDirection);
-				minBlep.insertDiscontinuity(p, x);
-#if 0
-                if (channelNumber == 0) {
-                    printf("doSquareHighToLowMinblep\n");
-                }
-              //  minb2.go(p);
-#endif
-            }
-        }
+    const float_4 crossed = (0 < oneCrossing) & (oneCrossing <= 1.f);
+    if (rack::simd::movemask(crossed)) {
+        minBlep.insertDiscontinuities(oneCrossing - 1.f, crossed & (-2.f * syncDirection));
     }
 }
 
@@ -344,3 +346,61 @@ inline float_4 BasicVCO::processTri(float deltaTime)
     float_4 temp = 1 - 4 * rack::simd::fmin(rack::simd::fabs(phase - 0.25f), rack::simd::fabs(phase - 1.25f));
     return 5 * temp;
 }
+
+inline float_4 BasicVCO::processSawEco(float deltaTime)
+{
+    const float_4 deltaPhase = freq * deltaTime;
+    phase += deltaPhase;
+    phase -= rack::simd::floor(phase);
+
+    // same phase as the minBLEP saw, which jumps at .5
+    float_4 sawPhase = phase + float_4(.5f);
+    sawPhase -= rack::simd::trunc(sawPhase);
+    return 5 * sawTable->lookup(sawPhase, tableLevel);
+}
+
+inline float_4 BasicVCO::processPulseEco(float deltaTime)
+{
+    const float_4 deltaPhase = freq * deltaTime;
+    phase += deltaPhase;
+
+    currentPulseWidth = SimdBlocks::ifelse( phase >= 1, nextPulseWidth, currentPulseWidth);
+    phase -= rack::simd::floor(phase);
+
+    // the difference of two saws is a pulse. It comes out with no DC, 
+    // so there is no need for pulseOffsetDCComp.
+    float_4 shiftedPhase = phase - currentPulseWidth;
+    shiftedPhase -= rack::simd::floor(shiftedPhase);
+    // a tiny negative phase comes out as exactly one, which is past the end of the table.
+    shiftedPhase = SimdBlocks::ifelse(shiftedPhase >= 1, float_4(0), shiftedPhase);
+    const float_4 pulse = sawTable->lookup(phase, tableLevel) - sawTable->lookup(shiftedPhase, tableLevel);
+    return 5 * .8f * pulse;
+}
+
+inline float_4 BasicVCO::processEvenEco(float deltaTime)
+{
+    const float_4 deltaPhase = freq * deltaTime;
+    phase += deltaPhase;
+    phase -= rack::simd::floor(phase);
+
+    float_4 doublePhase = phase * 2;
+    doublePhase -= rack::simd::floor(doublePhase);
+    const float_4 doubleSaw = sawTable->lookup(doublePhase, tableLevel2x);
+
+    float_4 shiftedSaw = phase + .25;
+    shiftedSaw = SimdBlocks::ifelse( (shiftedSaw > 1) , shiftedSaw -1, shiftedSaw);
+    const float_4 fundamental = sin2pi_pade_05_5_4(shiftedSaw);
+    return float_4(4 * 0.55f * 1.4f) * (doubleSaw + 1.27f * fundamental);
+}
+
+inline float_4 BasicVCO::processTriCleanEco(float deltaTime)
+{
+    const float_4 deltaPhase = freq * deltaTime;
+    phase += deltaPhase;
+    phase -= rack::simd::floor(phase);
+
+    // the integrated square peaks at phase zero
+    float_4 triPhase = phase + float_4(.25f);
+    triPhase -= rack::simd::trunc(triPhase);
+    return 5.0f * 1.25f * triTable->lookup(triPhase, tableLevel);
+}
@@ -23,11 +23,9 @@ namespace std {
 #include "SqMath.h"
 
 #include "dsp/filter.hpp"
-#ifndef _MSC_VER
-#include "dsp/minblep.hpp"
-#endif
 #include "AudioMath.h"
 #include "ObjectCache.h"
+#include "SqMinBlep.h"
 
 #include <functional>
 
@@ -95,7 +93,7 @@ public:
     }
 
 private:
-    using MinBlep = ::rack::dsp::MinBlepGenerator<16, 32>;
+    using MinBlep = SqMinBlep<16, 32>;
 
     float output = 0;
     Waveform waveform = Waveform::Saw;
@@ -0,0 +1,99 @@
+
+#include "MinBlepImpulse.h"
+#include "AudioMath.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <complex>
+
+using Complex = std::complex<double>;
+
+static double sinc(double x)
+{
+    if (x == 0) {
+        return 1;
+    }
+    x *= AudioMath::Pi;
+    return std::sin(x) / x;
+}
+
+static double blackmanHarris(double p)
+{
+    return 0.35875 -
+        0.48829 * std::cos(2 * AudioMath::Pi * p) +
+        0.14128 * std::cos(4 * AudioMath::Pi * p) -
+        0.01168 * std::cos(6 * AudioMath::Pi * p);
+}
+
+/**
+ * Plain DFT in double precision. The inverse does the 1/N.
+ *
+ * We only do this a few times per process, and the float FFT isn't accurate
+ * enough: the rounding noise in the stop band ends up all over the cepstrum,
+ * and the result overshoots more than it should.
+ */
+static std::vector<Complex> dft(const std::vector<Complex>& input, bool inverse)
+{
+    const int n = int(input.size());
+    const double sign = inverse ? 1 : -1;
+    std::vector<Complex> twiddle(n);
+    for (int i = 0; i < n; ++i) {
+        twiddle[i] = std::polar(1.0, sign * 2 * AudioMath::Pi * i / n);
+    }
+
+    std::vector<Complex> ret(n);
+    for (int k = 0; k < n; ++k) {
+        Complex sum = 0;
+        for (int i = 0; i < n; ++i) {
+            sum += input[i] * twiddle[(i * k) % n];
+        }
+        ret[k] = inverse ? sum / double(n) : sum;
+    }
+    return ret;
+}
+
+MinBlepImpulse::MinBlepImpulse(int zeroCrossings, int overSample) :
+    impulse(2 * zeroCrossings * overSample + 1)
+{
+    const int n = 2 * zeroCrossings * overSample;
+    assert(n > 0);
+
+    // windowed sinc with zeroCrossings on each side
+    std::vector<Complex> x(n);
+    for (int i = 0; i < n; ++i) {
+        const double p = double(i) / (n - 1);
+        const double t = -zeroCrossings + 2 * zeroCrossings * p;
+        x[i] = sinc(t) * blackmanHarris(p);
+    }
+
+    // real cepstrum = idft(log(abs(dft(x))))
+    x = dft(x, false);
+    for (Complex& value : x) {
+        // clamp the stop band, like VCV does.
+        value = std::max(std::log(std::abs(value)), -30.0);
+    }
+    x = dft(x, true);
+
+    // fold the cepstrum onto the positive side, to make it minimum phase.
+    for (int i = 1; i < n; ++i) {
+        x[i] = (i < n / 2) ? 2.0 * x[i] : 0.0;
+    }
+    x = dft(x, false);
+    for (Complex& value : x) {
+        value = std::exp(value);
+    }
+    x = dft(x, true);
+
+    // integrate the impulse to get the step, and normalize so it ends at one
+    double total = 0;
+    std::vector<double> step(n);
+    for (int i = 0; i < n; ++i) {
+        total += x[i].real();
+        step[i] = total;
+    }
+    for (int i = 0; i < n; ++i) {
+        impulse[i] = float(step[i] / total);
+    }
+    impulse[n] = 1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * The integrated minimum phase band-limited impulse used by the minBLEP
+ * generators. Same algorithm as minBlepImpulse in VCV's dsp/minblep.
+ *
+ * Making one takes several FFTs, so get them from ObjectCache, where
+ * everyone with the same zeroCrossings and overSample shares one.
+ */
+class MinBlepImpulse
+{
+public:
+    MinBlepImpulse(int zeroCrossings, int overSample);
+
+    /**
+     * Step response, from 0 to 1. There are 2 * zeroCrossings * overSample points,
+     * plus one extra point of 1 on the end so a generator can interpolate
+     * all the way to the last point.
+     */
+    const float* data() const
+    {
+        return impulse.data();
+    }
+
+    int size() const
+    {
+        return int(impulse.size()) - 1;
+    }
+
+private:
+    std::vector<float> impulse;
+};
@@ -35,6 +35,11 @@ public:
      * 0 = C4
      */
     void setPitch(T f, float sampleRate);
+
+    /**
+     * Units are Hz. Frequencies above .47 * sampleRate are silenced.
+     */
+    void setFrequency(T f, float sampleRate);
     T process(T deltaT);
     T get() const {
         return output;
@@ -48,16 +53,16 @@ private:
 template <typename T>
 inline void SinesVCO<T>::setPitch(T pitch, float sampleRate)
 {
-    float highPitchLimit = sampleRate * .47f;
-   
-	freq = dsp::FREQ_C4 * dsp::approxExp2_taylor5(pitch + 30) / 1073741824;
+	setFrequency(dsp::FREQ_C4 * dsp::approxExp2_taylor5(pitch + 30) / 1073741824, sampleRate);
+}
 
-    for (int i=0; i<4; ++i) {
-        if (freq[i] > highPitchLimit) {
-            freq[i] = 0;
-            phase[i] = 0;
-        }
-    }
+template <typename T>
+inline void SinesVCO<T>::setFrequency(T f, float sampleRate)
+{
+    const T highPitchLimit = sampleRate * .47f;
+    const T tooHigh = f > highPitchLimit;
+    freq = SimdBlocks::ifelse(tooHigh, T::zero(), f);
+    phase = SimdBlocks::ifelse(tooHigh, T::zero(), phase);
 }
 
 static float_4 twoPi = 2 * 3.141592653589793238f;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "MinBlepImpulse.h"
+#include "ObjectCache.h"
+#include "SimdBlocks.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <memory>
+
+/**
+ * Drop in replacement for rack::dsp::MinBlepGenerator.
+ *
+ * VCV's generator computes its own impulse (several FFTs) in its constructor,
+ * and keeps its own copy. Our VCOs have a lot of these, so here they all share
+ * one impulse from ObjectCache.
+ *
+ * When T is float_4 there is also insertDiscontinuities, which
+ * adds the edges for all four lanes in one pass through the buffer.
+ *
+ * Z is the number of zero crossings, O is the oversample.
+ */
+template <int Z, int O, typename T = float>
+class SqMinBlep
+{
+public:
+    /**
+     * Places a discontinuity with magnitude x at -1 < p <= 0 relative to the current frame.
+     */
+    void insertDiscontinuity(float p, T x);
+
+    /**
+     * Each lane gets its own p, with the same meaning as above.
+     * Lanes with x == 0, or with p out of range, are left alone.
+     */
+    void insertDiscontinuities(float_4 p, float_4 x);
+
+    T process();
+
+private:
+    static const int bufferSize = 2 * Z;
+    static_assert((bufferSize & (bufferSize - 1)) == 0, "buffer wraps with a mask");
+    static_assert(Z == 16 && (O == 16 || O == 32), "ObjectCache only has minBLEP impulses for 16 zero crossings, oversampled 16 or 32");
+
+    T buf[bufferSize] = {};
+    int pos = 0;
+    std::shared_ptr<const MinBlepImpulse> impulse = {ObjectCache<float>::getMinBlepImpulse(Z, O)};
+};
+
+template <int Z, int O, typename T>
+inline void SqMinBlep<Z, O, T>::insertDiscontinuity(float p, T x)
+{
+    if (!(-1 < p && p <= 0)) {
+        return;
+    }
+    const float* table = impulse->data();
+    const int lastIndex = impulse->size() - 1;
+    for (int j = 0; j < bufferSize; j++) {
+        const float minBlepIndex = (float(j) - p) * O;
+        // with p just above -1 this can round up to the very end of the table
+        const int index = std::min(int(minBlepIndex), lastIndex);
+        const float t = minBlepIndex - index;
+        const float minBlepValue = table[index] + t * (table[index + 1] - table[index]);
+        buf[(pos + j) & (bufferSize - 1)] += x * (minBlepValue - 1.f);
+    }
+}
+
+template <int Z, int O, typename T>
+inline void SqMinBlep<Z, O, T>::insertDiscontinuities(float_4 p, float_4 x)
+{
+    const float_4 active = (p > float_4(-1)) & (p <= float_4(0)) & (x != float_4(0));
+    if (!rack::simd::movemask(active)) {
+        return;
+    }
+
+    // park the unused lanes somewhere safe to read
+    p = SimdBlocks::ifelse(active, p, float_4(0));
+    x = SimdBlocks::ifelse(active, x, float_4(0));
+
+    const float* table = impulse->data();
+    const int32_4 lastIndex = impulse->size() - 1;
+    for (int j = 0; j < bufferSize; j++) {
+        const float_4 minBlepIndex = (float(j) - p) * float(O);
+        int32_4 index = minBlepIndex;
+        index = SimdBlocks::ifelse(index > lastIndex, lastIndex, index);
+        const float_4 t = minBlepIndex - float_4(index);
+
+        const float* p0 = table + index[0];
+        const float* p1 = table + index[1];
+        const float* p2 = table + index[2];
+        const float* p3 = table + index[3];
+        const float_4 y0(p0[0], p1[0], p2[0], p3[0]);
+        const float_4 y1(p0[1], p1[1], p2[1], p3[1]);
+        const float_4 minBlepValue = y0 + t * (y1 - y0);
+        buf[(pos + j) & (bufferSize - 1)] += x * (minBlepValue - 1.f);
+    }
+}
+
+template <int Z, int O, typename T>
+inline T SqMinBlep<Z, O, T>::process()
+{
+    const T v = buf[pos];
+    buf[pos] = T(0);
+    pos = (pos + 1) & (bufferSize - 1);
+    return v;
+}
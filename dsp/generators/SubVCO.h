@@ -9,10 +9,13 @@
 #if 1
 #include "simd.h"
 #include "SimdBlocks.h"
-#include "dsp/minblep.hpp"
 #include "dsp/approx.hpp"
 #include "dsp/filter.hpp"
 
+#include "BandLimitedWaveTable.h"
+#include "ObjectCache.h"
+#include "SqMinBlep.h"
+
 using namespace rack;		// normally I don't like "using", but this is third party code...
 extern bool _logvco;
 
@@ -33,6 +36,14 @@ public:
 	 */
 	void setWaveform(T mainSaw, T subSaw);
 
+	/**
+	 * eco uses band-limited wavetables instead of minBLEP.
+	 * Must call computeOffsetCorrection after changing it.
+	 */
+	void setEco(bool eco) {
+		ecoMode = eco;
+	}
+
 	/**
 	 * Set num channels and all pitches for VCO.
 	 * note that most of the parameters are vectors
@@ -66,7 +77,7 @@ public:
 	 */
 	void computeOffsetCorrection(float sampleTime);
 private:
-	using MinBlep = dsp::MinBlepGenerator<QUALITY, OVERSAMPLE, T>;
+	using MinBlep = SqMinBlep<QUALITY, OVERSAMPLE, T>;
 	MinBlep mainMinBlep;
 	MinBlep subMinBlep[2];
 	T mainValue = 0;
@@ -86,6 +97,12 @@ private:
 	T subDCOffset[2] = {};
 
 	bool syncEnabled = false;
+	bool ecoMode = false;
+
+	// which wavetable to use for each saw, when in eco mode
+	I mainLevel = {};
+	I subLevel[2] = {};
+	std::shared_ptr<const BandLimitedWaveTable> sawTable = {ObjectCache<float>::getSawWaveTable()};
 
 	T lastSyncValue = 0.f;
 	T mainPhase = 0.f;
@@ -96,7 +113,17 @@ private:
 
 	static T saw(T phase, T minBlepValue);
 	static T sqr(T phase, T minBlepValue, T pwValue);
+	T sawEco(T phase, I level) const;
+	T sqrEco(T phase, T sawValue, I level) const;
+	void processEco(T deltaPhase, T deltaSubPhase0, T deltaSubPhase1);
 	void doSquareLowToHighMinblep(T deltaPhase, T phase, T notSaw, MinBlep& minBlep, int id) const;
+
+	/**
+	 * mask of the lanes that are in use
+	 */
+	T getChannelMask() const {
+		return simd::movemaskInverse<T>((1 << _channels) - 1);
+	}
 };
 
 template <int OV, int Q, typename T, typename I>
@@ -158,6 +185,16 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::computeOffsetCorrection(fl
 	mainDCOffset = SimdBlocks::ifelse(mainIsSaw, sawCorrect * freq, pwCorrect );
 	subDCOffset[0] =  SimdBlocks::ifelse(subIsSaw, sawCorrect * subFreq[0], pwCorrect );
 	subDCOffset[1] =  SimdBlocks::ifelse(subIsSaw, sawCorrect * subFreq[1], pwCorrect );
+
+	if (ecoMode) {
+		// the band-limited saw has no DC, and neither does the difference of two of them.
+		mainDCOffset = 0;
+		subDCOffset[0] = 0;
+		subDCOffset[1] = 0;
+		mainLevel = BandLimitedWaveTable::getLevel(freq * sampleTime);
+		subLevel[0] = BandLimitedWaveTable::getLevel(subFreq[0] * sampleTime);
+		subLevel[1] = BandLimitedWaveTable::getLevel(subFreq[1] * sampleTime);
+	}
 	//printf("main dc offset = %s\n", toStr(mainDCOffset).c_str());
 }
 
@@ -166,19 +203,10 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::doSquareLowToHighMinblep(T
 	MinBlep& minBlep, int id) const
 {
 	T pulseCrossing = (pulseWidth + deltaPhase - phase) / deltaPhase;
-	int pulseMask = simd::movemask((0 < pulseCrossing) & (pulseCrossing <= 1.f));
-	if (pulseMask) {
-		for (int i = 0; i < _channels; i++) {
-			if (pulseMask & (1 << i)) {
-				T highToLowMask = simd::movemaskInverse<T>(1 << i);
-				// mask &= mainIsNotSaw;
-				const T mainHighToLowMask = highToLowMask & notSaw;
-				float p = pulseCrossing[i] - 1.f;
-				T x = mainHighToLowMask & (2.f * syncDirection);
-				minBlep.insertDiscontinuity(p, x);
-			}
-		}
-	}	
+	const T crossed = (0 < pulseCrossing) & (pulseCrossing <= 1.f) & getChannelMask();
+	if (simd::movemask(crossed)) {
+		minBlep.insertDiscontinuities(pulseCrossing - 1.f, crossed & notSaw & (2.f * syncDirection));
+	}
 }
 
 template<typename T>
@@ -199,6 +227,11 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::process(float deltaTime, T
 	deltaSubPhase[0] = simd::clamp(subFreq[0] * deltaTime, 1e-6f, 0.35f);
 	deltaSubPhase[1] = simd::clamp(subFreq[1] * deltaTime, 1e-6f, 0.35f);
 
+	if (ecoMode) {
+		processEco(deltaPhase, deltaSubPhase[0], deltaSubPhase[1]);
+		return;
+	}
+
 	// Advance the phase of everyone.
 	// Don't wrap any - we will do them all at once later
 
@@ -257,33 +290,25 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::process(float deltaTime, T
 	int oneCrossMask =  simd::movemask((0 < oneCrossing) & (oneCrossing <= 1.f));
 
 	if (oneCrossMask) {
-		for (int channelNumber = 0; channelNumber < _channels; channelNumber++) {
-
-			if (oneCrossMask & (1 << channelNumber)) {
-				T crossingMask = simd::movemaskInverse<T>(1 << channelNumber);
+		// The main VCO edges all go in at once. The subs only jump when their
+		// counters run out, so remember those lanes and do them at the end.
+		int subJumpMask[2] = {0, 0};
+		const T mainCrossed = simd::movemaskInverse<T>(oneCrossMask) & getChannelMask();
 
-				// do we need saw?
-				//T sawCrossingMask = crossingMask & mainIsSaw;
-				float p = oneCrossing[channelNumber] - 1.f;
+		// used to only do for saw, since square has own case.
+		// TODO: are we still generating -1..+1? why not...?
+		// not that even so instead of 2 is should be 2 -phase or something
+		mainMinBlep.insertDiscontinuities(oneCrossing - 1.f, mainCrossed & (-2.f * syncDirection));
 
-				// used to only do for saw, since square has own case.
-				//T x = sawCrossingMask & (-2.f * syncDirection);
-				// TODO: are we still generating -1..+1? why not...?
-				// not that even so instead of 2 is should be 2 -phase or something
-				T x =  crossingMask & (-2.f * syncDirection);
-				mainMinBlep.insertDiscontinuity(p, x);
+		for (int channelNumber = 0; channelNumber < _channels; channelNumber++) {
 
+			if (oneCrossMask & (1 << channelNumber)) {
 				for (int subIndex = 0; subIndex <= 1; ++subIndex) {
 					assertGT(subCounter[subIndex][channelNumber], 0);
 					subCounter[subIndex][channelNumber]--;
 					if (subCounter[subIndex][channelNumber] == 0) {
 						subCounter[subIndex][channelNumber] = subDivisionAmount[subIndex][channelNumber];
 
-						// note: this value of "2" is a little inaccurate for subs.
-						// almost the same at low-normal freq
-						// this is perfect for saw
-						//	T xs = crossingMask & ((-2.f ) * subPhase[subIndex]);
-					 	T xs = crossingMask & T(-2.f);
 #if 1	// new, clean way
 						{
 							const float temp = mainPhase[channelNumber];
@@ -295,11 +320,21 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::process(float deltaTime, T
 #else
 						subPhase[subIndex][channelNumber] = 0;
 #endif
-						subMinBlep[subIndex].insertDiscontinuity(p, xs);
+						subJumpMask[subIndex] |= (1 << channelNumber);
 					}
 				}
 			}
 		}
+
+		// note: this value of "2" is a little inaccurate for subs.
+		// almost the same at low-normal freq
+		// this is perfect for saw
+		for (int subIndex = 0; subIndex <= 1; ++subIndex) {
+			if (subJumpMask[subIndex]) {
+				const T subCrossed = simd::movemaskInverse<T>(subJumpMask[subIndex]);
+				subMinBlep[subIndex].insertDiscontinuities(oneCrossing - 1.f, subCrossed & T(-2.f));
+			}
+		}
 	}
 
 	// We used to do this "wrap around" logic only when oneCrossMask told us to.
@@ -333,6 +368,75 @@ inline void VoltageControlledOscillator<OV, Q, T, I>::process(float deltaTime, T
 	simd_assertLT(mainPhase, float_4(1.5));
 }
 
+/**
+ * Same as process, but with no minBLEP. The subs still re-sync to the main
+ * VCO, and the waveforms come from the band-limited tables.
+ */
+template <int OV, int Q, typename T, typename I>
+inline void VoltageControlledOscillator<OV, Q, T, I>::processEco(T deltaPhase, T deltaSubPhase0, T deltaSubPhase1)
+{
+	mainPhase += deltaPhase;
+	subPhase[0] += deltaSubPhase0;
+	subPhase[1] += deltaSubPhase1;
+
+	const T oneCrossing = (1.f - (mainPhase - deltaPhase)) / deltaPhase;
+	wrapVCOPhase<T>(mainPhase);
+
+	const int oneCrossMask =  simd::movemask((0 < oneCrossing) & (oneCrossing <= 1.f));
+	if (oneCrossMask) {
+		for (int channelNumber = 0; channelNumber < _channels; channelNumber++) {
+			if (oneCrossMask & (1 << channelNumber)) {
+				for (int subIndex = 0; subIndex <= 1; ++subIndex) {
+					subCounter[subIndex][channelNumber]--;
+					if (subCounter[subIndex][channelNumber] == 0) {
+						subCounter[subIndex][channelNumber] = subDivisionAmount[subIndex][channelNumber];
+						const float divisor = float(subDivisionAmount[subIndex][channelNumber]);
+						subPhase[subIndex][channelNumber] = mainPhase[channelNumber] / divisor;
+					}
+				}
+			}
+		}
+	}
+	wrapVCOPhase<T>(subPhase[0]);
+	wrapVCOPhase<T>(subPhase[1]);
+
+	// only do the extra lookup for square if someone needs it
+	const bool anyMainSquare = simd::movemask(mainIsNotSaw);
+	const bool anySubSquare = simd::movemask(subIsNotSaw);
+
+	mainValue = sawEco(mainPhase, mainLevel);
+	if (anyMainSquare) {
+		mainValue = SimdBlocks::ifelse(mainIsSaw, mainValue, sqrEco(mainPhase, mainValue, mainLevel));
+	}
+	for (int side = 0; side <= 1; ++side) {
+		subValue[side] = sawEco(subPhase[side], subLevel[side]);
+		if (anySubSquare) {
+			subValue[side] = SimdBlocks::ifelse(subIsSaw, subValue[side], sqrEco(subPhase[side], subValue[side], subLevel[side]));
+		}
+	}
+}
+
+template <int OV, int Q, typename T, typename I>
+inline T VoltageControlledOscillator<OV, Q, T, I>::sawEco(T phase, I level) const
+{
+	// phase may be exactly one, which is past the end of the table.
+	return sawTable->lookup(phase - simd::floor(phase), level);
+}
+
+/**
+ * A saw minus the same saw delayed by pulse width is a pulse
+ * with the same levels as sqr + pwCorrect.
+ */
+template <int OV, int Q, typename T, typename I>
+inline T VoltageControlledOscillator<OV, Q, T, I>::sqrEco(T phase, T sawValue, I level) const
+{
+	T shiftedPhase = phase - pulseWidth;
+	shiftedPhase -= simd::floor(shiftedPhase);
+	// a tiny negative phase comes out as exactly one, which is past the end of the table.
+	shiftedPhase = SimdBlocks::ifelse(shiftedPhase >= 1, T(0), shiftedPhase);
+	return sawValue - sawTable->lookup(shiftedPhase, level);
+}
+
 template <int OV, int Q, typename T, typename I>
 inline T VoltageControlledOscillator<OV, Q, T, I>::saw(T phase, T blepValue)
 {
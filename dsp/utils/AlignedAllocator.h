@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * Allocator for std::vector that puts the data on an Alignment byte boundary,
+ * so SSE code can use aligned loads on it.
+ *
+ * We are C++11, so there is no aligned operator new. Instead we over-allocate,
+ * round up, and stash the original pointer just before the aligned block.
+ */
+template <typename T, std::size_t Alignment = 16>
+class AlignedAllocator
+{
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+    static_assert(Alignment >= alignof(void*), "alignment too small to hold the original pointer");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        void* raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        const std::uintptr_t aligned = (first + Alignment - 1) & ~std::uintptr_t(Alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
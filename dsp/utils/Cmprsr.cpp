@@ -4,4 +4,4 @@
  * This static needs somewhere to live. 
  * So I put him here.
  */
- CompCurves::LookupPtr Cmprsr::ratioCurves[int(Ratios::NUM_RATIOS)];
+ CompCurves::LookupPtr CmprsrBase::ratioCurves[int(Ratios::NUM_RATIOS)];
@@ -7,12 +7,16 @@
 
 #include <atomic>
 
+#include "EnumDispatch.h"
 #include "MultiLag2.h"
 #include "SqMath.h"
 
-class Cmprsr {
+/**
+ * The parts of the compressor that do not depend on the lane width.
+ */
+class CmprsrBase {
 public:
-    Cmprsr();
+    CmprsrBase();
     enum class Ratios {
         HardLimit,
         _2_1_soft,
@@ -26,198 +30,255 @@ public:
         NUM_RATIOS
     };
 
-    float_4 step(float_4);
-    float_4 stepPoly(float_4);
+    /**
+     * The processing kernels for step().
+     */
+    enum class Kernel {
+        Limit,              // hard limiter
+        LimitReduceDist,
+        Comp,               // compressor curve
+        CompReduceDist,
+        NUM_KERNELS
+    };
+    using KernelDispatch = EnumDispatch<Kernel,
+                                        Kernel::Limit,
+                                        Kernel::LimitReduceDist,
+                                        Kernel::Comp,
+                                        Kernel::CompReduceDist>;
+    static_assert(KernelDispatch::checkCount(int(Kernel::NUM_KERNELS)), "KernelDispatch must list every kernel");
+
+    static const std::vector<std::string>& ratios();
+    static const std::vector<std::string>& ratiosLong();
+
+    static bool wasInit() {
+        return !!ratioCurves[0];
+    }
+
+protected:
+    static CompCurves::LookupPtr ratioCurves[int(Ratios::NUM_RATIOS)];
+};
+
+/**
+ * T is the lane type: float_4, or float_8 to run eight channels at a time.
+ * Cmprsr is the usual float_4 one.
+ */
+template <typename T>
+class CmprsrT : public CmprsrBase {
+public:
+    CmprsrT();
+
+    /**
+     * The kernel depends only on the curve (setCurve) and on distortion
+     * reduction (setTimes), not on the channel count.
+     * A module that gives all its Cmprsrs the same curve and times
+     * may pick the kernel from one of them and run it on all of them.
+     * step<k> asserts that they really do match.
+     */
+    Kernel getKernel() const;
+
+    /**
+     * k must be the kernel getKernel() returns.
+     */
+    template <Kernel k>
+    T step(T);
+
+    T step(T);
+    T stepPoly(T);
     void setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction);
     void setThreshold(float th);
     void setCurve(Ratios);
 
-    void setTimesPoly(float_4 attackMs, float_4 releaseMs, float sampleTime, float_4 enableDistortionReduction);
-    void setThresholdPoly(float_4 th);
+    void setTimesPoly(T attackMs, T releaseMs, float sampleTime, T enableDistortionReduction);
+    void setThresholdPoly(T th);
     void setCurvePoly(const Ratios*);
 
     void setNumChannels(int);
 
-    const MultiLag2& _lag() const;
-    static const std::vector<std::string>& ratios();
-    static const std::vector<std::string>& ratiosLong();
-    float_4 getGain() const;
-
-    static bool wasInit() {
-        return !!ratioCurves[0];
-    }
+    const MultiLag2T<T>& _lag() const;
+    T getGain() const;
 
 private:
-    MultiLag2 lag;
-    MultiLPF2 attackFilter;
+    MultiLag2T<T> lag;
+    MultiLPF2T<T> attackFilter;
 
     // TODO: get rid of the non-poly version
     bool reduceDistortion = false;
-    float_4 reduceDistortionPoly = { 0 };
+    T reduceDistortionPoly = 0;
 
 
-    float_4 threshold = 5;
-    float_4 invThreshold = 1.f / 5.f;
+    T threshold = 5;
+    T invThreshold = 1.f / 5.f;
 
-    int ratioIndex[4] = { 0 };
-    Ratios ratio[4] = { Ratios::HardLimit, Ratios::HardLimit, Ratios::HardLimit, Ratios::HardLimit };
+    int ratioIndex[T::size] = { 0 };
+    Ratios ratio[T::size] = { Ratios::HardLimit };      // the rest are zero, which is also HardLimit
     //int ratioIndex = 0;
    // Ratios ratio = Ratios::HardLimit;
-    int maxChannel = 3;
+    int maxChannel = T::size - 1;
+
+    /**
+     * mask of the channels in use, 0 to maxChannel. Made by setNumChannels
+     */
+    T activeChannels = T::mask();
+
+    /**
+     * true if all the channels use the same curve,
+     * in which case stepPoly can do the lookup in one go.
+     */
+    bool sameCurvePoly = true;
 
 #ifdef _SQATOMIC
-    std::atomic<float_4> gain_;
+    std::atomic<T> gain_;
 #else
-    float_4 gain_;
+    T gain_;
 #endif
 
-    static CompCurves::LookupPtr ratioCurves[int(Ratios::NUM_RATIOS)];
+    Kernel kernel = Kernel::Limit;
+    void updateKernel();
 
-    using processFunction = float_4 (Cmprsr::*)(float_4 input);
-    processFunction procFun = &Cmprsr::stepGeneric;
-    void updateProcFun();
+    static float_4 lookupCurve(CompCurves::LookupPtrConst table, float_4 x) {
+        return CompCurves::lookup4(table, x);
+    }
+    static float_8 lookupCurve(CompCurves::LookupPtrConst table, float_8 x) {
+        return CompCurves::lookup8(table, x);
+    }
 
-    float_4 stepGeneric(float_4);
-    float_4 step1NoDistComp(float_4);
-    float_4 step1Comp(float_4);
+    /**
+     * Calls step<k> for the kernel KernelDispatch picks.
+     */
+    struct Stepper {
+        CmprsrT& comp;
+        T input;
+        T output;
+
+        template <class K>
+        void operator()(K) {
+            output = comp.template step<K::value>(input);
+        }
+    };
 };
 
-inline float_4 Cmprsr::getGain() const {
+using Cmprsr = CmprsrT<float_4>;
+
+template <typename T>
+inline T CmprsrT<T>::getGain() const {
     return gain_;
 }
 
-inline void Cmprsr::setNumChannels(int ch) {
+template <typename T>
+inline void CmprsrT<T>::setNumChannels(int ch) {
     maxChannel = ch - 1;
-    updateProcFun();
-}
-
-
-// only called for non poly
-inline void Cmprsr::updateProcFun() {
-    // printf("in update, max = %d\n", maxChannel);
-    procFun = &Cmprsr::stepGeneric;
-    if (maxChannel == 0 && (ratio[0] != Ratios::HardLimit)) {
-        if (reduceDistortion) {
-            procFun = &Cmprsr::step1NoDistComp;
-        } else {
-            procFun = &Cmprsr::step1Comp;
-        }
+    T channel;
+    for (int i = 0; i < T::size; ++i) {
+        channel[i] = float(i);
     }
+    activeChannels = channel <= T(float(maxChannel));
 }
 
-inline void Cmprsr::setCurve(Ratios r) {
-    ratio[0] = r;
-    ratio[1] = r;
-    ratio[2] = r;
-    ratio[3] = r;
-
-    ratioIndex[0] = int(r);
-    ratioIndex[1] = int(r);
-    ratioIndex[2] = int(r);
-    ratioIndex[3] = int(r);
+template <typename T>
+inline CmprsrBase::Kernel CmprsrT<T>::getKernel() const {
+    return kernel;
 }
 
-inline void Cmprsr::setCurvePoly(const Ratios* r) {
-    ratio[0] = r[0];
-    ratio[1] = r[1];
-    ratio[2] = r[2];
-    ratio[3] = r[3];
-
-    ratioIndex[0] = int(r[0]);
-    ratioIndex[1] = int(r[1]);
-    ratioIndex[2] = int(r[2]);
-    ratioIndex[3] = int(r[3]);
+// only called for non poly
+template <typename T>
+inline void CmprsrT<T>::updateKernel() {
+    if (ratio[0] == Ratios::HardLimit) {
+        kernel = reduceDistortion ? Kernel::LimitReduceDist : Kernel::Limit;
+    } else {
+        kernel = reduceDistortion ? Kernel::CompReduceDist : Kernel::Comp;
+    }
 }
 
-inline float_4 Cmprsr::step(float_4 input) {
-    return (this->*procFun)(input);
+template <typename T>
+inline void CmprsrT<T>::setCurve(Ratios r) {
+    for (int i = 0; i < T::size; ++i) {
+        ratio[i] = r;
+        ratioIndex[i] = int(r);
+    }
+    updateKernel();
 }
 
-// only non poly
-inline float_4 Cmprsr::step1Comp(float_4 input) {
-    assert(wasInit());
-    //printf("step1Comp gain = %s\n", toStr(gain_).c_str());
-    lag.step(rack::simd::abs(input));
-    float_4 envelope = lag.get();
-
-    CompCurves::LookupPtr table = ratioCurves[ratioIndex[0]];
-    //   gain = float_4(1);
-    const float_4 level = envelope * invThreshold;
-
-    // gain[0] = CompCurves::lookup(table, level[0]);
-    float_4 t = gain_;
-    t[0] = CompCurves::lookup(table, level[0]);
-    gain_ = t;
-    return gain_ * input;
+template <typename T>
+inline void CmprsrT<T>::setCurvePoly(const Ratios* r) {
+    sameCurvePoly = true;
+    for (int i = 0; i < T::size; ++i) {
+        ratio[i] = r[i];
+        ratioIndex[i] = int(r[i]);
+        sameCurvePoly = sameCurvePoly && (r[i] == r[0]);
+    }
 }
 
-// only non poly
-inline float_4 Cmprsr::step1NoDistComp(float_4 input) {
-    assert(wasInit());
-
-    //printf("step1NoDist gain = %s\n", toStr(gain_).c_str());
-    lag.step(rack::simd::abs(input));
-    attackFilter.step(lag.get());
-    float_4 envelope = attackFilter.get();
-
-    CompCurves::LookupPtr table = ratioCurves[ratioIndex[0]];
-
-    const float_4 level = envelope * invThreshold;
-
-    float_4 t = gain_;
-    t[0] = CompCurves::lookup(table, level[0]);
-    gain_ = t;
-    return gain_ * input;
+template <typename T>
+inline T CmprsrT<T>::step(T input) {
+    Stepper stepper = {*this, input, T(0)};
+    KernelDispatch::call(kernel, stepper);
+    return stepper.output;
 }
 
 // only non-poly
-inline float_4 Cmprsr::stepGeneric(float_4 input) {
+template <typename T>
+template <CmprsrBase::Kernel k>
+inline T CmprsrT<T>::step(T input) {
     assert(wasInit());
+    assert(k == kernel);
+
+    // k is a constant here, so all of these tests go away
+    const bool reduceDist = (k == Kernel::LimitReduceDist) || (k == Kernel::CompReduceDist);
+    const bool limit = (k == Kernel::Limit) || (k == Kernel::LimitReduceDist);
 
-    float_4 envelope;
-    if (reduceDistortion) {
-        lag.step(rack::simd::abs(input));
+    T envelope;
+    lag.step(SimdBlocks::abs(input));
+    if (reduceDist) {
         attackFilter.step(lag.get());
         envelope = attackFilter.get();
     } else {
-        lag.step(rack::simd::abs(input));
         envelope = lag.get();
     }
 
-    if (ratio[0] == Ratios::HardLimit) {
-        float_4 reductionGain = threshold / envelope;
-        gain_ = SimdBlocks::ifelse(envelope > threshold, reductionGain, 1);
-        return gain_ * input;
+    if (limit) {
+        const T reductionGain = threshold / envelope;
+        gain_ = SimdBlocks::ifelse(envelope > threshold, reductionGain, T(1));
     } else {
         CompCurves::LookupPtr table = ratioCurves[ratioIndex[0]];
-        const float_4 level = envelope * invThreshold;
-
-        float_4 t = gain_;
-        for (int i = 0; i < 4; ++i) {
-            if (i <= maxChannel) {
-                t[i] = CompCurves::lookup(table, level[i]);
-            }
+        const T level = envelope * invThreshold;
+        if (maxChannel == 0) {
+            // one channel is cheaper as a scalar lookup
+            T t = gain_;
+            t[0] = CompCurves::lookup(table, level[0]);
+            gain_ = t;
+        } else {
+            // only update the gain for channels that are in use
+            gain_ = SimdBlocks::ifelse(activeChannels, lookupCurve(table, level), gain_);
         }
-        gain_ = t;
-        return gain_ * input;
     }
+    return gain_ * input;
 }
 
 // only non-poly
-inline float_4 Cmprsr::stepPoly(float_4 input) {
+template <typename T>
+inline T CmprsrT<T>::stepPoly(T input) {
     assert(wasInit());
     simd_assertMask(reduceDistortionPoly);
 
-    float_4 envelope;
+    T envelope;
 
-    lag.step(rack::simd::abs(input));
+    lag.step(SimdBlocks::abs(input));
     attackFilter.step(lag.get());
     envelope = SimdBlocks::ifelse(reduceDistortionPoly, attackFilter.get(), lag.get());
 
 
+    if (sameCurvePoly) {
+        if (ratio[0] == Ratios::HardLimit) {
+            gain_ = SimdBlocks::ifelse(envelope > threshold, threshold / envelope, T(1));
+        } else {
+            CompCurves::LookupPtr table = ratioCurves[ratioIndex[0]];
+            gain_ = lookupCurve(table, envelope * invThreshold);
+        }
+        return gain_ * input;
+    }
+
     // have to do the rest non-simd - in case the curves are all different.
-    // TODO: optimized case for all curves the same
-    for (int iChan = 0; iChan < 4; ++iChan) {
+    for (int iChan = 0; iChan < T::size; ++iChan) {
         if (ratio[iChan] == Ratios::HardLimit) {
             const float reductionGain = threshold[iChan] / envelope[iChan];
             gain_[iChan] = (envelope[iChan] > threshold[iChan]) ? threshold[iChan] / envelope[iChan] : 1.f;
@@ -232,11 +293,12 @@ inline float_4 Cmprsr::stepPoly(float_4 input) {
     return gain_ * input;
 }
 
-inline void Cmprsr::setTimesPoly(float_4 attackMs, float_4 releaseMs, float sampleTime, float_4 enableDistortionReduction) {
+template <typename T>
+inline void CmprsrT<T>::setTimesPoly(T attackMs, T releaseMs, float sampleTime, T enableDistortionReduction) {
     simd_assertMask(enableDistortionReduction);
-    const float_4 correction = 2 * M_PI;
-    const float_4 releaseHz = 1000.f / (releaseMs * correction);
-    const float_4 attackHz = 1000.f / (attackMs * correction);
+    const T correction = 2 * M_PI;
+    const T releaseHz = 1000.f / (releaseMs * correction);
+    const T attackHz = 1000.f / (attackMs * correction);
   //  const float_4 normRelease = releaseHz * sampleTime;
 
     // this sets:
@@ -247,8 +309,8 @@ inline void Cmprsr::setTimesPoly(float_4 attackMs, float_4 releaseMs, float samp
     // attackFilter.cutoff
 
 
-    this->reduceDistortionPoly = SimdBlocks::ifelse( attackMs < float_4(.1f), SimdBlocks::maskFalse(), enableDistortionReduction);
-    lag.setInstantAttackPoly(attackMs < float_4(.1f));
+    this->reduceDistortionPoly = SimdBlocks::ifelse( attackMs < T(.1f), T::zero(), enableDistortionReduction);
+    lag.setInstantAttackPoly(attackMs < T(.1f));
 
     lag.setAttackPoly(attackHz * sampleTime);
     attackFilter.setCutoffPoly(attackHz * sampleTime);
@@ -281,10 +343,11 @@ inline void Cmprsr::setTimesPoly(float_4 attackMs, float_4 releaseMs, float samp
 
     lag.setRelease(normRelease);
     #endif
-   // updateProcFun();
+   // updateKernel();
 }
 
-inline void Cmprsr::setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) {
+template <typename T>
+inline void CmprsrT<T>::setTimes(float attackMs, float releaseMs, float sampleTime, bool enableDistortionReduction) {
     const float correction = 2 * M_PI;
     const float releaseHz = 1000.f / (releaseMs * correction);
     const float normRelease = releaseHz * sampleTime;
@@ -309,13 +372,16 @@ inline void Cmprsr::setTimes(float attackMs, float releaseMs, float sampleTime,
     }
 
     lag.setRelease(normRelease);
-    updateProcFun();
+    updateKernel();
 }
 
-inline Cmprsr::Cmprsr() {
-    const float softKnee = 12;
+template <typename T>
+inline CmprsrT<T>::CmprsrT() {
+    gain_ = T(1);
+}
 
-    gain_ = float_4(1);
+inline CmprsrBase::CmprsrBase() {
+    const float softKnee = 12;
 
     if (wasInit()) {
         return;
@@ -380,27 +446,30 @@ inline Cmprsr::Cmprsr() {
     assert(wasInit());
 }
 
-inline const std::vector<std::string>& Cmprsr::ratios() {
+inline const std::vector<std::string>& CmprsrBase::ratios() {
     assert(int(Ratios::NUM_RATIOS) == 9);
     static const std::vector<std::string> theRatios = {"Limit", "2:1 soft", "2:1 hard", "4:1 soft", "4:1 hard", "8:1 soft", "8:1 hard", "20:1 soft", "20:1 hard"};
     return theRatios;
 }
 
-inline const std::vector<std::string>& Cmprsr::ratiosLong() {
+inline const std::vector<std::string>& CmprsrBase::ratiosLong() {
     assert(int(Ratios::NUM_RATIOS) == 9);
     static const std::vector<std::string> theRatios = {"Infinite (limiter)", "2:1 soft-knee", "2:1 hard-knee", "4:1 soft-knee", "4:1 har-kneed", "8:1 soft-knee", "8:1 hard-knee", "20:1 soft-knee", "20:1 hard-knee"};
     return theRatios;
 }
 
-inline const MultiLag2& Cmprsr::_lag() const {
+template <typename T>
+inline const MultiLag2T<T>& CmprsrT<T>::_lag() const {
     return lag;
 }
 
-inline void Cmprsr::setThreshold(float th) {
-    setThresholdPoly(float_4(th));
+template <typename T>
+inline void CmprsrT<T>::setThreshold(float th) {
+    setThresholdPoly(T(th));
 }
 
-inline void Cmprsr::setThresholdPoly(float_4 th) {
+template <typename T>
+inline void CmprsrT<T>::setThresholdPoly(T th) {
     threshold = th;
     invThreshold = 1.f / threshold;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "NonUniformLookupTable.h"
+#include "SimdLookupTable.h"
 #include <functional>
 #include <memory>
 #include <vector>
@@ -70,6 +71,14 @@ public:
         return NonUniformLookupTable<float>::lookup(*table, x);
     }
 
+    static float_4 lookup4(LookupPtrConst table, float_4 x) {
+        return SimdLookupTable::lookup4(*table, x);
+    }
+
+    static float_8 lookup8(LookupPtrConst table, float_8 x) {
+        return SimdLookupTable::lookup8(*table, x);
+    }
+
     /**
      * returns a series of points that define a gain curve.
      * removed interior points that are on a straight line.
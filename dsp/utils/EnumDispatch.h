@@ -0,0 +1,82 @@
+#pragma once
+
+#include <assert.h>
+#include <type_traits>
+
+/**
+ * Turns a mode enum known only at run time into a compile time constant.
+ *
+ * Processing kernels are function templates with the mode as a template parameter,
+ * so each instantiation has the mode baked in and the per-sample code
+ * has no switches on it. The owner picks the instantiation once per block:
+ *
+ *      using VoicingDispatch = EnumDispatch<Voicing, Voicing::Classic, Voicing::Fold, ...>;
+ *      VoicingDispatch::call(voicing, f);
+ *
+ * call() calls f(std::integral_constant<E, v>()) for the v that equals e.
+ * C++11 has no generic lambdas, so f is a small functor with a template operator().
+ * Inside it v is V::value, which can be used as a template argument.
+ *
+ * Vs must be every value of E, in order, starting at zero. That way
+ * a value added to E and not to the list is a compile error, as long as
+ * the owner checks size against the enum's count (see checkCount).
+ */
+template <typename E, E... Vs>
+class EnumDispatch
+{
+public:
+    static const int size = sizeof...(Vs);
+
+    template <class F>
+    static void call(E e, F&& f)
+    {
+        assert(int(e) >= 0 && int(e) < size);
+        Caller<Vs...>::call(e, f);
+    }
+
+    /**
+     * For static_assert. count is the number of values in E,
+     * usually the NUM_xxx at the end of it.
+     */
+    static constexpr bool checkCount(int count)
+    {
+        return count == size;
+    }
+
+private:
+    template <int first, E... Rest>
+    struct InOrder : std::true_type
+    {
+    };
+
+    template <int first, E V, E... Rest>
+    struct InOrder<first, V, Rest...> : std::integral_constant<bool, int(V) == first && InOrder<first + 1, Rest...>::value>
+    {
+    };
+
+    static_assert(InOrder<0, Vs...>::value, "EnumDispatch needs every value, in order, starting at zero");
+
+    template <E... Rest>
+    struct Caller
+    {
+        template <class F>
+        static void call(E, F&)
+        {
+            assert(false);
+        }
+    };
+
+    template <E V, E... Rest>
+    struct Caller<V, Rest...>
+    {
+        template <class F>
+        static void call(E e, F& f)
+        {
+            if (e == V) {
+                f(std::integral_constant<E, V>());
+            } else {
+                Caller<Rest...>::call(e, f);
+            }
+        }
+    };
+};
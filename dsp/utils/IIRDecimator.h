@@ -29,6 +29,18 @@ public:
         }
     }
 
+    /**
+     * Clears the filter memory, for when the input
+     * starts again after a gap.
+     */
+    void reset()
+    {
+        for (int i = 0; i < 3; ++i) {
+            state.z0(i) = 0;
+            state.z1(i) = 0;
+        }
+    }
+
     /**
      * Down-sample a buffer of data.
      * input is just an array of floats, the size is our oversampling factor.
@@ -10,6 +10,7 @@
  * takes a single sample at a lower sample rate, and converts it
  * to a buffer of data at the higher sample rate
  */
+template <typename T>
 class IIRUpsampler
 {
 public:
@@ -22,7 +23,19 @@ public:
     void setup(int oversampleFactor)
     {
         oversample = oversampleFactor;
-        params = ObjectCache<float>::get6PLPParams(1.f / (4.0f * oversample));
+        params = ObjectCache<T>::get6PLPParams(1.f / (4.0f * oversample));
+    }
+
+    /**
+     * Clears the filter memory, for when the input
+     * starts again after a gap.
+     */
+    void reset()
+    {
+        for (int i = 0; i < 3; ++i) {
+            state.z0(i) = 0;
+            state.z1(i) = 0;
+        }
     }
 
     /**
@@ -35,21 +48,21 @@ public:
      * repeating the data like [a, a, a, a, b, b, b, b] would give a slight roll-off that
      * we don't want.
      */
-    void process(float * outputBuffer, float input)
+    void process(T * outputBuffer, T input)
     {
         // The zero packing reduced the overall volume. To preserve the volume,
         // multiply be the reduction amount, which is oversample.
-        input *= oversample;
+        input = input * T(float(oversample));
 
         for (int i = 0; i < oversample; ++i) {
-            outputBuffer[i] = BiquadFilter<float>::run(input, state, *params);
-            input = 0;      // just filter a delta - don't average the whole signal (i.e. zero pack)
+            outputBuffer[i] = BiquadFilter<T>::run(input, state, *params);
+            input = T(0);      // just filter a delta - don't average the whole signal (i.e. zero pack)
         }
     }
 
 private:
     int oversample = 16;
 
-    std::shared_ptr<BiquadParams<float, 3>> params;
-    BiquadState<float, 3> state;
+    std::shared_ptr<BiquadParams<T, 3>> params;
+    BiquadState<T, 3> state;
 };
\ No newline at end of file
@@ -1,15 +1,21 @@
 #pragma once
 
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
+#include <vector>
 
 template <typename T> class NonUniformLookupTable;
+class SimdLookupTable;
 
 template <typename T>
 class NonUniformLookupTableParams
 {
 public:
     friend NonUniformLookupTable<T>;
+    friend SimdLookupTable;
     NonUniformLookupTableParams() = default;
     NonUniformLookupTableParams(const NonUniformLookupTableParams&) = delete;
     NonUniformLookupTableParams& operator= (const NonUniformLookupTableParams&) = delete;
@@ -30,6 +36,30 @@ private:
     using container = std::map<T, Entry>;
     bool isFinalized = false;
     container entries;
+
+    /**
+     * Search acceleration, built by finalize.
+     * The entries are copied into flat arrays, and a uniform grid
+     * over the domain maps each cell to the first segment in that cell.
+     * At most maxSteps more breakpoints fall inside any one cell, so a lookup
+     * is a fixed number of compares, with no searching.
+     *
+     * xs has one extra sentinel at the end, so we never step past the last segment.
+     */
+    std::vector<T> xs;
+    std::vector<T> ys;
+    std::vector<T> as;
+    std::vector<int> cellToSegment;
+    T xMin = 0;
+    T xMax = 0;
+    T cellsPerX = 0;
+    int maxSteps = 0;
+
+    /**
+     * Upper limit on the grid size. If the breakpoints are so close
+     * together that we would need more cells than this, we take more steps instead.
+     */
+    static const int maxCells = 1024;
 };
 
 template <typename T>
@@ -39,7 +69,20 @@ public:
     NonUniformLookupTable() = delete;
     static void addPoint(NonUniformLookupTableParams<T>& params, T x, T y);
     static void finalize(NonUniformLookupTableParams<T>& params);
+
+    /**
+     * O(1) lookup, using the acceleration structure built by finalize.
+     */
     static T lookup(const NonUniformLookupTableParams<T>& params, T x);
+
+    /**
+     * Original lookup, using a search of the map.
+     * Gives the same result as lookup, but is slower. Used for testing.
+     */
+    static T lookupSearch(const NonUniformLookupTableParams<T>& params, T x);
+private:
+    static void buildIndex(NonUniformLookupTableParams<T>& params);
+    static int findCell(const NonUniformLookupTableParams<T>& params, T x);
 };
 
 template <typename T>
@@ -73,9 +116,68 @@ inline void NonUniformLookupTable<T>::finalize(NonUniformLookupTableParams<T>& p
         }
     }
 
+    buildIndex(params);
     params.isFinalized = true;
 }
 
+template <typename T>
+inline int NonUniformLookupTable<T>::findCell(const NonUniformLookupTableParams<T>& params, T x)
+{
+    const int numCells = int(params.cellToSegment.size());
+    int cell = int((x - params.xMin) * params.cellsPerX);
+    return std::max(0, std::min(numCells - 1, cell));
+}
+
+template <typename T>
+inline void NonUniformLookupTable<T>::buildIndex(NonUniformLookupTableParams<T>& params)
+{
+    params.xs.clear();
+    params.ys.clear();
+    params.as.clear();
+    for (auto it : params.entries) {
+        params.xs.push_back(it.second.x);
+        params.ys.push_back(it.second.y);
+        params.as.push_back(it.second.a);
+    }
+    const int numEntries = int(params.xs.size());
+    params.xs.push_back(std::numeric_limits<T>::max());
+
+    params.xMin = params.xs[0];
+    params.xMax = params.xs[numEntries - 1];
+
+    // pick the cell size so that (ideally) no cell has more than one breakpoint in it
+    T minSpacing = params.xMax - params.xMin;
+    for (int i = 1; i < numEntries; ++i) {
+        minSpacing = std::min(minSpacing, params.xs[i] - params.xs[i - 1]);
+    }
+    int numCells = 1;
+    if (minSpacing > 0) {
+        const double idealCells = std::ceil(double(params.xMax - params.xMin) / double(minSpacing));
+        numCells = int(std::min(double(NonUniformLookupTableParams<T>::maxCells), idealCells));
+        numCells = std::max(1, numCells);
+    }
+    params.cellsPerX = (numEntries > 1) ? T(numCells / (params.xMax - params.xMin)) : 0;
+
+    // for each cell, find the last segment that starts in an earlier cell.
+    // Every x in the cell is at or after the start of that segment.
+    params.cellToSegment.resize(numCells);
+    int segment = 0;
+    for (int cell = 0; cell < numCells; ++cell) {
+        while (segment < (numEntries - 1) && findCell(params, params.xs[segment + 1]) < cell) {
+            ++segment;
+        }
+        params.cellToSegment[cell] = segment;
+    }
+
+    // now find how many breakpoints we might need to step over in any cell
+    params.maxSteps = 0;
+    for (int i = 0; i < numEntries; ++i) {
+        const int cell = findCell(params, params.xs[i]);
+        const int steps = i - params.cellToSegment[cell];
+        params.maxSteps = std::max(params.maxSteps, steps);
+    }
+}
+
 
 template <typename T>
 inline T NonUniformLookupTable<T>::lookup(const NonUniformLookupTableParams<T>& params, T x)
@@ -83,6 +185,23 @@ inline T NonUniformLookupTable<T>::lookup(const NonUniformLookupTableParams<T>&
     assert(params.isFinalized);
     assert(!params.entries.empty());
 
+    x = std::max(x, params.xMin);
+    x = std::min(x, params.xMax);
+
+    int segment = params.cellToSegment[findCell(params, x)];
+    for (int i = 0; i < params.maxSteps; ++i) {
+        segment += (x >= params.xs[segment + 1]) ? 1 : 0;
+    }
+
+    return params.as[segment] * (x - params.xs[segment]) + params.ys[segment];
+}
+
+template <typename T>
+inline T NonUniformLookupTable<T>::lookupSearch(const NonUniformLookupTableParams<T>& params, T x)
+{
+    assert(params.isFinalized);
+    assert(!params.entries.empty());
+
     auto lb_init = params.entries.lower_bound(x);
     auto lb = lb_init;
 
@@ -6,8 +6,10 @@
 
 
 #include "AudioMath.h"
+#include "BandLimitedWaveTable.h"
 #include "ButterworthFilterDesigner.h"
 #include "LookupTableFactory.h"
+#include "MinBlepImpulse.h"
 #include "ObjectCache.h"
 
 
@@ -157,6 +159,50 @@ std::shared_ptr<LookupTableParams<T>> ObjectCache<T>::getTanh5()
     return ret;
 }
 
+template <typename T>
+std::shared_ptr<const BandLimitedWaveTable> ObjectCache<T>::getSawWaveTable()
+{
+    std::shared_ptr<const BandLimitedWaveTable> ret = sawWaveTable.lock();
+    if (!ret) {
+        ret = std::make_shared<BandLimitedWaveTable>(BandLimitedWaveTable::Waveform::SAW);
+        sawWaveTable = ret;
+    }
+    return ret;
+}
+
+template <typename T>
+std::shared_ptr<const BandLimitedWaveTable> ObjectCache<T>::getTriangleWaveTable()
+{
+    std::shared_ptr<const BandLimitedWaveTable> ret = triangleWaveTable.lock();
+    if (!ret) {
+        ret = std::make_shared<BandLimitedWaveTable>(BandLimitedWaveTable::Waveform::TRIANGLE);
+        triangleWaveTable = ret;
+    }
+    return ret;
+}
+
+template <typename T>
+std::shared_ptr<const MinBlepImpulse> ObjectCache<T>::getMinBlepImpulse(int zeroCrossings, int overSample)
+{
+    assert(zeroCrossings == 16);
+    std::weak_ptr<const MinBlepImpulse>* cache = nullptr;
+    if (overSample == 16) {
+        cache = &minBlep16_16;
+    } else if (overSample == 32) {
+        cache = &minBlep16_32;
+    } else {
+        assert(false);
+        return nullptr;
+    }
+
+    std::shared_ptr<const MinBlepImpulse> ret = cache->lock();
+    if (!ret) {
+        ret = std::make_shared<MinBlepImpulse>(zeroCrossings, overSample);
+        *cache = ret;
+    }
+    return ret;
+}
+
 /**
  * Lambda capture two smart pointers to lookup table params,
  * so lifetime of the lambda control their reft.
@@ -248,6 +294,18 @@ std::weak_ptr<LookupTableParams<T>> ObjectCache<T>::mixerPanL;
 template <typename T>
 std::weak_ptr<LookupTableParams<T>> ObjectCache<T>::mixerPanR;
 
+template <typename T>
+std::weak_ptr<const BandLimitedWaveTable> ObjectCache<T>::sawWaveTable;
+
+template <typename T>
+std::weak_ptr<const BandLimitedWaveTable> ObjectCache<T>::triangleWaveTable;
+
+template <typename T>
+std::weak_ptr<const MinBlepImpulse> ObjectCache<T>::minBlep16_16;
+
+template <typename T>
+std::weak_ptr<const MinBlepImpulse> ObjectCache<T>::minBlep16_32;
+
 // Explicit instantiation, so we can put implementation into .cpp file
 template class ObjectCache<double>;
 template class ObjectCache<float>;
@@ -3,6 +3,9 @@
 #include "LookupTable.h"
 #include "BiquadParams.h"
 
+class BandLimitedWaveTable;
+class MinBlepImpulse;
+
 /**
  * This class creates objects and caches them.
  * Objects in the cache only stay alive as long as there is a reference to the object,
@@ -52,6 +55,20 @@ public:
 
     static std::shared_ptr<BiquadParams<T, 3>> get6PLPParams(float normalizedFc);
 
+    /**
+     * Mip-mapped band-limited tables, for the eco VCOs.
+     * These are always float, whatever T is.
+     */
+    static std::shared_ptr<const BandLimitedWaveTable> getSawWaveTable();
+    static std::shared_ptr<const BandLimitedWaveTable> getTriangleWaveTable();
+
+    /**
+     * Step response for the minBLEP generators. Always float.
+     * Only the sizes we use are supported: 16 zero crossings,
+     * oversampled 16 or 32. SqMinBlep checks this when it compiles.
+     */
+    static std::shared_ptr<const MinBlepImpulse> getMinBlepImpulse(int zeroCrossings, int overSample);
+
 private:
     /**
      * Cache uses weak pointers. This allows the cached objects to be
@@ -73,4 +90,10 @@ private:
 
     static std::weak_ptr<LookupTableParams<T>> mixerPanL;
     static std::weak_ptr<LookupTableParams<T>> mixerPanR;
+
+    static std::weak_ptr<const BandLimitedWaveTable> sawWaveTable;
+    static std::weak_ptr<const BandLimitedWaveTable> triangleWaveTable;
+
+    static std::weak_ptr<const MinBlepImpulse> minBlep16_16;
+    static std::weak_ptr<const MinBlepImpulse> minBlep16_32;
 };
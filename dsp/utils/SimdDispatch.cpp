@@ -0,0 +1,39 @@
+#include "SimdDispatch.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+bool SimdDispatch::forceSSE = false;
+
+static bool detectAVX()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+    const bool cpuHasAVX = (info[2] & (1 << 28)) != 0;
+    if (!osUsesXSave || !cpuHasAVX) {
+        return false;
+    }
+    // the OS must also be saving the upper half of the ymm registers
+    return (_xgetbv(0) & 6) == 6;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+#else
+    return false;
+#endif
+}
+
+bool SimdDispatch::hasAVX()
+{
+    static const bool avx = detectAVX();
+    return avx && !forceSSE;
+}
+
+void SimdDispatch::_forceSSE(bool b)
+{
+    forceSSE = b;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * Runtime CPU dispatch for code that has an AVX build as well as the usual SSE one.
+ *
+ * The plugin is built for SSE. The processing code is a template on the lane type.
+ * The owner gives it an entry point marked SQ_TARGET_AVX and SQ_FLATTEN,
+ * which runs it on float_8 (see float_8.h). Flatten inlines everything under it,
+ * so all of that is built for AVX. The owner calls that entry point only
+ * if hasAVX() says it is safe, and otherwise runs the same template on float_4.
+ *
+ * Nothing outside the flattened entry point is built for AVX, so no
+ * AVX copy of a shared inline function can end up running on an SSE only CPU.
+ */
+#if defined(_MSC_VER)
+#define SQ_TARGET_AVX
+#define SQ_FLATTEN
+#else
+#define SQ_TARGET_AVX __attribute__((target("avx")))
+#define SQ_FLATTEN __attribute__((flatten))
+#endif
+
+class SimdDispatch
+{
+public:
+    SimdDispatch() = delete;        // we are only static
+
+    /**
+     * true if both the CPU and the OS support AVX
+     */
+    static bool hasAVX();
+
+    /**
+     * Lets unit tests run the SSE fallback on any machine.
+     */
+    static void _forceSSE(bool);
+
+private:
+    static bool forceSSE;
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "LookupTable.h"
+#include "NonUniformLookupTable.h"
+#include "float_8.h"
+#include "simd.h"
+
+#include <functional>
+#include <vector>
+
+/**
+ * SIMD versions of the lookup tables.
+ *
+ * lookup4 works with any LookupTableParams<float>, so all the tables
+ * in ObjectCache<float> may be used four at a time.
+ * It also works with any finalized NonUniformLookupTableParams<float>.
+ */
+class SimdLookupTable
+{
+public:
+    SimdLookupTable() = delete;       // we are only static
+
+    /**
+     * Same as LookupTable<float>::lookup, but does four inputs at once.
+     * Inputs outside the domain are always limited to the domain.
+     */
+    static float_4 lookup4(const LookupTableParams<float>& params, float_4 input);
+
+    /**
+     * Same as NonUniformLookupTable<float>::lookup, but does four inputs at once.
+     * Uses the grid index built by NonUniformLookupTable<float>::finalize,
+     * so there is no search and no branching.
+     */
+    static float_4 lookup4(const NonUniformLookupTableParams<float>& params, float_4 input);
+
+    /**
+     * Same as lookup4, but for eight inputs.
+     * The gathers are per lane anyway, so it is just two lookup4.
+     */
+    static float_8 lookup8(const NonUniformLookupTableParams<float>& params, float_8 input);
+};
+
+inline float_4 SimdLookupTable::lookup4(const LookupTableParams<float>& params, float_4 input)
+{
+    assert(params.isValid());
+    input = rack::simd::clamp(input, float_4(params.xMin), float_4(params.xMax));
+
+    const float_4 scaledInput = input * float_4(params.a) + float_4(params.b);
+
+    // truncates, same as cvtt in the scalar version
+    const int32_4 index = scaledInput;
+    float_4 fraction = scaledInput - float_4(index);
+
+    // same numeric issues as the scalar version, so clamp here also
+    fraction = rack::simd::clamp(fraction, float_4::zero(), float_4(1.f));
+
+    // Each entry is a (value, slope) pair, so one 64 bit load
+    // will "gather" both of them for a channel.
+    const float* entries = params.entries;
+    assert(index[0] >= 0 && index[0] <= params.numBins_i);
+    assert(index[1] >= 0 && index[1] <= params.numBins_i);
+    assert(index[2] >= 0 && index[2] <= params.numBins_i);
+    assert(index[3] >= 0 && index[3] <= params.numBins_i);
+    __m128 lo = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(entries + 2 * index[0]));
+    lo = _mm_loadh_pi(lo, reinterpret_cast<const __m64*>(entries + 2 * index[1]));
+    __m128 hi = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(entries + 2 * index[2]));
+    hi = _mm_loadh_pi(hi, reinterpret_cast<const __m64*>(entries + 2 * index[3]));
+
+    // lo = v0 s0 v1 s1, hi = v2 s2 v3 s3
+    const float_4 values = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+    const float_4 slopes = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    return values + fraction * slopes;
+}
+
+inline float_4 SimdLookupTable::lookup4(const NonUniformLookupTableParams<float>& params, float_4 input)
+{
+    assert(params.isFinalized);
+    input = rack::simd::clamp(input, float_4(params.xMin), float_4(params.xMax));
+
+    // same math as NonUniformLookupTable<float>::findCell
+    const int32_4 numCells = int32_4(int(params.cellToSegment.size()));
+    int32_4 cell = (input - float_4(params.xMin)) * float_4(params.cellsPerX);
+    cell = rack::simd::ifelse(cell < int32_4::zero(), int32_4::zero(), cell);
+    cell = rack::simd::ifelse(cell < numCells, cell, numCells - int32_4(1));
+
+    int32_4 segment;
+    for (int i = 0; i < 4; ++i) {
+        segment[i] = params.cellToSegment[cell[i]];
+    }
+    const float* xs = params.xs.data();
+    for (int step = 0; step < params.maxSteps; ++step) {
+        const float_4 nextX(xs[segment[0] + 1], xs[segment[1] + 1], xs[segment[2] + 1], xs[segment[3] + 1]);
+        // mask is all ones (-1) where we need to move to the next segment
+        segment -= int32_4::cast(input >= nextX);
+    }
+
+    const float_4 x(xs[segment[0]], xs[segment[1]], xs[segment[2]], xs[segment[3]]);
+    const float* ys = params.ys.data();
+    const float_4 y(ys[segment[0]], ys[segment[1]], ys[segment[2]], ys[segment[3]]);
+    const float* as = params.as.data();
+    const float_4 a(as[segment[0]], as[segment[1]], as[segment[2]], as[segment[3]]);
+    return a * (input - x) + y;
+}
+
+inline float_8 SimdLookupTable::lookup8(const NonUniformLookupTableParams<float>& params, float_8 input)
+{
+    return float_8(lookup4(params, input.lo()), lookup4(params, input.hi()));
+}
+
+/**
+ * A bank of four lookup tables that share the same domain and bin count.
+ * The tables are interleaved, so that for each bin there is one
+ * float_4 of values followed by one float_4 of slopes.
+ *
+ * A single scalar lookup returns all four tables at once with two
+ * aligned loads, rather than four separate scalar lookups.
+ */
+class LookupTableBank4
+{
+public:
+    /**
+     * bins, xMin, xMax have the same meaning as for LookupTable<float>::init.
+     * f(x, table) is the function that table number "table" (0..3) approximates.
+     */
+    void init(int bins, float xMin, float xMax, std::function<double(double x, int table)> f);
+
+    float_4 lookup(float input) const;
+
+    bool isValid() const
+    {
+        return !entries.empty() && (xMax > xMin);
+    }
+
+private:
+    /**
+     * entries[2 * i] is the values for bin i,
+     * entries[2 * i + 1] is the slopes.
+     * The allocator keeps them 16 byte aligned, as the loads in lookup() need.
+     */
+    std::vector<float_4, AlignedAllocator<float_4>> entries;
+    int numBins_i = 0;
+    float a = 0, b = 0;
+    float xMin = 0;
+    float xMax = 0;
+};
+
+inline void LookupTableBank4::init(int bins, float x0In, float x1In, std::function<double(double x, int table)> f)
+{
+    // allocate one extra, so we can index all the way to the end...
+    entries.resize(2 * (bins + 1));
+    numBins_i = bins;
+
+    a = (float) bins / (x1In - x0In);
+    b = -a * x0In;
+
+    for (int i = 0; i <= bins; ++i) {
+        const double x0 = (i - b) / a;
+        const double x1 = ((i + 1) - b) / a;
+        for (int table = 0; table < 4; ++table) {
+            const double y0 = f(x0, table);
+            const double y1 = f(x1, table);
+            entries[2 * i][table] = (float) y0;
+            entries[2 * i + 1][table] = (float) (y1 - y0);
+        }
+    }
+    xMin = x0In;
+    xMax = x1In;
+}
+
+inline float_4 LookupTableBank4::lookup(float input) const
+{
+    assert(isValid());
+    input = std::min(input, xMax);
+    input = std::max(input, xMin);
+
+    const float scaledInput = input * a + b;
+    const int index = (int) scaledInput;
+    float fraction = scaledInput - index;
+    fraction = std::max(0.f, std::min(1.f, fraction));
+    assert(index >= 0 && index <= numBins_i);
+
+    const float_4* entry = entries.data() + 2 * index;
+    return entry[0] + float_4(fraction) * entry[1];
+}
@@ -11,7 +11,6 @@ class IMidiPlayerHost4
 public:
     virtual void setGate(int track, int voice, bool gate) = 0;
     virtual void setCV(int track, int voice, float pitch) = 0;
-    virtual void onLockFailed() = 0;
 
     /**
      * when player calls resetCLock, host must actually 
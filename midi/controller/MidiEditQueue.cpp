@@ -0,0 +1,249 @@
+
+#include "MidiEditQueue.h"
+#include "MidiTrack.h"
+
+#include <algorithm>
+#include <assert.h>
+
+MidiEditQueue::MidiEditQueue()
+{
+    tracksInUse.push_back(std::unique_ptr<MidiTrackFlat>(new MidiTrackFlat()));
+    playTrack = tracksInUse.back().get();
+    sentCapacity = playTrack->capacity();
+}
+
+bool MidiEditQueue::sendTrack(const MidiTrack& track, bool restart)
+{
+    scratch.build(track);
+    if (restart) {
+        return sendNewTrack(true);
+    }
+
+    diff();
+    const bool lengthChanged = scratch.getLength() != sent.getLength();
+    const int numEdits = int(removes.size() + inserts.size()) + (lengthChanged ? 1 : 0);
+    if (numEdits == 0) {
+        return true;
+    }
+
+    // Removes go first, so the track never gets bigger than it will end up.
+    if (numEdits > maxEditsPerTrack || scratch.getNumNotes() > sentCapacity) {
+        return sendNewTrack(false);
+    }
+
+    // Send all of it or none of it. apply will wait for the
+    // whole group to arrive before it applies any of it.
+    if (numEdits > editsToPlay.space()) {
+        return false;
+    }
+    int groupSize = numEdits;
+    auto push = [this, &groupSize](MidiEdit edit) {
+        edit.groupSize = groupSize;
+        groupSize = 0;
+        editsToPlay.push(edit);
+    };
+    for (const MidiEdit& edit : removes) {
+        push(edit);
+    }
+    for (const MidiEdit& edit : inserts) {
+        push(edit);
+    }
+    if (lengthChanged) {
+        MidiEdit edit;
+        edit.type = MidiEdit::Type::SetLength;
+        edit.startTime = scratch.getLength();
+        push(edit);
+    }
+    std::swap(sent, scratch);
+    return true;
+}
+
+bool MidiEditQueue::sendNewTrack(bool restart)
+{
+    reclaim();
+
+    // Every track we send will come back, so don't send more than tracksToFree can hold.
+    // One of the tracks in use is the one playing now.
+    if (editsToPlay.full() || int(tracksInUse.size()) > trackQueueSize) {
+        return false;
+    }
+
+    std::unique_ptr<MidiTrackFlat> newTrack(new MidiTrackFlat(scratch));
+
+    // leave room to grow, so small edits after this don't need a whole new track.
+    const int numNotes = scratch.getNumNotes();
+    newTrack->reserve(numNotes + numNotes / 2 + maxEditsPerTrack);
+    sentCapacity = newTrack->capacity();
+
+    MidiEdit edit;
+    edit.type = MidiEdit::Type::NewTrack;
+    edit.track = newTrack.get();
+    edit.restart = restart;
+    tracksInUse.push_back(std::move(newTrack));
+    editsToPlay.push(edit);
+    std::swap(sent, scratch);
+    return true;
+}
+
+bool MidiEditQueue::sendLoop(const SubrangeLoop& loop)
+{
+    if (!(loop != sentLoop)) {
+        return true;
+    }
+    if (editsToPlay.full()) {
+        return false;
+    }
+    MidiEdit edit;
+    edit.type = MidiEdit::Type::SetLoop;
+    edit.loop = loop;
+    editsToPlay.push(edit);
+    sentLoop = loop;
+    return true;
+}
+
+void MidiEditQueue::reclaim()
+{
+    while (!tracksToFree.empty()) {
+        const MidiTrackFlat* done = tracksToFree.pop();
+        auto it = std::find_if(tracksInUse.begin(), tracksInUse.end(), [done](const std::unique_ptr<MidiTrackFlat>& p) {
+            return p.get() == done;
+        });
+        assert(it != tracksInUse.end());
+        if (it != tracksInUse.end()) {
+            tracksInUse.erase(it);
+        }
+    }
+}
+
+MidiEditQueue::Changes MidiEditQueue::apply(int maxEdits)
+{
+    Changes ret;
+    int numApplied = 0;
+    while (!editsToPlay.empty()) {
+        const int groupSize = editsToPlay.peek().groupSize;
+        assert(groupSize > 0);
+
+        // The UI may still be pushing the rest of this group.
+        if (groupSize > editsToPlay.available()) {
+            break;
+        }
+        // Leave it for next time, unless it's too big to ever fit.
+        if (numApplied > 0 && numApplied + groupSize > maxEdits) {
+            break;
+        }
+        for (int i = 0; i < groupSize; ++i) {
+            applyEdit(editsToPlay.pop(), ret);
+        }
+        numApplied += groupSize;
+    }
+    return ret;
+}
+
+void MidiEditQueue::applyEdit(const MidiEdit& edit, Changes& ret)
+{
+    switch (edit.type) {
+        case MidiEdit::Type::InsertNote:
+            playTrack->insertNote(edit.startTime, edit.duration, edit.pitchCV);
+            ret.edited = true;
+            break;
+        case MidiEdit::Type::RemoveNote: {
+            const bool removed = playTrack->removeNote(edit.startTime, edit.duration, edit.pitchCV);
+            assert(removed);
+            (void) removed;
+            ret.edited = true;
+        }
+        break;
+        case MidiEdit::Type::SetLength:
+            playTrack->setLength(edit.startTime);
+            ret.edited = true;
+            break;
+        case MidiEdit::Type::SetLoop:
+            playLoop = edit.loop;
+            ret.restart = true;
+            break;
+        case MidiEdit::Type::NewTrack:
+            // sendNewTrack made sure there is room
+            assert(!tracksToFree.full());
+            tracksToFree.push(playTrack);
+            playTrack = edit.track;
+            ret.edited = true;
+            ret.restart = ret.restart || edit.restart;
+            break;
+        default:
+            assert(false);
+    }
+}
+
+MidiEditQueue::MidiEdit MidiEditQueue::makeNoteEdit(MidiEdit::Type type, const MidiTrackFlat& track, int index)
+{
+    MidiEdit edit;
+    edit.type = type;
+    edit.startTime = track.getStartTime(index);
+    edit.duration = track.getDuration(index);
+    edit.pitchCV = track.getPitchCV(index);
+    return edit;
+}
+
+/**
+ * Finds the notes in scratch that aren't in sent (inserts),
+ * and the notes in sent that aren't in scratch (removes).
+ * Both are sorted by start time, so we can walk through them together.
+ */
+void MidiEditQueue::diff()
+{
+    removes.clear();
+    inserts.clear();
+
+    int sentIndex = 0;
+    int newIndex = 0;
+    while (!sent.isEnd(sentIndex) || !scratch.isEnd(newIndex)) {
+        if (int(removes.size() + inserts.size()) > maxEditsPerTrack) {
+            // no point going on - it will be sent as a whole track.
+            return;
+        }
+        if (sent.isEnd(sentIndex) ||
+            (!scratch.isEnd(newIndex) && scratch.getStartTime(newIndex) < sent.getStartTime(sentIndex))) {
+            inserts.push_back(makeNoteEdit(MidiEdit::Type::InsertNote, scratch, newIndex++));
+        } else if (scratch.isEnd(newIndex) || sent.getStartTime(sentIndex) < scratch.getStartTime(newIndex)) {
+            removes.push_back(makeNoteEdit(MidiEdit::Type::RemoveNote, sent, sentIndex++));
+        } else {
+            // Same start time. The notes that start then may be in any order.
+            const float startTime = sent.getStartTime(sentIndex);
+            int sentEnd = sentIndex;
+            while (!sent.isEnd(sentEnd) && sent.getStartTime(sentEnd) == startTime) {
+                ++sentEnd;
+            }
+            int newEnd = newIndex;
+            while (!scratch.isEnd(newEnd) && scratch.getStartTime(newEnd) == startTime) {
+                ++newEnd;
+            }
+            diffSameStart(sentIndex, sentEnd, newIndex, newEnd);
+            sentIndex = sentEnd;
+            newIndex = newEnd;
+        }
+    }
+}
+
+void MidiEditQueue::diffSameStart(int sentBegin, int sentEnd, int newBegin, int newEnd)
+{
+    matched.assign(newEnd - newBegin, false);
+    for (int i = sentBegin; i < sentEnd; ++i) {
+        bool found = false;
+        for (int j = newBegin; j < newEnd && !found; ++j) {
+            if (!matched[j - newBegin] &&
+                scratch.getDuration(j) == sent.getDuration(i) &&
+                scratch.getPitchCV(j) == sent.getPitchCV(i)) {
+                matched[j - newBegin] = true;
+                found = true;
+            }
+        }
+        if (!found) {
+            removes.push_back(makeNoteEdit(MidiEdit::Type::RemoveNote, sent, i));
+        }
+    }
+    for (int j = newBegin; j < newEnd; ++j) {
+        if (!matched[j - newBegin]) {
+            inserts.push_back(makeNoteEdit(MidiEdit::Type::InsertNote, scratch, j));
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "AtomicRingBuffer.h"
+#include "MidiSong.h"
+#include "MidiTrackFlat.h"
+
+#include <memory>
+#include <vector>
+
+class MidiTrack;
+
+/**
+ * Carries edits from the UI thread to a track that belongs to the audio thread.
+ *
+ * The UI calls sendTrack after the song is edited. It compares the track
+ * to what it sent last time, and sends just the notes that were added or removed.
+ * The audio thread calls apply at the start of each block, which
+ * makes those same changes to its own copy of the track.
+ *
+ * Big edits (and edits that would make the audio copy grow past
+ * the room it has) send a whole new track instead.
+ *
+ * Neither side ever waits for the other, and the audio side never allocates or frees.
+ * Like the snapshots in MidiTrackPlayer, tracks the audio thread is done with
+ * are sent back, so they are only ever deleted on the UI thread.
+ */
+class MidiEditQueue
+{
+public:
+    MidiEditQueue();
+
+    /**
+     * Return value from apply.
+     * restart is set when the player should start over (a new song, or a new loop).
+     */
+    class Changes
+    {
+    public:
+        bool edited = false;
+        bool restart = false;
+    };
+
+    /************** UI thread **************/
+
+    /**
+     * Sends whatever changed in track since the last call.
+     * @param restart sends the whole track, and asks the player to start over.
+     * @returns false if there wasn't room. Try again later.
+     */
+    bool sendTrack(const MidiTrack& track, bool restart);
+
+    /**
+     * Sends the loop, if it has changed.
+     * @returns false if there wasn't room. Try again later.
+     */
+    bool sendLoop(const SubrangeLoop& loop);
+
+    /**
+     * Frees the tracks the audio thread is done with.
+     */
+    void reclaim();
+
+    /************** audio thread **************/
+
+    /**
+     * Applies the edits that are waiting, up to about maxEdits.
+     * Any more will be applied next time.
+     *
+     * Each sendTrack is applied all at once, so the player never
+     * plays a track that is half edited. If one is bigger than maxEdits
+     * it is applied on its own, so at most maxEditsPerTrack + 1 edits get applied.
+     */
+    Changes apply(int maxEdits = maxEditsPerBlock);
+
+    const MidiTrackFlat& getTrack() const
+    {
+        return *playTrack;
+    }
+
+    const SubrangeLoop& getLoop() const
+    {
+        return playLoop;
+    }
+
+    /**
+     * More notes changed than this, and sendTrack sends the whole thing.
+     */
+    static const int maxEditsPerTrack = 64;
+    static const int maxEditsPerBlock = 32;
+
+private:
+    class MidiEdit
+    {
+    public:
+        enum class Type
+        {
+            InsertNote,
+            RemoveNote,
+            SetLength,
+            SetLoop,
+            NewTrack
+        };
+        Type type = Type::InsertNote;
+        float startTime = 0;
+        float duration = 0;
+        float pitchCV = 0;
+        SubrangeLoop loop;
+        MidiTrackFlat* track = nullptr;
+        bool restart = false;
+
+        /**
+         * Edits are sent in groups that go together.
+         * The first edit in a group has the number of edits in it,
+         * the rest have zero.
+         */
+        int groupSize = 1;
+    };
+
+    static const int editQueueSize = 256;
+    static const int trackQueueSize = 8;
+    AtomicRingBuffer<MidiEdit, editQueueSize> editsToPlay;
+    AtomicRingBuffer<MidiTrackFlat*, trackQueueSize> tracksToFree;
+
+    /**
+     * UI keeps all the tracks here, including the one being played,
+     * so they never get deleted on the audio thread.
+     */
+    std::vector<std::unique_ptr<MidiTrackFlat>> tracksInUse;
+
+    /**
+     * UI side: what the audio thread's track will look like once it
+     * has applied everything we sent, and how many notes it can hold.
+     */
+    MidiTrackFlat sent;
+    int sentCapacity = 0;
+    SubrangeLoop sentLoop;
+
+    // UI side, kept around so we don't allocate for every edit.
+    MidiTrackFlat scratch;
+    std::vector<MidiEdit> removes;
+    std::vector<MidiEdit> inserts;
+    std::vector<bool> matched;
+
+    // audio side
+    MidiTrackFlat* playTrack = nullptr;
+    SubrangeLoop playLoop;
+
+    bool sendNewTrack(bool restart);
+    void applyEdit(const MidiEdit&, Changes&);
+    void diff();
+    void diffSameStart(int sentBegin, int sentEnd, int newBegin, int newEnd);
+    static MidiEdit makeNoteEdit(MidiEdit::Type, const MidiTrackFlat&, int index);
+};
@@ -532,20 +532,19 @@ void MidiEditor::updateSelectionForCursor(bool extendCurrent)
 MidiNoteEventPtr MidiEditor::getNoteUnderCursor()
 {
     const int cursorSemi = PitchUtils::cvToSemitone(seq()->context->cursorPitch());
+    const float cursorTime = seq()->context->cursorTime();
 
-    // iterate over all the notes that are in the edit context
-    auto start = seq()->context->startTime();
-    auto end = seq()->context->endTime();
-    MidiTrack::note_iterator_pair notes = getTrack()->timeRangeNotes(start, end);
-    for (auto it = notes.first; it != notes.second; ++it) {
-        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it->second);
+    // iterate over all the notes that are playing at the cursor,
+    // including long ones that started before the edit context.
+    std::vector<MidiNoteEventPtr> notes;
+    getTrack()->getNotesOverlapping(cursorTime, cursorTime, notes);
+    for (const MidiNoteEventPtr& note : notes) {
         const auto startTime = note->startTime;
         const auto endTime = note->startTime + note->duration;
 
         if ((PitchUtils::cvToSemitone(note->pitchCV) == cursorSemi) &&
-            (startTime <= seq()->context->cursorTime()) &&
-            (endTime > seq()->context->cursorTime())) {
-            //seq()->selection->select(note);
+            (startTime <= cursorTime) &&
+            (endTime > cursorTime)) {
             return note;
         }
     }
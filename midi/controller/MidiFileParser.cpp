@@ -0,0 +1,214 @@
+
+#include "MidiFileParser.h"
+
+#include <stdio.h>
+
+/**
+ * Reads big-endian numbers and variable length quantities,
+ * without ever going off the end.
+ */
+class SmfReader
+{
+public:
+    SmfReader(const uint8_t* d, size_t s) : data(d), size(s)
+    {
+    }
+
+    bool ok = true;
+
+    bool atEnd() const
+    {
+        return pos >= size;
+    }
+
+    size_t remaining() const
+    {
+        return size - pos;
+    }
+
+    const uint8_t* current() const
+    {
+        return data + pos;
+    }
+
+    uint8_t peek()
+    {
+        if (atEnd()) {
+            ok = false;
+            return 0;
+        }
+        return data[pos];
+    }
+
+    uint8_t getByte()
+    {
+        const uint8_t ret = peek();
+        if (ok) {
+            ++pos;
+        }
+        return ret;
+    }
+
+    uint32_t getBigEndian(int numBytes)
+    {
+        uint32_t ret = 0;
+        for (int i = 0; i < numBytes; ++i) {
+            ret = (ret << 8) | getByte();
+        }
+        return ret;
+    }
+
+    uint32_t getVarLen()
+    {
+        uint32_t ret = 0;
+        for (int i = 0; i < 4; ++i) {
+            const uint8_t byte = getByte();
+            ret = (ret << 7) | (byte & 0x7f);
+            if (!(byte & 0x80)) {
+                return ret;
+            }
+        }
+        ok = false;             // more than four bytes isn't legal
+        return 0;
+    }
+
+    void skip(size_t n)
+    {
+        if (n > remaining()) {
+            ok = false;
+            pos = size;
+        } else {
+            pos += n;
+        }
+    }
+
+private:
+    const uint8_t* const data;
+    const size_t size;
+    size_t pos = 0;
+};
+
+bool MidiFileParser::load(const std::string& filename, bool firstNotesOnly)
+{
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+
+    // read it all at once, then parse out of the buffer
+    std::vector<uint8_t> buffer;
+    fseek(fp, 0, SEEK_END);
+    const long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    bool ok = size > 0;
+    if (ok) {
+        buffer.resize(size);
+        ok = fread(buffer.data(), 1, size, fp) == size_t(size);
+    }
+    fclose(fp);
+    return ok && parse(buffer.data(), buffer.size(), firstNotesOnly);
+}
+
+bool MidiFileParser::parse(const uint8_t* data, size_t size, bool firstNotesOnly)
+{
+    tracks.clear();
+    SmfReader reader(data, size);
+
+    if (reader.getBigEndian(4) != 0x4d546864) {        // MThd
+        return false;
+    }
+    const uint32_t headerSize = reader.getBigEndian(4);
+    reader.getBigEndian(2);                             // format. We treat them all the same
+    const int numTracks = reader.getBigEndian(2);
+    const int division = reader.getBigEndian(2);
+    if (!reader.ok || headerSize < 6 || (division & 0x8000) || division == 0) {
+        // SMPTE time isn't supported
+        return false;
+    }
+    reader.skip(headerSize - 6);
+    ticksPerQuarterNote = division;
+
+    while (reader.ok && !reader.atEnd() && int(tracks.size()) < numTracks) {
+        const uint32_t id = reader.getBigEndian(4);
+        const uint32_t chunkSize = reader.getBigEndian(4);
+        if (!reader.ok || chunkSize > reader.remaining()) {
+            return false;
+        }
+        if (id == 0x4d54726b) {                         // MTrk
+            tracks.push_back(Track());
+            if (!parseTrack(reader.current(), chunkSize, tracks.back())) {
+                return false;
+            }
+            if (firstNotesOnly && !tracks.back().notes.empty()) {
+                return true;
+            }
+        }
+        // other chunk types are legal, and ignored
+        reader.skip(chunkSize);
+    }
+    return true;
+}
+
+bool MidiFileParser::parseTrack(const uint8_t* data, size_t size, Track& track)
+{
+    SmfReader reader(data, size);
+
+    // Note ons waiting for their note off, by channel and key.
+    // Like linkNotePairs, a note off goes with the most recent note on.
+    std::vector<std::vector<int>> pending(16 * 128);
+
+    uint32_t tick = 0;
+    uint8_t runningStatus = 0;
+    while (reader.ok && !reader.atEnd()) {
+        tick += reader.getVarLen();
+
+        uint8_t status = reader.peek();
+        if (status & 0x80) {
+            reader.getByte();
+        } else {
+            status = runningStatus;
+        }
+
+        if (status == 0xff) {
+            const uint8_t type = reader.getByte();
+            const uint32_t length = reader.getVarLen();
+            reader.skip(length);
+            if (type == 0x2f) {
+                track.haveEnd = true;
+                track.endTick = tick;
+                break;
+            }
+        } else if (status == 0xf0 || status == 0xf7) {
+            reader.skip(reader.getVarLen());
+        } else if (status >= 0x80 && status < 0xf0) {
+            runningStatus = status;
+            const int command = status & 0xf0;
+            const int channel = status & 0x0f;
+            const bool oneByte = (command == 0xc0) || (command == 0xd0);
+            const int key = reader.getByte();
+            const int velocity = oneByte ? 0 : reader.getByte();
+            if (!reader.ok) {
+                break;
+            }
+
+            std::vector<int>& waiting = pending[channel * 128 + (key & 0x7f)];
+            if (command == 0x90 && velocity > 0) {
+                Note note;
+                note.startTick = tick;
+                note.key = key;
+                waiting.push_back(int(track.notes.size()));
+                track.notes.push_back(note);
+            } else if ((command == 0x80) || (command == 0x90)) {
+                if (!waiting.empty()) {
+                    Note& note = track.notes[waiting.back()];
+                    note.durationTicks = tick - note.startTick;
+                    waiting.pop_back();
+                }
+            }
+        } else {
+            // data byte with no running status, or a system message that doesn't belong in a file
+            reader.ok = false;
+        }
+    }
+    return reader.ok;
+}
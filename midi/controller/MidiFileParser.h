@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Reads the notes out of a standard MIDI file.
+ *
+ * The midifile library builds a big object graph (a vector of bytes for every event),
+ * and we only want the notes. This reads the whole file into one buffer and
+ * decodes the tracks right out of it.
+ *
+ * Notes are paired up with their note offs the same way midifile's
+ * linkNotePairs does it, so imports come out the same.
+ */
+class MidiFileParser
+{
+public:
+    struct Note
+    {
+        uint32_t startTick = 0;
+        uint32_t durationTicks = 0;         // zero if there was no note off
+        int key = 0;
+    };
+
+    struct Track
+    {
+        std::vector<Note> notes;            // in the order they start
+        bool haveEnd = false;
+        uint32_t endTick = 0;
+    };
+
+    /**
+     * returns false if the file can't be read, or isn't a MIDI file we understand.
+     * @param firstNotesOnly stops after the first track that has notes,
+     *      which is all an import uses. The tracks after it aren't decoded at all.
+     */
+    bool load(const std::string& filename, bool firstNotesOnly = false);
+    bool parse(const uint8_t* data, size_t size, bool firstNotesOnly = false);
+
+    int getTicksPerQuarterNote() const
+    {
+        return ticksPerQuarterNote;
+    }
+
+    const std::vector<Track>& getTracks() const
+    {
+        return tracks;
+    }
+
+private:
+    int ticksPerQuarterNote = 0;
+    std::vector<Track> tracks;
+
+    static bool parseTrack(const uint8_t* data, size_t size, Track& track);
+};
@@ -1,11 +1,13 @@
 
 #include "MidiFile.h"
+#include "MidiFileParser.h"
 #include "MidiFileProxy.h"
 #include "MidiLock.h"
 #include "MidiSong.h"
 #include "TimeUtils.h"
 
 //#include <direct.h>
+#include <algorithm>
 #include <iostream>
 #include <assert.h>
 
@@ -49,73 +51,73 @@ bool MidiFileProxy::save(MidiSongPtr song, const std::string& filePath)
     return false;
 }
 
-MidiSongPtr MidiFileProxy::load(const std::string& filename)
+static MidiTrackPtr makeTrack(MidiSongPtr song, const MidiFileParser::Track& parsedTrack, int ticksPerQuarter)
 {
-    smf::MidiFile midiFile;
+    const double ppq = ticksPerQuarter;
+    MidiTrackPtr newTrack = std::make_shared<MidiTrack>(song->lock);
+    float lastNoteEnd = 0;
+    for (const MidiFileParser::Note& parsedNote : parsedTrack.notes) {
+        const double dur = double(parsedNote.durationTicks) / ppq;
+        const double start = double(parsedNote.startTick) / ppq;
+        const float pitch = PitchUtils::midiToCV(parsedNote.key);
 
-    bool b = midiFile.read(filename);
-    if (!b) {
-        printf("open failed\n");
-        return nullptr;
+        MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+        note->startTime = float(start);
+        note->duration = float(dur);
+        note->pitchCV = float(pitch);
+
+        newTrack->insertEvent(note);
+        lastNoteEnd = std::max(lastNoteEnd, note->startTime + note->duration);
     }
-    midiFile.makeAbsoluteTicks();
-    midiFile.linkNotePairs();
 
-    assert(midiFile.isAbsoluteTicks());
+    // If the file doesn't say where the track ends, end it after the last note.
+    const float end = parsedTrack.haveEnd ?
+        float(double(parsedTrack.endTick) / ppq) :
+        lastNoteEnd;
 
-    MidiSongPtr song = std::make_shared<MidiSong>();
-    MidiTrackPtr track = getFirst(song, midiFile);
-    if (!track) {
-        //printf("get first failed\n");
+    // quantize end point to 1/16 note, because that's what we support
+    float endq = (float) TimeUtils::quantize(end, .25f, false);
+    if (endq < end) {
+        endq += .25f;
+    }
+    newTrack->insertEnd(endq);
+    return newTrack;
+}
+
+/**
+ * The parser was told to stop at the first track with notes,
+ * so if there is one it is the last track.
+ */
+static MidiSongPtr makeSong(const MidiFileParser& parser)
+{
+    const std::vector<MidiFileParser::Track>& tracks = parser.getTracks();
+    if (tracks.empty() || tracks.back().notes.empty()) {
         return nullptr;
     }
-    song->addTrack(0, track);
+    MidiSongPtr song = std::make_shared<MidiSong>();
+    {
+        MidiLocker l(song->lock);
+        song->addTrack(0, makeTrack(song, tracks.back(), parser.getTicksPerQuarterNote()));
+    }
     song->assertValid();
     return song;
 }
 
-MidiTrackPtr MidiFileProxy::getFirst(MidiSongPtr song, smf::MidiFile& midiFile)
+MidiSongPtr MidiFileProxy::load(const std::string& filename)
 {
-    MidiLocker l(song->lock);
-    const double ppq = midiFile.getTicksPerQuarterNote();
-   
-    const int tracks = midiFile.getTrackCount();
-
-    bool foundNotes = false;
-    for (int track = 0; track < tracks; track++) {
-        MidiTrackPtr newTrack = std::make_shared<MidiTrack>(song->lock);;
-        for (int event = 0; event < midiFile[track].size(); event++) {
-            smf::MidiEvent& evt = midiFile[track][event];
-            if (evt.isNoteOn()) {
-                const double dur = double(evt.getTickDuration()) / ppq;
-                const double  start = double(evt.tick) / ppq;
-                const float pitch = PitchUtils::midiToCV(evt.getKeyNumber());
-
-                MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
-                note->startTime = float(start);
-                note->duration = float(dur);
-                note->pitchCV = float(pitch);
-
-                newTrack->insertEvent(note);
-                foundNotes = true;
-            } else if (evt.isEndOfTrack()) {
-                const float start =  float (double(evt.tick) / ppq);
+    MidiFileParser parser;
+    if (!parser.load(filename, true)) {
+        printf("open failed\n");
+        return nullptr;
+    }
+    return makeSong(parser);
+}
 
-                // quantize end point to 1/16 note, because that's what we support
-                float startq = (float) TimeUtils::quantize(start, .25f, false);
-                if (startq < start) {
-                    startq += .25f;
-                }
-                newTrack->insertEnd(startq);
-            } else if (evt.isTrackName()) {
-               // std::string name = evt.getMetaContent();
-               // printf("track name is %s\n", name.c_str());
-            }
-        }
-        if (foundNotes) {
-           // newTrack->_dump();
-            return newTrack;
-        }
+MidiSongPtr MidiFileProxy::load(const uint8_t* data, size_t size)
+{
+    MidiFileParser parser;
+    if (!parser.parse(data, size, true)) {
+        return nullptr;
     }
-    return nullptr;
-}
\ No newline at end of file
+    return makeSong(parser);
+}
@@ -1,12 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
-namespace smf {
-    class MidiFile;
-};
-
 class MidiSong;
 class MidiTrack;
 
@@ -17,6 +14,10 @@ class MidiFileProxy
 public:
     MidiFileProxy() = delete;
     static MidiSongPtr load(const std::string& filename);
-    static MidiTrackPtr getFirst(MidiSongPtr song, smf::MidiFile&);
+
+    /**
+     * Makes a song from the first track in the file that has notes.
+     */
+    static MidiSongPtr load(const uint8_t* data, size_t size);
     static bool save(MidiSongPtr song, const std::string& filePath);
 };
\ No newline at end of file
@@ -7,7 +7,8 @@ MidiLock::MidiLock()
 {
     theLock = false;
     editorLockLevel = 0;
-    editorDidLock = false;
+    editorDidLockSinceSnapshot = false;
+    editCount = 0;
 }
 
 MidiLockPtr MidiLock::make()
@@ -18,14 +19,11 @@ MidiLockPtr MidiLock::make()
 void MidiLock::editorLock()
 {
     if (editorLockLevel == 0) {
-
-        // poll to take lock
-        for (bool done = false; !done; ) {
-            done = tryLock();
-        }
+        theLock = true;
     }
     ++editorLockLevel;
-    editorDidLock = true;
+    editorDidLockSinceSnapshot = true;
+    ++editCount;
 }
 
 void MidiLock::editorUnlock()
@@ -35,36 +33,21 @@ void MidiLock::editorUnlock()
     }
 }
 
-bool MidiLock::playerTryLock()
-{
-    // try once to take lock
-    return tryLock();
-}
-
-void MidiLock::playerUnlock()
+bool MidiLock::locked() const
 {
-    assert(locked());
-    theLock = false;
+    return theLock;
 }
 
-bool MidiLock::tryLock()
+bool MidiLock::snapshotDirty()
 {
-    bool expected = false;
-    bool desired = true;
-    bool ret = theLock.compare_exchange_weak(expected, desired);
+    bool ret = editorDidLockSinceSnapshot;
+    editorDidLockSinceSnapshot = false;
     return ret;
 }
 
-bool MidiLock::locked() const
-{
-    return theLock;
-}
-
-bool MidiLock::dataModelDirty() 
+unsigned int MidiLock::getEditCount() const
 {
-    bool ret = editorDidLock;
-    editorDidLock = false;
-    return ret;
+    return editCount;
 }
 
 /***********************************************************************/
@@ -6,6 +6,14 @@
 class MidiLock;
 using MidiLockPtr = std::shared_ptr<MidiLock>;
 
+/**
+ * MidiLock marks the song as being edited.
+ *
+ * Only the UI thread takes it. Nothing on the audio thread reads the song
+ * any more (the players get copies), so the lock is never contended.
+ * The UI code that makes those copies uses locked() to skip a song
+ * that is half edited, and the dirty flag or the edit count to know when to make new ones.
+ */
 class MidiLock
 {
 public:
@@ -16,22 +24,27 @@ public:
     void editorLock();
     void editorUnlock();
 
-    bool playerTryLock();
-    void playerUnlock();
     bool locked() const;
 
-    /** 
-     * Returns true is an editor lock has occurred since last query.
+    /**
+     * Returns true if an editor lock has occurred since last query.
      * Will clear flag after calling.
+     * For the UI code that sends edits of the song to the player.
      */
-    bool dataModelDirty();
+    bool snapshotDirty();
+
+    /**
+     * Goes up every time the editor locks.
+     * Unlike the dirty flag, any number of clients can each
+     * remember the last count they saw.
+     */
+    unsigned int getEditCount() const;
 
 private:
     std::atomic<bool> theLock;
     std::atomic<int> editorLockLevel;
-    std::atomic<bool> editorDidLock;
-
-    bool tryLock();
+    std::atomic<bool> editorDidLockSinceSnapshot;
+    std::atomic<unsigned int> editCount;
 };
 
 /**
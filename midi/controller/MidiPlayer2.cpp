@@ -16,7 +16,11 @@ MidiPlayer2::MidiPlayer2(std::shared_ptr<IMidiPlayerHost4> host, std::shared_ptr
         vx.setHost(host.get());
         vx.setIndex(i);
     }
-//    loopParams = nullptr;
+
+    // nothing can be in the queue yet, so these can't fail.
+    trackEditCount = track->lock->getEditCount();
+    edits.sendTrack(*track, true);
+    edits.sendLoop(song->getSubrangeLoop());
 }
 
 void MidiPlayer2::setSong(std::shared_ptr<MidiSong> newSong)
@@ -26,6 +30,36 @@ void MidiPlayer2::setSong(std::shared_ptr<MidiSong> newSong)
     assert(newSong->lock->locked());
     song = newSong;
     track = song->getTrack(0);
+    trackEditCount = track->lock->getEditCount();
+
+    // The new song plays from the start. The locks are held, so we can send it now.
+    edits.sendLoop(song->getSubrangeLoop());
+    restartPending = !edits.sendTrack(*track, true);
+    sendPending = restartPending;
+}
+
+void MidiPlayer2::sendEdits()
+{
+    // Edits to the track lock the track's lock. That is usually the song's lock,
+    // but in remote edit mode the track belongs to another module's song.
+    // That song's player watches the same lock, so use the edit count rather than
+    // the dirty flag, which only one of us could see.
+    const MidiLock& trackLock = *track->lock;
+
+    // If the editor is in the middle of an edit, we will get it next time.
+    if (!song->lock->locked() && !trackLock.locked()) {
+        const unsigned int editCount = trackLock.getEditCount();
+        if (editCount != trackEditCount) {
+            trackEditCount = editCount;
+            sendPending = true;
+        }
+        if (sendPending && edits.sendTrack(*track, restartPending)) {
+            sendPending = false;
+            restartPending = false;
+        }
+        edits.sendLoop(song->getSubrangeLoop());
+    }
+    edits.reclaim();
 }
 
 void MidiPlayer2::reset(bool clearGates, bool)
@@ -41,6 +75,12 @@ void MidiPlayer2::setNumVoices(int track, int voices)
     voiceAssigner.setNumVoices(voices);
 }
 
+void MidiPlayer2::setStealPolicy(int track, MidiVoiceAssigner::StealPolicy policy)
+{
+    assert(track == 0);
+    voiceAssigner.setStealPolicy(policy);
+}
+
 void MidiPlayer2::setSampleCountForRetrigger(int samples)
 {
     for (int i = 0; i < maxVoices; ++i) {
@@ -63,11 +103,9 @@ double MidiPlayer2::getCurrentLoopIterationStart() const
 
 float MidiPlayer2::getCurrentSubrangeLoopStart() const
 {
-    float ret = 0;
-    if (song->getSubrangeLoop().enabled) {
-        ret += song->getSubrangeLoop().startTime;
-    }
-    return ret;
+    // the loop we are playing, not the one in the song (that belongs to the UI)
+    const SubrangeLoop& loop = edits.getLoop();
+    return loop.enabled ? loop.startTime : 0;
 }
 
 void MidiPlayer2::updateToMetricTime(double metricTime, float quantizationInterval, bool running)
@@ -77,24 +115,47 @@ void MidiPlayer2::updateToMetricTime(double metricTime, float quantizationInterv
 #endif
     assert(quantizationInterval != 0);
 
+    applyEdits(quantizationInterval);
     if (!running) {
-        // If seq is paused, leave now so we don't act on the dirty flag when stopped.
         return;
     }
 
-    const bool acquiredLock = song->lock->playerTryLock();
-    if (acquiredLock) {
-        if (song->lock->dataModelDirty()) {
-            reset(false);
-        }
-        updateToMetricTimeInternal(metricTime, quantizationInterval);
-        song->lock->playerUnlock();
-    } else {
+    updateToMetricTimeInternal(metricTime, quantizationInterval);
+}
+
+void MidiPlayer2::applyEdits(float quantizationInterval)
+{
+    const MidiEditQueue::Changes changes = edits.apply();
+    if (changes.restart) {
         reset(false);
-        host->onLockFailed();
+    } else if (changes.edited && !isReset) {
+        // The notes moved around under us. Pick up where we left off.
+        if (havePlayed) {
+            seekAfter(lastMetricTime, quantizationInterval);
+        } else {
+            curEvent = 0;
+        }
     }
 }
 
+void MidiPlayer2::seekAfter(double metricTime, float quantizationInterval)
+{
+    // find the first event that we haven't played yet.
+    const MidiTrackFlat& playTrack = edits.getTrack();
+    int low = 0;
+    int high = playTrack.getNumNotes();
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        const double eventStart = TimeUtils::quantize(currentLoopIterationStart + playTrack.getStartTime(mid), quantizationInterval, true);
+        if (eventStart <= metricTime) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    curEvent = low;
+}
+
 void MidiPlayer2::updateToMetricTimeInternal(double metricTime, float quantizationInterval)
 {
     metricTime = TimeUtils::quantize(metricTime, quantizationInterval, true);
@@ -102,26 +163,29 @@ void MidiPlayer2::updateToMetricTimeInternal(double metricTime, float quantizati
     // start all over from beginning. Or, if reset initiated by user.
     if (isReset) {
         // printf("\nupdatetometrictimeinternal  player proc reset\n");
-        curEvent = track->begin();
+        curEvent = 0;
         resetAllVoices(isResetGates);
         voiceAssigner.reset();
         isReset = false;
         isResetGates = false;
         currentLoopIterationStart = 0;
+        havePlayed = false;
     }
 
 
     // To implement loop start, we just push metric time up to where we want to start.
     // TODO: skip over initial stuff?
     
-    if (song->getSubrangeLoop().enabled) {
-   // if (loopParams && loopParams.load()->enabled) {
-        metricTime += song->getSubrangeLoop().startTime;
+    const SubrangeLoop& loop = edits.getLoop();
+    if (loop.enabled) {
+        metricTime += loop.startTime;
     }
      // keep processing events until we are caught up
     while (playOnce(metricTime, quantizationInterval)) {
 
     }
+    lastMetricTime = metricTime;
+    havePlayed = true;
 }
 
 bool MidiPlayer2::playOnce(double metricTime, float quantizeInterval)
@@ -136,46 +200,41 @@ bool MidiPlayer2::playOnce(double metricTime, float quantizeInterval)
         return true;
     }
 
+    const MidiTrackFlat& playTrack = edits.getTrack();
+
     // push the start time up by loop start, so that event t==loop start happens at start of loop
-    const double eventStartUnQuantized = (currentLoopIterationStart + curEvent->first);
+    const double eventStartUnQuantized = (currentLoopIterationStart + playTrack.getStartTime(curEvent));
 
     // Treat loop end just like track end. loop back around
     // when we pass then end.
-    if (song->getSubrangeLoop().enabled) {
-        auto loopEnd = song->getSubrangeLoop().endTime + currentLoopIterationStart;
+    const SubrangeLoop& loop = edits.getLoop();
+    if (loop.enabled) {
+        auto loopEnd = loop.endTime + currentLoopIterationStart;
         if (loopEnd <= metricTime) {
-            currentLoopIterationStart += (song->getSubrangeLoop().endTime - song->getSubrangeLoop().startTime);
-            curEvent = track->begin();
+            currentLoopIterationStart += (loop.endTime - loop.startTime);
+            curEvent = 0;
             return true;
         }
     }
 
     const double eventStart = TimeUtils::quantize(eventStartUnQuantized, quantizeInterval, true);
     if (eventStart <= metricTime) {
-        MidiEventPtr event = curEvent->second;
-        switch (event->type) {
-            case MidiEvent::Type::Note:
-            {
-                MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(event);
-  
-                // find a voice to play
-                MidiVoice* voice = voiceAssigner.getNext(note->pitchCV);
-                assert(voice);
-
-                // play the note
-                const double durationQuantized = TimeUtils::quantize(note->duration, quantizeInterval, false);  
-                double quantizedNoteEnd = TimeUtils::quantize(durationQuantized + eventStart, quantizeInterval, false);
-                voice->playNote(note->pitchCV, float(eventStart), float(quantizedNoteEnd));
-                ++curEvent;
-            }
-            break;
-            case MidiEvent::Type::End:
-                // for now, should loop.
-                currentLoopIterationStart += curEvent->first;
-                curEvent = track->begin();
-                break;
-            default:
-                assert(false);
+        if (!playTrack.isEnd(curEvent)) {
+            const float pitchCV = playTrack.getPitchCV(curEvent);
+
+            // find a voice to play
+            MidiVoice* voice = voiceAssigner.getNext(pitchCV);
+            assert(voice);
+
+            // play the note
+            const double durationQuantized = TimeUtils::quantize(playTrack.getDuration(curEvent), quantizeInterval, false);  
+            double quantizedNoteEnd = TimeUtils::quantize(durationQuantized + eventStart, quantizeInterval, false);
+            voice->playNote(pitchCV, float(eventStart), float(quantizedNoteEnd));
+            ++curEvent;
+        } else {
+            // for now, should loop.
+            currentLoopIterationStart += playTrack.getLength();
+            curEvent = 0;
         }
         didSomething = true;
     }
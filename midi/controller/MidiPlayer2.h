@@ -5,16 +5,29 @@
 class MidiSong;
 class IMidiPlayerHost4;
 
-#include "MidiTrack.h"
+#include "MidiEditQueue.h"
 #include "MidiVoice.h"
 #include "MidiVoiceAssigner.h"
 
+/**
+ * Plays the first track of a MidiSong.
+ *
+ * The player has its own copy of the track, which the UI keeps up to date
+ * by calling sendEdits. So the player never has to lock the song,
+ * and editing never has to wait for the player.
+ */
 class MidiPlayer2
 {
 public:
     MidiPlayer2(std::shared_ptr<IMidiPlayerHost4> host, std::shared_ptr<MidiSong> song);
     void setSong(std::shared_ptr<MidiSong> song);
 
+    /**
+     * Must be called from the UI thread, periodically.
+     * Sends any edits to the song over to the player.
+     */
+    void sendEdits();
+
     /**
      * Main "play something" function.
      * @param metricTime is the current time where 1 = quarter note.
@@ -32,6 +45,12 @@ public:
      */
     void setNumVoices(int trackNumber, int voices);
 
+    /**
+     * Which voice to take when they are all busy.
+     * trackNumber must be zero, as above.
+     */
+    void setStealPolicy(int trackNumber, MidiVoiceAssigner::StealPolicy);
+
     /**
      * resets all internal playback state.
      * @param clearGate will set the host's gate low, if true
@@ -55,10 +74,10 @@ private:
     /***************************************
      * Variables  to play one track
      */
-    MidiTrack::const_iterator curEvent;
+    int curEvent = 0;
 
     /**
-     * when starting, or when reset by lock contention
+     * when starting, or when the song changes
      */
     bool isReset = true;
     bool isResetGates = false;
@@ -66,8 +85,24 @@ private:
     double currentLoopIterationStart = 0;
     int numVoices=1;
 
+    /**
+     * The metric time we have played up to, so we can find our place
+     * again after an edit. Only valid if havePlayed.
+     */
+    double lastMetricTime = 0;
+    bool havePlayed = false;
+
+    /**
+     * The UI side of edits uses these
+     */
     std::shared_ptr<MidiTrack> track;
+    unsigned int trackEditCount = 0;
+    bool sendPending = false;
+    bool restartPending = false;
+    MidiEditQueue edits;
 
+    void applyEdits(float quantizationInterval);
+    void seekAfter(double metricTime, float quantizationInterval);
     void updateToMetricTimeInternal(double, float);
     bool playOnce(double metricTime, float quantizeInterval);
     bool pollForNoteOff(double metricTime);
@@ -2,6 +2,7 @@
 #include "MidiLock.h"
 #include "MidiPlayer4.h"
 #include "MidiSong4.h"
+#include "MidiSong4Snapshot.h"
 #include "MidiTrackPlayer.h"
 #include "TimeUtils.h"
 
@@ -27,8 +28,23 @@ void MidiPlayer4::setSong(std::shared_ptr<MidiSong4> newSong)
   //  track = song->getTrack(0);
 
     song = newSong;
+    auto snapshot = std::make_shared<const MidiSong4Snapshot>(*song);
     for (int i = 0; i<MidiSong4::numTracks; ++i) {
-        trackPlayers[i]->setSong(song, i);
+        trackPlayers[i]->setSong(song, i, snapshot);
+    }
+}
+
+void MidiPlayer4::updateSnapshot()
+{
+    // If the editor is in the middle of an edit, we will get it next time.
+    if (!song->lock->locked() && song->lock->snapshotDirty()) {
+        auto snapshot = std::make_shared<const MidiSong4Snapshot>(*song);
+        for (int i = 0; i < MidiSong4::numTracks; ++i) {
+            trackPlayers[i]->setSnapshot(snapshot);
+        }
+    }
+    for (int i = 0; i < MidiSong4::numTracks; ++i) {
+        trackPlayers[i]->reclaimSnapshots();
     }
 }
 
@@ -80,19 +96,8 @@ void MidiPlayer4::updateToMetricTime(double metricTime, float quantizationInterv
     }
 #endif
 
-    const bool acquiredLock = song->lock->playerTryLock();
-    if (acquiredLock) {
-        if (song->lock->dataModelDirty()) {
-            reset(true, false);         // reset all the gates. we need to do this, because we
-                                        // only replay the current section, so we are probably at a 
-                                        // different rotation when reset, than when played straight
-        }
-        updateToMetricTimeInternal(metricTime, quantizationInterval);
-        song->lock->playerUnlock();
-    } else {
-        reset(true, false);
-        host->onLockFailed();
-    }
+    // No lock here. The track players only look at their snapshots, which never change.
+    updateToMetricTimeInternal(metricTime, quantizationInterval);
 }
 
 void MidiPlayer4::updateToMetricTimeInternal(double metricTime, float quantizationInterval)
@@ -115,7 +120,7 @@ void MidiPlayer4::updateToMetricTimeInternal(double metricTime, float quantizati
 
      // keep processing events until we are caught up
     for (int i=0; i < MidiSong4::numTracks; ++i) {
-        auto trackPlayer = trackPlayers[i];
+        auto& trackPlayer = trackPlayers[i];
         assert(trackPlayer);
         while (trackPlayer->playOnce(metricTime, quantizationInterval)) {
         }
@@ -170,6 +175,12 @@ void MidiPlayer4::setNumVoices(int track, int numVoices)
 
 }
 
+void MidiPlayer4::setStealPolicy(int track, MidiVoiceAssigner::StealPolicy policy)
+{
+    assert(track >= 0 && track < 4);
+    trackPlayers[track]->setStealPolicy(policy);
+}
+
 void MidiPlayer4::setSampleCountForRetrigger(int count)
 {
      for (int i=0; i < MidiSong4::numTracks; ++i) {
@@ -182,7 +193,7 @@ void MidiPlayer4::setSampleCountForRetrigger(int count)
 void MidiPlayer4::updateSampleCount(int numElapsed)
 {
      for (int i=0; i < MidiSong4::numTracks; ++i) {
-        auto trackPlayer = trackPlayers[i];
+        auto& trackPlayer = trackPlayers[i];
         assert(trackPlayer);
         trackPlayer->updateSampleCount(numElapsed);
     }
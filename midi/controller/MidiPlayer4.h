@@ -22,6 +22,13 @@ public:
     void setSong(std::shared_ptr<MidiSong4> song);
     MidiSong4Ptr getSong();
 
+    /**
+     * Called on the UI thread, often.
+     * If the song has been edited, sends a new snapshot of it to the track players.
+     * Also frees the snapshots they are done with.
+     */
+    void updateSnapshot();
+
     /**
      * Main "play something" function.
      * @param metricTime is the current time where 1 = quarter note.
@@ -37,6 +44,7 @@ public:
     void step();
 
     void setNumVoices(int track, int numVoices);
+    void setStealPolicy(int track, MidiVoiceAssigner::StealPolicy);
     void setSampleCountForRetrigger(int);
     void updateSampleCount(int numElapsed);
 
@@ -9,7 +9,9 @@
 #include "engine/Port.hpp"
 #endif
 
+#include <algorithm>
 #include <assert.h>
+#include <limits>
 #include <stdio.h>
 
 // #define _LOGX
@@ -30,10 +32,47 @@ private:
 };
 
 
-void MidiTrackPlayer::setSong(std::shared_ptr<MidiSong4> newSong, int _trackIndex) {
+void MidiTrackPlayer::setSong(std::shared_ptr<MidiSong4> newSong, int _trackIndex, MidiSong4SnapshotPtr snapshot) {
     assert(_trackIndex == constTrackIndex);     // we don't expect anyone to change this
-    eventQ.newSong = newSong;                   // queue up the song to be moved on next play call
     uiSong = newSong;                              // and immediately use it as UI song.
+    if (!snapshot) {
+        snapshot = std::make_shared<const MidiSong4Snapshot>(*newSong);
+    }
+    sendSnapshot(snapshot, true);               // queue up the song to be moved on next play call
+}
+
+void MidiTrackPlayer::setSnapshot(MidiSong4SnapshotPtr snapshot) {
+    sendSnapshot(snapshot, false);
+}
+
+void MidiTrackPlayer::sendSnapshot(MidiSong4SnapshotPtr snapshot, bool isNewSong) {
+    // if a new song is still waiting to go, an edit must not make us forget it's new.
+    pendingIsNewSong = isNewSong || (pendingSnapshot && pendingIsNewSong);
+    pendingSnapshot = snapshot;
+    reclaimSnapshots();
+}
+
+void MidiTrackPlayer::reclaimSnapshots() {
+    while (!snapshotsToFree.empty()) {
+        const MidiSong4Snapshot* done = snapshotsToFree.pop();
+        auto it = std::find_if(snapshotsInUse.begin(), snapshotsInUse.end(), [done](const MidiSong4SnapshotPtr& p) {
+            return p.get() == done;
+        });
+        assert(it != snapshotsInUse.end());
+        if (it != snapshotsInUse.end()) {
+            snapshotsInUse.erase(it);
+        }
+    }
+
+    if (pendingSnapshot && !snapshotsToPlay.full()) {
+        SnapshotMessage msg;
+        msg.snapshot = pendingSnapshot.get();
+        msg.isNewSong = pendingIsNewSong;
+        snapshotsInUse.push_back(pendingSnapshot);
+        snapshotsToPlay.push(msg);
+        pendingSnapshot.reset();
+        pendingIsNewSong = false;
+    }
 }
 
 // TODO: move this all the playback
@@ -63,7 +102,8 @@ void MidiTrackPlayer::setSong(std::shared_ptr<MidiSong4> newSong, int _trackInde
 
 
 // This can be sued for UI song or playback.song
-int MidiTrackPlayer::validateSectionRequest(int section, std::shared_ptr<MidiSong4> song, int trackNumber) {
+template <class TSongPtr>
+int MidiTrackPlayer::validateSectionRequest(int section, TSongPtr song, int trackNumber) {
     assert(song);
    // assert(song ==  playback.inPlayCode ? playback.song : uiSong);
     int nextSection = section;
@@ -86,6 +126,7 @@ int MidiTrackPlayer::validateSectionRequest(int section, std::shared_ptr<MidiSon
 }
 
 void MidiTrackPlayer::resetAllVoices(bool clearGates) {
+    playback.nextEventTimeValid = false;
     for (int i = 0; i < numVoices; ++i) {
         voices[i].reset(clearGates);
     }
@@ -125,10 +166,17 @@ MidiTrackPlayer::MidiTrackPlayer(
 }
 
 void MidiTrackPlayer::setNumVoices(int _numVoices) {
+    if (_numVoices != numVoices) {
+        playback.nextEventTimeValid = false;
+    }
     this->numVoices = _numVoices;
     voiceAssigner.setNumVoices(numVoices);
 }
 
+void MidiTrackPlayer::setStealPolicy(MidiVoiceAssigner::StealPolicy policy) {
+    voiceAssigner.setStealPolicy(policy);
+}
+
 void MidiTrackPlayer::setNextSectionRequest(int section) {
     // printf("called set next section with %d\n", section);
 
@@ -168,7 +216,7 @@ void MidiTrackPlayer::setSampleCountForRetrigger(int numSamples) {
 
 // maybe we should be rid of this accessor??
 MidiSong4Ptr MidiTrackPlayer::getSong() {
-    return playback.song;
+    return uiSong;
 }
 
 /******************************* non-playback code typically called from proc ******************/
@@ -315,6 +363,14 @@ bool MidiTrackPlayer::playOnce(double metricTime, float quantizeInterval) {
         return false;
     }
 
+    // Between events there is nothing to do, so don't bother looking at the voices or the track.
+    if (playback.nextEventTimeValid &&
+        (metricTime < playback.nextEventTime) &&
+        (quantizeInterval == playback.nextEventQuantizeInterval)) {
+        return false;
+    }
+    playback.nextEventTimeValid = false;
+
     bool didSomething = false;
 
     didSomething = pollForNoteOff(metricTime);
@@ -324,11 +380,15 @@ bool MidiTrackPlayer::playOnce(double metricTime, float quantizeInterval) {
 
     if (!playback.curTrack) {
         // should be possible if we keep int curPlaybackSection
+        scheduleNextEvent(std::numeric_limits<double>::max(), quantizeInterval);
         return false;
     }
 
+    const MidiTrackFlat& track = *playback.curTrack;
+    const int eventIndex = playback.curEvent;
+
     // push the start time up by loop start, so that event t==loop start happens at start of loop
-    const double eventStartUnQuantized = (playback.currentLoopIterationStart + playback.curEvent->first);
+    const double eventStartUnQuantized = (playback.currentLoopIterationStart + track.getStartTime(eventIndex));
 
     const double eventStart = TimeUtils::quantize(eventStartUnQuantized, quantizeInterval, true);
 
@@ -341,43 +401,42 @@ bool MidiTrackPlayer::playOnce(double metricTime, float quantizeInterval) {
     }
 #endif
     if (eventStart <= metricTime) {
-        MidiEventPtr event = playback.curEvent->second;
-        switch (event->type) {
-            case MidiEvent::Type::Note: {
-#ifdef _LOGX
-                {
-                    if (constTrackIndex == 0) {
-                        MidiEventPtr ev = curEvent->second;
-                        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(ev);
-                        assert(note);
-                        printf("MidiTrackPlayer:playOnce.pitch = %.2f\n", note->pitchCV);
-                    }
-                }
-#endif
-                MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(event);
-
-                // find a voice to play
-                MidiVoice* voice = voiceAssigner.getNext(note->pitchCV);
-                assert(voice);
-
-                // play the note
-                const double durationQuantized = TimeUtils::quantize(note->duration, quantizeInterval, false);
-                double quantizedNoteEnd = TimeUtils::quantize(durationQuantized + eventStart, quantizeInterval, false);
-                voice->playNote(note->pitchCV, float(eventStart), float(quantizedNoteEnd));
-                ++playback.curEvent;
-                // printfprintf("just inc curEvent 129\n");
-            } break;
-            case MidiEvent::Type::End:
-                onEndOfTrack();
-                break;
-            default:
-                assert(false);
+        if (track.isEnd(eventIndex)) {
+            onEndOfTrack();
+        } else {
+            const float pitchCV = track.getPitchCV(eventIndex);
+
+            // find a voice to play
+            MidiVoice* voice = voiceAssigner.getNext(pitchCV);
+            assert(voice);
+
+            // play the note
+            const double durationQuantized = TimeUtils::quantize(track.getDuration(eventIndex), quantizeInterval, false);
+            double quantizedNoteEnd = TimeUtils::quantize(durationQuantized + eventStart, quantizeInterval, false);
+            voice->playNote(pitchCV, float(eventStart), float(quantizedNoteEnd));
+            ++playback.curEvent;
         }
         didSomething = true;
+    } else {
+        scheduleNextEvent(eventStart, quantizeInterval);
     }
     return didSomething;
 }
 
+void MidiTrackPlayer::scheduleNextEvent(double eventStart, float quantizeInterval)
+{
+    double next = eventStart;
+    for (int i = 0; i < numVoices; ++i) {
+        const double noteOff = voices[i].getNoteOffTime();
+        if (noteOff >= 0 && noteOff < next) {
+            next = noteOff;
+        }
+    }
+    playback.nextEventTime = next;
+    playback.nextEventQuantizeInterval = quantizeInterval;
+    playback.nextEventTimeValid = true;
+}
+
 
 /*
 what we want:
@@ -392,31 +451,46 @@ bool MidiTrackPlayer::serviceEventQueue()
     assert(playback.inPlayCode);
     bool resetClock = false;
     bool isNewSong = false;
+    bool isEdited = false;
 
     //printf("serviceEventQueue\n");
 
-    // newSong is where we store the song that should be treated as "new"
-    MidiSong4Ptr newSong;
+    // Pick up the latest snapshot from the UI. We can only let go of the old
+    // one if there is room to send it back.
+    while (!snapshotsToPlay.empty() && (!playback.song || !snapshotsToFree.full())) {
+        const SnapshotMessage msg = snapshotsToPlay.pop();
+        if (playback.song) {
+            snapshotsToFree.push(playback.song);
+        }
+        playback.song = msg.snapshot;
+        playback.nextEventTimeValid = false;
+        if (msg.isNewSong) {
+            isNewSong = true;
+        } else {
+            isEdited = true;
+        }
+    }
 
-    if (eventQ.newSong) {
-        // move the song from the Q to newSong
-        newSong = eventQ.newSong;
-        eventQ.newSong.reset();
-        isNewSong = true;
-        // printf("serviceQ new song\n");
-    } 
+    // newSong is true if the song should be treated as "new"
+    bool newSong = isNewSong;
+
+    if (isEdited && !isNewSong) {
+        // The song was edited. We only replay the current section, so we are probably
+        // at a different rotation than if played straight. Start it over, and clear the gates.
+        resetFromQueue(false);
+        resetAllVoices(true);
+    }
 
     if (eventQ.reset) {
         // This doesn't do anything at the moment
         resetFromQueue(eventQ.resetSections);
+        playback.nextEventTimeValid = false;
 
          //printf("serviceQ reset\n");
         // for "hard reset, re-init the whole song. This will take us back to the start";
         if (eventQ.resetSections) {
            //  printf("serviceQ resetSections\n");
-            if (!newSong) {
-                newSong = playback.song;
-            }
+            newSong = true;
         }
         eventQ.reset = false;
         eventQ.resetSections = false;
@@ -424,7 +498,7 @@ bool MidiTrackPlayer::serviceEventQueue()
 
     if (newSong) {
         // printf("serviceQ setSongFromQ\n");
-        setSongFromQueue(newSong);
+        setSongFromQueue();
     }
 
     const bool shouldDoNewSectionImmediately = isNewSong || eventQ.startupTriggered;
@@ -449,6 +523,7 @@ bool MidiTrackPlayer::serviceEventQueue()
 
         // set curTrack, curEvent, loop Counter, and reset clock
         setPlaybackTrackFromSongAndSection();
+        playback.nextEventTimeValid = false;
         resetClock = true;
 
 #ifdef _LOGX
@@ -476,7 +551,7 @@ void MidiTrackPlayer::resetFromQueue(bool resetSectionIndex) {
     playback.curTrack = playback.song->getTrack(constTrackIndex, playback.curSectionIndex);
     if (playback.curTrack) {
         // can we really handle not having a track?
-        playback.curEvent = playback.curTrack->begin();
+        playback.curEvent = 0;
         //printf("reset put cur event back\n");
     }
 
@@ -542,10 +617,8 @@ void MidiTrackPlayer::resetFromQueue(bool resetSectionIndex) {
     #endif
 }
 
-void MidiTrackPlayer::setSongFromQueue(std::shared_ptr<MidiSong4> newSong)
+void MidiTrackPlayer::setSongFromQueue()
 {
-    playback.song = newSong;
-
     setupToPlayFirstTrackSection();
     setPlaybackTrackFromSongAndSection();
 }
@@ -565,7 +638,7 @@ void MidiTrackPlayer::setPlaybackTrackFromSongAndSection()
     playback.curTrack = playback.song->getTrack(constTrackIndex, playback.curSectionIndex);
     if (playback.curTrack) {
         // can we really handle not having a track?
-        playback.curEvent = playback.curTrack->begin();
+        playback.curEvent = 0;
 #ifdef _LOGX
         if (constTrackIndex == 0)
         {
@@ -599,7 +672,7 @@ void MidiTrackPlayer::onEndOfTrack() {
     fflush(stdout);
 #endif
     // for now, should loop.
-    playback.currentLoopIterationStart += playback.curEvent->first;
+    playback.currentLoopIterationStart += playback.curTrack->getLength();
 
     // If there is a section change queued up, do it.
     if (eventQ.nextSectionIndex > 0) {
@@ -629,7 +702,7 @@ void MidiTrackPlayer::onEndOfTrack() {
             // Then I think all we need to do is reset the pointer, 
             // and update the loop counter for the UI
             assert(playback.curTrack);
-            playback.curEvent = playback.curTrack->begin();
+            playback.curEvent = 0;
             // printf("at end, keep looping set totalRepeatCount to %d\n", totalRepeatCount);
         } else {
             assert(sectionLoopCounter >= 0);
@@ -643,7 +716,7 @@ void MidiTrackPlayer::onEndOfTrack() {
     }
 
     assert(playback.curTrack);
-    playback.curEvent = playback.curTrack->begin();
+    playback.curEvent = 0;
 }
 
 void MidiTrackPlayer::setupToPlayFirstTrackSection() {
@@ -664,7 +737,8 @@ void MidiTrackPlayer::setupToPlayFirstTrackSection() {
 
 void MidiTrackPlayer::dumpCurEvent(const char* msg)
 {
-    printf("dumpCurEvent: %s tkIndex=%d, time=%.2f, evtp=%p\n", msg, constTrackIndex, playback.curEvent->first, playback.curEvent->second.get());
+    printf("dumpCurEvent: %s tkIndex=%d, time=%.2f, index=%d\n", msg, constTrackIndex,
+        playback.curTrack->getStartTime(playback.curEvent), playback.curEvent);
 }
 
 void MidiTrackPlayer::setupToPlayDifferentSection(int section) {
@@ -686,7 +760,7 @@ void MidiTrackPlayer::setupToPlayCommon() {
     if (playback.curTrack) {
         // printf("got new track in setupToPlayCommon. here's track\n");
         // curTrack->_dump();
-        playback.curEvent = playback.curTrack->begin();
+        playback.curEvent = 0;
         auto opts = playback.song->getOptions(constTrackIndex, playback.curSectionIndex);
         assert(opts);
         if (opts) {
@@ -704,7 +778,7 @@ void MidiTrackPlayer::setupToPlayCommon() {
 void MidiTrackPlayer::setupToPlayNextSection() {
     assert(playback.inPlayCode);
     playback.curTrack = nullptr;
-    MidiTrackPtr tk = nullptr;
+    const MidiTrackFlat* tk = nullptr;
     while (!tk) {
         if (++playback.curSectionIndex > 3) {
             playback.curSectionIndex = 0;
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "AtomicRingBuffer.h"
 #include "GateTrigger.h"
+#include "MidiSong4Snapshot.h"
 #include "MidiTrack.h"
+#include "MidiTrackFlat.h"
 #include "MidiVoice.h"
 #include "MidiVoiceAssigner.h"
 #include "SqPort.h"
 
 #include <memory>
+#include <vector>
 
 class IMidiPlayerHost4;
 class MidiSong4;
@@ -30,7 +34,26 @@ class MidiTrack;
 class MidiTrackPlayer {
 public:
     MidiTrackPlayer(std::shared_ptr<IMidiPlayerHost4> host, int trackIndex, std::shared_ptr<MidiSong4> song);
-    void setSong(std::shared_ptr<MidiSong4> newSong, int trackIndex);
+
+    /**
+     * Called from the UI thread.
+     * @param snapshot is the copy of newSong that we will play.
+     *      If null, we will make one.
+     */
+    void setSong(std::shared_ptr<MidiSong4> newSong, int trackIndex, MidiSong4SnapshotPtr snapshot = nullptr);
+
+    /**
+     * Called from the UI thread after the song has been edited.
+     * Playback will switch to the new snapshot next time it runs.
+     */
+    void setSnapshot(MidiSong4SnapshotPtr snapshot);
+
+    /**
+     * Called from the UI thread, every so often.
+     * Frees the snapshots playback is done with.
+     */
+    void reclaimSnapshots();
+
     void resetAllVoices(bool clearGates);
 
     /**
@@ -46,6 +69,7 @@ public:
     void step();
     void reset(bool resetGates, bool resetSectionIndex);
     void setNumVoices(int numVoices);
+    void setStealPolicy(MidiVoiceAssigner::StealPolicy);
     void setSampleCountForRetrigger(int);
     void updateSampleCount(int numElapsed);
     std::shared_ptr<MidiSong4> getSong();
@@ -144,6 +168,12 @@ private:
     bool isPlaying = false;    
 
     bool pollForNoteOff(double metricTime);
+
+    /**
+     * Figures out when playOnce will next have something to do.
+     * @param eventStart is the quantized start time of curEvent.
+     */
+    void scheduleNextEvent(double eventStart, float quantizeInterval);
     void setupToPlayFirstTrackSection();
 
     /**
@@ -165,7 +195,13 @@ private:
      * returns true if clock was reset
      */
     bool serviceEventQueue();
-    void setSongFromQueue(std::shared_ptr<MidiSong4>);
+    void setSongFromQueue();
+
+    /**
+     * Sends a snapshot to playback, or holds onto it
+     * if the queue is full.
+     */
+    void sendSnapshot(MidiSong4SnapshotPtr snapshot, bool isNewSong);
 
     /**
      * Based on current song and section,
@@ -180,7 +216,8 @@ private:
      *      otherwise will search forward for one to play.
      *      Will return 0 if there are no playable sections.
      */
-    static int validateSectionRequest(int section, std::shared_ptr<MidiSong4> song, int trackNumber);
+    template <class TSongPtr>
+    static int validateSectionRequest(int section, TSongPtr song, int trackNumber);
 
     void dumpCurEvent(const char*);
 
@@ -206,9 +243,10 @@ private:
         bool inPlayCode = false;
 
         /**
-         * The song we are currently playing
+         * The song we are currently playing.
+         * Owned by snapshotsInUse, on the UI side.
          */
-        std::shared_ptr<MidiSong4> song;
+        const MidiSong4Snapshot* song = nullptr;
 
         /**
          * abs metric time of start of current section's current loop.
@@ -216,14 +254,29 @@ private:
          */
         double currentLoopIterationStart = 0;
 
-        std::shared_ptr<MidiTrack> curTrack;
+        const MidiTrackFlat* curTrack = nullptr;
 
         /**
-         * event iterator that playback uses. Advances each
-         * time an event is played from the track.
+         * Index of the next event to play in curTrack.
+         * Advances each time an event is played from the track.
          * We also set it on set song, but maybe that should be queued also?
          */
-        MidiTrack::const_iterator curEvent;
+        int curEvent = 0;
+
+        /**
+         * The metric time of the next thing this track has to do: start
+         * the next note, or stop a playing one. Until then playOnce has nothing to do.
+         * Anything that moves curEvent or changes the voices must clear nextEventTimeValid.
+         *
+         * This is used instead of a per-block schedule of sample offsets. Metric time
+         * only moves when an external clock edge arrives, so the sample an event will fall on
+         * isn't known until that edge comes in. Events were always quantized to clock edges,
+         * so nothing is lost: an event plays on the same sample as the clock edge that reaches it,
+         * with no jitter beyond the clock's own, at any tempo.
+         */
+        double nextEventTime = 0;
+        float nextEventQuantizeInterval = 0;
+        bool nextEventTimeValid = false;
     };
 
     /**
@@ -250,16 +303,33 @@ private:
          */
         bool eventsHappenImmediately = false;
 
-        /** When UI wants to set a new song, it gets queued here.
-         */
-        std::shared_ptr<MidiSong4> newSong;
-
         bool reset = false;
         bool resetSections = false;
         bool resetGates = false;
         bool startupTriggered = false;
     };
 
+    /**
+     * Snapshots go from the UI to playback in snapshotsToPlay.
+     * When playback is done with one, it sends it back in snapshotsToFree.
+     * UI keeps a reference to all of them in snapshotsInUse, so
+     * they never get deleted on the audio thread.
+     */
+    class SnapshotMessage {
+    public:
+        const MidiSong4Snapshot* snapshot = nullptr;
+        bool isNewSong = false;
+    };
+    AtomicRingBuffer<SnapshotMessage, 8> snapshotsToPlay;
+    AtomicRingBuffer<const MidiSong4Snapshot*, 16> snapshotsToFree;
+    std::vector<MidiSong4SnapshotPtr> snapshotsInUse;
+
+    /**
+     * If snapshotsToPlay was full, the latest snapshot waits here.
+     */
+    MidiSong4SnapshotPtr pendingSnapshot;
+    bool pendingIsNewSong = false;
+
     EventQ eventQ;
     Playback playback;
     GateTrigger cv0Trigger;
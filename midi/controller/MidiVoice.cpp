@@ -102,6 +102,11 @@ void MidiVoice::playNote(float pitch, double currentTime, float endTime)
     }
 }
 
+double MidiVoice::getNoteOffTime() const
+{
+    return (curState == State::ReTriggering) ? delayedNoteEndtime : noteOffTime;
+}
+
 bool MidiVoice::updateToMetricTime(double metricTime)
 {
     bool ret = false;
@@ -49,6 +49,13 @@ public:
 
     void updateSampleCount(int samples);
 
+    /**
+     * @returns the metric time when this voice will next turn its gate off,
+     * or -1 if there is no note playing.
+     * Includes the note that is waiting for a re-trigger to finish.
+     */
+    double getNoteOffTime() const;
+
     /**
      * resets all internal playback state.
      * @param clearGate will set the host's gate low, if true
@@ -1,10 +1,13 @@
-
 #include "MidiVoiceAssigner.h"
 #include "MidiVoice.h"
 
 #include <assert.h>
 #include <stdio.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 MidiVoiceAssigner::MidiVoiceAssigner(MidiVoice* vx, int maxVoices) :
     voices(vx),
     maxVoices(maxVoices),
@@ -19,6 +22,10 @@ MidiVoiceAssigner::MidiVoiceAssigner(MidiVoice* vx, int maxVoices) :
 void MidiVoiceAssigner::reset()
 {
     nextVoice = 0;
+    counter = 0;
+    for (int i = 0; i < maxVoices; ++i) {
+        startCount[i] = 0;
+    }
 }
 
 void MidiVoiceAssigner::setNumVoices(int voices)
@@ -30,6 +37,11 @@ void MidiVoiceAssigner::setNumVoices(int voices)
     }
 }
 
+void MidiVoiceAssigner::setStealPolicy(StealPolicy policy)
+{
+    stealPolicy = policy;
+}
+
 MidiVoice* MidiVoiceAssigner::getNext(float pitch)
 {
     MidiVoice * nextVoice = nullptr;
@@ -40,6 +52,10 @@ MidiVoice* MidiVoiceAssigner::getNext(float pitch)
         default:
             assert(false);
     }
+
+    const int index = int(nextVoice - voices);
+    startCount[index] = ++counter;
+    assignedPitch[index] = pitch;
 #if defined(_MLOG)
     printf("MidiVoiceAssigner::getNext(pitch=%.2f), ret voice #%d state=%d\n",
         pitch, nextVoice->_getIndex(), nextVoice->state()); 
@@ -61,34 +77,116 @@ int MidiVoiceAssigner::advance(int vxNum)
     return wrapAround(vxNum + 1);
 }
 
+int MidiVoiceAssigner::firstBit(uint32_t x)
+{
+    assert(x);
+#if defined(_MSC_VER)
+    unsigned long ret;
+    _BitScanForward(&ret, x);
+    return int(ret);
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
 MidiVoice* MidiVoiceAssigner::getNextReUse(float pitch)
 {
     assert(numVoices > 0);
 
-    // first, look for a voice already playing this pitch, but idle
+    // One pass to find the idle voices, and the first idle one already at this pitch.
+    // The voices change state on their own, so we can't keep a free list up to date.
+    uint32_t idleMask = 0;
+    int samePitch = -1;
     for (int i = 0; i < numVoices; ++i) {
-        if ((voices[i].pitch() == pitch) &&
-         (voices[i].state() == MidiVoice::State::Idle)) {
-            // OK, we found an idle voice at the desired pitch
-            if (i == nextVoice) {
-                nextVoice = advance(nextVoice);
+        if (voices[i].state() == MidiVoice::State::Idle) {
+            idleMask |= 1u << i;
+            if (samePitch < 0 && voices[i].pitch() == pitch) {
+                samePitch = i;
             }
-            return voices + i;
         }
     }
 
-    // next, look for any idle voice, starting at next voice
-    for (int i = 0; i < numVoices; ++i) {
-        int candidateVoice = wrapAround(i + nextVoice);
-     
-        if (voices[candidateVoice].state() == MidiVoice::State::Idle) {
-            nextVoice = advance(candidateVoice);
-            return voices + candidateVoice;
+    // first, use a voice already playing this pitch, but idle
+    if (samePitch >= 0) {
+        if (samePitch == nextVoice) {
+            nextVoice = advance(nextVoice);
         }
+        return voices + samePitch;
+    }
+
+    // next, use the first idle voice at or after next voice
+    if (idleMask) {
+        const uint32_t atOrAfterNext = idleMask >> nextVoice;
+        const int candidateVoice = atOrAfterNext ?
+            nextVoice + firstBit(atOrAfterNext) :
+            firstBit(idleMask);
+        nextVoice = advance(candidateVoice);
+        return voices + candidateVoice;
     }
 
-    // If no idle voices, use the next one
-    int i = nextVoice;
-    nextVoice = advance(nextVoice);
-    return voices + i;            
-}
\ No newline at end of file
+    return voices + steal(pitch);
+}
+
+int MidiVoiceAssigner::steal(float pitch)
+{
+    int ret = -1;
+    switch (stealPolicy) {
+        case StealPolicy::Next:
+            ret = nextVoice;
+            nextVoice = advance(nextVoice);
+            break;
+        case StealPolicy::Oldest:
+            ret = stealOldest();
+            break;
+        case StealPolicy::SoonestEnd:
+            ret = 0;
+            for (int i = 1; i < numVoices; ++i) {
+                if (voices[i].getNoteOffTime() < voices[ret].getNoteOffTime()) {
+                    ret = i;
+                }
+            }
+            break;
+        case StealPolicy::Lowest:
+            ret = 0;
+            for (int i = 1; i < numVoices; ++i) {
+                if (assignedPitch[i] < assignedPitch[ret]) {
+                    ret = i;
+                }
+            }
+            break;
+        case StealPolicy::Highest:
+            ret = 0;
+            for (int i = 1; i < numVoices; ++i) {
+                if (assignedPitch[i] > assignedPitch[ret]) {
+                    ret = i;
+                }
+            }
+            break;
+        case StealPolicy::SamePitch:
+            for (int i = 0; i < numVoices && ret < 0; ++i) {
+                if (assignedPitch[i] == pitch) {
+                    ret = i;
+                }
+            }
+            if (ret < 0) {
+                ret = stealOldest();
+            }
+            break;
+        default:
+            assert(false);
+            ret = 0;
+    }
+    return ret;
+}
+
+int MidiVoiceAssigner::stealOldest() const
+{
+    // the counter will wrap eventually, so compare by how long ago each one started
+    int ret = 0;
+    for (int i = 1; i < numVoices; ++i) {
+        if ((counter - startCount[i]) > (counter - startCount[ret])) {
+            ret = i;
+        }
+    }
+    return ret;
+}
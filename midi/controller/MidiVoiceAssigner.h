@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 class MidiVoice;
 
 class MidiVoiceAssigner
@@ -10,8 +12,23 @@ public:
         ReUse,          // default
         Rotate
     };
+
+    /**
+     * Which voice to take when all of them are busy.
+     */
+    enum class StealPolicy
+    {
+        Next,           // default. keep rotating through the voices
+        Oldest,         // the voice that started playing first
+        SoonestEnd,     // the voice whose note will end first
+        Lowest,         // the voice playing the lowest pitch
+        Highest,        // the voice playing the highest pitch
+        SamePitch       // a voice already playing this pitch, otherwise the oldest
+    };
+
     MidiVoiceAssigner(MidiVoice* vx, int maxVoices);
     void setNumVoices(int);
+    void setStealPolicy(StealPolicy);
     MidiVoice* getNext(float pitch);
     void reset();
 private:
@@ -21,8 +38,20 @@ private:
     int nextVoice = 0;
 
     Mode mode = Mode::ReUse;
+    StealPolicy stealPolicy = StealPolicy::Next;
+
+    /**
+     * What we last handed out each voice for. We keep our own copy
+     * of the pitch, because a voice that is re-triggering still reports the old one.
+     */
+    uint32_t startCount[16] = {};
+    float assignedPitch[16] = {};
+    uint32_t counter = 0;
 
     MidiVoice* getNextReUse(float pitch);
+    int steal(float pitch);
+    int stealOldest() const;
     int wrapAround(int vxNum);
     int advance(int vxNum);
-};
\ No newline at end of file
+    static int firstBit(uint32_t);
+};
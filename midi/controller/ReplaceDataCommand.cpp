@@ -77,13 +77,7 @@ void ReplaceDataCommand::execute(MidiSequencerPtr seq, SequencerWidget*)
         mt->setLength(newTrackLength);
     }
 
-    for (auto it : addData) {
-        mt->insertEvent(it);
-    }
-
-    for (auto it : removeData) {
-        mt->deleteEvent(*it);
-    }
+    mt->replaceEvents(removeData, addData);
 
     //  if we need to make track shorter, do it last
     if (isNewLengthRequested && !isNewLengthLonger) {
@@ -103,11 +97,11 @@ void ReplaceDataCommand::execute(MidiSequencerPtr seq, SequencerWidget*)
 
     seq->assertValid();
     
-    for (auto it : addData) {
-        auto foundIter = mt->findEventDeep(*it);      // find an event in the track that matches the one we just inserted
-        assert(foundIter != mt->end());
-        MidiEventPtr evt = foundIter->second;
-        selection->extendSelection(evt);
+    // replaceEvents always leaves the added events themselves in the track,
+    // so there is no need to go find them.
+    for (const MidiEventPtr& it : addData) {
+        assert(mt->findEventPointer(it) != mt->end());
+        selection->extendSelection(it);
     }
     seq->assertValid();
 }
@@ -130,12 +124,7 @@ void ReplaceDataCommand::undo(MidiSequencerPtr seq, SequencerWidget*)
     }
 
     // to undo the insertion, delete all of them
-    for (auto it : addData) {
-        mt->deleteEvent(*it);
-    }
-    for (auto it : removeData) {
-        mt->insertEvent(it);
-    }
+    mt->replaceEvents(addData, removeData);
 
         // If we need to make track shorter, do it last
     if (isNewLengthRequested && !isNewLengthLonger) {
@@ -145,11 +134,9 @@ void ReplaceDataCommand::undo(MidiSequencerPtr seq, SequencerWidget*)
     MidiSelectionModelPtr selection = seq->selection;
     assert(selection);
     selection->clear();
-    for (auto it : removeData) {
-        auto foundIter = mt->findEventDeep(*it);      // find an event in the track that matches the one we just inserted
-        assert(foundIter != mt->end());
-        MidiEventPtr evt = foundIter->second;
-        selection->extendSelection(evt);
+    for (const MidiEventPtr& it : removeData) {
+        assert(mt->findEventPointer(it) != mt->end());
+        selection->extendSelection(it);
     }
     // TODO: move cursor
 }
@@ -188,47 +175,39 @@ ReplaceDataCommandPtr ReplaceDataCommand::makeChangeNoteCommand(
     std::vector<MidiEventPtr> toAdd;
     std::vector<MidiEventPtr> toRemove;
 
-    float newTrackLength = -1;         // assume we won't need to change track length
-    if (canChangeLength) {
-        // Figure out the duration of the track after xforming the notes
-        MidiSelectionModelPtr clonedSelection = seq->selection->clone();
-        // find required length
-        MidiEndEventPtr end = seq->context->getTrack()->getEndEvent();
-        float endTime = end->startTime;
-
-        int index = 0;  // hope index is stable across clones
-        for (auto it : *clonedSelection) {
-            MidiEventPtr ev = it;
-            xform(ev, index++);
-            float t = ev->startTime;
-            MidiNoteEventPtrC note = safe_cast<MidiNoteEvent>(ev);
-            if (note) {
-                t += note->duration;
-            }
-            endTime = std::max(endTime, t);
-        }
+    toAdd.reserve(seq->selection->size());
+    toRemove.reserve(seq->selection->size());
 
-        // now end time is the required duration
-        // set up events to extend to that length
-        newTrackLength = calculateDurationRequest(seq, endTime);
-    }
+    // Figure out the duration of the track after xforming the notes
+    MidiEndEventPtr end = seq->context->getTrack()->getEndEvent();
+    float endTime = end->startTime;
 
-    MidiSelectionModelPtr clonedSelection = seq->selection->clone();
-
-    // will remove existing selection
-    for (auto it : *seq->selection) {
+    // Remove the existing selection, and add back transformed clones of it.
+    // One pass, no intermediate selection.
+    int index = 0;
+    for (const MidiEventPtr& it : *seq->selection) {
         auto note = safe_cast<MidiNoteEvent>(it);
         if (note) {
             toRemove.push_back(note);
         }
-    }
 
-    // and add back the transformed notes
-    int index=0;
-    for (auto it : *clonedSelection) {
-        MidiEventPtr event = it;
+        MidiEventPtr event = it->clone();
         xform(event, index++);
         toAdd.push_back(event);
+
+        float t = event->startTime;
+        MidiNoteEventPtrC newNote = safe_cast<MidiNoteEvent>(event);
+        if (newNote) {
+            t += newNote->duration;
+        }
+        endTime = std::max(endTime, t);
+    }
+
+    float newTrackLength = -1;         // assume we won't need to change track length
+    if (canChangeLength) {
+        // now end time is the required duration
+        // set up events to extend to that length
+        newTrackLength = calculateDurationRequest(seq, endTime);
     }
 
     ReplaceDataCommandPtr ret = std::make_shared<ReplaceDataCommand>(
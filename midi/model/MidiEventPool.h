@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+/**
+ * A pool of fixed size memory blocks.
+ *
+ * Editing a big track clones thousands of events, and each clone
+ * used to be a trip to the heap. Freed blocks go on a free list,
+ * so the next clone just pops one off.
+ *
+ * Memory is grabbed from the heap in chunks, and never given back.
+ * Events are made and freed on the UI thread, but also by file import and the
+ * clipboard, so the free list is protected by a mutex.
+ */
+template <size_t BlockSize>
+class MidiEventPool
+{
+public:
+    static MidiEventPool& get()
+    {
+        // Never deleted, so events that die during static destruction still have a pool to go back to.
+        static MidiEventPool* pool = new MidiEventPool();
+        return *pool;
+    }
+
+    void* allocate()
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!freeList) {
+            addChunk();
+        }
+        Block* ret = freeList;
+        freeList = freeList->next;
+        return ret;
+    }
+
+    void deallocate(void* p)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        Block* block = static_cast<Block*>(p);
+        block->next = freeList;
+        freeList = block;
+    }
+
+private:
+    union Block
+    {
+        Block* next;
+        typename std::aligned_storage<BlockSize, alignof(std::max_align_t)>::type storage;
+    };
+
+    static const int blocksPerChunk = 256;
+
+    std::mutex mutex;
+    Block* freeList = nullptr;
+
+    MidiEventPool() = default;
+
+    void addChunk()
+    {
+        Block* chunk = new Block[blocksPerChunk];
+        for (int i = 0; i < blocksPerChunk; ++i) {
+            chunk[i].next = freeList;
+            freeList = chunk + i;
+        }
+    }
+};
+
+/**
+ * Standard allocator that gets single objects from MidiEventPool.
+ * Use with std::allocate_shared, so the event and its ref count
+ * come from the pool in one block.
+ */
+template <typename T>
+class MidiEventAllocator
+{
+public:
+    using value_type = T;
+
+    MidiEventAllocator() = default;
+    template <typename U>
+    MidiEventAllocator(const MidiEventAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(MidiEventPool<sizeof(T)>::get().allocate());
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (n != 1) {
+            ::operator delete(p);
+            return;
+        }
+        MidiEventPool<sizeof(T)>::get().deallocate(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator == (const MidiEventAllocator<T>&, const MidiEventAllocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator != (const MidiEventAllocator<T>&, const MidiEventAllocator<U>&)
+{
+    return false;
+}
@@ -67,6 +67,7 @@ void MidiSelectionModel::addToSelection(std::shared_ptr<MidiEvent> event, bool k
 
     if (!keepExisting) {
         selection.clear();
+        ++changes;
     }
     add(event);
 }
@@ -77,6 +78,7 @@ void MidiSelectionModel::removeFromSelection(std::shared_ptr<MidiEvent> event)
     assert(it != selection.end());
     if (it != selection.end()) {
         selection.erase(it);
+        ++changes;
     }
 }
 
@@ -105,21 +107,24 @@ void MidiSelectionModel::clear()
 {
     selection.clear();
     allIsSelected = false;
+    ++changes;
 }
 
 void MidiSelectionModel::add(MidiEventPtr evt)
 {
-    auto found = selection.find(evt);
-    if (found != selection.end()) {
-        // if the event is already there, don't do anything.
+    // Events usually come in order, so try the end first.
+    const size_t oldSize = selection.size();
+    selection.insert(selection.end(), evt);
+    if (selection.size() == oldSize) {
+        // if the event was already there, don't do anything.
         return;
     }
+    ++changes;
 
     MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(evt);
     if (note && !auditionSuppressed) {
         auditionHost->auditionNote(note->pitchCV);
     }
-    selection.insert(evt);
 }
 
 bool MidiSelectionModel::isSelected(MidiEventPtr evt) const
@@ -166,9 +171,9 @@ MidiSelectionModelPtr MidiSelectionModel::clone() const
     // Clones ones never need to drive audition
     auto nullAudition = std::make_shared<NullAudition>();
     MidiSelectionModelPtr ret = std::make_shared<MidiSelectionModel>(nullAudition);
-    for (auto it : selection) {
-        MidiEventPtr clonedEvent = it->clone();
-        ret->add(clonedEvent);
+    for (const MidiEventPtr& it : selection) {
+        // the clones sort the same as the originals, so they always go on the end
+        ret->selection.insert(ret->selection.end(), it->clone());
     }
     return ret;
 }
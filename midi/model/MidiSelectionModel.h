@@ -88,6 +88,15 @@ public:
      */
     bool isSelectedDeep(MidiEventPtr event) const;
 
+    /**
+     * Goes up every time the selection changes.
+     * Lets the UI tell if it needs to redraw.
+     */
+    unsigned int getChangeCount() const
+    {
+        return changes;
+    }
+
     IMidiPlayerAuditionHostPtr _testGetAudition();
 
 private:
@@ -99,4 +108,5 @@ private:
     IMidiPlayerAuditionHostPtr auditionHost;
     bool auditionSuppressed = false;
     bool allIsSelected = false;
+    unsigned int changes = 0;
 };
@@ -0,0 +1,37 @@
+
+#include "MidiSong4Snapshot.h"
+#include "MidiTrack4Options.h"
+
+#include <assert.h>
+
+MidiSong4Snapshot::MidiSong4Snapshot(MidiSong4& song)
+{
+    for (int track = 0; track < MidiSong4::numTracks; ++track) {
+        for (int section = 0; section < MidiSong4::numSectionsPerTrack; ++section) {
+            MidiTrackPtr tk = song.getTrack(track, section);
+            if (tk) {
+                tracks[track][section].build(*tk);
+                hasTrack[track][section] = true;
+            }
+            options[track][section] = song.getOptions(track, section);
+        }
+    }
+}
+
+const MidiTrackFlat* MidiSong4Snapshot::getTrack(int trackIndex, int sectionIndex) const
+{
+    if (trackIndex < 0 || trackIndex >= MidiSong4::numTracks || sectionIndex < 0 || sectionIndex >= MidiSong4::numSectionsPerTrack) {
+        assert(false);
+        return nullptr;
+    }
+    return hasTrack[trackIndex][sectionIndex] ? &tracks[trackIndex][sectionIndex] : nullptr;
+}
+
+MidiTrack4Options* MidiSong4Snapshot::getOptions(int trackIndex, int sectionIndex) const
+{
+    if (trackIndex < 0 || trackIndex >= MidiSong4::numTracks || sectionIndex < 0 || sectionIndex >= MidiSong4::numSectionsPerTrack) {
+        assert(false);
+        return nullptr;
+    }
+    return options[trackIndex][sectionIndex].get();
+}
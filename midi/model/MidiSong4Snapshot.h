@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MidiSong4.h"
+#include "MidiTrackFlat.h"
+
+#include <memory>
+
+class MidiSong4Snapshot;
+using MidiSong4SnapshotPtr = std::shared_ptr<const MidiSong4Snapshot>;
+
+/**
+ * An immutable copy of a MidiSong4, for the player.
+ *
+ * The UI makes a new one after every edit, and hands it to the player,
+ * so the player never has to look at (or lock) the song that is being edited.
+ *
+ * The notes are copied, but the options are shared with the song.
+ * They are just a repeat count that the UI pokes directly.
+ */
+class MidiSong4Snapshot
+{
+public:
+    MidiSong4Snapshot(MidiSong4&);
+    MidiSong4Snapshot(const MidiSong4Snapshot&) = delete;
+    const MidiSong4Snapshot& operator = (const MidiSong4Snapshot&) = delete;
+
+    /**
+     * Returns nullptr if there is no track in that section.
+     */
+    const MidiTrackFlat* getTrack(int trackIndex, int sectionIndex) const;
+    MidiTrack4Options* getOptions(int trackIndex, int sectionIndex) const;
+
+private:
+    MidiTrackFlat tracks[MidiSong4::numTracks][MidiSong4::numSectionsPerTrack];
+    bool hasTrack[MidiSong4::numTracks][MidiSong4::numSectionsPerTrack] = {{false}};
+    MidiTrack4OptionsPtr options[MidiSong4::numTracks][MidiSong4::numSectionsPerTrack];
+};
@@ -70,6 +70,26 @@ void MidiTrack::insertEvent(MidiEventPtr evIn)
     assert(lock);
     assert(lock->locked());
     events.insert(std::pair<MidiEvent::time_t, MidiEventPtr>(evIn->startTime, evIn));
+    addToIndex(evIn);
+}
+
+void MidiTrack::addToIndex(const MidiEventPtr& ev)
+{
+    if (ev->type == MidiEvent::Type::Note) {
+        index.insert(safe_cast<MidiNoteEvent>(ev));
+    }
+}
+
+void MidiTrack::removeFromIndex(const MidiEventPtr& ev)
+{
+    if (ev->type == MidiEvent::Type::Note) {
+        index.remove(static_cast<const MidiNoteEvent*>(ev.get()));
+    }
+}
+
+void MidiTrack::getNotesOverlapping(MidiEvent::time_t start, MidiEvent::time_t end, std::vector<MidiNoteEventPtr>& notes) const
+{
+    index.getNotes(start, end, notes);
 }
 
 float MidiTrack::getLength() const
@@ -95,6 +115,7 @@ void MidiTrack::deleteEvent(const MidiEvent& evIn)
     for (auto it = candidateRange.first; it != candidateRange.second; it++) {
 
         if (*it->second == evIn) {
+            removeFromIndex(it->second);
             events.erase(it);
             return;
         }
@@ -105,6 +126,81 @@ void MidiTrack::deleteEvent(const MidiEvent& evIn)
     assert(false);          // If you get here it means the event to be deleted was not in the track
 }
 
+void MidiTrack::replaceEvents(const std::vector<MidiEventPtr>& toRemove, const std::vector<MidiEventPtr>& toAdd)
+{
+    assert(lock);
+    assert(lock->locked());
+
+    // For a few events it's cheaper to just poke them into the map.
+    if ((toRemove.size() + toAdd.size()) * 4 < events.size()) {
+        for (const MidiEventPtr& ev : toAdd) {
+            insertEvent(ev);
+        }
+        for (const MidiEventPtr& ev : toRemove) {
+            deleteEvent(*ev);
+        }
+        return;
+    }
+
+    auto earlier = [](const MidiEventPtr& a, const MidiEventPtr& b) {
+        return a->startTime < b->startTime;
+    };
+    // stable, so that events at the same time keep their order, just like insertEvent
+    std::vector<MidiEventPtr> adds(toAdd);
+    std::stable_sort(adds.begin(), adds.end(), earlier);
+    std::vector<MidiEventPtr> removes(toRemove);
+    std::stable_sort(removes.begin(), removes.end(), earlier);
+
+    container newEvents;
+    std::vector<MidiEventPtr> group;        // everything at one time
+    auto oldIt = events.begin();
+    auto addIt = adds.begin();
+    auto removeIt = removes.begin();
+    while (oldIt != events.end() || addIt != adds.end()) {
+        MidiEvent::time_t t;
+        if (oldIt == events.end()) {
+            t = (*addIt)->startTime;
+        } else if (addIt == adds.end()) {
+            t = oldIt->first;
+        } else {
+            t = std::min(oldIt->first, (*addIt)->startTime);
+        }
+
+        // existing events first, then the new ones, same as if we had inserted them.
+        group.clear();
+        for (; oldIt != events.end() && oldIt->first == t; ++oldIt) {
+            group.push_back(oldIt->second);
+        }
+        for (; addIt != adds.end() && (*addIt)->startTime == t; ++addIt) {
+            group.push_back(*addIt);
+            addToIndex(*addIt);
+        }
+
+        // like deleteEvent, each removal takes out the first match
+        for (; removeIt != removes.end() && (*removeIt)->startTime <= t; ++removeIt) {
+            const MidiEvent& evRemove = **removeIt;
+            auto found = std::find_if(group.begin(), group.end(), [&evRemove](const MidiEventPtr& ev) {
+                return ev && *ev == evRemove;
+            });
+            if (found == group.end()) {
+                printf("could not delete event %p\n", &evRemove);
+                assert(false);      // If you get here it means the event to be deleted was not in the track
+                continue;
+            }
+            removeFromIndex(*found);
+            found->reset();
+        }
+
+        for (MidiEventPtr& ev : group) {
+            if (ev) {
+                newEvents.emplace_hint(newEvents.end(), t, std::move(ev));
+            }
+        }
+    }
+    assert(removeIt == removes.end());
+    events.swap(newEvents);
+}
+
 void MidiTrack::setLength(float newTrackLength)
 {
     assert(lock);
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "FilteredIterator.h"
+#include "MidiTrackIndex.h"
 #include "SqCommand.h"
 
 #include "SqMidiEvent.h"
@@ -34,6 +35,15 @@ public:
     void deleteEvent(const MidiEvent&);
     void insertEnd(MidiEvent::time_t time);
 
+    /**
+     * Inserts all of toAdd, then deletes all of toRemove.
+     * Same result as calling insertEvent and deleteEvent for each one,
+     * but big batches (like editing a select-all) are merged into the track in one pass.
+     * Either way, the events in toAdd are the ones that end up in the track, even
+     * if toRemove has an identical one.
+     */
+    void replaceEvents(const std::vector<MidiEventPtr>& toRemove, const std::vector<MidiEventPtr>& toAdd);
+
     float getLength() const;
     std::shared_ptr<MidiEndEvent> getEndEvent();
     std::shared_ptr<MidiNoteEvent> getFirstNote();
@@ -57,6 +67,14 @@ public:
     using note_iterator_pair = std::pair<note_iterator, note_iterator>;
     note_iterator_pair timeRangeNotes(MidiEvent::time_t start, MidiEvent::time_t end) const;
 
+    /**
+     * Gets all the notes that start in the range start <= t <= end, and also the ones that
+     * start earlier but are still playing at start. Sorted by start time.
+     * Unlike timeRangeNotes, this only looks at the notes near the range, so it is fast
+     * even on a huge track.
+     */
+    void getNotesOverlapping(MidiEvent::time_t start, MidiEvent::time_t end, std::vector<MidiNoteEventPtr>& notes) const;
+
     /**
      * finds an event that satisfies == and returns a pointer to it
      */
@@ -116,6 +134,10 @@ public:
     std::shared_ptr<MidiLock> lock;
 private:
     container events;
+    MidiTrackIndex index;
+
+    void addToIndex(const MidiEventPtr&);
+    void removeFromIndex(const MidiEventPtr&);
 
     static MidiTrackPtr makeTest1(std::shared_ptr<MidiLock>);
     static MidiTrackPtr makeTestCmaj(std::shared_ptr<MidiLock>);
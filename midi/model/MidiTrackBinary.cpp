@@ -0,0 +1,357 @@
+
+#include "MidiLock.h"
+#include "MidiTrack.h"
+#include "MidiTrackBinary.h"
+#include "PitchUtils.h"
+
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+
+// same numbers SequencerSerializer uses for JSON
+static const int typeNote = 1;
+static const int typeEnd = 2;
+
+static uint32_t floatToBits(float x)
+{
+    uint32_t ret;
+    memcpy(&ret, &x, sizeof(ret));
+    return ret;
+}
+
+static float bitsToFloat(uint32_t x)
+{
+    float ret;
+    memcpy(&ret, &x, sizeof(ret));
+    return ret;
+}
+
+static bool sameBits(float a, float b)
+{
+    return floatToBits(a) == floatToBits(b);
+}
+
+static float ticksToTime(int64_t ticks)
+{
+    return float(ticks) / float(MidiTrackBinary::ticksPerQuarterNote);
+}
+
+static int64_t timeToTicks(float time)
+{
+    return std::llround(double(time) * MidiTrackBinary::ticksPerQuarterNote);
+}
+
+static float semitoneToPitch(int64_t semitone)
+{
+    const PitchUtils::NormP p{int(semitone)};
+    return PitchUtils::pitchToCV(p.oct, p.semi);
+}
+
+class BinaryWriter
+{
+public:
+    std::vector<uint8_t> data;
+
+    void putVarint(uint64_t x)
+    {
+        while (x >= 0x80) {
+            data.push_back(uint8_t(x | 0x80));
+            x >>= 7;
+        }
+        data.push_back(uint8_t(x));
+    }
+
+    /**
+     * Low bit zero: the rest is a zig-zag encoded integer.
+     * Low bit one: a raw float follows.
+     */
+    void putInt(int64_t x)
+    {
+        const uint64_t zigZag = (uint64_t(x) << 1) ^ uint64_t(x >> 63);
+        putVarint(zigZag << 1);
+    }
+
+    void putRaw(float x)
+    {
+        putVarint(1);
+        const uint32_t bits = floatToBits(x);
+        for (int i = 0; i < 4; ++i) {
+            data.push_back(uint8_t(bits >> (8 * i)));
+        }
+    }
+
+    void putTime(float time, int64_t& lastTicks)
+    {
+        const int64_t ticks = timeToTicks(time);
+        if (sameBits(ticksToTime(ticks), time)) {
+            putInt(ticks - lastTicks);
+        } else {
+            putRaw(time);
+        }
+        lastTicks = ticks;
+    }
+
+    void putDuration(float duration)
+    {
+        const int64_t ticks = timeToTicks(duration);
+        if (sameBits(ticksToTime(ticks), duration)) {
+            putInt(ticks);
+        } else {
+            putRaw(duration);
+        }
+    }
+
+    void putPitch(float pitchCV)
+    {
+        const int semitone = PitchUtils::cvToSemitone(pitchCV);
+        if (sameBits(semitoneToPitch(semitone), pitchCV)) {
+            putInt(semitone);
+        } else {
+            putRaw(pitchCV);
+        }
+    }
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const std::vector<uint8_t>& d) : data(d)
+    {
+    }
+
+    bool ok = true;
+
+    bool atEnd() const
+    {
+        return pos >= data.size();
+    }
+
+    uint64_t getVarint()
+    {
+        uint64_t ret = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (atEnd()) {
+                ok = false;
+                return 0;
+            }
+            const uint8_t byte = data[pos++];
+            ret |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return ret;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    /**
+     * Returns true for an integer, in which case intValue is valid.
+     * otherwise floatValue is valid.
+     */
+    bool getValue(int64_t& intValue, float& floatValue)
+    {
+        const uint64_t x = getVarint();
+        if (!(x & 1)) {
+            const uint64_t zigZag = x >> 1;
+            intValue = int64_t(zigZag >> 1) ^ -int64_t(zigZag & 1);
+            return true;
+        }
+        if (x != 1 || (pos + 4) > data.size()) {
+            ok = false;
+            floatValue = 0;
+            return false;
+        }
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) {
+            bits |= uint32_t(data[pos++]) << (8 * i);
+        }
+        floatValue = bitsToFloat(bits);
+        return false;
+    }
+
+    float getTime(int64_t& lastTicks)
+    {
+        int64_t delta = 0;
+        float ret = 0;
+        if (getValue(delta, ret)) {
+            lastTicks += delta;
+            return ticksToTime(lastTicks);
+        }
+        lastTicks = timeToTicks(ret);
+        return ret;
+    }
+
+    float getDuration()
+    {
+        int64_t ticks = 0;
+        float ret = 0;
+        if (getValue(ticks, ret)) {
+            ret = ticksToTime(ticks);
+        }
+        return ret;
+    }
+
+    float getPitch()
+    {
+        int64_t semitone = 0;
+        float ret = 0;
+        if (getValue(semitone, ret)) {
+            ret = semitoneToPitch(semitone);
+        }
+        return ret;
+    }
+
+private:
+    const std::vector<uint8_t>& data;
+    size_t pos = 0;
+};
+
+std::string MidiTrackBinary::toString(const MidiTrack& track)
+{
+    BinaryWriter writer;
+    writer.data.reserve(4 + track.size() * 6);
+    writer.data.push_back(uint8_t(version));
+
+    int64_t lastTicks = 0;
+    for (const auto& it : track) {
+        const MidiEvent* event = it.second.get();
+        switch (event->type) {
+            case MidiEvent::Type::Note: {
+                const MidiNoteEvent* note = static_cast<const MidiNoteEvent*>(event);
+                writer.putVarint(typeNote);
+                writer.putTime(note->startTime, lastTicks);
+                writer.putPitch(note->pitchCV);
+                writer.putDuration(note->duration);
+            }
+            break;
+            case MidiEvent::Type::End:
+                writer.putVarint(typeEnd);
+                writer.putTime(event->startTime, lastTicks);
+                break;
+            default:
+                assert(false);
+        }
+    }
+    return toBase64(writer.data);
+}
+
+MidiTrackPtr MidiTrackBinary::fromString(const std::string& str, MidiLockPtr lock)
+{
+    std::vector<uint8_t> data;
+    if (!fromBase64(str, data) || data.empty() || data[0] != version) {
+        return nullptr;
+    }
+
+    BinaryReader reader(data);
+    reader.getVarint();             // skip the version, which is one byte.
+    MidiTrackPtr track = std::make_shared<MidiTrack>(lock);
+    int64_t lastTicks = 0;
+    bool haveEnd = false;
+    while (!reader.atEnd() && reader.ok && !haveEnd) {
+        const uint64_t type = reader.getVarint();
+        switch (type) {
+            case typeNote: {
+                MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+                note->startTime = reader.getTime(lastTicks);
+                note->pitchCV = reader.getPitch();
+                note->duration = reader.getDuration();
+                if (reader.ok) {
+                    track->insertEvent(note);
+                }
+            }
+            break;
+            case typeEnd: {
+                const float endTime = reader.getTime(lastTicks);
+                if (reader.ok) {
+                    track->insertEnd(endTime);
+                    haveEnd = true;
+                }
+            }
+            break;
+            default:
+                reader.ok = false;
+        }
+    }
+
+    if (!reader.ok || !haveEnd) {
+        return nullptr;
+    }
+    return track;
+}
+
+static const char* base64Chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string MidiTrackBinary::toBase64(const std::vector<uint8_t>& data)
+{
+    std::string ret;
+    ret.reserve(((data.size() + 2) / 3) * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        const uint32_t x = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        ret.push_back(base64Chars[(x >> 18) & 63]);
+        ret.push_back(base64Chars[(x >> 12) & 63]);
+        ret.push_back(base64Chars[(x >> 6) & 63]);
+        ret.push_back(base64Chars[x & 63]);
+    }
+    const size_t remaining = data.size() - i;
+    if (remaining) {
+        uint32_t x = uint32_t(data[i]) << 16;
+        if (remaining == 2) {
+            x |= uint32_t(data[i + 1]) << 8;
+        }
+        ret.push_back(base64Chars[(x >> 18) & 63]);
+        ret.push_back(base64Chars[(x >> 12) & 63]);
+        ret.push_back((remaining == 2) ? base64Chars[(x >> 6) & 63] : '=');
+        ret.push_back('=');
+    }
+    return ret;
+}
+
+static int base64Value(char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+bool MidiTrackBinary::fromBase64(const std::string& str, std::vector<uint8_t>& data)
+{
+    data.clear();
+    if (str.size() % 4) {
+        return false;
+    }
+    data.reserve((str.size() / 4) * 3);
+    for (size_t i = 0; i < str.size(); i += 4) {
+        const bool last = (i + 4) == str.size();
+        const int pad = (last && str[i + 3] == '=') ? ((str[i + 2] == '=') ? 2 : 1) : 0;
+        uint32_t x = 0;
+        for (int j = 0; j < 4 - pad; ++j) {
+            const int v = base64Value(str[i + j]);
+            if (v < 0) {
+                return false;
+            }
+            x |= uint32_t(v) << (18 - 6 * j);
+        }
+        data.push_back(uint8_t(x >> 16));
+        if (pad < 2) {
+            data.push_back(uint8_t(x >> 8));
+        }
+        if (pad < 1) {
+            data.push_back(uint8_t(x));
+        }
+    }
+    return true;
+}
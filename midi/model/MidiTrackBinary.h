@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MidiLock;
+class MidiTrack;
+
+/**
+ * Compact text encoding of a MidiTrack, for saving in the patch.
+ *
+ * The JSON format writes an object per note, which is about fifty bytes
+ * for every note. This packs each note into a few bytes, then base64s it
+ * so it can go into the patch as a single JSON string.
+ *
+ * Binary format (before base64):
+ *      version byte
+ *      then for each event, in track order:
+ *          note:   1, start, pitch, duration
+ *          end:    2, start
+ *
+ * Every number is a varint. Start times and durations are stored as ticks
+ * (start times as the change from the previous event), and pitches as semitones.
+ * Any value that would not come back bit-exact that way is stored as a raw float.
+ * So the track always comes back exactly as it was saved.
+ */
+class MidiTrackBinary
+{
+public:
+    static std::string toString(const MidiTrack&);
+
+    /**
+     * Returns nullptr if the data is not a valid track.
+     */
+    static std::shared_ptr<MidiTrack> fromString(const std::string&, std::shared_ptr<MidiLock>);
+
+    static const int version = 1;
+    static const int ticksPerQuarterNote = 768;
+
+    // exposed for unit tests
+    static std::string toBase64(const std::vector<uint8_t>&);
+    static bool fromBase64(const std::string&, std::vector<uint8_t>&);
+};
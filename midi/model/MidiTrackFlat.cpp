@@ -0,0 +1,96 @@
+
+#include "MidiTrack.h"
+#include "MidiTrackFlat.h"
+
+#include <algorithm>
+#include <assert.h>
+
+void MidiTrackFlat::clear()
+{
+    numNotes = 0;
+    startTimes.resize(1);
+    durations.resize(1);
+    pitchCVs.resize(1);
+    startTimes[0] = 0;
+    durations[0] = 0;
+    pitchCVs[0] = 0;
+}
+
+void MidiTrackFlat::build(const MidiTrack& track)
+{
+    startTimes.clear();
+    durations.clear();
+    pitchCVs.clear();
+
+    float length = 0;
+    for (const auto& it : track) {
+        const MidiEvent* event = it.second.get();
+        switch (event->type) {
+            case MidiEvent::Type::Note: {
+                const MidiNoteEvent* note = static_cast<const MidiNoteEvent*>(event);
+                startTimes.push_back(note->startTime);
+                durations.push_back(note->duration);
+                pitchCVs.push_back(note->pitchCV);
+            } break;
+            case MidiEvent::Type::End:
+                length = event->startTime;
+                break;
+            default:
+                assert(false);
+        }
+    }
+    numNotes = int(startTimes.size());
+
+    // and the end marker
+    startTimes.push_back(length);
+    durations.push_back(0);
+    pitchCVs.push_back(0);
+}
+
+void MidiTrackFlat::reserve(int notes)
+{
+    // plus one for the end marker
+    startTimes.reserve(notes + 1);
+    durations.reserve(notes + 1);
+    pitchCVs.reserve(notes + 1);
+}
+
+int MidiTrackFlat::capacity() const
+{
+    return int(std::min(startTimes.capacity(), std::min(durations.capacity(), pitchCVs.capacity()))) - 1;
+}
+
+int MidiTrackFlat::upperBound(float startTime) const
+{
+    auto it = std::upper_bound(startTimes.begin(), startTimes.begin() + numNotes, startTime);
+    return int(it - startTimes.begin());
+}
+
+void MidiTrackFlat::insertNote(float startTime, float duration, float pitchCV)
+{
+    const int index = upperBound(startTime);
+    startTimes.insert(startTimes.begin() + index, startTime);
+    durations.insert(durations.begin() + index, duration);
+    pitchCVs.insert(pitchCVs.begin() + index, pitchCV);
+    ++numNotes;
+}
+
+bool MidiTrackFlat::removeNote(float startTime, float duration, float pitchCV)
+{
+    const int last = upperBound(startTime);
+    for (int index = last - 1; index >= 0 && startTimes[index] == startTime; --index) {
+        if (durations[index] == duration && pitchCVs[index] == pitchCV) {
+            startTimes.erase(startTimes.begin() + index);
+            durations.erase(durations.begin() + index);
+            pitchCVs.erase(pitchCVs.begin() + index);
+            --numNotes;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MidiTrackFlat::setLength(float length)
+{
+    startTimes[numNotes] = length;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+
+class MidiTrack;
+
+/**
+ * A read-only copy of a MidiTrack, laid out for playback.
+ *
+ * MidiTrack keeps its events in a multimap of shared pointers, which is
+ * great for editing but makes the player chase a node and a ref count for every note.
+ * Here the notes are in plain parallel arrays, sorted by start time
+ * (same order as the MidiTrack).
+ *
+ * Note index n == getNumNotes() is the end of the track. Its start time is the
+ * track length, so the player can treat it like any other event.
+ *
+ * MidiSong4Snapshot makes these on the UI thread, each time the song is edited.
+ *
+ * MidiPlayer2 keeps one on the audio thread and edits it in place with
+ * insertNote and removeNote. Those never allocate as long as the
+ * track stays under the capacity it was given with reserve.
+ */
+class MidiTrackFlat
+{
+public:
+    void build(const MidiTrack&);
+    void clear();
+
+    /**
+     * Makes room for this many notes, so that edits
+     * up to that size will not allocate.
+     */
+    void reserve(int notes);
+    int capacity() const;
+
+    /**
+     * Adds a note after any other notes with the same start time,
+     * the same place MidiTrack would put it.
+     */
+    void insertNote(float startTime, float duration, float pitchCV);
+
+    /**
+     * Removes one note that matches exactly.
+     * returns false if there isn't one.
+     */
+    bool removeNote(float startTime, float duration, float pitchCV);
+
+    /**
+     * Moves the end marker.
+     */
+    void setLength(float length);
+
+    int getNumNotes() const
+    {
+        return numNotes;
+    }
+
+    bool isEnd(int index) const
+    {
+        return index >= numNotes;
+    }
+
+    /**
+     * Valid for 0 <= index <= getNumNotes().
+     * The last one is the end marker.
+     */
+    float getStartTime(int index) const
+    {
+        return startTimes[index];
+    }
+
+    float getDuration(int index) const
+    {
+        return durations[index];
+    }
+
+    float getPitchCV(int index) const
+    {
+        return pitchCVs[index];
+    }
+
+    /**
+     * Zero for an empty (or cleared) track.
+     */
+    float getLength() const
+    {
+        return startTimes[numNotes];
+    }
+
+private:
+    int numNotes = 0;
+
+    // returns the index of the first note that starts after startTime
+    int upperBound(float startTime) const;
+
+    // each has numNotes + 1 entries. The last is the end marker.
+    std::vector<float> startTimes = {0};
+    std::vector<float> durations = {0};
+    std::vector<float> pitchCVs = {0};
+};
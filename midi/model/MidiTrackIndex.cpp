@@ -0,0 +1,86 @@
+
+#include "MidiTrackIndex.h"
+
+#include <algorithm>
+#include <assert.h>
+
+constexpr float MidiTrackIndex::bucketDuration;
+
+int MidiTrackIndex::getBucket(MidiEvent::time_t time)
+{
+    return std::max(0, int(time / bucketDuration));
+}
+
+void MidiTrackIndex::clear()
+{
+    buckets.clear();
+}
+
+void MidiTrackIndex::insert(const MidiNoteEventPtr& note)
+{
+    const int first = getBucket(note->startTime);
+    const int last = getBucket(note->startTime + note->duration);
+    if (int(buckets.size()) <= last) {
+        buckets.resize(last + 1);
+    }
+    for (int i = first; i <= last; ++i) {
+        buckets[i].push_back(note);
+    }
+}
+
+bool MidiTrackIndex::removeFrom(std::vector<MidiNoteEventPtr>& bucket, const MidiNoteEvent* note)
+{
+    for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+        if (it->get() == note) {
+            // order within a bucket doesn't matter
+            *it = std::move(bucket.back());
+            bucket.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void MidiTrackIndex::remove(const MidiNoteEvent* note)
+{
+    const int first = getBucket(note->startTime);
+    const int last = std::min(getBucket(note->startTime + note->duration), int(buckets.size()) - 1);
+    bool found = false;
+    for (int i = first; i <= last; ++i) {
+        found |= removeFrom(buckets[i], note);
+    }
+
+    // If someone changed the note after it went into the track it won't be where we expect.
+    // Slow, but don't leave it behind.
+    if (!found) {
+        for (auto& bucket : buckets) {
+            removeFrom(bucket, note);
+        }
+    }
+}
+
+void MidiTrackIndex::getNotes(MidiEvent::time_t start, MidiEvent::time_t end, std::vector<MidiNoteEventPtr>& notes) const
+{
+    assert(end >= start);
+    notes.clear();
+    const int first = getBucket(start);
+    const int last = std::min(getBucket(end), int(buckets.size()) - 1);
+    for (int i = first; i <= last; ++i) {
+        for (const MidiNoteEventPtr& note : buckets[i]) {
+            // a note in more than one of our buckets only gets reported from the first one.
+            const int noteFirst = std::max(first, getBucket(note->startTime));
+            if (noteFirst != i) {
+                continue;
+            }
+            const bool startsInRange = (note->startTime >= start) && (note->startTime <= end);
+            const bool playingAtStart = (note->startTime < start) && (note->startTime + note->duration > start);
+            if (startsInRange || playingAtStart) {
+                notes.push_back(note);
+            }
+        }
+    }
+
+    std::sort(notes.begin(), notes.end(), [](const MidiNoteEventPtr& a, const MidiNoteEventPtr& b) {
+        return a->startTime < b->startTime;
+    });
+}
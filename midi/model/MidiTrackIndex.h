@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "SqMidiEvent.h"
+
+/**
+ * Finds the notes that are sounding during a span of time.
+ *
+ * MidiTrack is sorted by start time, so the notes that start in a range are easy
+ * to find, but a long note that starts before the range is not. Here time is cut into
+ * one bar buckets, and each note goes into every bucket it sounds in.
+ * A query only looks in the buckets it covers, no matter how long the track is.
+ *
+ * MidiTrack keeps this up to date as notes are inserted and deleted.
+ */
+class MidiTrackIndex
+{
+public:
+    void insert(const MidiNoteEventPtr&);
+    void remove(const MidiNoteEvent*);
+    void clear();
+
+    /**
+     * Finds all the notes where start <= note start <= end, plus all the notes
+     * that start earlier and are still playing at start.
+     * So start == end finds the notes playing at that instant.
+     *
+     * Results are sorted by start time, and replace whatever was in notes.
+     */
+    void getNotes(MidiEvent::time_t start, MidiEvent::time_t end, std::vector<MidiNoteEventPtr>& notes) const;
+
+    int _numBuckets() const
+    {
+        return int(buckets.size());
+    }
+
+private:
+    /**
+     * One bar of 4/4, in quarter notes.
+     */
+    static constexpr float bucketDuration = 4;
+    std::vector<std::vector<MidiNoteEventPtr>> buckets;
+
+    static int getBucket(MidiEvent::time_t time);
+    static bool removeFrom(std::vector<MidiNoteEventPtr>& bucket, const MidiNoteEvent*);
+};
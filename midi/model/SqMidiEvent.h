@@ -5,6 +5,7 @@
 #include <assert.h>
 #include "asserts.h"
 
+#include "MidiEventPool.h"
 #include "PitchUtils.h"
 
 // forward declare smart pointers
@@ -242,7 +243,7 @@ inline std::shared_ptr<MidiEvent> safe_cast(std::shared_ptr<MidiNoteEvent> ev)
 
 inline MidiNoteEventPtr MidiNoteEvent::clonen() const
 {
-    return std::make_shared<MidiNoteEvent>(*this);
+    return std::allocate_shared<MidiNoteEvent>(MidiEventAllocator<MidiNoteEvent>(), *this);
 }
 
 inline MidiEventPtr MidiNoteEvent::clone() const
@@ -310,7 +311,7 @@ inline std::shared_ptr<MidiEvent> safe_cast(std::shared_ptr<MidiEndEvent> ev)
 
 inline MidiEventPtr MidiEndEvent::clone() const
 {
-    return std::make_shared<MidiEndEvent>(*this);
+    return std::allocate_shared<MidiEndEvent>(MidiEventAllocator<MidiEndEvent>(), *this);
 }
 
 
@@ -368,5 +369,5 @@ inline std::shared_ptr<MidiEvent> safe_cast(std::shared_ptr<MidiTestEvent> ev)
 
 inline MidiEventPtr MidiTestEvent::clone() const
 {
-    return std::make_shared<MidiTestEvent>(*this);
+    return std::allocate_shared<MidiTestEvent>(MidiEventAllocator<MidiTestEvent>(), *this);
 }
@@ -6,6 +6,8 @@
 #include "NoteScreenScale.h"
 #include "TimeUtils.h"
 
+#include <algorithm>
+
 extern int _mdb;
 
 MidiEditorContext::MidiEditorContext(MidiSongPtr song, ISeqSettingsPtr stt) : 
@@ -125,6 +127,20 @@ MidiEditorContext::iterator_pair MidiEditorContext::getEvents(float timeLow, flo
         iterator(rawIterators.second, rawIterators.second, lambda));
 }
 
+void MidiEditorContext::getNotesInViewport(std::vector<MidiNoteEventPtr>& notes) const
+{
+    const auto track = getSong()->getTrack(this->trackNumber);
+    track->getNotesOverlapping(m_startTime, m_endTime, notes);
+
+    const float pitchLow = m_pitchLow;
+    const float pitchHigh = m_pitchHigh;
+    const float endTime = m_endTime;
+    auto invisible = [pitchLow, pitchHigh, endTime](const MidiNoteEventPtr& note) {
+        return note->pitchCV < pitchLow || note->pitchCV > pitchHigh || note->startTime >= endTime;
+    };
+    notes.erase(std::remove_if(notes.begin(), notes.end(), invisible), notes.end());
+}
+
 bool MidiEditorContext::cursorInViewport() const
 {
     if (m_cursorTime < m_startTime) {
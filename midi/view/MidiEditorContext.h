@@ -132,6 +132,13 @@ public:
     iterator_pair getEvents(float preMargin) const;
     iterator_pair getEvents(float timeLow, float timeHigh, float pitchLow, float pitchHigh) const;
 
+    /**
+     * Gets all the notes that are at least partly visible in the edit context,
+     * including long notes that started before it.
+     * Replaces whatever was in notes, so the caller may re-use the vector.
+     */
+    void getNotesInViewport(std::vector<MidiNoteEventPtr>& notes) const;
+
     std::shared_ptr<MidiSong> getSong() const;
 
     void scrollVertically(float pitchCV);
@@ -0,0 +1,55 @@
+
+#include "MidiLock.h"
+#include "MidiSequencer.h"
+#include "MidiTrack.h"
+#include "NoteDisplayLayers.h"
+
+void NoteDisplayLayers::invalidate()
+{
+    valid = false;
+}
+
+NoteDisplayLayers::Dirty NoteDisplayLayers::update(const MidiSequencer& sequencer, float _quarterNotesInGrid, bool _hidingSelection)
+{
+    MidiEditorContext& context = *sequencer.context;
+    const MidiTrack* newTrack = context.getTrack().get();
+
+    // Edits lock the track's lock, which in remote edit mode isn't the song's.
+    const unsigned int newTrackEditCount = newTrack ? newTrack->lock->getEditCount() : 0;
+
+    const bool viewportChanged = !valid ||
+        (startTime != context.startTime()) ||
+        (endTime != context.endTime()) ||
+        (pitchLow != context.pitchLow()) ||
+        (pitchHigh != context.pitchHigh()) ||
+        (scaler != context.getScaler().get());
+
+    const float newTrackLength = newTrack ? newTrack->getLength() : 0;
+
+    Dirty ret;
+    ret.grid = viewportChanged ||
+        (trackLength != newTrackLength) ||
+        (quarterNotesInGrid != _quarterNotesInGrid);
+
+    ret.notes = viewportChanged ||
+        (track != newTrack) ||
+        (trackEditCount != newTrackEditCount) ||
+        (selection != sequencer.selection.get()) ||
+        (selectionChanges != sequencer.selection->getChangeCount()) ||
+        (hidingSelection != _hidingSelection);
+
+    valid = true;
+    startTime = context.startTime();
+    endTime = context.endTime();
+    pitchLow = context.pitchLow();
+    pitchHigh = context.pitchHigh();
+    scaler = context.getScaler().get();
+    trackLength = newTrackLength;
+    quarterNotesInGrid = _quarterNotesInGrid;
+    track = newTrack;
+    trackEditCount = newTrackEditCount;
+    selection = sequencer.selection.get();
+    selectionChanges = sequencer.selection->getChangeCount();
+    hidingSelection = _hidingSelection;
+    return ret;
+}
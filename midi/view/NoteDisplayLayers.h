@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+
+class MidiSequencer;
+class MidiSelectionModel;
+class MidiTrack;
+class NoteScreenScale;
+
+/**
+ * The note editor draws into cached layers, so it only re-draws
+ * what changed since the last frame. This class figures out what changed.
+ *
+ * The background and grid are one layer. They only depend on the viewport,
+ * the track length and the grid setting.
+ * The notes are the other layer. They depend on the viewport, any edit to the track,
+ * the selection, and whether the mouse manager is drawing the selected notes itself.
+ *
+ * The cursor blinks, and dragged notes move, so those are drawn every frame
+ * and aren't tracked here.
+ */
+class NoteDisplayLayers
+{
+public:
+    class Dirty
+    {
+    public:
+        bool grid = false;
+        bool notes = false;
+    };
+
+    /**
+     * Call once per frame.
+     * @param hidingSelection is true when the mouse manager draws the selected notes.
+     */
+    Dirty update(const MidiSequencer& sequencer, float quarterNotesInGrid, bool hidingSelection);
+
+    /**
+     * Next update will say everything is dirty.
+     */
+    void invalidate();
+
+private:
+    bool valid = false;
+
+    // viewport
+    float startTime = 0;
+    float endTime = 0;
+    float pitchLow = 0;
+    float pitchHigh = 0;
+    const NoteScreenScale* scaler = nullptr;
+
+    // grid
+    float trackLength = 0;
+    float quarterNotesInGrid = 0;
+
+    // notes
+    const MidiTrack* track = nullptr;
+    unsigned int trackEditCount = 0;
+    const MidiSelectionModel* selection = nullptr;
+    unsigned int selectionChanges = 0;
+    bool hidingSelection = false;
+};
@@ -35,8 +35,10 @@ public:
     {
         TEST1,
         TEST2,
-        NOISE,    // used by ColoredNoise
-        SAMP
+        NOISE,    // used by FFTCrossFader
+        NOISE_BANK,    // used by ColoredNoise
+        SAMP,
+        STFT
     };
     ThreadMessage(Type t) : type(t)
     {
@@ -21,6 +21,24 @@ public:
     T pop();
     bool full() const;
     bool empty() const;
+
+    /**
+     * How many more can be pushed.
+     * From the producer side, there will be at least this much room.
+     */
+    int space() const;
+
+    /**
+     * How many can be popped.
+     * From the consumer side, there will be at least this many.
+     */
+    int available() const;
+
+    /**
+     * The item pop will return, without removing it.
+     * Only for the consumer.
+     */
+    const T& peek() const;
 private:
     T memory[SIZE];
        
@@ -72,6 +90,25 @@ inline bool AtomicRingBuffer<T, SIZE>::empty() const
 }
 
 
+template <typename T, int SIZE>
+inline int AtomicRingBuffer<T, SIZE>::space() const
+{
+    return SIZE - size;
+}
+
+template <typename T, int SIZE>
+inline int AtomicRingBuffer<T, SIZE>::available() const
+{
+    return size;
+}
+
+template <typename T, int SIZE>
+inline const T& AtomicRingBuffer<T, SIZE>::peek() const
+{
+    assert(!empty());
+    return memory[outIndex];
+}
+
 template <typename T, int SIZE>
 inline void AtomicRingBuffer<T, SIZE>::advance(int &p)
 {
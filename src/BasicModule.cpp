@@ -67,7 +67,7 @@ void BasicModule::process(const ProcessArgs& args)
 struct BasicWidget : ModuleWidget
 {
     BasicWidget(BasicModule *);
-    DECLARE_MANUAL("Basic VCO Manual", "https://github.com/squinkylabs/SquinkyVCV/blob/main/docs/basic.md");
+    void appendContextMenu(Menu *menu) override;
 
     Label* addLabel(const Vec& v, const char* str, const NVGcolor& color = SqHelper::COLOR_BLACK)
     {
@@ -149,6 +149,18 @@ void BasicWidget::addControls(BasicModule *module, std::shared_ptr<IComposite> i
         module,  Comp::PWM_PARAM));
 }
 
+void BasicWidget::appendContextMenu(Menu* theMenu) 
+{
+    MenuLabel *spacerLabel = new MenuLabel();
+    theMenu->addChild(spacerLabel);
+    ManualMenuItem* manual = new ManualMenuItem("Basic VCO Manual", "https://github.com/squinkylabs/SquinkyVCV/blob/main/docs/basic.md");
+    theMenu->addChild(manual);
+
+    SqMenuItem_BooleanParam2 * item = new SqMenuItem_BooleanParam2(module, Comp::ECO_PARAM);
+    item->text = "Economy (wavetable)";
+    theMenu->addChild(item);
+}
+
 /**
  * Widget constructor will describe my implementation structure and
  * provide meta-data.
@@ -18,6 +18,7 @@
 #include "seq/ClockFinder.h"
 #include "seq/SequencerSerializer.h"
 #include "seq/S4ButtonGrid.h"
+#include "seq/StealPolicyMenuItem.h"
 
 #include "MidiSequencer4.h"
 #include "MidiSong4.h"
@@ -257,9 +258,19 @@ void Sequencer4Widget::appendContextMenu(Menu* theMenu) {
         theMenu->addChild(item);
 
     }
+    theMenu->addChild(new StealPolicyMenuItem(module, Comp::STEAL_POLICY_PARAM));
    
 }
 
+void Sequencer4Widget::step() {
+    ModuleWidget::step();
+    Sequencer4Module* seqModule = dynamic_cast<Sequencer4Module*>(module);
+    if (seqModule) {
+        // Hand any edits to the player.
+        seqModule->seq4Comp->updateSnapshot();
+    }
+}
+
 void Sequencer4Widget::setNewSeq(MidiSequencer4Ptr newSeq) {
     buttonGrid->setNewSeq(newSeq);
 }
@@ -23,6 +23,7 @@ class Sequencer4Module;
 struct Sequencer4Widget : ModuleWidget {
     Sequencer4Widget(Sequencer4Module*);
     void appendContextMenu(Menu* theMenu) override ;
+    void step() override;
     std::shared_ptr<S4ButtonGrid> getButtonGrid() { return buttonGrid; }
 
     Label* addLabel(const Vec& v, const char* str, const NVGcolor& color = SqHelper::COLOR_GREY) {
@@ -11,6 +11,7 @@
 #include "seq/NoteDisplay.h"
 #include "seq/AboveNoteGrid.h"
 #include "seq/ClockFinder.h"
+#include "seq/StealPolicyMenuItem.h"
 
 #include "ctrl/SqMenuItem.h"
 #include "ctrl/PopupMenuParamWidget.h"
@@ -73,6 +74,8 @@ struct SequencerWidget : ModuleWidget
         });
         item->text = "Hookup Clock";
         theMenu->addChild(item); 
+
+        theMenu->addChild(new StealPolicyMenuItem(module, Comp::STEAL_POLICY_PARAM));
 #ifdef _SEQ4
         ::rack::MenuItem* remoteEdit = new SqMenuItem_BooleanParam2(
             module,
@@ -244,8 +247,11 @@ void SequencerWidget::step()
         }
     }
 
-    // give this guy a chance to do some processing on the UI thread.
     if (_module) {
+        // Hand any edits to the player.
+        _module->seqComp->sendEdits();
+
+        // give this guy a chance to do some processing on the UI thread.
 #ifdef _USERKB
         noteDisplay->onUIThread(_module->seqComp, _module->sequencer);
 #else
@@ -100,6 +100,10 @@ void SubWidget::appendContextMenu(Menu *menu)
     SqMenuItem_BooleanParam2 * item = new SqMenuItem_BooleanParam2(module, Comp::AGC_PARAM);
     item->text = "AGC";
     menu->addChild(item);
+
+    item = new SqMenuItem_BooleanParam2(module, Comp::ECO_PARAM);
+    item->text = "Economy (wavetable)";
+    menu->addChild(item);
 }
 
 const float knobLeftEdge = 18;
@@ -24,6 +24,26 @@
 #include "../ctrl/SqMenuItem.h"
 #include "SqGfx.h"
 
+/**
+ * Child widget that lets NoteDisplay draw into one of its layers.
+ */
+class NoteDisplayLayer : public ::rack::widget::Widget
+{
+public:
+    using DrawFunc = std::function<void(NVGcontext*)>;
+    NoteDisplayLayer(const Vec& size, DrawFunc f) : drawFunc(f)
+    {
+        box.size = size;
+    }
+
+    void draw(const DrawArgs &args) override
+    {
+        drawFunc(args.vg);
+    }
+private:
+    DrawFunc drawFunc;
+};
+
 NoteDisplay::NoteDisplay(
     const Vec& pos,
     const Vec& size,
@@ -42,6 +62,8 @@ NoteDisplay::NoteDisplay(
         assert(scaler2);
     }
 
+    addLayers();
+
     focusLabel = new Label();
     focusLabel->box.pos = Vec(40, 40);
     focusLabel->text = "";
@@ -56,9 +78,37 @@ NoteDisplay::NoteDisplay(
 #endif
 }
 
+void NoteDisplay::addLayers()
+{
+    gridLayer = new ::rack::widget::FramebufferWidget();
+    gridLayer->box.size = box.size;
+    gridLayer->addChild(new NoteDisplayLayer(box.size, [this](NVGcontext* vg) {
+        if (sequencer) {
+            drawBackground(vg);
+            drawGrid(vg);
+        }
+    }));
+    addChild(gridLayer);
+
+    notesLayer = new ::rack::widget::FramebufferWidget();
+    notesLayer->box.size = box.size;
+    notesLayer->addChild(new NoteDisplayLayer(box.size, [this](NVGcontext* vg) {
+        if (sequencer) {
+            drawNotes(vg);
+        }
+    }));
+    addChild(notesLayer);
+
+    // The cursor blinks, and dragged notes move, so these are drawn every frame.
+    // They go under any other children, like the xform screens.
+    addChild(new NoteDisplayLayer(box.size, [this](NVGcontext* vg) {
+        drawOverlay(vg);
+    }));
+}
 
 void NoteDisplay::songUpdated()
 {
+    layers.invalidate();
     initEditContext();
     // re-associate seq and mouse manager
     mouseManager = std::make_shared<MouseManager>(sequencer); 
@@ -93,27 +143,33 @@ void NoteDisplay::initEditContext()
     assert(scaler);
 }
 
-// TODO: get rid of this (dont remember why this is here)
 void NoteDisplay::step()
 {
     if (!sequencer) {
         return;
     }
+
+    const NoteDisplayLayers::Dirty dirty = layers.update(
+        *sequencer,
+        sequencer->context->settings()->getQuarterNotesInGrid(),
+        mouseManager->willDrawSelection());
+    if (dirty.grid) {
+        gridLayer->dirty = true;
+    }
+    if (dirty.notes) {
+        notesLayer->dirty = true;
+    }
     OpaqueWidget::step();
 }
 
 void NoteDisplay::drawNotes(NVGcontext *vg)
 {
-    // Get all the events on the screen, and go back two bar so we get tied notes.
-    MidiEditorContext::iterator_pair it = sequencer->context->getEvents(8.f);
+    // Get all the notes on the screen, including long ones that started earlier.
+    sequencer->context->getNotesInViewport(visibleNotes);
     auto scaler = sequencer->context->getScaler();
     assert(scaler);
     const int noteHeight = scaler->noteHeight();
-    for (; it.first != it.second; ++it.first) {
-        auto temp = *(it.first);
-        MidiEventPtr evn = temp.second;
-        MidiNoteEventPtr ev = safe_cast<MidiNoteEvent>(evn);
-
+    for (const MidiNoteEventPtr& ev : visibleNotes) {
         const float x = scaler->midiTimeToX(*ev);
         const float y = scaler->midiPitchToY(*ev);
         const float width = scaler->midiTimeTodX(ev->duration);
@@ -213,14 +269,18 @@ void NoteDisplay::draw(const Widget::DrawArgs &args)
 
     // let's clip everything to our window
     nvgScissor(vg, 0, 0, this->box.size.x, this->box.size.y);
-    drawBackground(vg);
-    drawGrid(vg);
-    drawNotes(vg);
+    OpaqueWidget::draw(args);
+}
+
+void NoteDisplay::drawOverlay(NVGcontext *vg)
+{
+    if (!this->sequencer) {
+        return;
+    }
 
     // if we are dragging, will have something to draw
     mouseManager->draw(vg);
     drawCursor(vg);
-    OpaqueWidget::draw(args);
 }
 
 void NoteDisplay::drawBackground(NVGcontext *vg)
@@ -3,6 +3,7 @@
 
 #include "InputScreenManager.h"
 #include "MidiSequencer.h"
+#include "NoteDisplayLayers.h"
 #include "NoteScreenScale.h"
 #include "Seq.h"
 
@@ -55,6 +56,17 @@ private:
 
     std::shared_ptr<class MouseManager> mouseManager;
 
+    // re-used every redraw, so drawing doesn't allocate
+    std::vector<MidiNoteEventPtr> visibleNotes;
+
+    /**
+     * Background and grid are cached in one framebuffer, notes in another.
+     * Each is only re-drawn when NoteDisplayLayers says it changed.
+     */
+    ::rack::widget::FramebufferWidget* gridLayer = nullptr;
+    ::rack::widget::FramebufferWidget* notesLayer = nullptr;
+    NoteDisplayLayers layers;
+
     void step() override;
 
 
@@ -70,6 +82,8 @@ private:
     void drawCursor(NVGcontext *vg);
     void drawGrid(NVGcontext *vg);
     void drawBackground(NVGcontext *vg);
+    void drawOverlay(NVGcontext *vg);
+    void addLayers();
 
     bool isKeyWeNeedToStealFromRack(int key);
 
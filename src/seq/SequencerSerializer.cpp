@@ -4,6 +4,7 @@
 #include "MidiSequencer4.h"
 #include "MidiTrack4Options.h"
 #include "MidiSong4.h"
+#include "MidiTrackBinary.h"
 #include "../SequencerModule.h"
 #include "../Sequencer4Module.h"
 #include "SequencerSerializer.h"
@@ -41,6 +42,11 @@ schema for seq++
       "song4": <song4>,
       "globals4": <globals4>
   }
+
+  track:
+    Seq++ writes an array of events, one object for each.
+    4X4 writes a single string in the MidiTrackBinary format, which is much smaller
+    and faster. Either one may be read in either place.
  */
 
 json_t *SequencerSerializer::toJson(MidiSequencerPtr inSeq)
@@ -89,7 +95,7 @@ json_t *SequencerSerializer::toJson(std::shared_ptr<MidiSong4> sng)
                 auto tk = sng->getTrack(row, col);
                 if (tk) {
                     // only serialize tracks that exist
-                    json_object_set_new(song, key.c_str(), toJson(tk));
+                    json_object_set_new(song, key.c_str(), toJsonBinary(tk));
                 }
             }
 
@@ -138,6 +144,12 @@ json_t *SequencerSerializer::toJson(std::shared_ptr<MidiTrack> tk)
     return track;
 }
 
+json_t *SequencerSerializer::toJsonBinary(std::shared_ptr<MidiTrack> tk)
+{
+    const std::string data = MidiTrackBinary::toString(*tk);
+    return json_string(data.c_str());
+}
+
 json_t *SequencerSerializer::toJson(std::shared_ptr<MidiEvent> evt)
 {
     MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(evt);
@@ -399,6 +411,16 @@ MidiSong4Ptr SequencerSerializer::fromJsonSong4(json_t *data)
 
 MidiTrackPtr SequencerSerializer::fromJsonTrack(json_t *data, int index, MidiLockPtr lock)
 {
+    if (json_is_string(data)) {
+        MidiTrackPtr track = MidiTrackBinary::fromString(json_string_value(data), lock);
+        if (!track) {
+            WARN("bad binary track");
+            track = std::make_shared<MidiTrack>(lock);
+            track->insertEnd(4);            // make a legit blank track
+        }
+        return track;
+    }
+
     // data here is the track array
     MidiTrackPtr track = std::make_shared<MidiTrack>(lock);
 
@@ -32,6 +32,7 @@ private:
     static json_t *toJson(std::shared_ptr<MidiSong>);
     static json_t *toJson(std::shared_ptr<MidiSong4>);
     static json_t *toJson(std::shared_ptr<MidiTrack>);
+    static json_t *toJsonBinary(std::shared_ptr<MidiTrack>);
     static json_t *toJson(std::shared_ptr<MidiTrack4Options>);
     static json_t *toJson(std::shared_ptr<MidiNoteEvent>);
     static json_t *toJson(std::shared_ptr<MidiEndEvent>);
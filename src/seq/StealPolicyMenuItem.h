@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ctrl/SqMenuItem.h"
+#include "MidiVoiceAssigner.h"
+
+/**
+ * Sub-menu that picks which voice a sequencer steals when they are all busy.
+ * The choice is kept in an invisible param, so it gets saved with the patch.
+ */
+class StealPolicyMenuItem : public ::rack::ui::MenuItem {
+public:
+    StealPolicyMenuItem(::rack::engine::Module* module, int paramId) : module(module), paramId(paramId) {
+        text = "Voice stealing";
+        rightText = RIGHT_ARROW;
+    }
+
+    ::rack::ui::Menu* createChildMenu() override {
+        ::rack::ui::Menu* menu = new ::rack::ui::Menu();
+        addItem(menu, MidiVoiceAssigner::StealPolicy::Next, "Next voice");
+        addItem(menu, MidiVoiceAssigner::StealPolicy::Oldest, "Oldest note");
+        addItem(menu, MidiVoiceAssigner::StealPolicy::SoonestEnd, "Note that ends soonest");
+        addItem(menu, MidiVoiceAssigner::StealPolicy::Lowest, "Lowest note");
+        addItem(menu, MidiVoiceAssigner::StealPolicy::Highest, "Highest note");
+        addItem(menu, MidiVoiceAssigner::StealPolicy::SamePitch, "Same pitch");
+        return menu;
+    }
+
+private:
+    ::rack::engine::Module* const module;
+    const int paramId;
+
+    void addItem(::rack::ui::Menu* menu, MidiVoiceAssigner::StealPolicy policy, const char* label) {
+        ::rack::engine::Module* const m = module;
+        const int id = paramId;
+        const int value = int(policy);
+        std::function<bool()> isCheckedFn = [m, id, value]() {
+            return int(std::round(::rack::appGet()->engine->getParam(m, id))) == value;
+        };
+        std::function<void()> clickFn = [m, id, value]() {
+            ::rack::appGet()->engine->setParam(m, id, float(value));
+        };
+        SqMenuItem* item = new SqMenuItem(isCheckedFn, clickFn);
+        item->text = label;
+        menu->addChild(item);
+    }
+};
@@ -62,6 +62,11 @@ test : test.exe
 ## Consider fixing this in the future.
 perf : perf.exe
 
+## analyze runs the offline spectral analysis of the VCOs (alias, THD, SNR, CPU)
+## and writes the results to analysis.csv. Uses the perf build, so the CPU numbers are real.
+analyze : perf.exe
+	./perf.exe --analyze analysis.csv
+
 ## cleantest will clean out all the test and perf build products
 cleantest :
 	rm -rfv build_test
@@ -297,6 +297,15 @@ double Analyzer::hamming(int iSample, int totalSamples)
     return a0 - (1.0 - a0) * std::cos(theta);
 }
 
+double Analyzer::blackmanHarris(int iSample, int totalSamples)
+{
+    const double theta = AudioMath::Pi * 2.0 * double(iSample) / double(totalSamples);
+    return .35875
+        - .48829 * std::cos(theta)
+        + .14128 * std::cos(2 * theta)
+        - .01168 * std::cos(3 * theta);
+}
+
 void Analyzer::getSpectrum(FFTDataCpx& out, bool useWindow, std::function<float()> func)
 {
 
@@ -74,6 +74,12 @@ public:
 
     static double hamming(int iSample, int totalSamples);
 
+    /**
+     * 4 term Blackman-Harris. Sidelobes are down 92 db,
+     * so good for measuring low level alias.
+     */
+    static double blackmanHarris(int iSample, int totalSamples);
+
     /**
      * Assert that there is a single frequency in spectrum, and that it is close to
      * expectedFreq.
@@ -16,12 +16,12 @@ class MLockTest
 public:
     MLockTest(MidiSequencerPtr s) : lp(s->song->lock)
     {
-        assert(!lp->dataModelDirty());
+        assert(!lp->snapshotDirty());
         assert(!lp->locked());
     }
     ~MLockTest()
     {
-        assert(lp->dataModelDirty());
+        assert(lp->snapshotDirty());
         assert(!lp->locked());
     }
 private:
@@ -0,0 +1,239 @@
+
+#include "SpectralReport.h"
+#include "Analyzer.h"
+#include "FFT.h"
+#include "FFTData.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <thread>
+
+// Blackman-Harris main lobe is +/- 4 bins
+static const int guardBins = 4;
+static const int maxFrameSize = 64 * 1024;
+
+// aliases this far past the sample rate are too small to care about.
+static const double maxAliasRatio = 4;
+
+enum class BinType
+{
+    Noise,          // sorted so that the higher ones win when they overlap
+    Alias,
+    Harmonic,
+    Fundamental,
+    DC
+};
+
+static double db10(double powerRatio)
+{
+    return 10 * std::log10(std::max(powerRatio, 1e-30));
+}
+
+std::vector<double> SpectralReport::getPowerSpectrum(const std::vector<float>& signal, int frameSize)
+{
+    assert((frameSize & (frameSize - 1)) == 0);
+    const int numFrames = int(signal.size()) / frameSize;
+    assert(numFrames > 0);
+
+    std::vector<float> window(frameSize);
+    for (int i = 0; i < frameSize; ++i) {
+        window[i] = float(Analyzer::blackmanHarris(i, frameSize));
+    }
+
+    FFTDataReal frame(frameSize);
+    FFTDataCpx spectrum(frameSize);
+    std::vector<double> power(frameSize / 2 + 1);
+    for (int f = 0; f < numFrames; ++f) {
+        const float* input = signal.data() + f * frameSize;
+        for (int i = 0; i < frameSize; ++i) {
+            frame.set(i, input[i] * window[i]);
+        }
+        FFT::forward(&spectrum, frame);
+        for (int i = 0; i < int(power.size()); ++i) {
+            power[i] += std::norm(spectrum.get(i)) / numFrames;
+        }
+    }
+    return power;
+}
+
+static void markBins(std::vector<BinType>& types, double freq, double binWidth, BinType type)
+{
+    const int center = int(std::round(freq / binWidth));
+    const int first = std::max(0, center - guardBins);
+    const int last = std::min(int(types.size()) - 1, center + guardBins);
+    for (int i = first; i <= last; ++i) {
+        types[i] = std::max(types[i], type);
+    }
+}
+
+/**
+ * Finds the biggest peak near expectedFreq, and returns its power weighted center.
+ */
+static double findFundamental(const std::vector<double>& power, double expectedFreq, double binWidth)
+{
+    const int expectedBin = int(std::round(expectedFreq / binWidth));
+    const int searchBins = std::max(guardBins, expectedBin / 32);
+    const int first = std::max(1, expectedBin - searchBins);
+    const int last = std::min(int(power.size()) - 1, expectedBin + searchBins);
+
+    int peak = first;
+    for (int i = first; i <= last; ++i) {
+        if (power[i] > power[peak]) {
+            peak = i;
+        }
+    }
+
+    double sum = 0;
+    double weightedSum = 0;
+    for (int i = std::max(0, peak - guardBins); i <= std::min(int(power.size()) - 1, peak + guardBins); ++i) {
+        sum += power[i];
+        weightedSum += power[i] * i;
+    }
+    return (sum > 0) ? binWidth * weightedSum / sum : expectedFreq;
+}
+
+SpectralReport::Metrics SpectralReport::analyze(const std::vector<float>& signal, double expectedFreq, double sampleRate)
+{
+    int frameSize = 1024;
+    assert(int(signal.size()) >= frameSize);
+    while ((frameSize * 2 <= int(signal.size())) && (frameSize < maxFrameSize)) {
+        frameSize *= 2;
+    }
+
+    const std::vector<double> power = getPowerSpectrum(signal, frameSize);
+    const double binWidth = sampleRate / frameSize;
+    const double nyquist = sampleRate / 2;
+
+    Metrics ret;
+    ret.fundamental = findFundamental(power, expectedFreq, binWidth);
+
+    std::vector<BinType> types(power.size(), BinType::Noise);
+    markBins(types, 0, binWidth, BinType::DC);
+    markBins(types, ret.fundamental, binWidth, BinType::Fundamental);
+    for (int harmonic = 2; ; ++harmonic) {
+        double freq = harmonic * ret.fundamental;
+        if (freq >= maxAliasRatio * sampleRate) {
+            break;
+        }
+        if (freq < nyquist) {
+            markBins(types, freq, binWidth, BinType::Harmonic);
+        } else {
+            // fold it back into 0..nyquist
+            freq = std::fmod(freq, sampleRate);
+            if (freq > nyquist) {
+                freq = sampleRate - freq;
+            }
+            markBins(types, freq, binWidth, BinType::Alias);
+        }
+    }
+
+    double fundamental = 0;
+    double harmonics = 0;
+    double alias = 0;
+    double noise = 0;
+    for (int i = 0; i < int(power.size()); ++i) {
+        switch (types[i]) {
+            case BinType::Fundamental:
+                fundamental += power[i];
+                break;
+            case BinType::Harmonic:
+                harmonics += power[i];
+                break;
+            case BinType::Alias:
+                alias += power[i];
+                break;
+            case BinType::Noise:
+                noise += power[i];
+                break;
+            case BinType::DC:
+                break;
+        }
+    }
+
+    ret.thdDb = db10(harmonics / fundamental);
+    ret.aliasDb = db10(alias / (fundamental + harmonics));
+    ret.snrDb = db10((fundamental + harmonics) / (alias + noise));
+    return ret;
+}
+
+SpectralReport::SpectralReport(double seconds, double sampleRate) :
+    seconds(seconds),
+    sampleRate(sampleRate)
+{
+}
+
+void SpectralReport::addTarget(const std::string& name, GeneratorFactory factory)
+{
+    Target target;
+    target.name = name;
+    target.factory = factory;
+    targets.push_back(target);
+}
+
+std::vector<SpectralReport::Result> SpectralReport::run(const std::vector<double>& freqs, int numThreads)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    const int numSamples = int(seconds * sampleRate);
+
+    // render them all first, on this thread, so the timing isn't
+    // disturbed by the analysis.
+    std::vector<Result> results;
+    std::vector<std::vector<float>> signals;
+    for (const Target& target : targets) {
+        for (double freq : freqs) {
+            Generator generator = target.factory(freq, sampleRate);
+            std::vector<float> signal(numSamples);
+
+            const auto start = Clock::now();
+            for (int i = 0; i < numSamples; ++i) {
+                signal[i] = generator();
+            }
+            const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+            Result result;
+            result.target = target.name;
+            result.freq = freq;
+            result.nsPerSample = elapsed.count() / numSamples;
+            results.push_back(result);
+            signals.push_back(std::move(signal));
+        }
+    }
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<size_t> nextJob(0);
+    auto worker = [this, &nextJob, &results, &signals]() {
+        for (size_t job = nextJob++; job < results.size(); job = nextJob++) {
+            results[job].metrics = analyze(signals[job], results[job].freq, sampleRate);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+void SpectralReport::writeCSV(std::ostream& out, const std::vector<Result>& results)
+{
+    out << "target,freq,measured_freq,ns_per_sample,thd_db,alias_db,snr_db\n";
+    for (const Result& result : results) {
+        out << result.target << ","
+            << result.freq << ","
+            << result.metrics.fundamental << ","
+            << result.nsPerSample << ","
+            << result.metrics.thdDb << ","
+            << result.metrics.aliasDb << ","
+            << result.metrics.snrDb << "\n";
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * Offline spectral analysis of periodic signals, for tracking the quality
+ * of the VCOs over time.
+ *
+ * Each target (usually a composite driven through TestComposite) is run for a
+ * while at each frequency in a sweep. The rendering is done one at a time, so
+ * the CPU usage can be measured. Then the FFTs and the metrics are done in
+ * parallel on all the cores.
+ */
+class SpectralReport
+{
+public:
+    class Metrics
+    {
+    public:
+        double fundamental = 0;     // measured, in Hz
+        double thdDb = 0;           // harmonics relative to the fundamental
+        double aliasDb = 0;         // aliases relative to the harmonics (including fundamental)
+        double snrDb = 0;           // harmonics relative to everything else (alias, noise, spurs), but not DC.
+    };
+
+    /**
+     * Welch averaged power spectrum with a Blackman-Harris window.
+     * The signal is cut into frames of frameSize, which must be a power of two.
+     * The result has frameSize / 2 + 1 bins.
+     */
+    static std::vector<double> getPowerSpectrum(const std::vector<float>& signal, int frameSize);
+
+    /**
+     * Measures a periodic signal whose fundamental is near expectedFreq.
+     */
+    static Metrics analyze(const std::vector<float>& signal, double expectedFreq, double sampleRate);
+
+    /**
+     * Called once for each frequency in the sweep. Returns a function that
+     * generates one sample each time it's called.
+     */
+    using Generator = std::function<float()>;
+    using GeneratorFactory = std::function<Generator(double freq, double sampleRate)>;
+
+    class Target
+    {
+    public:
+        std::string name;
+        GeneratorFactory factory;
+    };
+
+    class Result
+    {
+    public:
+        std::string target;
+        double freq = 0;            // requested frequency
+        double nsPerSample = 0;
+        Metrics metrics;
+    };
+
+    SpectralReport(double seconds, double sampleRate);
+
+    void addTarget(const std::string& name, GeneratorFactory);
+
+    /**
+     * Runs every target at every frequency.
+     * numThreads of zero will use all the cores.
+     */
+    std::vector<Result> run(const std::vector<double>& freqs, int numThreads = 0);
+
+    /**
+     * One line per result, with a header line.
+     */
+    static void writeCSV(std::ostream&, const std::vector<Result>&);
+
+private:
+    const double seconds;
+    const double sampleRate;
+    std::vector<Target> targets;
+};
@@ -5,8 +5,6 @@
 #include "dr_wav.h"
 #include <assert.h>
 
-const char* wave_path = "C:\\Users\\bruce\\Documents\\VCV\\samples\\multi-note.wav";
-
 SqWaveFile::SqWaveFile()
 {
 
@@ -15,7 +13,7 @@ SqWaveFile::SqWaveFile()
 bool SqWaveFile::load(const std::string& path)
 {
     drwav wav;
-    if (!drwav_init_file(&wav, wave_path, NULL)) {
+    if (!drwav_init_file(&wav, path.c_str(), NULL)) {
         printf("can't init dr_wav\n");
         return false;;
     }
@@ -27,9 +25,9 @@ bool SqWaveFile::load(const std::string& path)
     }
 
     if (retValue) {
-        data.resize(wav.totalPCMFrameCount);
-        assert(false);  // fix this
-        //drwav_read_pcm_frames_f32__pcm(&wav, wav.totalPCMFrameCount, data.data());
+        data.resize(size_t(wav.totalPCMFrameCount));
+        const drwav_uint64 framesRead = drwav_read_pcm_frames_f32(&wav, wav.totalPCMFrameCount, data.data());
+        data.resize(size_t(framesRead));
     }
 
     drwav_uninit(&wav);
@@ -47,11 +47,6 @@ public:
         }
     }
 
-    void onLockFailed() override
-    {
-        ++lockConflicts;
-    }
-
     void resetClock() override
     {
         // won't reset anything, but remember we were called
@@ -62,8 +57,6 @@ public:
     int gateChangeCount = 0;
     int numClockResets = 0;
 
-    int lockConflicts = 0;
-
     std::vector<bool> gateState = {
         false, false, false, false,
         false, false, false, false,
@@ -69,10 +69,6 @@ public:
             cvValue[voice] = cv;
         }
     }
-    void onLockFailed() override
-    {
-        ++lockConflicts;
-    }
 
     void resetClock() override
     {
@@ -81,8 +77,6 @@ public:
 
     int cvChangeCount = 0;
     int gateChangeCount = 0;
-
-    int lockConflicts = 0;
     int numClockResets = 0;
 
     int numGates() const
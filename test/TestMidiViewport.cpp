@@ -2,7 +2,11 @@
 #include "asserts.h"
 #include "MidiEditorContext.h"
 #include "MidiLock.h"
+#include "MidiSequencer.h"
 #include "MidiSong.h"
+#include "NoteDisplayLayers.h"
+#include "TestAuditionHost.h"
+#include "TestSettings.h"
 
 
 static void testReleaseSong()
@@ -131,6 +135,81 @@ static void testDemoSong()
     assertEQ(std::distance(it.first, it.second), numNotes /2);
 }
 
+static void assertDirty(NoteDisplayLayers::Dirty dirty, bool grid, bool notes)
+{
+    assertEQ(dirty.grid, grid);
+    assertEQ(dirty.notes, notes);
+}
+
+static void testDisplayLayers()
+{
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::eightQNotes, 0);
+    MidiSequencerPtr seq = MidiSequencer::make(song, std::make_shared<TestSettings>(), std::make_shared<TestAuditionHost>());
+    NoteDisplayLayers layers;
+
+    // first frame draws everything, next one draws nothing
+    assertDirty(layers.update(*seq, 1, false), true, true);
+    assertDirty(layers.update(*seq, 1, false), false, false);
+
+    // moving the cursor doesn't need either layer
+    seq->context->setCursorTime(1);
+    assertDirty(layers.update(*seq, 1, false), false, false);
+
+    // selection
+    MidiNoteEventPtr note = seq->context->getTrack()->getFirstNote();
+    seq->selection->select(note);
+    assertDirty(layers.update(*seq, 1, false), false, true);
+    assertDirty(layers.update(*seq, 1, false), false, false);
+
+    // editing the song
+    {
+        MidiLocker l(song->lock);
+    }
+    assertDirty(layers.update(*seq, 1, false), false, true);
+
+    // dragging notes
+    assertDirty(layers.update(*seq, 1, true), false, true);
+    assertDirty(layers.update(*seq, 1, false), false, true);
+
+    // grid setting
+    assertDirty(layers.update(*seq, .5, false), true, false);
+
+    // scrolling
+    seq->context->setStartTime(8);
+    seq->context->setEndTime(16);
+    assertDirty(layers.update(*seq, .5, false), true, true);
+    seq->context->setPitchLow(seq->context->pitchLow() + 1);
+    assertDirty(layers.update(*seq, .5, false), true, true);
+    assertDirty(layers.update(*seq, .5, false), false, false);
+
+    layers.invalidate();
+    assertDirty(layers.update(*seq, .5, false), true, true);
+}
+
+/**
+ * In remote edit mode the track comes from another module's song,
+ * so edits lock the track's lock, not our song's.
+ */
+static void testDisplayLayersRemoteEdit()
+{
+    MidiSongPtr remoteSong = MidiSong::makeTest(MidiTrack::TestContent::eightQNotes, 0);
+    MidiSongPtr song = std::make_shared<MidiSong>();
+    song->addTrack(0, remoteSong->getTrack(0));
+    MidiSequencerPtr seq = MidiSequencer::make(song, std::make_shared<TestSettings>(), std::make_shared<TestAuditionHost>());
+    NoteDisplayLayers layers;
+    assertDirty(layers.update(*seq, 1, false), true, true);
+    assertDirty(layers.update(*seq, 1, false), false, false);
+
+    seq->editor->selectAll();
+    assertDirty(layers.update(*seq, 1, false), false, true);
+    seq->editor->changePitch(1);
+    assertDirty(layers.update(*seq, 1, false), false, true);
+    assertDirty(layers.update(*seq, 1, false), false, false);
+
+    seq->undo->undo(seq);
+    assertDirty(layers.update(*seq, 1, false), false, true);
+}
+
 void testMidiViewport()
 {
     assertEvCount(0);
@@ -138,6 +217,8 @@ void testMidiViewport()
     testEventAccess();
     testEventFilter();
     testDemoSong();
+    testDisplayLayers();
+    testDisplayLayersRemoteEdit();
 
     assertEvCount(0);
 }
@@ -0,0 +1,82 @@
+
+#include "TestComposite.h"
+
+#include "Basic.h"
+#include "SpectralReport.h"
+
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <stdio.h>
+
+using BasicComp = Basic<TestComposite>;
+
+/**
+ * Basic, mono, with pitch CV set to give freq.
+ */
+static SpectralReport::Generator makeBasic(BasicComp::Waves waveform, bool eco, double freq, double sampleRate)
+{
+    std::shared_ptr<BasicComp> vco = std::make_shared<BasicComp>();
+    vco->init();
+    vco->inputs[BasicComp::VOCT_INPUT].channels = 1;
+    vco->params[BasicComp::WAVEFORM_PARAM].value = float(waveform);
+    vco->params[BasicComp::PW_PARAM].value = 50;
+    vco->params[BasicComp::ECO_PARAM].value = eco ? 1.f : 0.f;
+
+    // octave knob at 4 makes 0V be C4
+    vco->params[BasicComp::OCTAVE_PARAM].value = 4;
+    vco->inputs[BasicComp::VOCT_INPUT].setVoltage(float(std::log2(freq / rack::dsp::FREQ_C4)), 0);
+
+    BasicComp::ProcessArgs args;
+    args.sampleRate = float(sampleRate);
+    args.sampleTime = float(1.0 / sampleRate);
+
+    // let the pitch settle before we start listening
+    for (int i = 0; i < 1000; ++i) {
+        vco->process(args);
+    }
+
+    return [vco, args]() {
+        vco->process(args);
+        return vco->outputs[BasicComp::MAIN_OUTPUT].getVoltage(0);
+    };
+}
+
+/**
+ * Runs the VCOs through a pitch sweep, and writes
+ * the alias and CPU measurements to reportPath, as CSV.
+ */
+void analyzeVCOs(const std::string& reportPath, double seconds)
+{
+    const double sampleRate = 44100;
+    SpectralReport report(seconds, sampleRate);
+    for (int i = 0; i < int(BasicComp::Waves::END); ++i) {
+        const BasicComp::Waves waveform = BasicComp::Waves(i);
+        report.addTarget("Basic " + BasicComp::getLabel(waveform), [waveform](double freq, double sampleRate) {
+            return makeBasic(waveform, false, freq, sampleRate);
+        });
+    }
+
+    // only these have an eco version
+    const BasicComp::Waves ecoWaves[] = {
+        BasicComp::Waves::SAW,
+        BasicComp::Waves::SQUARE,
+        BasicComp::Waves::EVEN,
+        BasicComp::Waves::TRI_CLEAN};
+    for (BasicComp::Waves waveform : ecoWaves) {
+        report.addTarget("Basic " + BasicComp::getLabel(waveform) + " eco", [waveform](double freq, double sampleRate) {
+            return makeBasic(waveform, true, freq, sampleRate);
+        });
+    }
+
+    const std::vector<double> freqs = {55, 110, 220, 440, 880, 1760, 3520, 7040};
+    const std::vector<SpectralReport::Result> results = report.run(freqs);
+
+    std::ofstream out(reportPath);
+    if (!out.good()) {
+        printf("can't open %s\n", reportPath.c_str());
+        return;
+    }
+    SpectralReport::writeCSV(out, results);
+    printf("wrote %d results to %s\n", int(results.size()), reportPath.c_str());
+}
@@ -26,6 +26,8 @@ extern void testVocalAnimator();
 extern void testObjectCache();
 extern void testThread(bool exended);
 extern void testFFT();
+extern void testSTFT();
+extern void testSpectralReport();
 extern void testRingBuffer();
 extern void testManagedPool();
 extern void testColoredNoise();
@@ -55,6 +57,7 @@ extern void testUndoRedo();
 extern void testMidiViewport();
 extern void testFilteredIterator();
 extern void testMidiEvents();
+extern void testMidiTrackBinary();
 extern void testMidiControllers();
 extern void testMultiLag();
 extern void testMultiLag2();
@@ -78,6 +81,7 @@ extern void testCommChannels();
 extern void testLadder();
 extern void testHighpassFilter();
 extern void calQ();
+extern void analyzeVCOs(const std::string& reportPath, double seconds);
 extern void testDrumTrigger();
 extern void testAudition();
 extern void testStepRecordInput();
@@ -100,6 +104,7 @@ extern void testSimpleQuantizer();
 extern void testDC();
 extern void testSines();
 extern void testBasic();
+extern void testSqMinBlep();
 extern void testFilterComposites();
 extern void testClockRecovery();
 extern void testCompCurves();
@@ -166,6 +171,7 @@ int main(int argc, char** argv) {
     bool extended = false;
     bool runShaperGen = false;
     bool cq = false;
+    bool analyze = false;
     if (argc > 1) {
         std::string arg = argv[1];
         if (arg == "--ext") {
@@ -176,6 +182,8 @@ int main(int argc, char** argv) {
             runShaperGen = true;
         } else if (arg == "--calQ") {
             cq = true;
+        } else if (arg == "--analyze") {
+            analyze = true;
         } else {
             printf("%s is not a valid command line argument\n", arg.c_str());
         }
@@ -200,6 +208,14 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    // --analyze [report file] [seconds]
+    if (analyze) {
+        const std::string reportPath = (argc > 2) ? argv[2] : "analysis.csv";
+        const double seconds = (argc > 3) ? std::stod(argv[3]) : 2;
+        analyzeVCOs(reportPath, seconds);
+        return 0;
+    }
+
     if (runPerf) {
         initPerf();
         perfTest2();
@@ -231,6 +247,7 @@ int main(int argc, char** argv) {
     testClockRecovery();
     testCompCurves();
 
+    testSqMinBlep();
     testBasic();
     testSines();
     testDC();
@@ -263,6 +280,7 @@ int main(int argc, char** argv) {
     testMidiEvents();
     testFilteredIterator();
     testMidiDataModel();
+    testMidiTrackBinary();
     testMidiSelectionModel();
     testChaos();
     testMidiSong();
@@ -315,6 +333,8 @@ int main(int argc, char** argv) {
     testVCO();
     // testSin();
     testFFT();
+    testSTFT();
+    testSpectralReport();
     testAnalyzer();
     testRateConversion();
     testUtils();
@@ -29,6 +29,17 @@
 #include "Super.h"
 #include "KSComposite.h"
 #include "Seq.h"
+#include "Seq4.h"
+#include "MidiEditQueue.h"
+#include "MidiEditor.h"
+#include "MidiSequencer.h"
+#include "MidiVoice.h"
+#include "MidiVoiceAssigner.h"
+#include "NoteDisplayLayers.h"
+#include "ReplaceDataCommand.h"
+#include "TestAuditionHost.h"
+#include "TestHost2.h"
+#include "TestSettings.h"
 
 //#ifndef _MSC_VER
 #if 1
@@ -591,6 +602,18 @@ static void testCHBdef()
         }, 1);
 }
 
+static void testCHB16()
+{
+    using Comp = CHB<TestComposite>;
+    Comp chb;
+    chb.outputs[Comp::MIX_OUTPUT].channels = 1;
+    chb.inputs[Comp::CV_INPUT].channels = 16;
+    MeasureTime<float>::run(overheadOutOnly, "chb 16 channels", [&chb]() {
+        chb.step();
+        return chb.outputs[Comp::MIX_OUTPUT].getVoltage(15);
+        }, 1);
+}
+
 #if 0
 static void testEV3()
 {
@@ -713,7 +736,7 @@ static void testWVCOPoly()
     }, 1);
 }
 
-static void testBasic(const std::string& name, Basic<TestComposite>::Waves waveform, bool dynamicCV)
+static void testBasic(const std::string& name, Basic<TestComposite>::Waves waveform, bool dynamicCV, bool eco = false)
 {
     printf("starting %s\n", name.c_str()); fflush(stdout);
     Basic<TestComposite> vco;
@@ -722,7 +745,7 @@ static void testBasic(const std::string& name, Basic<TestComposite>::Waves wavef
     vco.inputs[Basic<TestComposite>::MAIN_OUTPUT].channels = 1;
     vco.inputs[Basic<TestComposite>::VOCT_INPUT].channels = 1;
     vco.params[Basic<TestComposite>::WAVEFORM_PARAM].value = float(waveform);
-
+    vco.params[Basic<TestComposite>::ECO_PARAM].value = eco ? 1.f : 0.f;
 
     Basic<TestComposite>::ProcessArgs args;
     args.sampleTime = 1.f / 44100.f;
@@ -758,6 +781,14 @@ static void testBasic1SqDyn()
 {
    testBasic("basic sq 1 dyn", Basic<TestComposite>::Waves::SQUARE, true);
 }
+static void testBasic1SawEco()
+{
+   testBasic("basic saw 1 eco", Basic<TestComposite>::Waves::SAW, false, true);
+}
+static void testBasic1SqEco()
+{
+   testBasic("basic sq 1 eco", Basic<TestComposite>::Waves::SQUARE, false, true);
+}
 
 static void testBasic1Sin()
 {
@@ -881,6 +912,26 @@ static void testOrgan12()
     }, 1);
 }
 
+static void testOrgan16()
+{
+    printf("starting organ 16\n"); fflush(stdout);
+    Sines<TestComposite> sines;
+
+    sines.init();
+    sines.inputs[Sines<TestComposite>::MAIN_OUTPUT].channels = 1;
+    sines.inputs[Sines<TestComposite>::VOCT_INPUT].channels = 16;
+    sines.inputs[Sines<TestComposite>::GATE_INPUT].channels = 16;
+
+     Sines<TestComposite>::ProcessArgs args;
+    args.sampleTime = 1.f / 44100.f;
+    args.sampleRate = 44199;
+
+    MeasureTime<float>::run(overheadOutOnly, "organ 16", [&sines, args]() {
+        sines.process(args);
+        return sines.outputs[Sines<TestComposite>::MAIN_OUTPUT].getVoltage(0);           
+    }, 1);
+}
+
 static void testSubMono()
 {
     Sub<TestComposite> sub;
@@ -1201,6 +1252,159 @@ static void testNormal()
 }
 #endif
 
+static void testSeq4()
+{
+    using Sq4 = Seq4<TestComposite>;
+    MidiSong4Ptr song = MidiSong4::makeTest(MidiTrack::TestContent::eightQNotes, 0);
+    Sq4 seq(song);
+    seq.params[Sq4::CLOCK_INPUT_PARAM].value = float(SeqClock::ClockRate::Div64);
+    seq.toggleRunStop();
+
+    int counter = 0;
+    MeasureTime<float>::run(overheadOutOnly, "seq4", [&seq, &counter]() {
+        // a sixty-fourth note clock at 120 bpm is about one edge every 350 samples
+        seq.inputs[Sq4::CLOCK_INPUT].setVoltage((++counter & 256) ? 10.f : 0.f, 0);
+        seq.step();
+        return seq.outputs[Sq4::GATE0_OUTPUT].getVoltage(0);
+    }, 1);
+}
+
+static void testTransposeAll()
+{
+    // a thousand note track, all selected
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
+    {
+        MidiLocker l(song->lock);
+        MidiTrackPtr track = song->getTrack(0);
+        track->setLength(500);
+        for (int i = 0; i < 1000; ++i) {
+            MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+            note->startTime = i * .5f;
+            note->duration = .25f;
+            note->pitchCV = (i % 24) * PitchUtils::semitone;
+            track->insertEvent(note);
+        }
+    }
+    MidiSequencerPtr seq = MidiSequencer::make(song, std::make_shared<TestSettings>(), std::make_shared<TestAuditionHost>());
+    seq->editor->selectAll();
+
+    // this isn't audio, so the CPU percent is meaningless. Look at the iterations per second.
+    MeasureTime<float>::run(overheadOutOnly, "transpose all and undo", [&seq]() {
+        auto cmd = ReplaceDataCommand::makeChangePitchCommand(seq, 1);
+        seq->undo->execute(seq, cmd);
+        seq->undo->undo(seq);
+        return float(seq->selection->size());
+    }, 1);
+}
+
+// six note chords every 16th, each lasting a half note, so all 16 voices stay busy.
+static void testVoiceAssigner(MidiVoiceAssigner::StealPolicy policy, const char* name)
+{
+    TestHost2 host;
+    MidiVoice voices[16];
+    for (int i = 0; i < 16; ++i) {
+        voices[i].setHost(&host);
+        voices[i].setIndex(i);
+        voices[i].setSampleCountForRetrigger(44);
+    }
+    MidiVoiceAssigner va(voices, 16);
+    va.setStealPolicy(policy);
+
+    double time = 0;
+    int chord = 0;
+    MeasureTime<float>::run(overheadOutOnly, name, [&]() {
+        time += .25;
+        for (MidiVoice& vx : voices) {
+            vx.updateToMetricTime(time);
+        }
+        const int root = chord++ % 12;
+        for (int i = 0; i < 6; ++i) {
+            const float pitch = (root + i * 4) * PitchUtils::semitone;
+            va.getNext(pitch)->playNote(pitch, time, float(time + 2));
+        }
+        return float(host.gateChangeCount);
+    }, 1);
+}
+
+// What the note editor does every frame for the note layer, with nothing changed.
+// The old editor went through all the visible notes every frame.
+static void testNoteDisplayFrame(bool redrawEveryFrame)
+{
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
+    {
+        MidiLocker l(song->lock);
+        MidiTrackPtr track = song->getTrack(0);
+        track->setLength(8);
+        for (int i = 0; i < 256; ++i) {
+            MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+            note->startTime = (i / 8) * .25f;
+            note->duration = .25f;
+            note->pitchCV = (i % 8) * 2 * PitchUtils::semitone;
+            track->insertEvent(note);
+        }
+    }
+    MidiSequencerPtr seq = MidiSequencer::make(song, std::make_shared<TestSettings>(), std::make_shared<TestAuditionHost>());
+    seq->context->setStartTime(0);
+    seq->context->setEndTime(8);
+    seq->context->setPitchLow(0);
+    seq->context->setPitchHi(2);
+    seq->editor->selectAll();
+
+    NoteDisplayLayers layers;
+    std::vector<MidiNoteEventPtr> visibleNotes;
+    MeasureTime<float>::run(overheadOutOnly, redrawEveryFrame ? "note display frame, redraw" : "note display frame, cached", [&]() {
+        const NoteDisplayLayers::Dirty dirty = layers.update(*seq, 1, false);
+        float ret = 0;
+        if (dirty.notes || redrawEveryFrame) {
+            seq->context->getNotesInViewport(visibleNotes);
+            for (const MidiNoteEventPtr& note : visibleNotes) {
+                if (seq->selection->isSelected(note)) {
+                    ret += note->startTime;
+                }
+            }
+        }
+        return ret;
+    }, 1);
+}
+
+// Move one note in a thousand note track, send it to the player, and apply it.
+// The player used to start over from the beginning after every edit.
+static void testEditQueue()
+{
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
+    MidiTrackPtr track = song->getTrack(0);
+    MidiNoteEventPtr note;
+    {
+        MidiLocker l(song->lock);
+        track->setLength(500);
+        for (int i = 0; i < 1000; ++i) {
+            note = std::make_shared<MidiNoteEvent>();
+            note->startTime = i * .5f;
+            note->duration = .25f;
+            note->pitchCV = (i % 24) * PitchUtils::semitone;
+            track->insertEvent(note);
+        }
+    }
+    MidiEditQueue queue;
+    queue.sendTrack(*track, true);
+    queue.apply();
+
+    int counter = 0;
+    MeasureTime<float>::run(overheadOutOnly, "edit one note and send", [&]() {
+        {
+            MidiLocker l(song->lock);
+            MidiNoteEventPtr newNote = safe_cast<MidiNoteEvent>(note->clone());
+            newNote->pitchCV = (++counter & 1) ? 1.f : 0.f;
+            track->deleteEvent(*note);
+            track->insertEvent(newNote);
+            note = newNote;
+        }
+        queue.sendTrack(*track, false);
+        queue.apply();
+        return queue.getTrack().getPitchCV(999);
+    }, 1);
+}
+
 void dummy()
 {
     MidiSongPtr ms = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
@@ -1216,6 +1420,13 @@ void perfTest()
     assert(overheadOutOnly > 0);
 
      testVocalFilter();
+     testSeq4();
+     testTransposeAll();
+     testVoiceAssigner(MidiVoiceAssigner::StealPolicy::Next, "voice assign chords");
+     testVoiceAssigner(MidiVoiceAssigner::StealPolicy::Oldest, "voice assign chords oldest");
+     testNoteDisplayFrame(true);
+     testNoteDisplayFrame(false);
+     testEditQueue();
 #if 0
     testColors();
    
@@ -1231,11 +1442,14 @@ void perfTest()
     testBasic1Sin();
     testBasic1Saw();
     testBasic1Sq();
+    testBasic1SawEco();
+    testBasic1SqEco();
     testBasic1SqDyn();
     testOrgan1();
     testOrgan4();
     testOrgan4VCO();
     testOrgan12();
+    testOrgan16();
     testSuper();
     testSuperPoly();
     testWVCOPoly();
@@ -1263,6 +1477,7 @@ void perfTest()
 
 
     testCHBdef();
+    testCHB16();
 #if 0
     testShaper1b();
     testShaper1c();
@@ -2,6 +2,8 @@
 
 #include "DrumTrigger.h"
 
+#include "FFT.h"
+#include "FFTPlan.h"
 #include "Filt.h"
 
 #include "LookupTable.h"
@@ -14,10 +16,14 @@
 #include "MultiLag.h"
 #include "F2_Poly.h"
 #include "Compressor.h"
+#include "Compressor2.h"
 #endif
 
 #include "ObjectCache.h"
+#include "OnsetDetector.h"
+#include "SimdLookupTable.h"
 #include "Slew4.h"
+#include "SqWaveFile.h"
 #include "TestComposite.h"
 
 #include "MeasureTime.h"
@@ -130,6 +136,32 @@ static void testUniformLookup()
         return LookupTable<float>::lookup(*lookup, x, true);
 
     }, 1);
+
+    MeasureTime<float>::run(overheadInOut, "uniform X4 scalar", [lookup]() {
+        float x = TestBuffers<float>::get();
+        float ret = 0;
+        for (int i = 0; i < 4; ++i) {
+            ret += LookupTable<float>::lookup(*lookup, x + i * .01f, true);
+        }
+        return ret;
+    }, 1);
+
+    MeasureTime<float>::run(overheadInOut, "uniform X4 simd", [lookup]() {
+        float x = TestBuffers<float>::get();
+        float_4 input(x, x + .01f, x + .02f, x + .03f);
+        float_4 y = SimdLookupTable::lookup4(*lookup, input);
+        return y[0] + y[3];
+    }, 1);
+
+    auto bank = std::make_shared<LookupTableBank4>();
+    bank->init(512, 0, 1, [](double x, int table) {
+        return std::sin(x * (table + 1));
+    });
+    MeasureTime<float>::run(overheadInOut, "uniform bank of 4", [bank]() {
+        float x = TestBuffers<float>::get();
+        float_4 y = bank->lookup(x);
+        return y[0] + y[3];
+    }, 1);
 }
 static void testNonUniform()
 {
@@ -141,6 +173,15 @@ static void testNonUniform()
         return  NonUniformLookupTable<float>::lookup(*lookup, x);
      
     }, 1);
+    MeasureTime<float>::run(overheadInOut, "non-uniform search", [lookup]() {
+        float x = TestBuffers<float>::get();
+        return  NonUniformLookupTable<float>::lookupSearch(*lookup, x);
+    }, 1);
+    MeasureTime<float>::run(overheadInOut, "non-uniform X4 simd", [lookup]() {
+        float x = TestBuffers<float>::get();
+        float_4 y = SimdLookupTable::lookup4(*lookup, float_4(x, x + .01f, x + .02f, x + .03f));
+        return y[0] + y[3];
+    }, 1);
     printf("Now abort");
     abort();
 }
@@ -163,6 +204,76 @@ static void testSlew4()
         }, 1);
 }
 
+/**
+ * One whole FFT per "sample", at the 64k frame size
+ * that ColoredNoise uses.
+ */
+static void testFFT64k(bool useKiss, bool inverse, const char* name)
+{
+    const int bins = 64 * 1024;
+    FFTPlanCache::_forceKiss(useKiss);
+    FFTDataCpx spectrum(bins);
+    FFTDataReal signal(bins);
+    FFT::makeNoiseSpectrum(&spectrum, ColoredNoiseSpec());
+
+    MeasureTime<float>::run(overheadInOut, name, [&spectrum, &signal, inverse]() {
+        if (inverse) {
+            FFT::inverse(&signal, spectrum);
+        } else {
+            FFT::forward(&spectrum, signal);
+        }
+        return signal.get(0);
+        }, 1);
+    FFTPlanCache::_forceKiss(false);
+}
+
+static void testFFT64k()
+{
+    testFFT64k(true, true, "inverse FFT 64k kiss");
+    testFFT64k(false, true, "inverse FFT 64k radix");
+    testFFT64k(true, false, "forward FFT 64k kiss");
+    testFFT64k(false, false, "forward FFT 64k radix");
+}
+
+/**
+ * Runs the onset detector over one of the test wave files. If the file
+ * isn't there, uses a generated series of decaying notes instead.
+ */
+static void testOnsetDetector(OnsetDetector::DetectionFunction function, const char* name)
+{
+    std::vector<float> input;
+    SqWaveFile wave;
+    if (wave.loadTest(SqWaveFile::TestFiles::MultiNote)) {
+        for (int i = 0; i < wave.size(); ++i) {
+            input.push_back(wave.getAt(i));
+        }
+    } else {
+        const int noteLength = 44100 / 4;
+        for (int i = 0; i < noteLength * 8; ++i) {
+            const int t = i % noteLength;
+            const float env = float(std::exp(-t / 2000.0));
+            input.push_back(env * float(std::sin(t * .03)));
+        }
+    }
+
+    OnsetDetector detector(function);
+    size_t index = 0;
+    MeasureTime<float>::run(overheadInOut, name, [&detector, &input, &index]() {
+        const bool trigger = detector.step(input[index]);
+        if (++index >= input.size()) {
+            index = 0;
+        }
+        return trigger ? 1.f : 0.f;
+        }, 1);
+}
+
+static void testOnsetDetector()
+{
+    testOnsetDetector(OnsetDetector::DetectionFunction::SpectralFlux, "onset flux");
+    testOnsetDetector(OnsetDetector::DetectionFunction::PhaseDeviation, "onset phase");
+    testOnsetDetector(OnsetDetector::DetectionFunction::ComplexDomain, "onset complex");
+}
+
 using DT = DrumTrigger<TestComposite>;
 static void testDrumTrigger()
 {
@@ -210,6 +321,23 @@ static void testFilt2()
      }, 1);
 }
 
+static void testFilt16()
+{
+    Filter fs;
+    fs.init();
+    fs.inputs[Filter::L_AUDIO_INPUT].channels = 16;
+    fs.outputs[Filter::L_AUDIO_OUTPUT].channels = 16;
+    assert(overheadInOut >= 0);
+    MeasureTime<float>::run(overheadInOut, "filt 16 channel", [&fs]() {
+        const float_4 x(TestBuffers<float>::get());
+        for (int i = 0; i < 16; i += 4) {
+            fs.inputs[Filter::L_AUDIO_INPUT].setVoltageSimd(x, i);
+        }
+        fs.step();
+        return fs.outputs[Filter::L_AUDIO_OUTPUT].getVoltage(15);
+        }, 1);
+}
+
 using Mixer8 = Mix8<TestComposite>;
 static void testMix8()
 {
@@ -576,6 +704,41 @@ static void testCompKnee16Hard()
 #endif
 
 
+#ifndef _MSC_VER
+static void testComp2(int channels, int ratio, const char* name)
+{
+    using Comp = Compressor2<TestComposite>;
+    Comp comp;
+
+    comp.init();
+
+    comp.inputs[Comp::LAUDIO_INPUT].channels = channels;
+    comp.params[Comp::RATIO_PARAM].value = float(ratio);
+    comp.params[Comp::NOTBYPASS_PARAM].value = 1;
+
+    Comp::ProcessArgs args;
+    args.sampleTime = 1.f / 44100.f;
+    args.sampleRate = 44199;
+
+    MeasureTime<float>::run(overheadInOut, name, [&comp, args, channels]() {
+        const float x = TestBuffers<float>::get();
+        for (int i = 0; i < channels; ++i) {
+            comp.inputs[Comp::LAUDIO_INPUT].setVoltage(x, i);
+        }
+        comp.process(args);
+        return comp.outputs[Comp::LAUDIO_OUTPUT].getVoltage(0);
+        }, 1);
+}
+
+static void testComp2()
+{
+    testComp2(1, 0, "Compressor2 1 channel limit");
+    testComp2(1, 3, "Compressor2 1 channel 4:1 soft");
+    testComp2(16, 0, "Compressor2 16 channel limit");
+    testComp2(16, 3, "Compressor2 16 channel 4:1 soft");
+}
+#endif
+
 void perfTest2()
 {
     assert(overheadInOut > 0);
@@ -593,13 +756,14 @@ void perfTest2()
     testCompKnee();
     testCompKnee16();
     testCompKnee16Hard();
-   
+    testComp2();
 #endif
 
 
     testDrumTrigger();
     testFilt();
     testFilt2();
+    testFilt16();
     testSlew4();
     testMixStereo();
     testMix8();
@@ -612,4 +776,6 @@ void perfTest2()
     testMultiLPFMod();
     testMultiLag();
     testMultiLagMod();
+    testFFT64k();
+    testOnsetDetector();
 }
\ No newline at end of file
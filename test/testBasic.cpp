@@ -1,6 +1,11 @@
 
 #include "asserts.h"
 #include "BasicVCO.h"
+#include "TestComposite.h"
+#include "Basic.h"
+#include "SpectralReport.h"
+
+#include <cmath>
 
 
 using MinBlep = rack::dsp::MinBlepGenerator<16, 16, float_4>; 
@@ -63,6 +68,87 @@ static void testBasic3()
     printf("proc3b = %f\n", x);
 }
 
+using BasicComp = Basic<TestComposite>;
+
+static std::vector<float> renderBasic(BasicComp::Waves waveform, bool eco, float freq, int numSamples)
+{
+    BasicComp vco;
+    vco.init();
+    vco.inputs[BasicComp::VOCT_INPUT].channels = 1;
+    vco.outputs[BasicComp::MAIN_OUTPUT].channels = 1;
+    vco.params[BasicComp::WAVEFORM_PARAM].value = float(waveform);
+    vco.params[BasicComp::PW_PARAM].value = 50;
+    vco.params[BasicComp::ECO_PARAM].value = eco ? 1.f : 0.f;
+    vco.params[BasicComp::OCTAVE_PARAM].value = 4;
+    vco.inputs[BasicComp::VOCT_INPUT].setVoltage(std::log2(freq / rack::dsp::FREQ_C4), 0);
+
+    BasicComp::ProcessArgs args;
+    args.sampleRate = 44100;
+    args.sampleTime = 1.f / 44100;
+    // long enough for the tri clean integrator to settle
+    for (int i = 0; i < 10000; ++i) {
+        vco.process(args);
+    }
+    std::vector<float> ret(numSamples);
+    for (int i = 0; i < numSamples; ++i) {
+        vco.process(args);
+        ret[i] = vco.outputs[BasicComp::MAIN_OUTPUT].getVoltage(0);
+    }
+    return ret;
+}
+
+/**
+ * At a low pitch the band-limited waveform is close to the
+ * minBLEP one, so most of the samples should be the same.
+ * They differ for a few samples around each edge: the minBLEP is minimum phase,
+ * so it rings after the edge, where the wavetable rings on both sides.
+ *
+ * @param lag is how many samples the minBLEP waveform is behind the eco one.
+ * @param percentClose is how many samples must be within tolerance.
+ */
+static void testBasicEcoMatches(BasicComp::Waves waveform, float freq, float tolerance, int lag, int percentClose)
+{
+    const int numSamples = 4000;
+    const std::vector<float> normal = renderBasic(waveform, false, freq, numSamples);
+    const std::vector<float> eco = renderBasic(waveform, true, freq, numSamples);
+
+    int numClose = 0;
+    for (int i = 0; i < numSamples - lag; ++i) {
+        if (std::abs(normal[i + lag] - eco[i]) < tolerance) {
+            ++numClose;
+        }
+    }
+    assertGT(numClose, (numSamples - lag) * percentClose / 100);
+}
+
+static void testBasicEcoSpectrum(BasicComp::Waves waveform, float freq)
+{
+    const float sampleRate = 44100;
+    const std::vector<float> eco = renderBasic(waveform, true, freq, 32 * 1024);
+    const SpectralReport::Metrics metrics = SpectralReport::analyze(eco, freq, sampleRate);
+    assertClose(metrics.fundamental, freq, freq * .01);
+    assertLT(metrics.aliasDb, -55);
+}
+
+static void testBasicEco()
+{
+    testBasicEcoMatches(BasicComp::Waves::SAW, 55, .1f, 0, 95);
+
+    // two edges per cycle, so twice as many samples around edges
+    testBasicEcoMatches(BasicComp::Waves::SQUARE, 55, .1f, 0, 93);
+    testBasicEcoMatches(BasicComp::Waves::EVEN, 55, .1f, 0, 93);
+
+    // integrating the minBLEP square puts its triangle one sample behind
+    testBasicEcoMatches(BasicComp::Waves::TRI_CLEAN, 440, .5f, 1, 99);
+
+    for (float freq : {110.f, 880.f, 3520.f}) {
+        testBasicEcoSpectrum(BasicComp::Waves::SAW, freq);
+        testBasicEcoSpectrum(BasicComp::Waves::SQUARE, freq);
+        testBasicEcoSpectrum(BasicComp::Waves::EVEN, freq);
+        testBasicEcoSpectrum(BasicComp::Waves::TRI_CLEAN, freq);
+    }
+}
+
 // this test might be superfluous...
 void testBasic()
 {
@@ -71,6 +157,7 @@ void testBasic()
     testBasic1();
     testBasic2();
     testBasic3();
+    testBasicEco();
 #else
     printf("testBasic skipped for MS compiler: no minBlep\n");
 #endif
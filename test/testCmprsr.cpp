@@ -167,6 +167,71 @@ static void testCompZeroAttack(bool poly) {
     }
 }
 
+// changing the curve alone must switch the processing kernel
+static void testCurveChangeToLimiter(bool reduceDist) {
+    const float sampleTime = 1.f / 44100.f;
+    const float threshold = 5;
+
+    Cmprsr comp;
+    comp.setNumChannels(1);
+    comp.setCurve(Cmprsr::Ratios::_4_1_soft);
+    comp.setTimes(0, 100, sampleTime, reduceDist);
+    comp.setThreshold(threshold);
+
+    // compressor lets some through above threshold
+    auto out = comp.step(float_4(10));
+    assertGT(out[0], threshold + .5f);
+
+    comp.setCurve(Cmprsr::Ratios::HardLimit);
+    out = comp.step(float_4(10));
+    assertEQ(out[0], threshold);
+
+    comp.setCurve(Cmprsr::Ratios::_4_1_soft);
+    out = comp.step(float_4(10));
+    assertGT(out[0], threshold + .5f);
+}
+
+// eight lanes must do exactly what two float_4 ones do
+static void testCmprsr8(Cmprsr::Ratios ratio, int numChan) {
+    assert(numChan > 4 && numChan <= 8);
+    const float sampleTime = 1.f / 44100.f;
+
+    CmprsrT<float_8> comp8;
+    comp8.setNumChannels(numChan);
+    comp8.setCurve(ratio);
+    comp8.setTimes(1, 100, sampleTime, true);
+    comp8.setThreshold(3);
+
+    Cmprsr comp4[2];
+    comp4[0].setNumChannels(4);
+    comp4[1].setNumChannels(numChan - 4);
+    for (int bank = 0; bank < 2; ++bank) {
+        comp4[bank].setCurve(ratio);
+        comp4[bank].setTimes(1, 100, sampleTime, true);
+        comp4[bank].setThreshold(3);
+    }
+    assert(comp8.getKernel() == comp4[0].getKernel());
+
+    for (int i = 0; i < 2000; ++i) {
+        // a different level in each channel, some over threshold, some under
+        float_8 in;
+        for (int ch = 0; ch < 8; ++ch) {
+            in[ch] = float((i + 100 * ch) % 700) * (ch + 1) * .002f;
+        }
+        const float_8 out8 = comp8.step(in);
+        const float_4 out4[2] = {comp4[0].step(in.lo()), comp4[1].step(in.hi())};
+        for (int ch = 0; ch < numChan; ++ch) {
+            assertClose(out8[ch], out4[ch / 4][ch % 4], .0001);
+        }
+    }
+}
+
+static void testCmprsr8() {
+    testCmprsr8(Cmprsr::Ratios::HardLimit, 8);
+    testCmprsr8(Cmprsr::Ratios::_4_1_soft, 8);
+    testCmprsr8(Cmprsr::Ratios::_4_1_soft, 5);
+}
+
 static void testIndependentAttack(int indChan) {
     Cmprsr cmp;
 
@@ -193,5 +258,8 @@ void testCmprsr() {
     testCompZeroAttack(true);
 
     testLimiterZeroAttack();
+    testCurveChangeToLimiter(false);
+    testCurveChangeToLimiter(true);
+    testCmprsr8();
     testIndependentAttack();
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "TestComposite.h"
 #include "asserts.h"
 
+#include <vector>
+
 extern void testFinalLeaks();
 
 using Noise = ColoredNoise<TestComposite>;
@@ -52,7 +54,8 @@ static void test1()
 }
 
 
-// try to request a few different kinds of noise
+// try a few different kinds of noise.
+// after the bank arrives, slope changes don't need any more messages
 static void test2()
 {
     Noise cn;
@@ -60,30 +63,141 @@ static void test2()
     while (cn._msgCount() < 1) {
         cn.step();
     }
-    cn.params[Noise::SLOPE_PARAM].value = -6;
-    while (cn._msgCount() < 2) {
-        cn.step();
+
+    // knob is -5..5, slope is -8..8
+    const float knobs[] = {-4, 3, 2, 2.3f, 2.5f, -1.2f};
+    for (float knob : knobs) {
+        cn.params[Noise::SLOPE_PARAM].value = knob;
+        for (int i = 0; i < 100; ++i) {
+            cn.step();
+            const float output = cn.outputs[Noise::AUDIO_OUTPUT].getVoltage(0);
+            assert(output < 10);
+            assert(output > -10);
+        }
+        assertClose(cn.getSlope(), knob * 8 / 5, .0001);
     }
-    cn.params[Noise::SLOPE_PARAM].value = 3;
-    while (cn._msgCount() < 3) {
-        cn.step();
+    assertEQ(cn._msgCount(), 1);
+}
+
+static void testBankMix()
+{
+    auto bank = NoiseSpectrumBank::get();
+    assert(bank == NoiseSpectrumBank::get());
+
+    // whole number slopes play just one frame
+    auto mix = bank->getMix(2);
+    assert(mix.lower == bank->getFrame(2 - NoiseSpectrumBank::minSlope));
+    assertEQ(mix.upperGain, 0);
+
+    mix = bank->getMix(-2.25f);
+    assert(mix.lower == bank->getFrame(-3 - NoiseSpectrumBank::minSlope));
+    assert(mix.upper == bank->getFrame(-2 - NoiseSpectrumBank::minSlope));
+    assertClose(mix.upperGain, .75f, .0001);
+
+    // out of range is clipped
+    mix = bank->getMix(100);
+    assert(mix.upper == bank->getFrame(NoiseSpectrumBank::numFrames - 1));
+    assertEQ(mix.upperGain, 1);
+    mix = bank->getMix(-100);
+    assert(mix.lower == bank->getFrame(0));
+    assertEQ(mix.upperGain, 0);
+}
+
+/**
+ * Since all the frames have the same phases, neighboring
+ * slopes should be strongly correlated, so they don't cancel when mixed.
+ */
+static void testBankCoherent()
+{
+    auto bank = NoiseSpectrumBank::get();
+    for (int frame = 0; frame < NoiseSpectrumBank::numFrames - 1; ++frame) {
+        const float* a = bank->getFrame(frame);
+        const float* b = bank->getFrame(frame + 1);
+        double ab = 0, aa = 0, bb = 0;
+        for (int i = 0; i < NoiseSpectrumBank::numBins; ++i) {
+            ab += a[i] * b[i];
+            aa += a[i] * a[i];
+            bb += b[i] * b[i];
+        }
+        const double correlation = ab / std::sqrt(aa * bb);
+        assertGT(correlation, .8);
     }
-    cn.params[Noise::SLOPE_PARAM].value = 2;
-    while (cn._msgCount() < 4) {
-        cn.step();
+}
+
+static double correlation(const std::vector<float>& a, const std::vector<float>& b)
+{
+    double ab = 0, aa = 0, bb = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        ab += a[i] * b[i];
+        aa += a[i] * a[i];
+        bb += b[i] * b[i];
     }
-    cn.params[Noise::SLOPE_PARAM].value = 2.3f;
-    while (cn._msgCount() < 5) {
+    return ab / std::sqrt(aa * bb);
+}
+
+/**
+ * 16 channels of white noise should all be different,
+ * and each channel can have its own slope.
+ */
+static void testPoly()
+{
+    Noise cn;
+    cn.init();
+    cn.params[Noise::SLOPE_TRIM].value = 1;
+    cn.inputs[Noise::SLOPE_CV].channels = 16;
+    cn.outputs[Noise::AUDIO_OUTPUT].channels = 1;
+    cn.inputs[Noise::SLOPE_CV].setVoltage(-5, 15);   // max neg slope on last channel
+    while (cn._msgCount() < 1) {
         cn.step();
     }
-    cn.params[Noise::SLOPE_PARAM].value = 2.5f;
-    while (cn._msgCount() < 6) {
+    assertEQ(cn.outputs[Noise::AUDIO_OUTPUT].channels, 16);
+
+    std::vector<float> outputs[16];
+    for (int i = 0; i < 20000; ++i) {
         cn.step();
+        for (int ch = 0; ch < 16; ++ch) {
+            outputs[ch].push_back(cn.outputs[Noise::AUDIO_OUTPUT].getVoltage(ch));
+        }
     }
-    cn.params[Noise::SLOPE_PARAM].value = -1.2f;
-    while (cn._msgCount() < 7) {
-        cn.step();
+
+    for (int ch = 1; ch < 15; ++ch) {
+        assertLT(std::abs(correlation(outputs[0], outputs[ch])), .1);
+    }
+
+    // brown noise moves slowly, so it will be strongly correlated
+    // with itself one sample later. white noise is not.
+    std::vector<float> delayed0(outputs[0].begin() + 1, outputs[0].end());
+    std::vector<float> delayed15(outputs[15].begin() + 1, outputs[15].end());
+    outputs[0].pop_back();
+    outputs[15].pop_back();
+    assertLT(std::abs(correlation(outputs[0], delayed0)), .1);
+    assertGT(correlation(outputs[15], delayed15), .9);
+}
+
+/**
+ * Two instances share the bank, but should still
+ * play different noise.
+ */
+static void testTwoInstances()
+{
+    Noise cn0;
+    Noise cn1;
+    cn0.init();
+    cn1.init();
+    while (cn0._msgCount() < 1 || cn1._msgCount() < 1) {
+        cn0.step();
+        cn1.step();
+    }
+
+    std::vector<float> output0;
+    std::vector<float> output1;
+    for (int i = 0; i < 20000; ++i) {
+        cn0.step();
+        cn1.step();
+        output0.push_back(cn0.outputs[Noise::AUDIO_OUTPUT].getVoltage(0));
+        output1.push_back(cn1.outputs[Noise::AUDIO_OUTPUT].getVoltage(0));
     }
+    assertLT(std::abs(correlation(output0, output1)), .1);
 }
 
 void testColoredNoise()
@@ -92,5 +206,9 @@ void testColoredNoise()
     test0();
     test1();
     test2();
+    testBankMix();
+    testBankCoherent();
+    testPoly();
+    testTwoInstances();
     testFinalLeaks();
 }
\ No newline at end of file
@@ -342,6 +342,37 @@ static void testLookupAboveTheshNoKnee2() {
     testLookupAboveTheshNoKnee2(8);
 }
 
+/**
+ * The accelerated lookups must match the original search
+ * to within float rounding.
+ */
+static void testLookupMatchesSearch(float ratio, float kneeWidth) {
+    CompCurves::Recipe r;
+    r.ratio = ratio;
+    r.kneeWidth = kneeWidth;
+    auto table = CompCurves::makeCompGainLookup(r);
+
+    for (float input = 0; input < 120; input += (input < 4) ? .001f : .1f) {
+        const float expected = NonUniformLookupTable<float>::lookupSearch(*table, input);
+        const float actual = CompCurves::lookup(table, input);
+        assertClose(actual, expected, .00001);
+
+        const float_4 input4(input, input * 1.01f, input * 1.1f, input * 2);
+        const float_4 actual4 = CompCurves::lookup4(table, input4);
+        for (int i = 0; i < 4; ++i) {
+            assertClose(actual4[i], NonUniformLookupTable<float>::lookupSearch(*table, input4[i]), .00001);
+        }
+    }
+}
+
+static void testLookupMatchesSearch() {
+    testLookupMatchesSearch(1, 0);
+    testLookupMatchesSearch(4, 0);
+    testLookupMatchesSearch(20, 0);
+    testLookupMatchesSearch(2, 6);
+    testLookupMatchesSearch(8, 12);
+}
+
 void testCompCurves() {
     testInflection();
 
@@ -352,6 +383,7 @@ void testCompCurves() {
     testLookupAboveTheshNoKneeNoComp();
     testLookupAboveTheshNoKnee();
     testLookupAboveTheshNoKnee2();
+    testLookupMatchesSearch();
 
     // TODO: make these test work
     //  testLookupAboveTheshKnee();
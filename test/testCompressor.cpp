@@ -2,6 +2,7 @@
 
 #include "Compressor.h"
 #include "Compressor2.h"
+#include "SimdDispatch.h"
 
 #include "tutil.h"
 
@@ -222,6 +223,47 @@ static void testCompPoly() {
     test.testPoly();
 }
 
+// the AVX build of Compressor2 must match the SSE fallback.
+// On a machine without AVX both are the fallback, which is fine.
+static void testComp2Dispatch(Cmprsr::Ratios ratio, int numChan) {
+    using Comp = Compressor2<TestComposite>;
+    std::shared_ptr<Comp> comps[2] = {std::make_shared<Comp>(), std::make_shared<Comp>()};
+
+    SimdDispatch::_forceSSE(true);
+    initComposite(*comps[0]);
+    SimdDispatch::_forceSSE(false);
+    initComposite(*comps[1]);
+
+    for (auto comp : comps) {
+        comp->params[Comp::RATIO_PARAM].value = float(int(ratio));
+        comp->params[Comp::THRESHOLD_PARAM].value = 1;
+        comp->inputs[Comp::LAUDIO_INPUT].channels = numChan;
+        comp->outputs[Comp::LAUDIO_OUTPUT].channels = numChan;
+    }
+
+    TestComposite::ProcessArgs args;
+    for (int i = 0; i < 2000; ++i) {
+        for (auto comp : comps) {
+            for (int ch = 0; ch < numChan; ++ch) {
+                comp->inputs[Comp::LAUDIO_INPUT].setVoltage(float((i + 50 * ch) % 500) * .02f, ch);
+            }
+            comp->process(args);
+        }
+        for (int ch = 0; ch < numChan; ++ch) {
+            assertClose(comps[0]->outputs[Comp::LAUDIO_OUTPUT].voltages[ch], comps[1]->outputs[Comp::LAUDIO_OUTPUT].voltages[ch], .0001);
+            assertClose(comps[0]->getChannelGain(ch), comps[1]->getChannelGain(ch), .0001);
+        }
+        assertClose(comps[0]->getGainReductionDb(), comps[1]->getGainReductionDb(), .001);
+    }
+}
+
+static void testComp2Dispatch(Cmprsr::Ratios ratio) {
+    testComp2Dispatch(ratio, 1);
+    testComp2Dispatch(ratio, 5);
+    testComp2Dispatch(ratio, 12);
+    testComp2Dispatch(ratio, 16);
+}
+
 static void testCompPolyOrig() {
     using Comp = Compressor<TestComposite>;
     std::shared_ptr<Comp> comp = std::make_shared<Comp>();
@@ -274,4 +316,6 @@ void testCompressor()
 
     // testCompPolyOrig();
     testCompPoly();
+    testComp2Dispatch(Cmprsr::Ratios::HardLimit);
+    testComp2Dispatch(Cmprsr::Ratios::_4_1_soft);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "AudioMath.h"
 #include "FFTData.h"
 #include "FFT.h"
+#include "FFTPlan.h"
 
 extern void testFinalLeaks();
 
@@ -306,6 +307,100 @@ static void testBlueNoise(float corner = 0)
 }
 
 
+static void testPlanCache()
+{
+    FFTPlanPtr p1 = FFTPlanCache::get(1024, false);
+    FFTPlanPtr p2 = FFTPlanCache::get(1024, false);
+    FFTPlanPtr inv = FFTPlanCache::get(1024, true);
+    FFTPlanPtr other = FFTPlanCache::get(2048, false);
+
+    assert(p1);
+    assert(p1 == p2);
+    assert(p1 != inv);
+    assert(p1 != other);
+    assertEQ(p1->size(), 1024);
+    assertEQ(p1->isInverse(), false);
+    assertEQ(inv->isInverse(), true);
+}
+
+static void testRoundTripNotPowerOfTwo()
+{
+    const int size = 24;
+    FFTDataReal realIn(size);
+    FFTDataReal realOut(size);
+    FFTDataCpx complex(size);
+
+    for (int i = 0; i < size; ++i) {
+        realIn.set(i, float(sin(AudioMath::Pi * 2.0 * 3 * i / size)));
+    }
+
+    bool b = FFT::forward(&complex, realIn);
+    assert(b);
+    assertClose(std::abs(complex.get(3)), .5f, .0001);
+    b = FFT::inverse(&realOut, complex);
+    assert(b);
+
+    for (int i = 0; i < size; ++i) {
+        assertClose(realOut.get(i), realIn.get(i), .0001);
+    }
+}
+
+/**
+ * Runs a forward and inverse FFT with whatever plans FFTPlanCache picks.
+ */
+static void runBoth(int bins, std::vector<cpx>& spectrum, std::vector<float>& signal)
+{
+    FFTDataReal realIn(bins);
+    FFTDataCpx complexOut(bins);
+    FFTDataCpx complexIn(bins);
+    FFTDataReal realOut(bins);
+
+    srand(57);
+    for (int i = 0; i < bins; ++i) {
+        realIn.set(i, float(rand()) / float(RAND_MAX) - .5f);
+    }
+    FFT::makeNoiseSpectrum(&complexIn, ColoredNoiseSpec());
+
+    FFT::forward(&complexOut, realIn);
+    FFT::inverse(&realOut, complexIn);
+
+    spectrum.clear();
+    signal.clear();
+    for (int i = 0; i < bins; ++i) {
+        spectrum.push_back(complexOut.get(i));
+        signal.push_back(realOut.get(i));
+    }
+}
+
+static void testRadixMatchesKiss(int bins)
+{
+    std::vector<cpx> kissSpectrum, radixSpectrum;
+    std::vector<float> kissSignal, radixSignal;
+
+    FFTPlanCache::_forceKiss(true);
+    runBoth(bins, kissSpectrum, kissSignal);
+    FFTPlanCache::_forceKiss(false);
+    runBoth(bins, radixSpectrum, radixSignal);
+
+    float peak = 0;
+    for (int i = 0; i < bins; ++i) {
+        peak = std::max(peak, std::abs(kissSignal[i]));
+    }
+
+    for (int i = 0; i < bins; ++i) {
+        assertClose(radixSpectrum[i].real(), kissSpectrum[i].real(), .00001);
+        assertClose(radixSpectrum[i].imag(), kissSpectrum[i].imag(), .00001);
+        assertClose(radixSignal[i], kissSignal[i], .0001 * peak);
+    }
+}
+
+static void testRadixMatchesKiss()
+{
+    for (int bins = 8; bins <= 64 * 1024; bins *= 2) {
+        testRadixMatchesKiss(bins);
+    }
+}
+
 
 void testFFT()
 {
@@ -316,6 +411,9 @@ void testFFT()
     testForwardFFT_DC();
     test3();
     testRoundTrip();
+    testPlanCache();
+    testRoundTripNotPowerOfTwo();
+    testRadixMatchesKiss();
     testNoiseFormula();
     testNoiseRT();
     testPinkNoise();
@@ -3,6 +3,7 @@
 #include "TestComposite.h"
 #include "Filt.h"
 #include "LadderFilter.h"
+#include "LadderFilter_4.h"
 #include "PeakDetector.h"
 #include "TestComposite.h"
 
@@ -702,6 +703,100 @@ static void testProcVarsR()
     assertEQ(x.rightOutputChannels, 1);
 }
 
+/**
+ * Runs four scalar filters and one SIMD filter with the same settings,
+ * and makes sure each lane matches its scalar filter.
+ */
+static void testLadderSimdMatchesScalar(LadderFilterBase::Types type, LadderFilterBase::Voicing voicing)
+{
+    LadderFilter<float> scalar[4];
+    LadderFilter<float_4> simd;
+
+    const float_4 fc(.001f, .01f, .05f, .2f);
+    const float_4 feedback(0, 1, 2.5f, 3.9f);
+    const float_4 gain(.15f, 1, 2, 4);
+    const float_4 edge(.1f, .3f, .7f, 1);
+    const float_4 slope(0, 1.5f, 2.2f, 3);
+    const float_4 bass(1, 1.5f, 2, 3);
+
+    simd.setType(type);
+    simd.setVoicing(voicing);
+    simd.setNormalizedFc(fc);
+    simd.setFeedback(feedback);
+    simd.setGain(gain);
+    simd.setEdge(edge);
+    simd.setSlope(slope);
+    simd.setBassMakeupGain(bass);
+    simd.setFreqSpread(.5f);
+    simd.setVolume(.5f);
+
+    for (int i = 0; i < 4; ++i) {
+        LadderFilter<float>& f = scalar[i];
+        f.setType(type);
+        f.setVoicing(voicing);
+        f.setNormalizedFc(fc[i]);
+        f.setFeedback(feedback[i]);
+        f.setGain(gain[i]);
+        f.setEdge(edge[i]);
+        f.setSlope(slope[i]);
+        f.setBassMakeupGain(bass[i]);
+        f.setFreqSpread(.5f);
+        f.setVolume(.5f);
+    }
+
+    for (int sample = 0; sample < 400; ++sample) {
+        // a slow square wave, loud enough to hit the distortion
+        const float x = ((sample / 50) & 1) ? 5.f : -5.f;
+        simd.run(float_4(x));
+        const float_4 out = simd.getOutput();
+        for (int i = 0; i < 4; ++i) {
+            scalar[i].run(x);
+            assertClose(out[i], scalar[i].getOutput(), .001);
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        assertEQ(simd.getLEDValue(i), scalar[0].getLEDValue(i));
+    }
+}
+
+static void testLadderSimdMatchesScalar()
+{
+    for (int v = 0; v < (int) LadderFilterBase::Voicing::NUM_VOICINGS; ++v) {
+        testLadderSimdMatchesScalar(LadderFilterBase::Types::_4PLP, LadderFilterBase::Voicing(v));
+    }
+    for (int t = 0; t < (int) LadderFilterBase::Types::NUM_TYPES; ++t) {
+        testLadderSimdMatchesScalar(LadderFilterBase::Types(t), LadderFilterBase::Voicing::Classic);
+    }
+}
+
+static void testFiltPolyChannelsIndependent()
+{
+    using F = Filt<TestComposite>;
+    F f;
+    f.init();
+    f.inputs[F::L_AUDIO_INPUT].channels = 7;
+    f.inputs[F::CV_INPUT1].channels = 7;
+    f.outputs[F::L_AUDIO_OUTPUT].channels = 1;
+    f.outputs[F::R_AUDIO_OUTPUT].channels = 1;
+    f.params[F::MASTER_VOLUME_PARAM].value = 1;
+
+    // only channel 5 gets any input
+    f.inputs[F::L_AUDIO_INPUT].setVoltage(10, 5);
+
+    for (int i = 0; i < 50; ++i) {
+        f.step();
+    }
+
+    assertEQ(f.outputs[F::L_AUDIO_OUTPUT].channels, 7);
+    for (int i = 0; i < 7; ++i) {
+        if (i == 5) {
+            assertGT(f.outputs[F::L_AUDIO_OUTPUT].getVoltage(i), 1);
+        } else {
+            assertEQ(f.outputs[F::L_AUDIO_OUTPUT].getVoltage(i), 0);
+        }
+    }
+}
+
 void testLadder()
 {
     testEdgeInMiddleUnity(true);
@@ -740,6 +835,9 @@ void testLadder()
     testFiltOutputStereo();
     testFiltOutputLeftOnly();
     testFiltOutputRightOnly();
+    testFiltPolyChannelsIndependent();
+
+    testLadderSimdMatchesScalar();
 
     // the following are bad tests
 #if 0
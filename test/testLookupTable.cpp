@@ -446,6 +446,41 @@ static void testNonUniform4()
     assertClose(result, 11.f, .000001);
 }
 
+/**
+ * Clusters of close points mixed with big gaps, so
+ * some grid cells will hold more than one breakpoint.
+ */
+template <typename T>
+static void testNonUniformMatchesSearch()
+{
+    NonUniformLookupTableParams<T> params;
+    T x = 0;
+    for (int i = 0; i < 200; ++i) {
+        const T y = T(std::sin(i * .3)) * 10;
+        NonUniformLookupTable<T>::addPoint(params, x, y);
+        x += (i % 20 == 0) ? T(5) : T(.01 * (1 + (i % 7)));
+    }
+    NonUniformLookupTable<T>::finalize(params);
+
+    for (T input = -2; input < x + 2; input += T(.0037)) {
+        const T expected = NonUniformLookupTable<T>::lookupSearch(params, input);
+        const T actual = NonUniformLookupTable<T>::lookup(params, input);
+        assertClose(actual, expected, .0001);
+    }
+}
+
+template <typename T>
+static void testNonUniformOnePoint()
+{
+    NonUniformLookupTableParams<T> params;
+    NonUniformLookupTable<T>::addPoint(params, 1, 3);
+    NonUniformLookupTable<T>::finalize(params);
+
+    assertClose(NonUniformLookupTable<T>::lookup(params, -1), 3, .000001);
+    assertClose(NonUniformLookupTable<T>::lookup(params, 1), 3, .000001);
+    assertClose(NonUniformLookupTable<T>::lookup(params, 10), 3, .000001);
+}
+
 template <typename T>
 static void testGenericExp()
 {
@@ -509,6 +544,8 @@ static void test()
     testNonUniform2<T>();
     testNonUniform3<T>();
     testNonUniform4<T>(); 
+    testNonUniformMatchesSearch<T>();
+    testNonUniformOnePoint<T>();
 
     testGenericExp<T>();  
 }
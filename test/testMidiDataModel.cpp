@@ -1,10 +1,12 @@
 
+#include <algorithm>
 #include <assert.h>
 #include <memory>
 #include "MidiLock.h"
 #include "MidiSelectionModel.h"
 #include "MidiSong.h"
 #include "MidiTrack.h"
+#include "MidiTrackFlat.h"
 #include "TestAuditionHost.h"
 
 #include "asserts.h"
@@ -366,6 +368,208 @@ static void testPitchRoundTrip()
     assertEQ(PitchUtils::semitoneToCV(x), 0);
 }
 
+static void testFlatTrack()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = MidiTrack::makeTest(MidiTrack::TestContent::eightQNotes, lock);
+
+    MidiTrackFlat flat;
+    assertEQ(flat.getNumNotes(), 0);
+    assertEQ(flat.getLength(), 0);
+    assert(flat.isEnd(0));
+
+    flat.build(*track);
+    assertEQ(flat.getNumNotes(), 8);
+    assertEQ(flat.getLength(), track->getLength());
+
+    int i = 0;
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note) {
+            assert(!flat.isEnd(i));
+            assertEQ(flat.getStartTime(i), note->startTime);
+            assertEQ(flat.getDuration(i), note->duration);
+            assertEQ(flat.getPitchCV(i), note->pitchCV);
+            ++i;
+        }
+    }
+
+    // the end marker is at the end of the track
+    assert(flat.isEnd(8));
+    assertEQ(flat.getStartTime(8), track->getLength());
+
+    // building again should replace, not append
+    MidiTrackPtr track2 = MidiTrack::makeTest(MidiTrack::TestContent::oneQ1, lock);
+    flat.build(*track2);
+    assertEQ(flat.getNumNotes(), 1);
+    assertEQ(flat.getPitchCV(0), 3.f);
+    assertEQ(flat.getLength(), track2->getLength());
+
+    flat.clear();
+    assertEQ(flat.getNumNotes(), 0);
+    assertEQ(flat.getLength(), 0);
+}
+
+static void testFlatTrackEdit()
+{
+    MidiTrackFlat flat;
+    flat.reserve(8);
+    assertGE(flat.capacity(), 8);
+    flat.setLength(4);
+
+    flat.insertNote(2, 1, 5);
+    flat.insertNote(1, 1, 4);
+    flat.insertNote(1, .5, 3);          // goes after the other note at the same time
+    assertEQ(flat.getNumNotes(), 3);
+    assertEQ(flat.getPitchCV(0), 4);
+    assertEQ(flat.getPitchCV(1), 3);
+    assertEQ(flat.getPitchCV(2), 5);
+    assert(flat.isEnd(3));
+    assertEQ(flat.getLength(), 4);
+
+    // has to match exactly
+    assert(!flat.removeNote(1, 1, 3));
+    assert(flat.removeNote(1, 1, 4));
+    assertEQ(flat.getNumNotes(), 2);
+    assertEQ(flat.getStartTime(0), 1);
+    assertEQ(flat.getDuration(0), .5);
+    assertEQ(flat.getStartTime(1), 2);
+    assertEQ(flat.getLength(), 4);
+
+    assert(flat.removeNote(2, 1, 5));
+    assert(flat.removeNote(1, .5, 3));
+    assert(!flat.removeNote(1, .5, 3));
+    assertEQ(flat.getNumNotes(), 0);
+    assertEQ(flat.getLength(), 4);
+}
+
+static void testReplaceEvents()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = MidiTrack::makeTest(MidiTrack::TestContent::eightQNotes, lock);
+    const int origSize = track->size();
+
+    // replace every note with one a semitone higher. Big enough to merge in one pass.
+    std::vector<MidiEventPtr> toRemove;
+    std::vector<MidiEventPtr> toAdd;
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note) {
+            toRemove.push_back(note);
+            MidiNoteEventPtr newNote = note->clonen();
+            newNote->pitchCV += PitchUtils::semitone;
+            toAdd.push_back(newNote);
+        }
+    }
+    // add them backwards, to prove they get sorted.
+    std::reverse(toAdd.begin(), toAdd.end());
+
+    auto origNotes = track->_testGetVector();
+    track->replaceEvents(toRemove, toAdd);
+    track->assertValid();
+    assertEQ(track->size(), origSize);
+
+    auto newNotes = track->_testGetVector();
+    for (int i = 0; i < origSize - 1; ++i) {
+        MidiNoteEventPtr orig = safe_cast<MidiNoteEvent>(origNotes[i]);
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(newNotes[i]);
+        assertEQ(note->startTime, orig->startTime);
+        assertClose(note->pitchCV, orig->pitchCV + PitchUtils::semitone, .0001);
+    }
+
+    // now a small edit: replace one note with an identical one.
+    MidiNoteEventPtr first = track->getFirstNote();
+    MidiNoteEventPtr same = first->clonen();
+    track->replaceEvents({ first }, { same });
+    track->assertValid();
+    assertEQ(track->size(), origSize);
+
+    // the one we added is the one that stays
+    assert(track->findEventPointer(same) != track->end());
+    assert(track->findEventPointer(first) == track->end());
+}
+
+static MidiNoteEventPtr makeNote(float start, float duration, float pitch)
+{
+    MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+    note->startTime = start;
+    note->duration = duration;
+    note->pitchCV = pitch;
+    return note;
+}
+
+static void testNotesOverlapping()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = std::make_shared<MidiTrack>(lock, true);
+    track->setLength(40);
+
+    MidiNoteEventPtr longNote = makeNote(1, 30, 0);
+    track->insertEvent(longNote);
+    for (int i = 0; i < 40; ++i) {
+        track->insertEvent(makeNote(float(i), .5f, 1));
+    }
+
+    std::vector<MidiNoteEventPtr> notes;
+
+    // long note started way before, plus the two short ones that start in range
+    track->getNotesOverlapping(20, 21, notes);
+    assertEQ(notes.size(), 3);
+    assert(notes[0] == longNote);
+    assertEQ(notes[1]->startTime, 20);
+    assertEQ(notes[2]->startTime, 21);
+
+    // just an instant
+    track->getNotesOverlapping(20.75f, 20.75f, notes);
+    assertEQ(notes.size(), 1);
+    assert(notes[0] == longNote);
+
+    // the long note has ended by 31
+    track->getNotesOverlapping(31, 31, notes);
+    assertEQ(notes.size(), 1);
+    assertEQ(notes[0]->startTime, 31);
+
+    // the long note is only reported once, even though it crosses many bars.
+    track->getNotesOverlapping(0, 39, notes);
+    assertEQ(notes.size(), 41);
+
+    // compare to brute force, from every place in the track
+    for (float t = 0; t < 40; t += .25f) {
+        track->getNotesOverlapping(t, t + 1.5f, notes);
+        size_t expected = 0;
+        for (auto it : *track) {
+            MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+            if (note && (note->startTime <= t + 1.5f) && (note->startTime + note->duration > t || note->startTime >= t)) {
+                ++expected;
+            }
+        }
+        assertEQ(notes.size(), expected);
+    }
+
+    // index should follow deletes
+    track->deleteEvent(*longNote);
+    track->getNotesOverlapping(20.75f, 20.75f, notes);
+    assertEQ(notes.size(), 0);
+
+    // and big batch edits
+    MidiNoteEventPtr longNote2 = makeNote(2, 30, 0);
+    std::vector<MidiEventPtr> toRemove;
+    std::vector<MidiEventPtr> toAdd = { longNote2 };
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note && note->startTime >= 10) {
+            toRemove.push_back(note);
+        }
+    }
+    track->replaceEvents(toRemove, toAdd);
+    track->getNotesOverlapping(20, 21, notes);
+    assertEQ(notes.size(), 1);
+    assert(notes[0] == longNote2);
+}
+
 void testMidiDataModel()
 {
     assertNoMidi();     // check for leaks
@@ -387,6 +591,10 @@ void testMidiDataModel()
     testQuant();
     testQuantRel();
     testPitchRoundTrip();
+    testFlatTrack();
+    testFlatTrackEdit();
+    testReplaceEvents();
+    testNotesOverlapping();
 
 
 
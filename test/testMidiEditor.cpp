@@ -39,7 +39,7 @@ static MidiSequencerPtr makeTest(bool empty = false)
 
 
     sequencer->assertValid();
-    sequencer->song->lock->dataModelDirty();
+    sequencer->song->lock->snapshotDirty();
     return sequencer;
 }
 
@@ -505,7 +505,7 @@ static void testInsertSub(int advancUnitsBeforeInsert, bool advanceAfter, float
     seq->editor->advanceCursor(MidiEditor::Advance::Tick, advancUnitsBeforeInsert);
     
     // advance cursor may have dirtied the lock. let's clear
-    seq->context->getTrack()->lock->dataModelDirty();
+    seq->context->getTrack()->lock->snapshotDirty();
 
     float pitch = seq->context->cursorPitch();
 
@@ -801,6 +801,31 @@ static void testCut()
 #endif
 }
 
+// a long note that started before the viewport should still be found under the cursor
+static void testSelectLongNote()
+{
+    MidiSequencerPtr seq = makeTest(true);
+    const float pitch = PitchUtils::pitchToCV(3, 5);
+    MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+    note->startTime = 0;
+    note->duration = 12;
+    note->pitchCV = pitch;
+    {
+        MidiLocker l(seq->song->lock);
+        seq->context->getTrack()->setLength(16);
+        seq->context->getTrack()->insertEvent(note);
+    }
+
+    // move into the second two bars, where the note didn't start
+    seq->editor->selectAt(9, PitchUtils::pitchToCV(4, 0), false);
+    assertEQ(seq->context->startTime(), 8);
+    assert(seq->selection->empty());
+
+    seq->editor->selectAt(10, pitch, false);
+    assertEQ(seq->selection->size(), 1);
+    assert(seq->selection->isSelected(note));
+}
+
 void testMidiEditorSub(int trackNumber)
 {
     _trackNumber = trackNumber;
@@ -842,6 +867,7 @@ void testMidiEditorSub(int trackNumber)
     testChangeTrackLength();
     testChangeTrackLengthNoSnap();
     testCut();
+    testSelectLongNote();
 }
 
 void testMidiEditor()
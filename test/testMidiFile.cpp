@@ -1,23 +1,27 @@
 
 #define __STDC_WANT_LIB_EXT1__ 1        // to get tempnam_s
+#include "MidiFile.h"
+#include "MidiFileParser.h"
 #include "MidiSong.h"
 #include "MidiTrack.h"
 #include "MidiFileProxy.h"
 #include "asserts.h"
 //#include <filesystem>
 
+#include <sstream>
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
-static void test1()
-{
 #if defined(_MSC_VER)
-    const char* path = "..\\..\\test\\test1.mid";
+static const char* testFilePath = "..\\..\\test\\test1.mid";
 #else
-    const char* path = "./test/test1.mid";
+static const char* testFilePath = "./test/test1.mid";
 #endif
-    MidiSongPtr song = MidiFileProxy::load(path);
+
+static void test1()
+{
+    MidiSongPtr song = MidiFileProxy::load(testFilePath);
 
     fflush(stdout);
     assert(song);
@@ -84,8 +88,308 @@ static void test2()
 }
 #endif
 
+class SmfBuilder
+{
+public:
+    std::vector<uint8_t> data;
+
+    SmfBuilder(int numTracks, int ppq)
+    {
+        putString("MThd");
+        putBigEndian(6, 4);
+        putBigEndian(1, 2);
+        putBigEndian(numTracks, 2);
+        putBigEndian(ppq, 2);
+    }
+
+    void addTrack(const std::vector<uint8_t>& events)
+    {
+        putString("MTrk");
+        putBigEndian(uint32_t(events.size()), 4);
+        data.insert(data.end(), events.begin(), events.end());
+    }
+
+    static void putVarLen(std::vector<uint8_t>& out, uint32_t x)
+    {
+        uint8_t bytes[4];
+        int n = 0;
+        do {
+            bytes[n++] = x & 0x7f;
+            x >>= 7;
+        } while (x);
+        while (n--) {
+            out.push_back(bytes[n] | (n ? 0x80 : 0));
+        }
+    }
+
+    static void putEnd(std::vector<uint8_t>& out, uint32_t delta)
+    {
+        putVarLen(out, delta);
+        out.push_back(0xff);
+        out.push_back(0x2f);
+        out.push_back(0);
+    }
+
+private:
+    void putString(const char* s)
+    {
+        data.insert(data.end(), s, s + 4);
+    }
+
+    void putBigEndian(uint32_t x, int numBytes)
+    {
+        for (int i = numBytes - 1; i >= 0; --i) {
+            data.push_back(uint8_t(x >> (8 * i)));
+        }
+    }
+};
+
+// running status, and note on with velocity zero as the note off
+static void testParseRunningStatus()
+{
+    std::vector<uint8_t> events = {
+        0x00, 0x90, 60, 100,
+        0x60, 60, 0,                // running status note off at tick 96
+        0x00, 62, 100,
+        0x30, 0x80, 62, 0,          // real note off at tick 144
+    };
+    SmfBuilder::putEnd(events, 0x30);
+
+    SmfBuilder smf(1, 96);
+    smf.addTrack(events);
+
+    MidiFileParser parser;
+    assert(parser.parse(smf.data.data(), smf.data.size()));
+    assertEQ(parser.getTicksPerQuarterNote(), 96);
+    assertEQ(parser.getTracks().size(), 1);
+
+    const MidiFileParser::Track& track = parser.getTracks()[0];
+    assertEQ(track.notes.size(), 2);
+    assertEQ(track.notes[0].key, 60);
+    assertEQ(track.notes[0].startTick, 0);
+    assertEQ(track.notes[0].durationTicks, 96);
+    assertEQ(track.notes[1].key, 62);
+    assertEQ(track.notes[1].startTick, 96);
+    assertEQ(track.notes[1].durationTicks, 48);
+    assert(track.haveEnd);
+    assertEQ(track.endTick, 192);
+}
+
+// overlapping notes on the same key: note off goes with the latest note on
+static void testParseOverlap()
+{
+    std::vector<uint8_t> events = {
+        0x00, 0x90, 60, 100,
+        0x10, 0x90, 60, 100,
+        0x10, 0x80, 60, 0,
+        0x10, 0x80, 60, 0,
+        0x00, 0x90, 64, 100,        // never turned off
+    };
+    SmfBuilder::putEnd(events, 0);
+
+    SmfBuilder smf(1, 96);
+    smf.addTrack(events);
+
+    MidiFileParser parser;
+    assert(parser.parse(smf.data.data(), smf.data.size()));
+    const MidiFileParser::Track& track = parser.getTracks()[0];
+    assertEQ(track.notes.size(), 3);
+    assertEQ(track.notes[0].durationTicks, 0x30);
+    assertEQ(track.notes[1].durationTicks, 0x10);
+    assertEQ(track.notes[2].durationTicks, 0);
+}
+
+static void testParseBadFile()
+{
+    std::vector<uint8_t> events = { 0x00, 0x90, 60, 100, 0x10, 0x80, 60, 0 };
+    SmfBuilder::putEnd(events, 0);
+    SmfBuilder smf(1, 96);
+    smf.addTrack(events);
+
+    // chop it off in the middle of the track
+    std::vector<uint8_t> data = smf.data;
+    data.resize(data.size() - 6);
+    MidiFileParser parser;
+    assert(!parser.parse(data.data(), data.size()));
+    assert(!MidiFileProxy::load(data.data(), data.size()));
+
+    // SMPTE time
+    data = smf.data;
+    data[12] = 0xe7;
+    assert(!parser.parse(data.data(), data.size()));
+}
+
+// first track is meta only, so the song should come from the second
+static void testLoadSecondTrack()
+{
+    std::vector<uint8_t> tempo = { 0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20 };
+    SmfBuilder::putEnd(tempo, 0);
+
+    std::vector<uint8_t> notes = {
+        0x00, 0x90, 60, 100,
+        0x60, 0x80, 60, 0,
+        0x00, 0x90, 72, 100,
+        0x30, 0x80, 72, 0,
+    };
+    SmfBuilder::putEnd(notes, 1);     // just past the last note
+
+    SmfBuilder smf(2, 96);
+    smf.addTrack(tempo);
+    smf.addTrack(notes);
+
+    MidiSongPtr song = MidiFileProxy::load(smf.data.data(), smf.data.size());
+    assert(song);
+    MidiTrackPtr track = song->getTrack(0);
+    assertEQ(track->size(), 3);
+
+    MidiNoteEventPtr note = track->getFirstNote();
+    assertEQ(note->startTime, 0);
+    assertEQ(note->duration, 1);
+    assertEQ(note->pitchCV, PitchUtils::midiToCV(60));
+
+    // end gets rounded up to the next 1/16
+    assertEQ(track->getLength(), 1.75f);
+}
+
+// import only reads up to the first track with notes
+static void testParseStopsAtNotes()
+{
+    std::vector<uint8_t> tempo = { 0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20 };
+    SmfBuilder::putEnd(tempo, 0);
+
+    std::vector<uint8_t> notes = {
+        0x00, 0x90, 60, 100,
+        0x60, 0x80, 60, 0,
+    };
+    SmfBuilder::putEnd(notes, 0);
+
+    // a data byte with no running status
+    std::vector<uint8_t> bad = { 0x00, 60, 100 };
+
+    SmfBuilder smf(3, 96);
+    smf.addTrack(tempo);
+    smf.addTrack(notes);
+    smf.addTrack(bad);
+
+    MidiFileParser parser;
+    assert(!parser.parse(smf.data.data(), smf.data.size()));
+
+    assert(parser.parse(smf.data.data(), smf.data.size(), true));
+    assertEQ(parser.getTracks().size(), 2);
+    assertEQ(parser.getTracks()[1].notes.size(), 1);
+
+    MidiSongPtr song = MidiFileProxy::load(smf.data.data(), smf.data.size());
+    assert(song);
+    assertEQ(song->getTrack(0)->size(), 2);
+}
+
+static void testLoadNoEnd()
+{
+    std::vector<uint8_t> notes = {
+        0x00, 0x90, 60, 100,
+        0x60, 0x80, 60, 0,
+    };
+    SmfBuilder smf(1, 96);
+    smf.addTrack(notes);
+
+    MidiSongPtr song = MidiFileProxy::load(smf.data.data(), smf.data.size());
+    assert(song);
+    assertEQ(song->getTrack(0)->getLength(), 1);
+}
+
+static void assertSameAsMidifile(const std::vector<uint8_t>& data)
+{
+    MidiFileParser parser;
+    assert(parser.parse(data.data(), data.size()));
+
+    smf::MidiFile midiFile;
+    std::stringstream stream(std::string(data.begin(), data.end()));
+    assert(midiFile.read(stream));
+    midiFile.makeAbsoluteTicks();
+    midiFile.linkNotePairs();
+
+    assertEQ(parser.getTicksPerQuarterNote(), midiFile.getTicksPerQuarterNote());
+    assertEQ(int(parser.getTracks().size()), midiFile.getTrackCount());
+    for (int trackNum = 0; trackNum < midiFile.getTrackCount(); ++trackNum) {
+        const MidiFileParser::Track& track = parser.getTracks()[trackNum];
+        size_t noteNum = 0;
+        for (int i = 0; i < midiFile[trackNum].size(); ++i) {
+            smf::MidiEvent& evt = midiFile[trackNum][i];
+            if (evt.isNoteOn()) {
+                assertLT(noteNum, track.notes.size());
+                const MidiFileParser::Note& note = track.notes[noteNum++];
+                assertEQ(int(note.startTick), evt.tick);
+                assertEQ(int(note.durationTicks), evt.getTickDuration());
+                assertEQ(note.key, evt.getKeyNumber());
+            } else if (evt.isEndOfTrack()) {
+                assert(track.haveEnd);
+                assertEQ(int(track.endTick), evt.tick);
+            }
+        }
+        assertEQ(noteNum, track.notes.size());
+    }
+}
+
+static void testSameAsMidifile1()
+{
+    FILE* fp = fopen(testFilePath, "rb");
+    assert(fp);
+    std::vector<uint8_t> data;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        data.push_back(uint8_t(c));
+    }
+    fclose(fp);
+    assertSameAsMidifile(data);
+}
+
+// a big file with lots of notes in every track
+static void testSameAsMidifileBig()
+{
+    const int numTracks = 8;
+    SmfBuilder smf(numTracks, 480);
+    uint32_t seed = 12345;
+    auto random = [&seed](int range) {
+        seed = seed * 1664525 + 1013904223;
+        return int((seed >> 16) % range);
+    };
+
+    for (int trackNum = 0; trackNum < numTracks; ++trackNum) {
+        std::vector<uint8_t> events;
+        for (int i = 0; i < 4000; ++i) {
+            SmfBuilder::putVarLen(events, random(300));
+            const int key = 48 + random(12);
+            const int what = random(3);
+            if (what == 0) {
+                events.push_back(0x90 | trackNum);
+                events.push_back(key);
+                events.push_back(1 + random(127));
+            } else if (what == 1) {
+                events.push_back(0x80 | trackNum);
+                events.push_back(key);
+                events.push_back(0);
+            } else {
+                events.push_back(0x90 | trackNum);
+                events.push_back(key);
+                events.push_back(0);
+            }
+        }
+        SmfBuilder::putEnd(events, 0);
+        smf.addTrack(events);
+    }
+    assertSameAsMidifile(smf.data);
+}
+
 void testMidiFile()
 {
+    testParseRunningStatus();
+    testParseOverlap();
+    testParseBadFile();
+    testLoadSecondTrack();
+    testParseStopsAtNotes();
+    testLoadNoEnd();
+    testSameAsMidifile1();
+    testSameAsMidifileBig();
     test1();
 #if defined(_TMPNAM) && defined(_MSC_VER)
     test2();
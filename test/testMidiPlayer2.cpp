@@ -1,15 +1,19 @@
 
 #include "IMidiPlayerHost.h"
+#include "MidiEditQueue.h"
 #include "MidiLock.h"
 #include "MidiPlayer2.h"
 #include "MidiPlayer4.h"
+#include "MidiSequencer.h"
 
 #include "MidiSong.h"
 #include "MidiSong4.h"
 #include "MidiVoice.h"
 #include "MidiVoiceAssigner.h"
 #include "TestHost2.h"
+#include "TestAuditionHost.h"
 #include "TestHost4.h"
+#include "TestSettings.h"
 
 #include "asserts.h"
 #include <memory>
@@ -530,6 +534,70 @@ static void testVoiceAssignBug()
     assert(p->_getIndex() != 0);
 }
 
+// fill four voices with long notes, then ask for one more
+static int stealFromFour(MidiVoiceAssigner::StealPolicy policy, float newPitch)
+{
+    MidiVoice vx[4];
+    TestHost2 th;
+    MidiVoiceAssigner va(vx, 4);
+    va.setStealPolicy(policy);
+    initVoices(vx, 4, &th);
+
+    // voice 0 plays pitch 2, ends at 13
+    // voice 1 plays pitch 0, ends at 11
+    // voice 2 plays pitch 3, ends at 10
+    // voice 3 plays pitch 1, ends at 12
+    const float pitches[] = { 2, 0, 3, 1 };
+    const float ends[] = { 13, 11, 10, 12 };
+    for (int i = 0; i < 4; ++i) {
+        MidiVoice* p = va.getNext(pitches[i]);
+        assertEQ(p->_getIndex(), i);
+        p->playNote(pitches[i], 0, ends[i]);
+    }
+
+    // make voice 0 not the oldest, by stealing and re-playing it
+    if (policy == MidiVoiceAssigner::StealPolicy::Oldest) {
+        MidiVoice* p = va.getNext(2);
+        assertEQ(p->_getIndex(), 0);
+        p->playNote(2, 1, 13);
+    }
+    return va.getNext(newPitch)->_getIndex();
+}
+
+static void testVoiceStealPolicies()
+{
+    using Policy = MidiVoiceAssigner::StealPolicy;
+    assertEQ(stealFromFour(Policy::Next, 5), 0);
+    assertEQ(stealFromFour(Policy::Oldest, 5), 1);
+    assertEQ(stealFromFour(Policy::SoonestEnd, 5), 2);
+    assertEQ(stealFromFour(Policy::Lowest, 5), 1);
+    assertEQ(stealFromFour(Policy::Highest, 5), 2);
+    assertEQ(stealFromFour(Policy::SamePitch, 1), 3);
+
+    // nothing at this pitch, so take the oldest
+    assertEQ(stealFromFour(Policy::SamePitch, 5), 0);
+}
+
+// an idle voice is always used before stealing, whatever the policy
+static void testVoiceStealPolicyIdleFirst()
+{
+    MidiVoice vx[4];
+    TestHost2 th;
+    MidiVoiceAssigner va(vx, 4);
+    va.setStealPolicy(MidiVoiceAssigner::StealPolicy::Lowest);
+    initVoices(vx, 4, &th);
+
+    for (int i = 0; i < 4; ++i) {
+        MidiVoice* p = va.getNext(float(i));
+        p->playNote(float(i), 0, (i == 2) ? 1.f : 10.f);
+    }
+    for (int i = 0; i < 4; ++i) {
+        vx[i].updateToMetricTime(2);
+    }
+    assert(vx[2].state() == MidiVoice::State::Idle);
+    assertEQ(va.getNext(7)->_getIndex(), 2);
+}
+
 //********************* test helper functions ************************************************
 
 // song has an eight note starting at time 0
@@ -642,10 +710,10 @@ static std::shared_ptr<TestHost2> makeSongTouchingQandRun(bool exactDuration, fl
 }
 
 /**
- * runs a while, generates a lock contention, runs some more
+ * runs a while, runs some more while the song is being edited, then runs some more
  */
 template <class TPlayer, class THost, class TSong, bool hasPlayPosition>
-static std::shared_ptr<THost> makeSongOneQandRun2(float timeBeforeLock, float timeDuringLock, float timeAfterLock)
+static std::shared_ptr<THost> makeSongOneQandRunWhileEditing(float timeBeforeLock, float timeDuringLock, float timeAfterLock)
 {
     auto song = makeSongOneQ<TSong>();
     auto host = std::make_shared<THost>();
@@ -737,27 +805,24 @@ static void testMidiPlayerOneNoteOn()
     std::shared_ptr<THost> host = makeSongOneQandRun<TPlayer, THost, TSong, hasPlayPosition>(2 * .24f);
 
     assertAllButZeroAreInit(host.get());
-    assertEQ(host->lockConflicts, 0);
     assertEQ(host->gateChangeCount, 1);
     assertEQ(host->gateState[0], true);
     assertEQ(host->cvChangeCount, 1);
     assertEQ(host->cvValue[0], 2);
-    assertEQ(host->lockConflicts, 0);
 }
 
-// same as test1, but with a lock contention
+// same as test1, but the song is locked for editing part of the time.
+// both players play from their own copy of the song, so they don't care.
 template <class TPlayer, class THost, class TSong, bool hasPlayPosition>
-static void testMidiPlayerOneNoteOnWithLockContention(bool isSeq4)
+static void testMidiPlayerOneNoteOnWhileEditing()
 {
-    std::shared_ptr<THost> host = makeSongOneQandRun2<TPlayer, THost, TSong, hasPlayPosition>(2 * .20f, 2 * .01f, 2 * .03f);
+    std::shared_ptr<THost> host = makeSongOneQandRunWhileEditing<TPlayer, THost, TSong, hasPlayPosition>(2 * .20f, 2 * .01f, 2 * .03f);
 
-    const int expectedGateCount = isSeq4 ? 3 : 1;         // seq 4 clears gates on dirty
     assertAllButZeroAreInit(host.get());
-    assertEQ(host->gateChangeCount, expectedGateCount);
+    assertEQ(host->gateChangeCount, 1);
     assertEQ(host->gateState[0], true);
     assertEQ(host->cvChangeCount, 1);
     assertEQ(host->cvValue[0], 2);
-    assertEQ(host->lockConflicts, 1);
 }
 
 // play the first note on and off
@@ -769,23 +834,20 @@ static void testMidiPlayerOneNote()
     std::shared_ptr<THost> host = makeSongOneQandRun<TPlayer, THost, TSong, hasPlayPosition>(.5f);
 
     assertAllButZeroAreInit(host.get());
-    assertEQ(host->lockConflicts, 0);
     assertEQ(host->gateChangeCount, 2);
     assertEQ(host->gateState[0], false);
     assertEQ(host->cvChangeCount, 1);
     assertEQ(host->cvValue[0], 2);
 }
 
-// play the first note on and off with lock contention
+// play the first note on and off while the song is being edited
 template <class TPlayer, class THost, class TSong, bool hasPlayPosition>
-static void testMidiPlayerOneNoteLockContention(bool isSeq4)
+static void testMidiPlayerOneNoteWhileEditing()
 {
-    std::shared_ptr<THost> host = makeSongOneQandRun2<TPlayer, THost, TSong, hasPlayPosition>(2 * .20f, 2 * .01f, 2 * .04f);
-    const int expectedGateCount = isSeq4 ? 4 : 2;         // seq 4 clears gates on dirty
+    std::shared_ptr<THost> host = makeSongOneQandRunWhileEditing<TPlayer, THost, TSong, hasPlayPosition>(2 * .20f, 2 * .01f, 2 * .04f);
 
     assertAllButZeroAreInit(host.get());
-    assertEQ(host->lockConflicts, 1);
-    assertEQ(host->gateChangeCount, expectedGateCount);
+    assertEQ(host->gateChangeCount, 2);
     assertEQ(host->gateState[0], false);
     assertEQ(host->cvChangeCount, 1);
     assertEQ(host->cvValue[0], 2);
@@ -806,9 +868,9 @@ static void testMidiPlayerOneNoteLoop()
 
 // loop around to first note on second time
 template <class TPlayer, class THost, class TSong, bool hasPlayPosition>
-static void testMidiPlayerOneNoteLoopLockContention()
+static void testMidiPlayerOneNoteLoopWhileEditing()
 {
-    std::shared_ptr<THost> host = makeSongOneQandRun2<TPlayer, THost, TSong, hasPlayPosition>(2 * .4f, 2 * .7f, 2 * .4f);
+    std::shared_ptr<THost> host = makeSongOneQandRunWhileEditing<TPlayer, THost, TSong, hasPlayPosition>(2 * .4f, 2 * .7f, 2 * .4f);
 
     assertAllButZeroAreInit(host.get());
     assertGE(host->gateChangeCount, 3);
@@ -844,12 +906,10 @@ static void testMidiPlayerReset()
     pl.updateToMetricTime(2 * .24f, quantInterval, true);
 
     assertAllButZeroAreInit(host.get());
-    assertEQ(host->lockConflicts, 0);
     assertEQ(host->gateChangeCount, 1);
     assertEQ(host->gateState[0], true);
     assertEQ(host->cvChangeCount, 1);
     assertEQ(host->cvValue[0], 2);
-    assertEQ(host->lockConflicts, 0);
 }
 
 // Kind of a dumb test - just making sure we don't assert or crash
@@ -891,8 +951,12 @@ static void testMidiPlayerLoop()
     SubrangeLoop l(true, 4, 8);
     song->setSubrangeLoop(l);
     assert(song->getSubrangeLoop().enabled);
+    pl.sendEdits();
 
+    // the player doesn't have the loop until it applies the edits
+    assertEQ(pl.getCurrentSubrangeLoopStart(), 0);
     pl.updateToMetricTime(0, .5, true);        // send first clock, 1/8 note
+    assertEQ(pl.getCurrentSubrangeLoopStart(), 4);
 
     // Expect one note played on first clock, due to loop start offset
     assertEQ(1, host->gateChangeCount);
@@ -916,6 +980,7 @@ static void testMidiPlayerLoop2()
     SubrangeLoop l(true, 4, 8);
     song->setSubrangeLoop(l);
     assert(song->getSubrangeLoop().enabled);
+    pl.sendEdits();
 
     assertEQ(pl.getCurrentLoopIterationStart(), 0);
     pl.updateToMetricTime(0, .5, true);        // send first clock, 1/8 note
@@ -949,6 +1014,7 @@ static void testMidiPlayerLoop3()
     SubrangeLoop l(true, 4, 8);
     song->setSubrangeLoop(l);
     assert(song->getSubrangeLoop().enabled);
+    pl.sendEdits();
 
     pl.updateToMetricTime(0, .5, true);        // send first clock, 1/8 note
 
@@ -1113,19 +1179,345 @@ static void testQuantizedRetrigger2()
     _testQuantizedRetrigger2<TPlayer, THost, TSong>(.25f);
 }
 
+static void setPitchAt(MidiSongPtr song, float startTime, float pitchCV)
+{
+    MidiLocker l(song->lock);
+    MidiTrackPtr track = song->getTrack(0);
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note && note->startTime == startTime) {
+            MidiNoteEventPtr newNote = safe_cast<MidiNoteEvent>(note->clone());
+            newNote->pitchCV = pitchCV;
+            track->deleteEvent(*note);
+            track->insertEvent(newNote);
+            return;
+        }
+    }
+    assert(false);
+}
+
+static void transposeAll(MidiSongPtr song, float amount)
+{
+    MidiLocker l(song->lock);
+    MidiTrackPtr track = song->getTrack(0);
+    std::vector<MidiNoteEventPtr> notes;
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note) {
+            notes.push_back(note);
+        }
+    }
+    for (MidiNoteEventPtr note : notes) {
+        MidiNoteEventPtr newNote = safe_cast<MidiNoteEvent>(note->clone());
+        newNote->pitchCV += amount;
+        track->deleteEvent(*note);
+        track->insertEvent(newNote);
+    }
+}
+
+static MidiSongPtr makeSongManyNotes(int numNotes)
+{
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
+    MidiLocker l(song->lock);
+    MidiTrackPtr track = song->getTrack(0);
+    if (numNotes) {
+        track->setLength(numNotes * .25f);
+    }
+    for (int i = 0; i < numNotes; ++i) {
+        MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+        note->startTime = i * .25f;
+        note->duration = .125f;
+        note->pitchCV = (i % 2) ? 1.f : 0.f;
+        track->insertEvent(note);
+    }
+    return song;
+}
+
+// small steps, so every note off gets its own call and no notes are retriggered.
+static void playSlowly(MidiPlayer2& pl, double fromTime, double toTime)
+{
+    for (double time = fromTime; time < toTime; time += .05) {
+        pl.updateToMetricTime(time, quantInterval, true);
+    }
+    pl.updateToMetricTime(toTime, quantInterval, true);
+}
+
+/**
+ * Editing the song while it plays should be picked up
+ * once the UI sends the edits, without starting over.
+ */
+static void testMidiPlayerEditWhilePlaying()
+{
+    // sixteenth notes, pitch 0, 1, 0, 1...
+    MidiSongPtr song = makeSongManyNotes(16);
+    std::shared_ptr<TestHost2> host = std::make_shared<TestHost2>();
+    MidiPlayer2 pl(host, song);
+    pl.setNumVoices(0, 1);
+
+    playSlowly(pl, 0, 1.1);
+    assertEQ(host->cvValue[0], 0);
+    assertEQ(host->cvChangeCount, 5);
+
+    setPitchAt(song, 1.25, 2.f);
+    {
+        // nothing gets sent while an edit is in progress
+        MidiLocker l(song->lock);
+        pl.sendEdits();
+    }
+    pl.updateToMetricTime(1.2, quantInterval, true);
+    assertEQ(host->cvValue[0], 0);
+
+    pl.sendEdits();
+    playSlowly(pl, 1.2, 1.3);
+    assertEQ(host->cvValue[0], 2);
+
+    // if it had started over, we would have heard the first five notes again
+    assertEQ(host->cvChangeCount, 6);
+}
+
+/**
+ * In remote edit mode Seq++ plays a track from another module's song,
+ * wrapped in a song of its own. The editor only locks the track's lock,
+ * so that is where the player must look for edits.
+ */
+static void testMidiPlayerRemoteEdit()
+{
+    MidiSongPtr remoteSong = makeSongManyNotes(16);
+    MidiTrackPtr track = remoteSong->getTrack(0);
+    MidiSongPtr song = std::make_shared<MidiSong>();
+    song->addTrack(0, track);
+    assert(song->lock != track->lock);
+
+    std::shared_ptr<TestHost2> host = std::make_shared<TestHost2>();
+    MidiPlayer2 pl(host, song);
+    pl.setNumVoices(0, 1);
+
+    playSlowly(pl, 0, 1.1);
+    assertEQ(host->cvValue[0], 0);
+
+    MidiSequencerPtr seq = MidiSequencer::make(
+        song,
+        std::make_shared<TestSettings>(),
+        std::make_shared<TestAuditionHost>());
+    seq->editor->selectAll();
+    seq->editor->changePitch(12);
+
+    // the other module's player watches the same lock. It must not hide the edit from us.
+    remoteSong->lock->snapshotDirty();
+    pl.sendEdits();
+
+    // the next note was pitch 1, up an octave
+    playSlowly(pl, 1.1, 1.3);
+    assertEQ(host->cvValue[0], 2);
+
+    seq->undo->undo(seq);
+    remoteSong->lock->snapshotDirty();
+    pl.sendEdits();
+    playSlowly(pl, 1.3, 1.55);
+    assertEQ(host->cvValue[0], 0);
+}
+
+/**
+ * An edit that changes every note gets sent as a whole new track.
+ * It should still pick up where it left off.
+ */
+static void testMidiPlayerBigEditWhilePlaying()
+{
+    const int numNotes = 4 * MidiEditQueue::maxEditsPerTrack;
+    MidiSongPtr song = makeSongManyNotes(numNotes);
+    std::shared_ptr<TestHost2> host = std::make_shared<TestHost2>();
+    MidiPlayer2 pl(host, song);
+    pl.setNumVoices(0, 1);
+
+    playSlowly(pl, 0, 10.1);
+    assertEQ(host->cvValue[0], 0);
+    const int cvChanges = host->cvChangeCount;
+    assertEQ(cvChanges, 41);
+
+    transposeAll(song, 2);
+    pl.sendEdits();
+
+    // the next two notes, transposed
+    playSlowly(pl, 10.1, 10.3);
+    assertEQ(host->cvValue[0], 3);
+    playSlowly(pl, 10.3, 10.6);
+    assertEQ(host->cvValue[0], 2);
+    assertEQ(host->cvChangeCount, cvChanges + 2);
+
+    // Send more whole tracks than the player can take at once.
+    // The rest should wait, and none should leak.
+    for (int i = 0; i < 20; ++i) {
+        transposeAll(song, 1);
+        pl.sendEdits();
+    }
+    for (int i = 0; i < 4; ++i) {
+        pl.updateToMetricTime(10.6, quantInterval, true);
+        pl.sendEdits();
+    }
+    playSlowly(pl, 10.6, 10.8);
+    assertEQ(host->cvValue[0], 23);
+}
+
+// two voices playing long notes, then a third note has to steal one
+static int stealFromPlayer(MidiVoiceAssigner::StealPolicy policy)
+{
+    MidiSongPtr song = MidiSong::makeTest(MidiTrack::TestContent::empty, 0);
+    {
+        MidiLocker l(song->lock);
+        MidiTrackPtr track = song->getTrack(0);
+        track->setLength(8);
+        const float pitches[] = { 1, 0, 5 };
+        for (int i = 0; i < 3; ++i) {
+            MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+            note->startTime = i * .5f;
+            note->duration = 4;
+            note->pitchCV = pitches[i];
+            track->insertEvent(note);
+        }
+    }
+    std::shared_ptr<TestHost2> host = std::make_shared<TestHost2>();
+    MidiPlayer2 pl(host, song);
+    pl.setNumVoices(0, 2);
+    pl.setStealPolicy(0, policy);
+    playSlowly(pl, 0, 1.2);
+
+    assert(host->gateState[0]);
+    assert(host->gateState[1]);
+    for (int i = 0; i < 2; ++i) {
+        if (host->cvValue[i] == 5) {
+            return i;
+        }
+    }
+    assert(false);
+    return -1;
+}
+
+static void testMidiPlayerStealPolicy()
+{
+    assertEQ(stealFromPlayer(MidiVoiceAssigner::StealPolicy::Next), 0);
+    assertEQ(stealFromPlayer(MidiVoiceAssigner::StealPolicy::Lowest), 1);
+}
+
+static void addNotes(MidiSongPtr song, int first, int count)
+{
+    MidiTrackPtr track = song->getTrack(0);
+    MidiLocker l(song->lock);
+    track->setLength(float(first + count));
+    for (int i = first; i < first + count; ++i) {
+        MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+        note->startTime = float(i);
+        note->duration = .5f;
+        note->pitchCV = i * .1f;
+        track->insertEvent(note);
+    }
+}
+
+// removes the notes from first on
+static void removeNotes(MidiSongPtr song, int first)
+{
+    MidiTrackPtr track = song->getTrack(0);
+    MidiLocker l(song->lock);
+    std::vector<MidiNoteEventPtr> notes;
+    for (auto it : *track) {
+        MidiNoteEventPtr note = safe_cast<MidiNoteEvent>(it.second);
+        if (note && note->startTime >= first) {
+            notes.push_back(note);
+        }
+    }
+    for (auto note : notes) {
+        track->deleteEvent(*note);
+    }
+    track->setLength(float(first));
+}
+
+static void assertNotes(const MidiTrackFlat& track, int numNotes)
+{
+    assertEQ(track.getNumNotes(), numNotes);
+    assertEQ(track.getLength(), numNotes);
+    for (int i = 0; i < numNotes; ++i) {
+        assertEQ(track.getStartTime(i), i);
+        assertEQ(track.getPitchCV(i), i * .1f);
+    }
+}
+
+/**
+ * Edits get applied a few at a time, so the audio thread
+ * never does too much work in one block.
+ * But each edit is applied all at once, so it never plays half of one.
+ */
+static void testEditQueueBounded()
+{
+    MidiSongPtr song = makeSongManyNotes(0);
+    MidiTrackPtr track = song->getTrack(0);
+    MidiEditQueue queue;
+
+    bool b = queue.sendTrack(*track, true);
+    assert(b);
+    MidiEditQueue::Changes changes = queue.apply();
+    assert(changes.restart);
+    assertEQ(queue.getTrack().getNumNotes(), 0);
+
+    // more than one block's worth, but it all goes at once
+    const int numNotes = MidiEditQueue::maxEditsPerBlock + 8;
+    addNotes(song, 0, numNotes);
+    b = queue.sendTrack(*track, false);
+    assert(b);
+    changes = queue.apply();
+    assert(changes.edited);
+    assert(!changes.restart);
+    assertNotes(queue.getTrack(), numNotes);
+
+    changes = queue.apply();
+    assert(!changes.edited);
+
+    // two edits that won't both fit in one block go one at a time.
+    const int groupNotes = MidiEditQueue::maxEditsPerBlock / 2;
+    removeNotes(song, numNotes - groupNotes);
+    b = queue.sendTrack(*track, false);
+    assert(b);
+    removeNotes(song, numNotes - 2 * groupNotes);
+    b = queue.sendTrack(*track, false);
+    assert(b);
+
+    changes = queue.apply();
+    assert(changes.edited);
+    assertNotes(queue.getTrack(), numNotes - groupNotes);
+
+    changes = queue.apply();
+    assert(changes.edited);
+    assertNotes(queue.getTrack(), numNotes - 2 * groupNotes);
+
+    changes = queue.apply();
+    assert(!changes.edited);
+
+    // nothing changed, so nothing to send
+    b = queue.sendTrack(*track, false);
+    assert(b);
+    changes = queue.apply();
+    assert(!changes.edited);
+
+    // loop changes start over
+    b = queue.sendLoop(SubrangeLoop(true, 1, 2));
+    assert(b);
+    changes = queue.apply();
+    assert(changes.restart);
+    assert(queue.getLoop().enabled);
+    assertEQ(queue.getLoop().endTime, 2);
+}
+
 //*******************************tests of MidiPlayer2 **************************************
 
 template <class TPlayer, class THost, class TSong, bool hasPlayPosition>
-static void playerTests(bool isSeq4)
+static void playerTests()
 {
     testMidiPlayer0<TPlayer, THost, TSong>();
     testMidiPlayerOneNoteOn<TPlayer, THost, TSong, hasPlayPosition>();
-    testMidiPlayerOneNoteOnWithLockContention<TPlayer, THost, TSong, hasPlayPosition>(isSeq4);
+    testMidiPlayerOneNoteOnWhileEditing<TPlayer, THost, TSong, hasPlayPosition>();
     // printf("(reset) ***put back the player  tests with lock contention\n");
 
-    testMidiPlayerOneNoteLockContention<TPlayer, THost, TSong, hasPlayPosition>(isSeq4);
+    testMidiPlayerOneNoteWhileEditing<TPlayer, THost, TSong, hasPlayPosition>();
     testMidiPlayerOneNote<TPlayer, THost, TSong, hasPlayPosition>();
-    testMidiPlayerOneNoteLoopLockContention<TPlayer, THost, TSong, hasPlayPosition>();
+    testMidiPlayerOneNoteLoopWhileEditing<TPlayer, THost, TSong, hasPlayPosition>();
     testMidiPlayerOneNoteLoop<TPlayer, THost, TSong, hasPlayPosition>();
     testMidiPlayerReset<TPlayer, THost, TSong>();
     testMidiPlayerReset2<TPlayer, THost, TSong>();
@@ -1160,13 +1552,21 @@ void testMidiPlayer2()
     testVoiceAssignRotate();
     testVoiceAssignRetrigger();
     testVoiceAssignBug();
+    testVoiceStealPolicies();
+    testVoiceStealPolicyIdleFirst();
 
-    playerTests<MidiPlayer2, TestHost2, MidiSong, true>(false);
-    playerTests<MidiPlayer4, TestHost4, MidiSong4, false>(true);
+    playerTests<MidiPlayer2, TestHost2, MidiSong, true>();
+    playerTests<MidiPlayer4, TestHost4, MidiSong4, false>();
     player4Tests();
 
     // loop tests not templatized, because player 4 doesn't have subrange loop
     testMidiPlayerLoop();
     testMidiPlayerLoop2();
     testMidiPlayerLoop3();
+
+    testMidiPlayerEditWhilePlaying();
+    testMidiPlayerBigEditWhilePlaying();
+    testMidiPlayerRemoteEdit();
+    testEditQueueBounded();
+    testMidiPlayerStealPolicy();
 }
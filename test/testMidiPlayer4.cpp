@@ -468,6 +468,8 @@ static void testLockGates()
         //song->lock.
        // pl.updateToMetricTime(4.1, quantizationInterval, true);
     }
+    pl.updateSnapshot();
+    pl.step();                  // like the composite, let all the tracks pick up the edit before we play
     //about to play after reset
     pl.updateToMetricTime(4.1, quantizationInterval, true);
     assertEQ(host->numGates(), 1);
@@ -536,6 +538,85 @@ static void testSectionApi()
 }
 
 
+static void setFirstPitch(MidiSong4Ptr song, int trackNum, float pitchCV)
+{
+    MidiLocker l(song->lock);
+    MidiTrackPtr track = song->getTrack(trackNum);
+    MidiNoteEventPtr note = track->getFirstNote();
+    MidiEventPtr newEvent = note->clone();
+    MidiNoteEventPtr newNote = safe_cast<MidiNoteEvent>(newEvent);
+    newNote->pitchCV = pitchCV;
+    track->deleteEvent(*note);
+    track->insertEvent(newNote);
+}
+
+/**
+ * Editing the song while it plays should be picked up
+ * once the UI sends the player a new snapshot.
+ */
+static void testEditWhilePlaying()
+{
+    const int trackNum = 0;
+    MidiSong4Ptr song = MidiSong4::makeTest(MidiTrack::TestContent::oneQ1_75, trackNum);
+    std::shared_ptr<TestHost4> host = std::make_shared<TestHost4>();
+    MidiPlayer4 pl(host, song);
+    pl.step();
+
+    const float quantizationInterval = .01f;
+    pl.updateToMetricTime(1.1, quantizationInterval, true);
+    assertEQ(host->cvValue[0], 7.5f);
+    pl.updateToMetricTime(3.9, quantizationInterval, true);
+
+    setFirstPitch(song, trackNum, 2.f);
+
+    // player hasn't seen the edit yet, so it plays the old note again.
+    pl.updateToMetricTime(4.1, quantizationInterval, true);
+    assertEQ(host->cvValue[0], 7.5f);
+
+    pl.updateSnapshot();
+
+    // the edit starts the section over, so we hear the new note when we play the second time around.
+    pl.updateToMetricTime(5.1, quantizationInterval, true);
+    assertEQ(host->cvValue[0], 2.f);
+}
+
+/**
+ * If the UI makes more snapshots than the player can take,
+ * the player should still end up with the last one.
+ */
+static void testManyEditsBeforePlay()
+{
+    const int trackNum = 0;
+    MidiSong4Ptr song = MidiSong4::makeTest(MidiTrack::TestContent::oneQ1_75, trackNum);
+    std::shared_ptr<TestHost4> host = std::make_shared<TestHost4>();
+    MidiPlayer4 pl(host, song);
+    pl.step();
+
+    const float quantizationInterval = .01f;
+    pl.updateToMetricTime(1.1, quantizationInterval, true);
+    assertEQ(host->cvValue[0], 7.5f);
+
+    for (int i = 0; i < 20; ++i) {
+        setFirstPitch(song, trackNum, float(i) / 10.f);
+        pl.updateSnapshot();
+    }
+
+    // the player has taken all it can. The last edit waits in the UI
+    // until the next update.
+    pl.updateToMetricTime(1.1, quantizationInterval, true);
+    assertClose(host->cvValue[0], .7f, .0001);
+    pl.updateSnapshot();
+    pl.updateToMetricTime(1.1, quantizationInterval, true);
+    assertClose(host->cvValue[0], 1.9f, .0001);
+
+    // and again, after the player has handed back all the old ones.
+    pl.updateSnapshot();
+    setFirstPitch(song, trackNum, 3.f);
+    pl.updateSnapshot();
+    pl.updateToMetricTime(1.1, quantizationInterval, true);
+    assertEQ(host->cvValue[0], 3.f);
+}
+
 void testMidiPlayer4()
 {
     testSectionApi();
@@ -548,5 +629,7 @@ void testMidiPlayer4()
     testRepeatReset();
     testPauseSwitchSectionStart();
     testLockGates();
+    testEditWhilePlaying();
+    testManyEditsBeforePlay();
 }
    
\ No newline at end of file
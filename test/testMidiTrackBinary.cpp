@@ -0,0 +1,140 @@
+
+#include "MidiLock.h"
+#include "MidiTrack.h"
+#include "MidiTrackBinary.h"
+#include "PitchUtils.h"
+
+#include "asserts.h"
+
+static void assertSameTrack(MidiTrackPtr a, MidiTrackPtr b)
+{
+    assertEQ(a->size(), b->size());
+    auto va = a->_testGetVector();
+    auto vb = b->_testGetVector();
+    for (int i = 0; i < a->size(); ++i) {
+        assert(*va[i] == *vb[i]);
+    }
+}
+
+static MidiTrackPtr roundTrip(MidiTrackPtr track)
+{
+    const std::string data = MidiTrackBinary::toString(*track);
+    MidiTrackPtr ret = MidiTrackBinary::fromString(data, track->lock);
+    assert(ret);
+    ret->assertValid();
+    return ret;
+}
+
+static void testBase64()
+{
+    for (int size = 0; size < 10; ++size) {
+        std::vector<uint8_t> data;
+        for (int i = 0; i < size; ++i) {
+            data.push_back(uint8_t(i * 97 + 200));
+        }
+        const std::string str = MidiTrackBinary::toBase64(data);
+        assertEQ(str.size() % 4, 0);
+
+        std::vector<uint8_t> data2;
+        assert(MidiTrackBinary::fromBase64(str, data2));
+        assert(data == data2);
+    }
+    std::vector<uint8_t> x;
+    assertEQ(MidiTrackBinary::toBase64({ 'M', 'a', 'n' }), "TWFu");
+    assertEQ(MidiTrackBinary::toBase64({ 'M' }), "TQ==");
+    assert(!MidiTrackBinary::fromBase64("TQ=", x));
+    assert(!MidiTrackBinary::fromBase64("T!==", x));
+}
+
+static void testRoundTrip(MidiTrack::TestContent content)
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = MidiTrack::makeTest(content, lock);
+    assertSameTrack(track, roundTrip(track));
+}
+
+static void testRoundTrip()
+{
+    testRoundTrip(MidiTrack::TestContent::eightQNotes);
+    testRoundTrip(MidiTrack::TestContent::empty);
+    testRoundTrip(MidiTrack::TestContent::oneNote123);
+    testRoundTrip(MidiTrack::TestContent::oneQ1_75);
+    testRoundTrip(MidiTrack::TestContent::FourAlmostTouchingQuarters_12);
+    testRoundTrip(MidiTrack::TestContent::eightQNotesCMaj);
+}
+
+// values that aren't on the grid, or aren't semitones, must come back bit-exact
+static void testRoundTripOdd()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = std::make_shared<MidiTrack>(lock, true);
+    track->setLength(1000);
+
+    float t = 0;
+    for (int i = 0; i < 100; ++i) {
+        MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+        note->startTime = t;
+        note->duration = (i % 3) ? .25f : .1234f;
+        note->pitchCV = (i % 2) ? PitchUtils::pitchToCV(2 + i % 5, i % 12) : -1.23456f + i * .011f;
+        track->insertEvent(note);
+        t += (i % 4) ? 1.f / 3.f : .07f;
+    }
+    assertSameTrack(track, roundTrip(track));
+}
+
+static void testSize()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    MidiTrackPtr track = std::make_shared<MidiTrack>(lock, true);
+    const int numNotes = 1000;
+    track->setLength(numNotes);
+    for (int i = 0; i < numNotes; ++i) {
+        MidiNoteEventPtr note = std::make_shared<MidiNoteEvent>();
+        note->startTime = float(i);
+        note->duration = .5f;
+        note->pitchCV = PitchUtils::pitchToCV(3, i % 12);
+        track->insertEvent(note);
+    }
+    const std::string data = MidiTrackBinary::toString(*track);
+
+    // a note on the grid is seven bytes, under ten after base64.
+    // The JSON for one is over fifty.
+    assertLE(data.size(), numNotes * 10 + 20);
+    assertSameTrack(track, roundTrip(track));
+}
+
+static void testBadData()
+{
+    auto lock = MidiLock::make();
+    MidiLocker l(lock);
+    assert(!MidiTrackBinary::fromString("", lock));
+    assert(!MidiTrackBinary::fromString("not base64!", lock));
+
+    MidiTrackPtr track = MidiTrack::makeTest(MidiTrack::TestContent::eightQNotes, lock);
+    std::string data = MidiTrackBinary::toString(*track);
+
+    // chop off the end event
+    std::vector<uint8_t> binary;
+    assert(MidiTrackBinary::fromBase64(data, binary));
+    binary.resize(binary.size() - 2);
+    assert(!MidiTrackBinary::fromString(MidiTrackBinary::toBase64(binary), lock));
+
+    // wrong version
+    assert(MidiTrackBinary::fromBase64(data, binary));
+    binary[0] = 99;
+    assert(!MidiTrackBinary::fromString(MidiTrackBinary::toBase64(binary), lock));
+}
+
+void testMidiTrackBinary()
+{
+    assertNoMidi();     // check for leaks
+    testBase64();
+    testRoundTrip();
+    testRoundTripOdd();
+    testSize();
+    testBadData();
+    assertNoMidi();     // check for leaks
+}
@@ -572,6 +572,7 @@ static void testMissingSection()
     assertEQ(pl.getNextSectionRequest(), 1);        // so we wrap around to first
 
     song->addTrack(0, 0, nullptr);          // let's remove first clip
+    pl.setSnapshot(std::make_shared<const MidiSong4Snapshot>(*song));  // and tell the player
 
     pl.step();
     pl.playOnce(.1, quantizationInterval); // play a bit to prime the pump
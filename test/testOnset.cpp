@@ -433,34 +433,6 @@ static void testWaveFile2()
     assert(size > 0);
 }
 
-class TestOnsetDetector
-{
-public:
-    static void test1()
-    {
-        OnsetDetector o;
-        assertEQ(o.curFrame, 0);
-        assertEQ(o.nextFrame(), 1);
-        assertEQ(o.prevFrame(), 2);
-        assertEQ(o.prevPrevFrame(), 1);
-
-        o.curFrame = 1;
-        assertEQ(o.nextFrame(), 2);
-        assertEQ(o.prevFrame(), 0);
-        assertEQ(o.prevPrevFrame(), 2);
-        
-        o.curFrame = 2;
-        assertEQ(o.nextFrame(), 0);
-        assertEQ(o.prevFrame(), 1);
-        assertEQ(o.prevPrevFrame(), 0);
-    }
-};
-
- static void testOnsetDetector()
- {
-    TestOnsetDetector::test1();
- }
-
 #if 1
  static void testing()
  {
@@ -515,6 +487,5 @@ void testOnset()
 
     testWaveFile();
     testWaveFile2();
-    testOnsetDetector();
 #endif
 }
\ No newline at end of file
@@ -7,59 +7,75 @@
 
 #include "asserts.h"
 
+using DetectionFunction = OnsetDetector::DetectionFunction;
 
-
-//using generator = std::function<float(void)>;
-
+class OnsetResults
+{
+public:
+    int firstOnset = -1;
+    int triggerCount = 0;
+    int lastTriggerDuration = 0;
+};
 
 /**
- * find the first onset and returns it.
- * has various assertions an the trigger.
- * asserts if not exactly one trigger.
+ * Runs size samples from g through the detector.
+ * Asserts that the trigger goes low again by the end.
  */
-int findFirstOnset(TestGenerators::Generator g, int size, int numTriggersExpected)
+static OnsetResults findOnsets(OnsetDetector& o, TestGenerators::Generator g, int size)
 {
+    OnsetResults ret;
     bool isActive = false;
-    int triggerCount = 0;
-    int firstOnset = -1;
-    int triggerDuration = 0;
-
-    OnsetDetector o;
     int index = 0;
     while (size--) {
         ++index;
         const float x = float(g());
         const bool detected = o.step(x);
-        //if (detected) printf("DETECTED\n");
-
         const bool newTrigger = detected && !isActive;
         isActive = detected;
 
         if (newTrigger) {
-            ++triggerCount;
-            assert(triggerCount == 1);
-        }
-      
-
-        if (newTrigger) {
-            triggerDuration = -1;
+            ++ret.triggerCount;
+            ret.lastTriggerDuration = 0;
+            if (ret.firstOnset < 0) {
+                ret.firstOnset = index;
+            }
         }
-
-        if (newTrigger && firstOnset < 0) {
-            firstOnset = index;
-        }     
-
         if (isActive) {
-            triggerDuration++;
+            ret.lastTriggerDuration++;
         }
     }
     assert(!isActive);      // we want to see the detector go low
-    assertEQ(triggerCount, numTriggersExpected);
+    return ret;
+}
+
+/**
+ * find the first onset and returns it.
+ * asserts if not the expected number of triggers.
+ */
+int findFirstOnset(TestGenerators::Generator g, int size, int numTriggersExpected)
+{
+    OnsetDetector o;
+    OnsetResults results = findOnsets(o, g, size);
+    assertEQ(results.triggerCount, numTriggersExpected);
 
     if (numTriggersExpected) {
-        assertEQ(triggerDuration, 44);
+        // 1 ms at 44.1k
+        assertEQ(results.lastTriggerDuration, 44);
     }
-    return firstOnset;
+    return results.firstOnset;
+}
+
+/**
+ * sin that gets louder at stepPos.
+ */
+static TestGenerators::Generator makeSteppedSin(int stepPos, double normalizedFreq, double stepGain)
+{
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    return [counter, stepPos, normalizedFreq, stepGain]() {
+        const int i = (*counter)++;
+        const double gain = (i < stepPos) ? 1 / stepGain : 1;
+        return float(gain * std::sin(i * normalizedFreq * AudioMath::_2Pi));
+    };
 }
 
 static void test0()
@@ -82,80 +98,118 @@ static void testStepGen()
     }
 }
 
-static void testOnsetSin()
+static void testOnsetSilence()
 {
-    printf("\n\n*** test onset sin\n");
+    int x = findFirstOnset([]() { return 0.f; }, 512 * 10, 0);
+    assertLT(x, 0);
+}
 
-    // 512/10 is even, works
-    // TODO: two tests
+static void testOnsetSin()
+{
+    // sin starting at zero should not trigger, since it's in the preroll
     double period = 512 / 10.3;
     double freq = 1.0 / period;
     freq *= AudioMath::_2Pi;
 
-   // double freq = .02;
     int x = findFirstOnset(
         TestGenerators::makeSinGenerator(freq),
-        512 * 3,
+        512 * 10,
         0);
     assertLT(x, 0);
 }
 
-static void testOnsetDetectPulse()
+static void testOnsetDetectPulse(DetectionFunction function)
 {
-    printf("\n**** pulse\n");
     // let the test run long enough to see the pulse go low.
-    int x = findFirstOnset(TestGenerators::makeStepGenerator(512 * 5 + 256), 512 * 9, 1);
     const int actualOnset = int(OnsetDetector::frameSize * 5.5);
-    const int minOnset = OnsetDetector::preroll + OnsetDetector::frameSize * 5;
-    const int maxOnset = OnsetDetector::preroll + OnsetDetector::frameSize * 6;
-    assertGE(x, minOnset);
-    assertLE(x, maxOnset);
-}
+    OnsetDetector o(function);
+    OnsetResults results = findOnsets(o, TestGenerators::makeStepGenerator(actualOnset), 512 * 9);
+    assertEQ(results.triggerCount, 1);
 
+    // we should see it at the end of the hop that has the onset
+    assertGT(results.firstOnset, actualOnset);
+    assertLE(results.firstOnset, actualOnset + OnsetDetector::hopSize);
+}
 
-static void testOnsetDetectStep()
+static void testOnsetDetectPulse()
 {
-    printf("\n**** step\n");
-    // let the test run long enough to see the pulse go low.
-
-    // try to find a freq so that the phase doesn't jump at the step
-    int firstSectionLength = 512 * 5 + 256;
+    testOnsetDetectPulse(DetectionFunction::SpectralFlux);
+    testOnsetDetectPulse(DetectionFunction::PhaseDeviation);
+    testOnsetDetectPulse(DetectionFunction::ComplexDomain);
+}
 
+static void testOnsetDetectStep(DetectionFunction function)
+{
+    const int actualOnset = 512 * 5 + 256;
+    OnsetDetector o(function);
+    OnsetResults results = findOnsets(o, makeSteppedSin(actualOnset, .005, 8), 512 * 9);
+    assertEQ(results.triggerCount, 1);
+    assertGT(results.firstOnset, actualOnset);
+    assertLE(results.firstOnset, actualOnset + OnsetDetector::hopSize);
+}
 
-    // compute a freq close to what we want that will be even
-    double desiredFreq = .005;      // normalized to Fs
-    double desiredPeriod = 1 / desiredFreq;
-    double desiredPeriodsInSection = firstSectionLength / desiredPeriod;
+static void testOnsetDetectStep()
+{
+    // phase deviation can't see a step in amplitude, so don't test it.
+    testOnsetDetectStep(DetectionFunction::SpectralFlux);
+    testOnsetDetectStep(DetectionFunction::ComplexDomain);
+}
 
-    double periodsInSection = std::round(desiredPeriodsInSection);
-    double period = firstSectionLength / periodsInSection;
-    double freq = 1 / period;
+static void testOnsetSampleRate()
+{
+    OnsetDetector o;
+    o.setSampleRate(96000);
+    OnsetResults results = findOnsets(o, TestGenerators::makeStepGenerator(512 * 5), 512 * 9);
+    assertEQ(results.triggerCount, 1);
+    assertEQ(results.lastTriggerDuration, 96);
+}
 
-    freq *= AudioMath::_2Pi;
+/**
+ * two pulses, 20ms apart at 44.1k
+ */
+static TestGenerators::Generator makeTwoPulses()
+{
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    return [counter]() {
+        const int i = (*counter)++;
+        const bool first = (i >= 2048) && (i < 2048 + 100);
+        const bool second = (i >= 2048 + 882) && (i < 2048 + 882 + 100);
+        return (first || second) ? 1.f : 0.f;
+    };
+}
 
-    //double evenPeriod = std::round(desiredPeriod);
-    //double freq = 1 / evenPeriod;
+static void testOnsetHoldoff()
+{
+    OnsetDetector o;
+    o.setHoldoffMs(50);
+    OnsetResults results = findOnsets(o, makeTwoPulses(), 512 * 10);
+    assertEQ(results.triggerCount, 1);
+
+    OnsetDetector o2;
+    o2.setHoldoffMs(10);
+    results = findOnsets(o2, makeTwoPulses(), 512 * 10);
+    assertEQ(results.triggerCount, 2);
+}
 
-    
-    int x = findFirstOnset(
-        TestGenerators::makeSteppedSinGenerator(512 * 5 + 256, freq, 8),
-        512 * 9,
-        1);
-    const int actualOnset = int(OnsetDetector::frameSize * 5.5);
-    const int minOnset = OnsetDetector::preroll + OnsetDetector::frameSize * 5;
-    const int maxOnset = OnsetDetector::preroll + OnsetDetector::frameSize * 6;
-    assertGE(x, minOnset);
-    assertLE(x, maxOnset);
+static void testOnsetThreshold()
+{
+    // with a threshold that can't be reached, nothing triggers
+    OnsetDetector o;
+    o.setThreshold(1.1f);
+    OnsetResults results = findOnsets(o, TestGenerators::makeStepGenerator(512 * 5), 512 * 9);
+    assertEQ(results.triggerCount, 0);
+    assertGT(o.getDetectionValue(), -.001);
 }
 
 void testOnset2()
 {
-#if 0
     test0();
     testStepGen();
-    printf("REMOVED FAILING SIN TEST TEMPORARILY");
+    testOnsetSilence();
     testOnsetSin();
-    //testOnsetDetectPulse();
-   // testOnsetDetectStep();
-#endif
-}
\ No newline at end of file
+    testOnsetDetectPulse();
+    testOnsetDetectStep();
+    testOnsetSampleRate();
+    testOnsetHoldoff();
+    testOnsetThreshold();
+}
@@ -4,7 +4,7 @@
 
 #include "asserts.h"
 
-static void setup(IIRUpsampler& up, IIRDecimator<float>& dec)
+static void setup(IIRUpsampler<float>& up, IIRDecimator<float>& dec)
 {
    // float cutoff = .25 / 16;
     up.setup(16);
@@ -16,7 +16,7 @@ static void test0()
 {
     float buffer[16];
 
-    IIRUpsampler up;
+    IIRUpsampler<float> up;
     IIRDecimator<float> dec;
     setup(up, dec);
   
@@ -29,7 +29,7 @@ static void test1()
 {
     float buffer[16];
 
-    IIRUpsampler up;
+    IIRUpsampler<float> up;
     IIRDecimator<float> dec;
     setup(up, dec);
 
@@ -43,7 +43,7 @@ static void test2()
 {
     float buffer[16];
 
-    IIRUpsampler up;
+    IIRUpsampler<float> up;
     IIRDecimator<float> dec;
     setup(up, dec);
 
@@ -116,6 +116,21 @@ void _testRingBuffer()
    testFull<TRingBuffer>();
 }
 
+static void testAtomicSpace()
+{
+    AtomicRingBuffer<int, 4> rb;
+    assertEQ(rb.space(), 4);
+    rb.push(1);
+    rb.push(2);
+    assertEQ(rb.space(), 2);
+    assertEQ(rb.available(), 2);
+    assertEQ(rb.peek(), 1);
+    assertEQ(rb.pop(), 1);
+    assertEQ(rb.space(), 3);
+    assertEQ(rb.available(), 1);
+    assertEQ(rb.peek(), 2);
+}
+
 void testRingBuffer()
 {
     testConstruct<SqRingBuffer<int, 4>>();
@@ -128,6 +143,7 @@ void testRingBuffer()
 
     testOne<SqRingBuffer<const char *, 1 >> ();
     testOne<AtomicRingBuffer<const char *, 1 >>();
+    testAtomicSpace();
 }
 
 /***********************************************************************************************/
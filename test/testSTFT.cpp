@@ -0,0 +1,116 @@
+
+#include "asserts.h"
+
+#include "AlignedAllocator.h"
+#include "AudioMath.h"
+#include "FFTData.h"
+#include "STFT.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+extern void testFinalLeaks();
+
+static float testSignal(int i)
+{
+    return float(std::sin(i * .05) + .3 * std::sin(i * .31));
+}
+
+/**
+ * With no callback, output should be the input, delayed.
+ */
+static void testIdentity(int frameSize, int hopSize, STFT::Window window, bool useThread)
+{
+    STFT stft(frameSize, hopSize, window, true, useThread);
+    const int latency = stft.getLatency();
+    const int expectedLatency = useThread ? frameSize + hopSize : frameSize;
+    assertEQ(latency, expectedLatency);
+
+    const int numSamples = 8 * frameSize;
+    std::vector<float> output;
+    for (int i = 0; i < numSamples; ++i) {
+        output.push_back(stft.step(testSignal(i)));
+        if (useThread && (i % hopSize == 0)) {
+            // give the worker plenty of time
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    assertEQ(stft._overruns(), 0);
+
+    // first frame won't be complete, so skip it
+    for (int i = latency + frameSize; i < numSamples; ++i) {
+        assertClose(output[i], testSignal(i - latency), .001);
+    }
+}
+
+static void testIdentity()
+{
+    testIdentity(512, 256, STFT::Window::SqrtHann, false);
+    testIdentity(512, 128, STFT::Window::Hann, false);
+    testIdentity(64, 64, STFT::Window::Rectangular, false);
+    testIdentity(512, 256, STFT::Window::SqrtHann, true);
+}
+
+static void testCallbackCount()
+{
+    int frames = 0;
+    int size = 0;
+    STFT stft(256, 64, STFT::Window::Hann, false, false);
+    stft.setCallback([&frames, &size](FFTDataCpx& spectrum) {
+        ++frames;
+        size = spectrum.size();
+    });
+    for (int i = 0; i < 1000; ++i) {
+        const float x = stft.step(testSignal(i));
+        assertEQ(x, 0);
+    }
+    assertEQ(frames, 1000 / 64);
+    assertEQ(size, 256);
+}
+
+/**
+ * A callback that clears everything above bin 8 should
+ * remove the high sine from the test signal.
+ */
+static void testLowpassCallback()
+{
+    const int frameSize = 512;
+    STFT stft(frameSize, frameSize / 2, STFT::Window::SqrtHann, true, false);
+    stft.setCallback([](FFTDataCpx& spectrum) {
+        for (int i = 8; i < spectrum.size(); ++i) {
+            spectrum.set(i, 0);
+        }
+    });
+
+    const int latency = stft.getLatency();
+    float maxError = 0;
+    for (int i = 0; i < 8 * frameSize; ++i) {
+        const float x = stft.step(testSignal(i));
+        if (i > latency + frameSize) {
+            const float expected = float(std::sin((i - latency) * .05));
+            maxError = std::max(maxError, std::abs(x - expected));
+        }
+    }
+    assertLT(maxError, .05);
+}
+
+static void testAlignedBuffers()
+{
+    for (int size = 1; size < 40; ++size) {
+        std::vector<float, AlignedAllocator<float>> buffer(size);
+        assertEQ(reinterpret_cast<uintptr_t>(buffer.data()) % 16, 0);
+        buffer.push_back(1);
+        assertEQ(reinterpret_cast<uintptr_t>(buffer.data()) % 16, 0);
+        assertEQ(buffer.back(), 1);
+    }
+}
+
+void testSTFT()
+{
+    testAlignedBuffers();
+    testIdentity();
+    testCallbackCount();
+    testLowpassCallback();
+    testFinalLeaks();
+}
@@ -342,6 +342,39 @@ static void testLabels()
     assert(x.size() == 4);
 }
 
+/**
+ * A clock edge that doesn't line up with the divider should
+ * still start the note on the very same sample.
+ */
+static void testClockEdgeIsSampleAccurate(int samplesOutOfStep)
+{
+    const int tkNum = 0;
+    const auto rate = SeqClock::ClockRate::Div64;
+    Sq4Ptr comp = make(rate, 4, true, tkNum);
+    stepN(comp, 16);
+
+    // play to just before the first note, at 1.0
+    play(comp, rate, 1.f);
+    assertLT(comp->outputs[comp->GATE0_OUTPUT].getVoltage(0), 5);
+
+    // get out of step with the divider.
+    stepN(comp, samplesOutOfStep);
+    assertLT(comp->outputs[comp->GATE0_OUTPUT].getVoltage(0), 5);
+
+    comp->inputs[Sq4::CLOCK_INPUT].setVoltage(10, 0);
+    stepN(comp, 1);
+    assertGT(comp->outputs[comp->GATE0_OUTPUT].getVoltage(0), 5);
+    assertEQ(comp->outputs[comp->CV0_OUTPUT].getVoltage(0), 7.5f);
+}
+
+static void testClockEdgeIsSampleAccurate()
+{
+    // try every phase of the divider
+    for (int i = 0; i < 4; ++i) {
+        testClockEdgeIsSampleAccurate(i);
+    }
+}
+
 void testSeqComposite4()
 {
     test0();
@@ -350,4 +383,5 @@ void testSeqComposite4()
     testLabels();
     testSelectSectionWithCV();
     testSelectSectionWithCVPoly();
+    testClockEdgeIsSampleAccurate();
 }
\ No newline at end of file
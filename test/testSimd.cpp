@@ -188,6 +188,40 @@ static void testBools() {
     // I forgot what this test was going to do...
 }
 
+// float_8 should behave like two float_4
+static void testFloat8() {
+    const float_4 aLo(1, -2, 3, -4);
+    const float_4 aHi(5, -6, 7, -8);
+    const float_4 bLo(2, 2, 2, 2);
+    const float_4 bHi(6, 6, -8, -8);
+    const float_8 a(aLo, aHi);
+    const float_8 b(bLo, bHi);
+
+    simd_assertEQ(a.lo(), aLo);
+    simd_assertEQ(a.hi(), aHi);
+    assertEQ(a[5], -6);
+
+    const float_4 expectedHi = aHi * bHi + aHi;
+    const float_4 expectedLo = aLo / bLo - bLo;
+    simd_assertEQ((a * b + a).hi(), expectedHi);
+    simd_assertEQ((a / b - b).lo(), expectedLo);
+
+    const float_8 mask = a < b;
+    simd_assertMask(mask);
+    assertEQ(movemask(mask.lo()), movemask(aLo < bLo));
+    assertEQ(movemask(mask.hi()), movemask(aHi < bHi));
+    simd_assertEQ(SimdBlocks::ifelse(mask, a, b).hi(), SimdBlocks::ifelse(aHi < bHi, aHi, bHi));
+    simd_assertEQ(SimdBlocks::max(a, b).lo(), SimdBlocks::max(aLo, bLo));
+    simd_assertEQ(SimdBlocks::abs(a).hi(), float_4(5, 6, 7, 8));
+
+    float buffer[8];
+    float_8 c = a;
+    c[7] = 100;
+    c.store(buffer);
+    assertEQ(buffer[7], 100);
+    simd_assertEQ(float_8::load(buffer).lo(), aLo);
+}
+
 void testSimd() {
     testAsserts();
     testMask();
@@ -197,5 +231,6 @@ void testSimd() {
     testDeInterleaveHigh();
 
     testBools();
+    testFloat8();
 }
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 
 #include "LookupTableFactory.h"
+#include "ObjectCache.h"
+#include "SimdLookupTable.h"
 #include "asserts.h"
 
 #include "simd.h"
@@ -153,11 +155,68 @@ static void compareSecond()
     assertClose(maxErr, 0, .03);
 }
 
+static void testLookup4(std::shared_ptr<LookupTableParams<float>> params)
+{
+    const float delta = (params->xMax - params->xMin) / 1000.f;
+    for (float x = params->xMin; x <= params->xMax; x += delta) {
+        float_4 input(x, x + delta / 4, x + delta / 2, x + 3 * delta / 4);
+        float_4 y = SimdLookupTable::lookup4(*params, input);
+        for (int i = 0; i < 4; ++i) {
+            const float expected = LookupTable<float>::lookup(*params, input[i], true);
+            assertClose(y[i], expected, .00001);
+        }
+    }
+}
+
+static void testLookup4()
+{
+    testLookup4(ObjectCache<float>::getSinLookup());
+    testLookup4(ObjectCache<float>::getMixerPanL());
+    testLookup4(ObjectCache<float>::getMixerPanR());
+    testLookup4(ObjectCache<float>::getAudioTaper());
+    testLookup4(ObjectCache<float>::getExp2());
+}
+
+static void testLookup4OutsideDomain()
+{
+    auto params = ObjectCache<float>::getMixerPanL();
+    float_4 input(-10, params->xMin, params->xMax, 10);
+    float_4 y = SimdLookupTable::lookup4(*params, input);
+    assertClose(y[0], LookupTable<float>::lookup(*params, params->xMin), .00001);
+    assertClose(y[1], LookupTable<float>::lookup(*params, params->xMin), .00001);
+    assertClose(y[2], LookupTable<float>::lookup(*params, params->xMax), .00001);
+    assertClose(y[3], LookupTable<float>::lookup(*params, params->xMax), .00001);
+}
+
+static void testLookupBank()
+{
+    LookupTableBank4 bank;
+    LookupTableParams<float> tables[4];
+    auto f = [](double x, int table) {
+        return std::sin(x * (table + 1));
+    };
+    bank.init(64, -1, 2, f);
+    for (int i = 0; i < 4; ++i) {
+        LookupTable<float>::init(tables[i], 64, -1, 2, [f, i](double x) {
+            return f(x, i);
+        });
+    }
+    for (float x = -1; x <= 2; x += .01f) {
+        float_4 y = bank.lookup(x);
+        for (int i = 0; i < 4; ++i) {
+            assertClose(y[i], LookupTable<float>::lookup(tables[i], x), .00001);
+        }
+    }
+}
+
 void testSimdLookup()
 {
    // test0();
     compare();
     compare3();
+    testLookup4();
+    testLookup4OutsideDomain();
+    testLookupBank();
   //  compare2();
  //   compareSecond();
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 
+#include "TestComposite.h"
+#include "Sines.h"
 #include "SinesVCO.h"
+#include "tutil.h"
 
 #include "asserts.h"
 
@@ -27,8 +30,71 @@ static void testSines1()
    
 }
 
+static void testSinesTooHigh()
+{
+    SinesVCO<float_4> v;
+    float_4 freq(1000);
+    freq[2] = 30000;
+    v.setFrequency(freq, 44100.f);
+    float_4 deltaT = 1.f / 44100.f;
+    v.process(deltaT);
+    float_4 x = v.process(deltaT);
+    assertGT(x[0], .1);
+    assertClose(x[2], 0, .0001);
+}
+
+using Organ = Sines<TestComposite>;
+
+static void setupOrgan(Organ& organ, int channels)
+{
+    initComposite(organ);
+    organ.outputs[Organ::MAIN_OUTPUT].channels = 1;
+    organ.inputs[Organ::VOCT_INPUT].channels = channels;
+    for (int i = 0; i < channels; ++i) {
+        organ.inputs[Organ::VOCT_INPUT].setVoltage(-1 + .25f * i, i);
+    }
+    organ.params[Organ::PERCUSSION1_PARAM].value = 8;
+}
+
+// every voice of a poly organ should sound like a mono one
+static void testOrganPolyMatchesMono(int channels)
+{
+    Organ poly;
+    setupOrgan(poly, channels);
+
+    std::vector<std::shared_ptr<Organ>> monos;
+    for (int i = 0; i < channels; ++i) {
+        auto mono = std::make_shared<Organ>();
+        setupOrgan(*mono, 1);
+        mono->inputs[Organ::VOCT_INPUT].setVoltage(-1 + .25f * i, 0);
+        monos.push_back(mono);
+    }
+
+    Organ::ProcessArgs args;
+    args.sampleTime = 1.f / 44100.f;
+    args.sampleRate = 44100;
+    float maxOutput = 0;
+    for (int sample = 0; sample < 2000; ++sample) {
+        poly.process(args);
+        for (auto mono : monos) {
+            mono->process(args);
+        }
+        assertEQ(poly.outputs[Organ::MAIN_OUTPUT].channels, channels);
+        for (int i = 0; i < channels; ++i) {
+            const float expected = monos[i]->outputs[Organ::MAIN_OUTPUT].getVoltage(0);
+            assertClose(poly.outputs[Organ::MAIN_OUTPUT].getVoltage(i), expected, .001);
+            maxOutput = std::max(maxOutput, expected);
+        }
+    }
+    assertGT(maxOutput, 1);
+}
+
 void testSines()
 {
     testSines0();
     testSines1();
+    testSinesTooHigh();
+    testOrganPolyMatchesMono(2);
+    testOrganPolyMatchesMono(9);
+    testOrganPolyMatchesMono(16);
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+
+#include "asserts.h"
+#include "AudioMath.h"
+#include "SpectralReport.h"
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+static const double sampleRate = 44100;
+
+static std::vector<float> makeSignal(int size, std::function<float(int)> func)
+{
+    std::vector<float> ret(size);
+    for (int i = 0; i < size; ++i) {
+        ret[i] = func(i);
+    }
+    return ret;
+}
+
+static void testPowerSpectrumSine()
+{
+    const int frameSize = 1024;
+    const int bin = 100;
+    auto signal = makeSignal(frameSize * 4, [](int i) {
+        return float(std::sin(AudioMath::_2Pi * i * bin / frameSize));
+    });
+    auto power = SpectralReport::getPowerSpectrum(signal, frameSize);
+    assertEQ(power.size(), frameSize / 2 + 1);
+
+    int peak = 0;
+    for (int i = 0; i < int(power.size()); ++i) {
+        if (power[i] > power[peak]) {
+            peak = i;
+        }
+    }
+    assertEQ(peak, bin);
+    assertLT(power[bin + 10], power[bin] * 1e-8);
+}
+
+static void testAnalyzePureSine()
+{
+    const double freq = 1234.5;
+    auto signal = makeSignal(int(sampleRate), [freq](int i) {
+        return float(std::sin(AudioMath::_2Pi * i * freq / sampleRate));
+    });
+    auto metrics = SpectralReport::analyze(signal, 1200, sampleRate);
+    assertClose(metrics.fundamental, freq, .5);
+    assertLT(metrics.thdDb, -80);
+    assertLT(metrics.aliasDb, -80);
+    assertGT(metrics.snrDb, 80);
+}
+
+static void testAnalyzeSecondHarmonic()
+{
+    const double freq = 1000;
+    auto signal = makeSignal(int(sampleRate), [freq](int i) {
+        const double phase = AudioMath::_2Pi * i * freq / sampleRate;
+        return float(std::sin(phase) + .1 * std::sin(2 * phase));
+    });
+    auto metrics = SpectralReport::analyze(signal, freq, sampleRate);
+    assertClose(metrics.thdDb, -20, .1);
+    assertLT(metrics.aliasDb, -80);
+}
+
+static void testAnalyzeNaiveSaw()
+{
+    // a saw with no band limiting is full of alias
+    const double freq = 3000;
+    auto signal = makeSignal(int(sampleRate), [freq](int i) {
+        const double phase = std::fmod(i * freq / sampleRate, 1.0);
+        return float(2 * phase - 1);
+    });
+    auto metrics = SpectralReport::analyze(signal, freq, sampleRate);
+    assertClose(metrics.fundamental, freq, 1);
+    assertGT(metrics.aliasDb, -40);
+    assertLT(metrics.snrDb, 40);
+}
+
+static void testRun()
+{
+    SpectralReport report(.5, sampleRate);
+    report.addTarget("sine", [](double freq, double sampleRate) {
+        std::shared_ptr<int> counter = std::make_shared<int>(0);
+        return [counter, freq, sampleRate]() {
+            return float(std::sin(AudioMath::_2Pi * (*counter)++ * freq / sampleRate));
+        };
+    });
+
+    auto results = report.run({440, 880}, 2);
+    assertEQ(results.size(), 2);
+    assertEQ(results[0].target, "sine");
+    assertEQ(results[0].freq, 440);
+    assertEQ(results[1].freq, 880);
+    assertClose(results[0].metrics.fundamental, 440, 1);
+    assertClose(results[1].metrics.fundamental, 880, 1);
+    assertGT(results[1].nsPerSample, 0);
+
+    std::stringstream s;
+    SpectralReport::writeCSV(s, results);
+    std::string line;
+    int lines = 0;
+    while (std::getline(s, line)) {
+        ++lines;
+    }
+    assertEQ(lines, 3);
+}
+
+void testSpectralReport()
+{
+    testPowerSpectrumSine();
+    testAnalyzePureSine();
+    testAnalyzeSecondHarmonic();
+    testAnalyzeNaiveSaw();
+    testRun();
+}
@@ -0,0 +1,142 @@
+
+#include "asserts.h"
+#include "MinBlepImpulse.h"
+#include "ObjectCache.h"
+#include "SqMinBlep.h"
+
+#include <cmath>
+
+static void testImpulse()
+{
+    MinBlepImpulse impulse(16, 16);
+    assertEQ(impulse.size(), 2 * 16 * 16);
+
+    const float* data = impulse.data();
+    assertClose(data[0], 0, .001);
+    assertClose(data[impulse.size() - 1], 1, .001);
+    assertEQ(data[impulse.size()], 1);
+
+    // min phase step rings above one, but not too much
+    float peak = 0;
+    for (int i = 0; i < impulse.size(); ++i) {
+        peak = std::max(peak, data[i]);
+    }
+    assertGT(peak, 1.1);
+    assertLT(peak, 1.25);
+}
+
+static void testImpulseShared()
+{
+    auto a = ObjectCache<float>::getMinBlepImpulse(16, 16);
+    auto b = ObjectCache<float>::getMinBlepImpulse(16, 16);
+    auto c = ObjectCache<float>::getMinBlepImpulse(16, 32);
+    assert(a.get() == b.get());
+    assert(a.get() != c.get());
+    assertEQ(c->size(), 2 * 16 * 32);
+}
+
+/**
+ * An edge exactly on this sample should get cancelled by the minBLEP,
+ * and it should all be gone after 2 * Z samples.
+ */
+static void testScalar()
+{
+    SqMinBlep<16, 16, float> minBlep;
+    minBlep.insertDiscontinuity(0, 2);
+    assertClose(minBlep.process(), -2, .01);
+    for (int i = 1; i < 32; ++i) {
+        minBlep.process();
+    }
+    for (int i = 0; i < 32; ++i) {
+        assertEQ(minBlep.process(), 0);
+    }
+}
+
+static void testOutOfRange()
+{
+    SqMinBlep<16, 16, float> minBlep;
+    minBlep.insertDiscontinuity(.5f, 2);
+    minBlep.insertDiscontinuity(-1, 2);
+    for (int i = 0; i < 32; ++i) {
+        assertEQ(minBlep.process(), 0);
+    }
+}
+
+/**
+ * With p just above -1 the last points land on the end of the impulse.
+ * They must not read past it, and the edge must still be all gone after 2 * Z samples.
+ */
+static void testNearMinusOne()
+{
+    const float p = std::nextafter(-1.f, 0.f);
+    SqMinBlep<16, 16, float> scalarBlep;
+    SqMinBlep<16, 16, float_4> vectorBlep;
+    scalarBlep.insertDiscontinuity(p, 2);
+    vectorBlep.insertDiscontinuities(float_4(p), float_4(2));
+
+    for (int i = 0; i < 32; ++i) {
+        const float x = scalarBlep.process();
+        const float_4 v = vectorBlep.process();
+        assert(std::isfinite(x));
+        for (int lane = 0; lane < 4; ++lane) {
+            assertClose(v[lane], x, .00001);
+        }
+        if (i == 31) {
+            assertClose(x, 0, .001);
+        }
+    }
+}
+
+/**
+ * Each lane of insertDiscontinuities should be the same as a scalar insert.
+ */
+static void testVectorMatchesScalar()
+{
+    const float_4 p(-.1f, -.5f, 0, -.99f);
+    const float_4 x(1, -2, 3, .5f);
+
+    SqMinBlep<16, 16, float_4> vectorBlep;
+    SqMinBlep<16, 16, float> scalarBlep[4];
+    vectorBlep.insertDiscontinuities(p, x);
+    for (int i = 0; i < 4; ++i) {
+        scalarBlep[i].insertDiscontinuity(p[i], x[i]);
+    }
+
+    for (int n = 0; n < 32; ++n) {
+        const float_4 v = vectorBlep.process();
+        for (int i = 0; i < 4; ++i) {
+            assertClose(v[i], scalarBlep[i].process(), .00001);
+        }
+    }
+}
+
+static void testVectorSkipsLanes()
+{
+    SqMinBlep<16, 16, float_4> minBlep;
+
+    // lane 0 has no jump, lane 1 is out of range, lane 2 is the only real one
+    // lane 3 is garbage, but no jump
+    const float_4 p(-.5f, .5f, -.5f, 1000);
+    const float_4 x(0, 2, 2, 0);
+    minBlep.insertDiscontinuities(p, x);
+
+    float_4 total = 0;
+    for (int n = 0; n < 32; ++n) {
+        total += rack::simd::fabs(minBlep.process());
+    }
+    assertEQ(total[0], 0);
+    assertEQ(total[1], 0);
+    assertGT(total[2], 0);
+    assertEQ(total[3], 0);
+}
+
+void testSqMinBlep()
+{
+    testImpulse();
+    testImpulseShared();
+    testScalar();
+    testOutOfRange();
+    testNearMinusOne();
+    testVectorMatchesScalar();
+    testVectorSkipsLanes();
+}
@@ -61,6 +61,46 @@ static void testSubLevel(bool sub, int vcoNumber, int side)
     }
 }
 
+static void testSubLevelEco(bool sub, bool saw, int side)
+{
+    VoltageControlledOscillator<16, 16, rack::simd::float_4, rack::simd::int32_4> osc;
+    osc.index = 0;
+    const float deltaTime = 1.f / 44100.f;
+    const float_4 sawMask = saw ? float_4::mask() : float_4(0);
+    osc.setWaveform(sawMask, sawMask);
+    osc.setEco(true);
+    osc.setupSub(1, rack::simd::float_4(2), rack::simd::int32_4(4), rack::simd::int32_4(3));
+    osc.computeOffsetCorrection(deltaTime);
+    std::function<float()> lambda = [&osc, deltaTime, sub, side]() {
+        osc.process(deltaTime, 0);
+        return sub ? osc.sub(side)[0] : osc.main()[0];
+    };
+
+    // no DC in eco, and the band-limited edges ring (Gibbs) by about 9% of the jump
+    auto stats = getSignalStats(10000, lambda);
+    assertClose(std::get<1>(stats), 1, .25);       // max
+    assertClose(std::get<0>(stats), -1, .25);      // min
+    assertClose(std::get<2>(stats), 0, .05);       // average
+}
+
+static void testSubEco()
+{
+    Comp sub;
+    initComposite(sub);
+    sub.params[Comp::ECO_PARAM].value = 1;
+    sub.outputs[Comp::MAIN_OUTPUT].channels = 1;
+
+    float maxOut = 0;
+    for (int i = 0; i < 10000; ++i) {
+        sub.step();
+        const float x = sub.outputs[Comp::MAIN_OUTPUT].getVoltage(0);
+        assert(std::isfinite(x));
+        maxOut = std::max(maxOut, std::abs(x));
+    }
+    assertGT(maxOut, 1);
+    assertLT(maxOut, 12);
+}
+
 static void resetChan(Comp& sub) {
     // this doesn't look right
     #if 0
@@ -455,6 +495,14 @@ void testSub()
 
     testSubLevel(false, 0, 1);
     testSubLevel(false, 1, 1);
+
+    testSubLevelEco(false, true, 0);
+    testSubLevelEco(true, true, 0);
+    testSubLevelEco(true, true, 1);
+    testSubLevelEco(false, false, 0);
+    testSubLevelEco(true, false, 0);
+    testSubLevelEco(true, false, 1);
+    testSubEco();
 #else
     printf("skipping testSub - need minBlep\n");
 #endif
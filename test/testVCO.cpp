@@ -4,10 +4,13 @@
 #include "Analyzer.h"
 #include "asserts.h"
 #include "CHB.h"
+#include "FFT.h"
+#include "FFTData.h"
 //#include "EvenVCO.h"
 #include "FunVCO.h"
 #include "SawOscillator.h"
 #include "TestComposite.h"
+#include "tutil.h"
 
 
 //using EVCO = EvenVCO <TestComposite>;
@@ -229,6 +232,141 @@ static void testClamp()
     assertEQ(std::clamp(12, 13, 15), 13);
 }
 
+static void setupPolyCh(CH& vco, const std::vector<float>& cv)
+{
+    initComposite(vco);
+    vco.outputs[CH::MIX_OUTPUT].channels = 1;       // connected
+    vco.inputs[CH::CV_INPUT].channels = int(cv.size());
+    for (int i = 0; i < int(cv.size()); ++i) {
+        vco.inputs[CH::CV_INPUT].setVoltage(cv[i], i);
+    }
+}
+
+// each channel of a poly CHB should be the same as a mono one at that pitch
+static void testPolyChannelsCh(int numChannels)
+{
+    std::vector<float> cv;
+    for (int i = 0; i < numChannels; ++i) {
+        cv.push_back(-2 + .3f * i);
+    }
+
+    CH poly;
+    setupPolyCh(poly, cv);
+    poly.params[CH::PARAM_H2].value = 1;
+
+    std::vector<std::shared_ptr<CH>> monos;
+    for (int i = 0; i < numChannels; ++i) {
+        auto mono = std::make_shared<CH>();
+        setupPolyCh(*mono, {cv[i]});
+        mono->params[CH::PARAM_H2].value = 1;
+        monos.push_back(mono);
+    }
+
+    for (int sample = 0; sample < 1000; ++sample) {
+        poly.step();
+        for (auto mono : monos) {
+            mono->step();
+        }
+        assertEQ(poly.outputs[CH::MIX_OUTPUT].channels, numChannels);
+        for (int i = 0; i < numChannels; ++i) {
+            const float expected = monos[i]->outputs[CH::MIX_OUTPUT].getVoltage(0);
+            assertClose(poly.outputs[CH::MIX_OUTPUT].getVoltage(i), expected, .0001);
+        }
+    }
+}
+
+// with just the third harmonic up, the output should be at 3X the oscillator
+static float getPeakFreqCh(float cv, int harmonic)
+{
+    CH vco;
+    setupPolyCh(vco, {cv});
+    vco.params[CH::PARAM_H0].value = 0;
+    vco.params[CH::PARAM_H0 + harmonic - 1].value = 1;
+
+    const int numSamples = 16 * 1024;
+    FFTDataCpx spectrum(numSamples);
+    Analyzer::getSpectrum(spectrum, false, [&vco]() {
+        vco.step();
+        return vco.outputs[CH::MIX_OUTPUT].getVoltage(0);
+    });
+
+    const int maxBin = Analyzer::getMax(spectrum);
+    if ((maxBin < 0) || (std::abs(spectrum.get(maxBin)) < .001)) {
+        return 0;
+    }
+    return float(FFT::bin2Freq(maxBin, 44100, numSamples));
+}
+
+static void testHarmonicCh()
+{
+    const float fundamental = desiredPitch(0, 0, 0, 0, 0);
+    const float binWidth = 44100.f / (16 * 1024);
+    assertClose(getPeakFreqCh(0, 1), fundamental, binWidth);
+    assertClose(getPeakFreqCh(0, 3), 3 * fundamental, 3 * binWidth);
+}
+
+// harmonics above nyquist are removed
+static void testNoAliasCh()
+{
+    // 3k fundamental
+    const float cv = std::log2(3000.f / desiredPitch(0, 0, 0, 0, 0));
+    assertClose(getPeakFreqCh(cv, 5), 15000, 50);
+    assertEQ(getPeakFreqCh(cv, 8), 0);
+}
+
+
+/**
+ * Drives CHB hard into the clipper, with just the fundamental up.
+ * Returns the biggest spectral line that is not a harmonic, relative to the fundamental.
+ */
+static float getClipAliasCh(bool external)
+{
+    const int numSamples = 16 * 1024;
+    const double freq = Analyzer::makeEvenPeriod(3000, 44100, numSamples);
+
+    CH vco;
+    setupPolyCh(vco, {std::log2(float(freq) / desiredPitch(0, 0, 0, 0, 0))});
+    vco.params[CH::PARAM_EXTGAIN].value = 5;
+    if (external) {
+        vco.inputs[CH::AUDIO_INPUT].channels = 1;
+    }
+
+    double phase = 0;
+    auto run = [&vco, &phase, freq, external]() {
+        if (external) {
+            phase += freq / 44100;
+            phase -= std::floor(phase);
+            vco.inputs[CH::AUDIO_INPUT].setVoltage(float(std::sin(phase * 2 * AudioMath::Pi)), 0);
+        }
+        vco.step();
+        return vco.outputs[CH::MIX_OUTPUT].getVoltage(0);
+    };
+
+    // let the decimator settle
+    for (int i = 0; i < 2000; ++i) {
+        run();
+    }
+
+    FFTDataCpx spectrum(numSamples);
+    Analyzer::getSpectrum(spectrum, true, run);
+    const int fundamentalBin = Analyzer::getMax(spectrum);
+    float worst = 0;
+    for (int bin = 1; bin < numSamples / 2; ++bin) {
+        const int nearestHarmonic = ((bin + fundamentalBin / 2) / fundamentalBin) * fundamentalBin;
+        if (std::abs(bin - nearestHarmonic) > 8) {
+            worst = std::max(worst, float(std::abs(spectrum.get(bin))));
+        }
+    }
+    return worst / float(std::abs(spectrum.get(fundamentalBin)));
+}
+
+// clipping runs oversampled, so the aliases are more than 40 db down
+static void testClipAliasCh()
+{
+    assertLT(getClipAliasCh(false), .01);
+    assertLT(getClipAliasCh(true), .01);
+}
+
 #if 1
 void testVCO()
 {
@@ -243,6 +381,13 @@ void testVCO()
     testClamp();
   //  testTuneEv();
     testTuneCh();
+    testPolyChannelsCh(1);
+    testPolyChannelsCh(4);
+    testPolyChannelsCh(7);
+    testPolyChannelsCh(16);
+    testHarmonicCh();
+    testNoAliasCh();
+    testClipAliasCh();
 }
 #else
 void testVCO()
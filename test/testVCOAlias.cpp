@@ -1,6 +1,7 @@
 
 #include "Analyzer.h"
 #include "asserts.h"
+#include "BasicVCO.h"
 #include "FunVCO.h"
 #include "SawOscillator.h"
 #include "SinOscillator.h"
@@ -422,6 +423,22 @@ static void testAliasFun(double normalizedFreq)
         }, freq, numSamples);
 }
 
+static void testAliasBasic(double normalizedFreq, bool eco)
+{
+    double freq = Analyzer::makeEvenPeriod(sampleRate * normalizedFreq, sampleRate, numSamples);
+    printHeader(eco ? "Basic saw eco" : "Basic saw", sampleRate * normalizedFreq, freq);
+
+    auto vco = std::make_shared<BasicVCO>();
+    const float pitch = float(std::log2(freq / rack::dsp::FREQ_C4));
+    vco->setPitch(float_4(pitch), 1.0f / sampleRate, sampleRate);
+    BasicVCO::processFunction proc = vco->getProcPointer(BasicVCO::Waveform::SAW, eco);
+
+    testAlias([vco, proc]() {
+        const float deltaTime = 1.0f / sampleRate;
+        const float_4 x = ((*vco).*proc)(deltaTime);
+        return 3 * x[0];
+        }, freq, numSamples);
+}
 
 /*
 First try:
@@ -508,5 +525,7 @@ void testVCOAlias()
        // testRawSaw<float>(f);
        // testAliasFunOrig(f);
         testAliasFun(f);
+        testAliasBasic(f, false);
+        testAliasBasic(f, true);
     }
 }
\ No newline at end of file